@@ -0,0 +1,148 @@
+/**
+ * @file BitFaults.cpp
+ * @brief Implements the mask compilation and application for discrete bit faults.
+ */
+#include "BitFaults.hpp"
+#include <algorithm>
+#include <cmath>
+
+void PackedBooleans::unpack(const uint64_t* words, size_t count, fmi2Boolean out[]) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = static_cast<fmi2Boolean>((words[i >> 6] >> (i & 63)) & 1u);
+    }
+}
+
+BitFaultEngine::BitFaultEngine(size_t nIntegers, size_t nBooleans, const std::vector<BitFault>& faults, uint64_t seed)
+    : m_nIntegers(nIntegers), m_nBooleans(nBooleans), m_rngState(seed ? seed : 0x9E3779B97F4A7C15ull) {
+
+    // Clip every fault to the bank it targets; faults outside the bank are dropped.
+    for (BitFault f : faults) {
+        const size_t bankSize = (f.kind == DiscreteKind::Integer) ? m_nIntegers : m_nBooleans;
+        if (f.first >= bankSize || f.count == 0) continue;
+        f.count = static_cast<uint32_t>(std::min<size_t>(f.count, bankSize - f.first));
+        m_faults.push_back(f);
+    }
+    m_active.assign(m_faults.size(), 0);
+
+    m_intMasks.reset(m_nIntegers);
+    m_boolMasks.reset((m_nBooleans + 63) / 64);
+    m_intErrors.assign(m_nIntegers, 0);
+    m_boolErrors.assign((m_nBooleans + 63) / 64, 0);
+}
+
+// xorshift64*: cheap, deterministic per instance, good enough for fault sampling.
+uint64_t BitFaultEngine::nextRandom() {
+    m_rngState ^= m_rngState >> 12;
+    m_rngState ^= m_rngState << 25;
+    m_rngState ^= m_rngState >> 27;
+    return m_rngState * 0x2545F4914F6CDD1Dull;
+}
+
+double BitFaultEngine::nextUniform() {
+    // 53 random bits mapped to (0, 1]; never returns 0 so log() stays finite.
+    return (static_cast<double>(nextRandom() >> 11) + 1.0) * (1.0 / 9007199254740992.0);
+}
+
+void BitFaultEngine::update(double time) {
+    bool changed = false;
+    m_anyRandomActive = false;
+    for (size_t i = 0; i < m_faults.size(); i++) {
+        const uint8_t active = (time >= m_faults[i].startTime && time < m_faults[i].endTime) ? 1 : 0;
+        if (active != m_active[i]) { m_active[i] = active; changed = true; }
+        if (active && m_faults[i].type == BitFaultType::BitErrorRate) m_anyRandomActive = true;
+    }
+    if (changed) rebuildStaticMasks();
+
+    if (m_anyRandomActive) {
+        std::fill(m_intErrors.begin(), m_intErrors.end(), 0u);
+        std::fill(m_boolErrors.begin(), m_boolErrors.end(), 0ull);
+        for (size_t i = 0; i < m_faults.size(); i++) {
+            if (m_active[i] && m_faults[i].type == BitFaultType::BitErrorRate) drawBitErrors(m_faults[i]);
+        }
+    }
+}
+
+void BitFaultEngine::rebuildStaticMasks() {
+    m_intMasks.reset(m_nIntegers);
+    m_boolMasks.reset((m_nBooleans + 63) / 64);
+
+    for (size_t i = 0; i < m_faults.size(); i++) {
+        const BitFault& f = m_faults[i];
+        if (!m_active[i] || f.type == BitFaultType::BitErrorRate) continue;
+
+        if (f.kind == DiscreteKind::Integer) {
+            std::vector<uint32_t>* target = &m_intMasks.flip;
+            if (f.type == BitFaultType::StuckAt0) target = &m_intMasks.clear;
+            else if (f.type == BitFaultType::StuckAt1) target = &m_intMasks.set;
+            for (size_t v = f.first; v < f.first + f.count; v++) (*target)[v] |= f.mask;
+        } else {
+            std::vector<uint64_t>* target = &m_boolMasks.flip;
+            if (f.type == BitFaultType::StuckAt0) target = &m_boolMasks.clear;
+            else if (f.type == BitFaultType::StuckAt1) target = &m_boolMasks.set;
+            // Fill whole words at once; only the partial words at either end need bit masks.
+            size_t first = f.first, last = f.first + f.count; // [first, last)
+            while (first < last) {
+                const size_t w = first >> 6, lo = first & 63;
+                const size_t hi = std::min<size_t>(64, lo + (last - first));
+                const uint64_t bits = (hi == 64 ? ~uint64_t{0} : ((uint64_t{1} << hi) - 1)) & (~uint64_t{0} << lo);
+                (*target)[w] |= bits;
+                first += hi - lo;
+            }
+        }
+    }
+}
+
+void BitFaultEngine::drawBitErrors(const BitFault& f) {
+    const size_t bitsPerVar = (f.kind == DiscreteKind::Integer) ? 32 : 1;
+    const size_t nBits = static_cast<size_t>(f.count) * bitsPerVar;
+    if (f.rate <= 0.0) return;
+
+    // Geometric skipping: jump straight to the next erroneous bit instead of testing each one.
+    const double logKeep = (f.rate < 1.0) ? std::log1p(-f.rate) : 0.0;
+    size_t pos = 0;
+    while (true) {
+        if (f.rate < 1.0) {
+            const double gap = std::floor(std::log(nextUniform()) / logKeep);
+            if (gap >= static_cast<double>(nBits - pos)) break;
+            pos += static_cast<size_t>(gap);
+        }
+        if (pos >= nBits) break;
+
+        if (f.kind == DiscreteKind::Integer) {
+            const uint32_t bit = uint32_t{1} << (pos & 31);
+            if (f.mask & bit) m_intErrors[f.first + (pos >> 5)] |= bit;
+        } else {
+            const size_t b = f.first + pos;
+            m_boolErrors[b >> 6] |= uint64_t{1} << (b & 63);
+        }
+        pos++;
+    }
+}
+
+void BitFaultEngine::applyIntegers(const fmi2Integer* in, fmi2Integer* out) const {
+    const uint32_t* flip = m_intMasks.flip.data();
+    const uint32_t* clear = m_intMasks.clear.data();
+    const uint32_t* set = m_intMasks.set.data();
+    for (size_t i = 0; i < m_nIntegers; i++) {
+        const uint32_t v = static_cast<uint32_t>(in[i]);
+        out[i] = static_cast<fmi2Integer>(((v ^ flip[i]) & ~clear[i]) | set[i]);
+    }
+    if (m_anyRandomActive) {
+        const uint32_t* err = m_intErrors.data();
+        for (size_t i = 0; i < m_nIntegers; i++) out[i] = static_cast<fmi2Integer>(static_cast<uint32_t>(out[i]) ^ err[i]);
+    }
+}
+
+void BitFaultEngine::applyBooleans(const uint64_t* in, uint64_t* out) const {
+    const size_t nWords = m_boolMasks.flip.size();
+    const uint64_t* flip = m_boolMasks.flip.data();
+    const uint64_t* clear = m_boolMasks.clear.data();
+    const uint64_t* set = m_boolMasks.set.data();
+    for (size_t w = 0; w < nWords; w++) {
+        out[w] = ((in[w] ^ flip[w]) & ~clear[w]) | set[w];
+    }
+    if (m_anyRandomActive) {
+        const uint64_t* err = m_boolErrors.data();
+        for (size_t w = 0; w < nWords; w++) out[w] ^= err[w];
+    }
+}
@@ -0,0 +1,115 @@
+/**
+ * @file BitFaults.hpp
+ * @brief Bit-level fault injection for the wrapper's Integer and Boolean variables.
+ *
+ * Booleans are held as a packed bitset (64 flags per word) and Integers as a plain
+ * array. Active faults are compiled into per-word flip/clear/set masks, so a step
+ * applies all of them with one branch-free pass that the compiler can vectorize.
+ */
+#ifndef BIT_FAULTS_HPP
+#define BIT_FAULTS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+extern "C" {
+#include "fmi2Functions.h"
+}
+
+// The kind of bit fault applied to the selected variables.
+enum class BitFaultType {
+    BitFlip,      // Invert the masked bits.
+    StuckAt0,     // Force the masked bits to 0.
+    StuckAt1,     // Force the masked bits to 1.
+    BitErrorRate  // Invert each masked bit independently with probability `rate` per step.
+};
+
+// Which variable bank a fault targets.
+enum class DiscreteKind { Integer, Boolean };
+
+// A single bit fault covering `count` consecutive bank positions starting at `first`.
+// Banks are indexed like model::Bank, not by value reference; the wrapper translates.
+struct BitFault {
+    DiscreteKind kind;
+    uint32_t first;
+    uint32_t count;
+    BitFaultType type;
+    uint32_t mask;     // Bits affected within each Integer; ignored for Booleans.
+    double startTime;
+    double endTime;
+    double rate;       // Per-bit, per-step error probability for BitErrorRate.
+};
+
+/**
+ * @class PackedBooleans
+ * @brief Stores fmi2Boolean variables as a bitset indexed by bank position.
+ */
+class PackedBooleans {
+public:
+    explicit PackedBooleans(size_t count) : m_count(count), m_words((count + 63) / 64, 0) {}
+
+    size_t size() const { return m_count; }
+    size_t wordCount() const { return m_words.size(); }
+    const uint64_t* words() const { return m_words.data(); }
+
+    bool get(size_t i) const { return (m_words[i >> 6] >> (i & 63)) & 1u; }
+    void set(size_t i, bool v) {
+        const uint64_t bit = uint64_t{1} << (i & 63);
+        m_words[i >> 6] = v ? (m_words[i >> 6] | bit) : (m_words[i >> 6] & ~bit);
+    }
+
+    // Expands a packed word array into one fmi2Boolean per variable.
+    static void unpack(const uint64_t* words, size_t count, fmi2Boolean out[]);
+
+private:
+    size_t m_count;
+    std::vector<uint64_t> m_words;
+};
+
+/**
+ * @class BitFaultEngine
+ * @brief Compiles a fault table into word masks and applies them to the discrete banks.
+ *
+ * Static faults (flip and stuck-at) are folded into masks only when the set of active
+ * faults changes; bit-error-rate faults draw a fresh random mask every step using
+ * geometric skipping, so the cost scales with the number of flipped bits.
+ */
+class BitFaultEngine {
+public:
+    BitFaultEngine(size_t nIntegers, size_t nBooleans, const std::vector<BitFault>& faults, uint64_t seed);
+
+    bool empty() const { return m_faults.empty(); }
+
+    // Refreshes the masks for the given simulation time. Call once per step before applying.
+    void update(double time);
+
+    // out[i] = ((in[i] ^ flip[i]) & ~clear[i]) | set[i], followed by any random bit errors.
+    void applyIntegers(const fmi2Integer* in, fmi2Integer* out) const;
+    void applyBooleans(const uint64_t* in, uint64_t* out) const;
+
+private:
+    template <typename Word>
+    struct Masks {
+        std::vector<Word> flip, clear, set;
+        void reset(size_t n) { flip.assign(n, 0); clear.assign(n, 0); set.assign(n, 0); }
+    };
+
+    void rebuildStaticMasks();
+    void drawBitErrors(const BitFault& f);
+    uint64_t nextRandom();
+    double nextUniform();
+
+    size_t m_nIntegers, m_nBooleans;
+    std::vector<BitFault> m_faults;    // Faults clipped to the configured banks.
+    std::vector<uint8_t> m_active;     // Activity flags from the previous update.
+    bool m_anyRandomActive = false;
+
+    Masks<uint32_t> m_intMasks;        // One lane per Integer.
+    Masks<uint64_t> m_boolMasks;       // One word per 64 Booleans.
+    std::vector<uint32_t> m_intErrors; // Random error masks for the current step.
+    std::vector<uint64_t> m_boolErrors;
+    uint64_t m_rngState;
+};
+
+#endif // BIT_FAULTS_HPP
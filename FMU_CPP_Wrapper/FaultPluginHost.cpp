@@ -0,0 +1,142 @@
+/**
+ * @file FaultPluginHost.cpp
+ * @brief Implements plugin discovery, ABI negotiation, state save/restore and block rewinding.
+ */
+#include "FaultPluginHost.hpp"
+#include "PlatformLibrary.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+FaultPluginHost::~FaultPluginHost() {
+    for (auto it = m_plugins.rbegin(); it != m_plugins.rend(); ++it) {
+        if (it->api->destroy) it->api->destroy(it->state);
+        FREE_LIBRARY(reinterpret_cast<DLL_HANDLE>(it->library));
+    }
+}
+
+const char* FaultPluginHost::getOption(void* host, const char* key) {
+    auto* self = static_cast<FaultPluginHost*>(host);
+    const std::string fullKey = "plugin." + self->m_currentPlugin + "." + key;
+    if (!self->m_config || !self->m_config->has(fullKey)) return nullptr;
+    self->m_optionValue = self->m_config->getString(fullKey);
+    return self->m_optionValue.c_str();
+}
+
+void FaultPluginHost::logFromPlugin(void* host, int status, const char* message) {
+    auto* self = static_cast<FaultPluginHost*>(host);
+    if (self->m_logger) self->m_logger(status, message ? message : "");
+}
+
+// Members beyond the size the plugin reported do not exist on its side.
+static bool hasStateSupport(const FaultPluginApi* api) {
+    return api->struct_size >= sizeof(FaultPluginApi) && api->state_size && api->save_state && api->restore_state;
+}
+
+void FaultPluginHost::loadAll(const std::string& resourcePath, const std::string& instanceName, const WrapperConfig* config, Logger logger) {
+    namespace fs = std::filesystem;
+    m_config = config;
+    m_logger = std::move(logger);
+
+    const fs::path dir = fs::path(resourcePath) / "plugins";
+    std::error_code ec;
+    if (!fs::is_directory(dir, ec)) return;
+
+    std::vector<fs::path> candidates;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        if (entry.is_regular_file() && entry.path().extension() == LIB_EXT) candidates.push_back(entry.path());
+    }
+    std::sort(candidates.begin(), candidates.end()); // Deterministic application order.
+
+    for (const fs::path& path : candidates) {
+        const std::string file = path.string();
+        DLL_HANDLE library = LOAD_LIBRARY(file.c_str());
+        if (!library) throw std::runtime_error("Could not load fault plugin: " + file);
+
+        auto getApi = reinterpret_cast<FaultPluginGetApiFn>(GET_FUNCTION(library, FAULT_PLUGIN_ENTRY));
+        const FaultPluginApi* api = getApi ? getApi(FAULT_PLUGIN_ABI_VERSION) : nullptr;
+        if (!api || api->abi_version != FAULT_PLUGIN_ABI_VERSION || api->struct_size < offsetof(FaultPluginApi, state_size)
+            || !api->name || !api->init || !api->apply_batch) {
+            FREE_LIBRARY(library);
+            throw std::runtime_error("Incompatible fault plugin (ABI " + std::to_string(FAULT_PLUGIN_ABI_VERSION) + " expected): " + file);
+        }
+
+        FaultPluginContext ctx{};
+        ctx.struct_size = sizeof(FaultPluginContext);
+        ctx.instance_name = instanceName.c_str();
+        ctx.resource_path = resourcePath.c_str();
+        ctx.get_option = &FaultPluginHost::getOption;
+        ctx.log = &FaultPluginHost::logFromPlugin;
+        ctx.host = this;
+
+        m_currentPlugin = api->name;
+        void* state = api->init(&ctx);
+        if (!state) {
+            FREE_LIBRARY(library);
+            throw std::runtime_error("Fault plugin '" + m_currentPlugin + "' failed to initialize.");
+        }
+
+        m_plugins.push_back({reinterpret_cast<void*>(library), api, state, api->name, file});
+        m_dispatch.push_back({api->apply_batch, state});
+        m_stateful = m_stateful || hasStateSupport(api);
+        logFromPlugin(this, 0, ("Loaded fault plugin '" + m_currentPlugin + "' from " + file).c_str());
+    }
+    m_currentPlugin.clear();
+}
+
+size_t FaultPluginHost::serializedStateSize() const {
+    size_t total = 0;
+    for (const Plugin& p : m_plugins) {
+        total += sizeof(uint64_t);
+        if (hasStateSupport(p.api)) total += p.api->state_size(p.state);
+    }
+    return total;
+}
+
+bool FaultPluginHost::saveState(std::vector<uint8_t>& out) const {
+    out.resize(serializedStateSize());
+    uint8_t* cursor = out.data();
+    for (const Plugin& p : m_plugins) {
+        const uint64_t size = hasStateSupport(p.api) ? p.api->state_size(p.state) : 0;
+        std::memcpy(cursor, &size, sizeof(size));
+        cursor += sizeof(size);
+        if (size && p.api->save_state(p.state, cursor, size) != FAULT_PLUGIN_OK) return false;
+        cursor += size;
+    }
+    return true;
+}
+
+bool FaultPluginHost::applyBlock(uint32_t vr, double* values, const double* times, size_t n) {
+    if (m_stateful) {
+        if (!saveState(m_checkpoint)) return false;
+        m_blockVr = vr;
+        m_blockValues.assign(values, values + n);
+        m_blockTimes.assign(times, times + n);
+    }
+    return applyBatch(vr, values, times, n);
+}
+
+// Replaying the used samples from the checkpoint leaves each plugin where the per-sample path
+// would have: its output for those samples is the same, and nothing was drawn for the rest.
+bool FaultPluginHost::rewindBlock(size_t used) {
+    if (!m_stateful || used >= m_blockValues.size()) return true;
+    if (!restoreState(m_checkpoint.data(), m_checkpoint.size())) return false;
+    m_blockValues.resize(used);
+    return used == 0 || applyBatch(m_blockVr, m_blockValues.data(), m_blockTimes.data(), used);
+}
+
+bool FaultPluginHost::restoreState(const uint8_t* data, size_t size) {
+    const uint8_t* end = data + size;
+    for (const Plugin& p : m_plugins) {
+        uint64_t chunk = 0;
+        if (static_cast<size_t>(end - data) < sizeof(chunk)) return false;
+        std::memcpy(&chunk, data, sizeof(chunk));
+        data += sizeof(chunk);
+        if (chunk > static_cast<uint64_t>(end - data)) return false;
+        if (chunk && (!hasStateSupport(p.api) || p.api->restore_state(p.state, data, chunk) != FAULT_PLUGIN_OK)) return false;
+        data += chunk;
+    }
+    return data == end;
+}
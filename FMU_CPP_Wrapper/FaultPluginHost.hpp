@@ -0,0 +1,98 @@
+/**
+ * @file FaultPluginHost.hpp
+ * @brief Discovers, loads and dispatches to fault-model plugins (see fault_plugin.h).
+ */
+#ifndef FAULT_PLUGIN_HOST_HPP
+#define FAULT_PLUGIN_HOST_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "fault_plugin.h"
+#include "WrapperConfig.hpp"
+
+/**
+ * @class FaultPluginHost
+ * @brief Owns the plugin libraries and their per-instance states for one wrapper instance.
+ *
+ * The hot path only touches `m_dispatch`, a flat array of (apply_batch, state) pairs
+ * resolved once at load time; everything else lives in `m_plugins`.
+ */
+class FaultPluginHost {
+public:
+    using Logger = std::function<void(int status, const std::string& message)>;
+
+    FaultPluginHost() = default;
+    ~FaultPluginHost();
+    FaultPluginHost(const FaultPluginHost&) = delete;
+    FaultPluginHost& operator=(const FaultPluginHost&) = delete;
+
+    /**
+     * @brief Loads every shared library in `<resourcePath>/plugins`, sorted by file name.
+     * @throws std::runtime_error if a library cannot be loaded or its init() fails.
+     */
+    void loadAll(const std::string& resourcePath, const std::string& instanceName, const WrapperConfig* config, Logger logger);
+
+    bool empty() const { return m_dispatch.empty(); }
+
+    /** @brief Runs all plugins, in load order, over the samples. Returns false if any reports an error. */
+    bool applyBatch(uint32_t vr, double* values, const double* times, size_t n) const {
+        bool ok = true;
+        for (const Slot& s : m_dispatch) ok &= (s.applyBatch(s.state, vr, values, times, n) == FAULT_PLUGIN_OK);
+        return ok;
+    }
+
+    /**
+     * @brief applyBatch() for samples generated ahead of their use. Checkpoints the plugin
+     * states first and keeps the input, so rewindBlock() can take back the unused samples.
+     */
+    bool applyBlock(uint32_t vr, double* values, const double* times, size_t n);
+
+    /**
+     * @brief Returns the plugins to the state they would have after only the first `used`
+     * samples of the last applyBlock(), which is discarded early. Plugins without
+     * save_state/restore_state cannot be rewound and must be stateless.
+     */
+    bool rewindBlock(size_t used);
+
+    // Plugin states concatenated in load order, each prefixed with its byte length.
+    size_t serializedStateSize() const;
+    bool saveState(std::vector<uint8_t>& out) const;
+    bool restoreState(const uint8_t* data, size_t size);
+
+private:
+    struct Slot {
+        int (*applyBatch)(void*, uint32_t, double*, const double*, size_t);
+        void* state;
+    };
+    struct Plugin {
+        void* library;           // DLL_HANDLE, kept opaque here to avoid platform headers.
+        const FaultPluginApi* api;
+        void* state;
+        std::string name;
+        std::string path;
+    };
+
+    static const char* getOption(void* host, const char* key);
+    static void logFromPlugin(void* host, int status, const char* message);
+
+    std::vector<Slot> m_dispatch;
+    std::vector<Plugin> m_plugins;
+    bool m_stateful = false;              // Some plugin can save and restore its state.
+
+    // The last applyBlock(): plugin states before it, and its unfiltered input.
+    std::vector<uint8_t> m_checkpoint;
+    uint32_t m_blockVr = 0;
+    std::vector<double> m_blockValues;
+    std::vector<double> m_blockTimes;
+
+    // Used by the context callbacks while a plugin initializes.
+    const WrapperConfig* m_config = nullptr;
+    Logger m_logger;
+    std::string m_currentPlugin;
+    std::string m_optionValue;
+};
+
+#endif // FAULT_PLUGIN_HOST_HPP
@@ -6,13 +6,18 @@
  * methods for the C++ wrapper class.
  */
 #include "FaultWrapper.hpp"
+#include "InnerLibraryPool.hpp"
+#if defined(FAULT_WRAPPER_STATIC_INNER)
+#include "StaticInnerModel.hpp"
+#endif
 #include <vector>
+#include <cstdio>  // For snprintf
 #include <cstring> // For strncmp
-
-// Prometheus C++ client library headers
-#include <prometheus/exposer.h>
-#include <prometheus/registry.h>
-#include <prometheus/gauge.h>
+#include <algorithm> // For std::max
+#include <chrono>   // For std::chrono::system_clock
+#include <functional> // For std::hash
+#include <iterator> // For std::size
+#include <limits>   // For std::numeric_limits
 
 /**
  * @brief Converts a file URI (e.g., "file:///path/to/file") to a standard filesystem path.
@@ -33,11 +38,139 @@ std::string uriToPath(const char* uri) {
     return path;
 }
 
+// Layout of a telemetry sample; the order matches the values pushed in doStep().
+static const TelemetryVariable TELEMETRY_VARIABLES[] = {
+    {"time", 0xFFFFFFFFu, 0},
+    {"u", VR_U, 0},
+    {"y", VR_Y, 0},
+    {"k", VR_K, 0},
+};
+// MetricsData and the telemetry sample carry exactly the wrapper's Reals; a new variable must be added to both.
+static_assert(std::size(TELEMETRY_VARIABLES) == 1 + model::Real::COUNT, "telemetry layout is out of date");
+static_assert(sizeof(MetricsData) == (1 + model::Real::COUNT) * sizeof(double), "MetricsData layout is out of date");
+
+// Adds the faults of one bitfault.<n> entry to `faults`: the variables of Type whose value
+// references lie in [vr, vr + count), as runs of consecutive bank positions. Returns the
+// number of variables covered.
+template <class Type>
+static size_t addBitFaultRuns(BitFault fault, long long vr, long long count, std::vector<BitFault>& faults) {
+    size_t covered = 0;
+    fault.count = 0;
+    for (const model::Variable& var : Type::VARIABLES) {
+        if (var.valueReference < vr || var.valueReference >= vr + count) continue;
+        covered++;
+        if (fault.count > 0 && var.index == fault.first + fault.count) { fault.count++; continue; }
+        if (fault.count > 0) faults.push_back(fault);
+        fault.first = var.index;
+        fault.count = 1;
+    }
+    if (fault.count > 0) faults.push_back(fault);
+    return covered;
+}
+
+// Reads the discrete bit faults bitfault.0.*, bitfault.1.*, ... from wrapper.cfg.
+static std::vector<BitFault> bitFaultsFromConfig(const WrapperConfig& config) {
+    std::vector<BitFault> faults;
+    for (int n = 0; config.has("bitfault." + std::to_string(n) + ".kind"); n++) {
+        const std::string prefix = "bitfault." + std::to_string(n) + ".";
+        const std::string kind = config.getString(prefix + "kind");
+        const std::string type = config.getString(prefix + "type", "flip");
+        BitFault fault{};
+        if (kind == "integer") fault.kind = DiscreteKind::Integer;
+        else if (kind == "boolean") fault.kind = DiscreteKind::Boolean;
+        else throw std::runtime_error("wrapper.cfg: '" + prefix + "kind' must be integer or boolean: " + kind);
+        if (type == "flip") fault.type = BitFaultType::BitFlip;
+        else if (type == "stuck_at_0") fault.type = BitFaultType::StuckAt0;
+        else if (type == "stuck_at_1") fault.type = BitFaultType::StuckAt1;
+        else if (type == "bit_error_rate") fault.type = BitFaultType::BitErrorRate;
+        else throw std::runtime_error("wrapper.cfg: '" + prefix + "type' must be flip, stuck_at_0, stuck_at_1 or bit_error_rate: " + type);
+        fault.mask = static_cast<uint32_t>(config.getInt(prefix + "mask", 0xFFFFFFFFLL));
+        fault.startTime = config.getDouble(prefix + "start_time", 0.0);
+        fault.endTime = config.getDouble(prefix + "end_time", std::numeric_limits<double>::infinity());
+        fault.rate = config.getDouble(prefix + "rate", 0.0);
+
+        const long long vr = config.getInt(prefix + "vr", -1);
+        const long long count = config.getInt(prefix + "count", 1);
+        if (vr < 0 || count < 1) throw std::runtime_error("wrapper.cfg: '" + prefix + "vr' and '" + prefix + "count' must select value references");
+        const size_t covered = fault.kind == DiscreteKind::Integer ? addBitFaultRuns<model::Integer>(fault, vr, count, faults)
+                                                                   : addBitFaultRuns<model::Boolean>(fault, vr, count, faults);
+        if (covered == 0) throw std::runtime_error("wrapper.cfg: '" + prefix + "vr' selects no " + kind + " variable of the model");
+    }
+    return faults;
+}
+
+// Lists the value references and bank positions of the variables of Type with the given causality.
+template <class Type, class Ports>
+static Ports discretePorts(model::Causality causality) {
+    Ports ports;
+    for (const model::Variable& var : Type::VARIABLES) {
+        if (var.causality != causality) continue;
+        ports.vrs.push_back(var.valueReference);
+        ports.indices.push_back(var.index);
+    }
+    return ports;
+}
+
 // The constructor is responsible for all initialization (RAII).
 FaultWrapper::FaultWrapper(fmi2String instanceName, fmi2String fmuResourceLocation, const fmi2CallbackFunctions* functions, fmi2Boolean visible, fmi2Boolean loggingOn)
-    : m_callbacks(functions), m_instanceName(instanceName) {
+    : m_callbacks(functions), m_instanceName(instanceName),
+      // Optional configuration, read first so that a bad value fails before anything is acquired.
+      m_config(WrapperConfig::load(uriToPath(fmuResourceLocation) + SEP + "wrapper.cfg")),
+      m_booleans(model::Boolean::COUNT),
+      m_bitFaults(model::Integer::COUNT, model::Boolean::COUNT, bitFaultsFromConfig(m_config),
+                  std::hash<std::string>{}(m_instanceName)),
+      m_integerInputs(discretePorts<model::Integer, DiscretePorts>(model::Causality::Input)),
+      m_integerOutputs(discretePorts<model::Integer, DiscretePorts>(model::Causality::Output)),
+      m_booleanInputs(discretePorts<model::Boolean, DiscretePorts>(model::Causality::Input)),
+      m_booleanOutputs(discretePorts<model::Boolean, DiscretePorts>(model::Causality::Output)),
+      m_faultyIntegers(model::Integer::COUNT), m_faultyBooleanWords(m_booleans.wordCount()),
+      m_integerValues(model::Integer::COUNT), m_booleanValues(model::Boolean::COUNT) {
+    for (size_t i = 0; i < model::Boolean::COUNT; i++) m_booleans.set(i, model::Boolean::START[i] != fmi2False);
 
     std::string resourcePath = uriToPath(fmuResourceLocation);
+    // Signal sources replace the host-provided inputs.
+    m_step.uSource = SignalGenerator::fromConfig(m_config, "signal.u");
+    const bool metricsEnabled = m_config.getBool("metrics.enabled", true);
+    if (metricsEnabled) {
+        MetricsSettings& metrics = m_metricsSettings;
+        metrics.address = m_config.getString("metrics.address", "127.0.0.1:8080");
+        metrics.exposition = m_config.getString("metrics.exposition", "prometheus");
+        metrics.pushUrl = m_config.getString("metrics.push_url", "http://127.0.0.1:9201/api/v1/import/prometheus");
+        metrics.compression = m_config.getString("metrics.push_compression", "");
+        metrics.spoolDir = m_config.getString("metrics.spool_dir", "");
+        metrics.pushIntervalMs = static_cast<uint32_t>(m_config.getInt("metrics.push_interval_ms", metrics.pushIntervalMs));
+        metrics.pushRetries = static_cast<uint32_t>(m_config.getInt("metrics.push_retries", metrics.pushRetries));
+        metrics.spoolMaxBytes = static_cast<uint64_t>(m_config.getInt("metrics.spool_max_bytes", static_cast<long long>(metrics.spoolMaxBytes)));
+        metrics.blockSize = static_cast<size_t>(std::max(1LL, m_config.getInt("metrics.block_size", 256)));
+        metrics.f32 = m_config.getString("metrics.block_encoding", "f64") == "f32";
+        metrics.flushIntervalMs = static_cast<uint32_t>(std::min<long long>(std::numeric_limits<uint32_t>::max(),
+            std::max(0LL, m_config.getInt("metrics.flush_interval_ms", metrics.flushIntervalMs))));
+    }
+    const double stepBudgetMs = m_config.getDouble("watchdog.step_budget_ms", 0.0);
+
+    // Load fault-model plugins before the inner FMU so a failing plugin needs no extra cleanup.
+    m_plugins.loadAll(resourcePath, m_instanceName, &m_config,
+                      [this](int status, const std::string& message) { log(static_cast<fmi2Status>(status), "plugin", message); });
+    m_step.hasPlugins = !m_plugins.empty();
+    if (m_step.uSource && m_step.hasPlugins) {
+        // Generated inputs are known a block ahead, so plugins see whole blocks instead of single
+        // samples; a block cut short rewinds them past the samples that were actually stepped.
+        m_step.uSource->setBlockFilter([this](double* samples, const double* times, size_t n) {
+            if (!m_plugins.applyBlock(VR_U, samples, times, n)) m_step.pluginFailed = true;
+        });
+        m_step.uSource->setDiscardHook([this](size_t used) {
+            if (!m_plugins.rewindBlock(used)) m_step.pluginFailed = true;
+        });
+    }
+#if defined(FAULT_WRAPPER_STATIC_INNER)
+    // 1-2. The inner model is compiled into this library; there is nothing to load.
+    // Its globals live in this library, so there is no namespace to isolate them in.
+    if (m_config.getString("inner.isolation", "none") != "none") {
+        log(fmi2Warning, "isolation", "inner.isolation = " + m_config.getString("inner.isolation") +
+            " is ignored: the inner model is linked into the wrapper, so all instances share its globals.");
+    }
+    loadInnerFmuFunctions();
+#else
     // Determine the correct platform-specific directory and library extension.
     std::string platform, lib_ext;
 #if defined(_WIN32)
@@ -51,10 +184,17 @@ FaultWrapper::FaultWrapper(fmi2String instanceName, fmi2String fmuResourceLocati
     // Construct the full path to the inner FMU's shared library.
     std::string innerFmuPath = resourcePath + SEP + "Amplifier" + SEP + "binaries" + SEP + platform + SEP + "model" + lib_ext;
 
-    // 1. Load the inner FMU's shared library.
-    m_innerFMUHandle = LOAD_LIBRARY(innerFmuPath.c_str());
+    // 1. Load the inner FMU's shared library, into a private namespace if inner.isolation asks for one.
+    InnerLibraryPool::Isolation isolation = InnerLibraryPool::Isolation::Shared;
+    const std::string isolationName = m_config.getString("inner.isolation", "none");
+    if (!InnerLibraryPool::parseIsolation(isolationName, isolation)) {
+        log(fmi2Fatal, "error", "Unknown inner.isolation '" + isolationName + "'; expected none, instance or thread.");
+        throw std::runtime_error("Invalid inner.isolation.");
+    }
+    std::string loadError;
+    m_innerFMUHandle = InnerLibraryPool::acquire(innerFmuPath, isolation, loadError);
     if (!m_innerFMUHandle) {
-        log(fmi2Fatal, "error", "Could not load inner FMU binary: " + innerFmuPath);
+        log(fmi2Fatal, "error", "Could not load inner FMU binary: " + innerFmuPath + (loadError.empty() ? "" : ": " + loadError));
         throw std::runtime_error("Failed to load inner FMU binary.");
     }
 
@@ -62,9 +202,10 @@ FaultWrapper::FaultWrapper(fmi2String instanceName, fmi2String fmuResourceLocati
     try {
         loadInnerFmuFunctions();
     } catch (...) {
-        FREE_LIBRARY(m_innerFMUHandle); // Ensure library is freed on failure.
+        InnerLibraryPool::release(m_innerFMUHandle); // Ensure library is freed on failure.
         throw;
     }
+#endif
 
     // 3. Instantiate the inner FMU.
     // The GUID is from the inner FMU's modelDescription.xml.
@@ -72,54 +213,107 @@ FaultWrapper::FaultWrapper(fmi2String instanceName, fmi2String fmuResourceLocati
     // The inner FMU needs a URI to its own resources directory.
     std::string innerResourceUri = std::string(fmuResourceLocation) + SEP + "Amplifier" + SEP "resources";
 
-    m_innerFMUInstance = m_innerFunctions.Instantiate("innerAmplifier", fmi2CoSimulation, innerGuid, innerResourceUri.c_str(), m_callbacks, visible, loggingOn);
-    if (!m_innerFMUInstance) {
+    m_step.innerInstance = m_innerFunctions.Instantiate("innerAmplifier", fmi2CoSimulation, innerGuid, innerResourceUri.c_str(), m_callbacks, visible, loggingOn);
+    if (!m_step.innerInstance) {
         log(fmi2Fatal, "error", "Failed to instantiate inner FMU.");
-        FREE_LIBRARY(m_innerFMUHandle); // Ensure library is freed on failure.
+        if (m_innerFMUHandle) InnerLibraryPool::release(m_innerFMUHandle); // Ensure library is freed on failure.
         throw std::runtime_error("Failed to instantiate inner FMU.");
     }
 
-    // 4. Start the Prometheus worker thread.
-    // The thread is launched and its main function `prometheusWorker` is executed.
-    // `this` is passed to give the member function access to the class instance.
-    m_prometheusWorkerThread = std::thread(&FaultWrapper::prometheusWorker, this);
+    // The remaining steps only fail on resource exhaustion, but the destructor does not run
+    // for a throwing constructor, so the inner instance and library are released here.
+    try {
+        // 4. Publish every step to the shared-memory telemetry segment, if enabled.
+        // Telemetry is an observation aid, so a failure only disables it.
+        try {
+            m_step.telemetry = TelemetryChannel::open(m_config, m_instanceName, TELEMETRY_VARIABLES, std::size(TELEMETRY_VARIABLES));
+            if (m_step.telemetry) log(fmi2OK, "info", "Publishing telemetry to shared memory " + m_step.telemetry->segmentName());
+        } catch (const std::exception& e) {
+            log(fmi2Warning, "telemetry", e.what());
+        }
+
+        // 5. Watch the inner doStep against a time budget, if configured.
+        // The callback runs on the watchdog thread while this instance is still inside doStep.
+        if (stepBudgetMs > 0.0) {
+            m_step.watchdog = StepWatchdog::watch(std::chrono::nanoseconds(static_cast<int64_t>(stepBudgetMs * 1e6)), [this, stepBudgetMs] {
+                log(fmi2Warning, "watchdog", "doStep exceeded its budget of " + std::to_string(stepBudgetMs) + " ms; cancelling the inner step.");
+                if (m_innerFunctions.CancelStep) m_innerFunctions.CancelStep(m_step.innerInstance);
+            });
+        }
+
+        // 6. Start the metrics worker thread, if metrics are enabled.
+        // The exporter library is loaded here rather than linked, so runs without metrics never map it.
+        // The thread is launched and its main function `metricsWorker` is executed.
+        // `this` is passed to give the member function access to the class instance.
+        if (metricsEnabled && loadMetricsExporter(resourcePath)) {
+            m_step.metrics = std::make_unique<MetricsBlockChannel>(m_metricsSettings.blockSize, m_metricsSettings.f32,
+                                                                   m_metricsSettings.flushIntervalMs);
+            m_metricsWorkerThread = std::thread(&FaultWrapper::metricsWorker, this);
+        }
+    } catch (...) {
+        m_step.watchdog.reset(); // Before the instance its callback cancels goes away.
+        if (m_metricsLibrary) FREE_LIBRARY(m_metricsLibrary);
+        m_innerFunctions.FreeInstance(m_step.innerInstance);
+        if (m_innerFMUHandle) InnerLibraryPool::release(m_innerFMUHandle);
+        throw;
+    }
 }
 
 // The destructor is responsible for all cleanup (RAII).
 FaultWrapper::~FaultWrapper() {
-    // --- Graceful shutdown of the worker thread ---
-    log(fmi2OK, "info", "Shutting down Prometheus worker thread.");
-    // 1. Signal the worker to stop by closing the channel.
-    m_metricsChannel.close();
+    // Unregister first; this waits for an expiry callback that still uses the inner instance.
+    m_step.watchdog.reset();
 
-    // 2. Wait for the worker thread to finish its execution.
-    if (m_prometheusWorkerThread.joinable()) {
-        m_prometheusWorkerThread.join();
+    // --- Graceful shutdown of the worker thread ---
+    if (m_metricsWorkerThread.joinable()) {
+        log(fmi2OK, "info", "Shutting down metrics worker thread.");
+        // 1. Signal the worker to stop by closing the channel; the last partial block is delivered first.
+        m_step.metrics->close();
+        // 2. Wait for the worker thread to finish its execution.
+        m_metricsWorkerThread.join();
+    }
+    if (m_metricsLibrary) {
+        FREE_LIBRARY(m_metricsLibrary);
     }
 
     // --- Cleanup of inner FMU resources ---
     // Terminate and free the inner FMU instance if it exists.
-    if (m_innerFMUInstance) {
-        m_innerFunctions.Terminate(m_innerFMUInstance);
-        m_innerFunctions.FreeInstance(m_innerFMUInstance);
+    if (m_step.innerInstance) {
+        m_innerFunctions.Terminate(m_step.innerInstance);
+        m_innerFunctions.FreeInstance(m_step.innerInstance);
     }
-    // Unload the shared library.
+    // Unload the shared library, or return its namespace to the pool.
     if (m_innerFMUHandle) {
-        FREE_LIBRARY(m_innerFMUHandle);
+        InnerLibraryPool::release(m_innerFMUHandle);
     }
 }
 
 void FaultWrapper::loadInnerFmuFunctions() {
+#if defined(FAULT_WRAPPER_STATIC_INNER)
+    // The table still serves the cold calls; doStep calls the model directly (see INNER_STEP_CALL).
+#define LOAD_FUNC(Name) m_innerFunctions.Name = &STATIC_INNER(Name)
+#else
 #define LOAD_FUNC(Name) \
     /* Load the function pointer from the shared library by its name. */ \
     m_innerFunctions.Name = (fmi2##Name##TYPE*)GET_FUNCTION(m_innerFMUHandle, "fmi2" #Name); \
     if (!m_innerFunctions.Name) throw std::runtime_error("Failed to load function: fmi2" #Name);
+#endif
 
     LOAD_FUNC(Instantiate); LOAD_FUNC(FreeInstance); LOAD_FUNC(SetupExperiment);
     LOAD_FUNC(EnterInitializationMode); LOAD_FUNC(ExitInitializationMode);
     LOAD_FUNC(Terminate); LOAD_FUNC(Reset); LOAD_FUNC(GetReal);
-    LOAD_FUNC(SetReal); LOAD_FUNC(DoStep);
+    LOAD_FUNC(SetReal); LOAD_FUNC(GetInteger); LOAD_FUNC(SetInteger);
+    LOAD_FUNC(GetBoolean); LOAD_FUNC(SetBoolean); LOAD_FUNC(DoStep);
 #undef LOAD_FUNC
+#if defined(FAULT_WRAPPER_STATIC_INNER)
+    m_innerFunctions.CancelStep = &STATIC_INNER(CancelStep);
+#else
+    m_innerFunctions.CancelStep = (fmi2CancelStepTYPE*)GET_FUNCTION(m_innerFMUHandle, "fmi2CancelStep");
+#endif
+    // doStep calls these through m_step, which it has in cache anyway.
+    m_step.setReal = m_innerFunctions.SetReal;
+    m_step.doStep = m_innerFunctions.DoStep;
+    m_step.getReal = m_innerFunctions.GetReal;
 }
 
 // A logging helper that uses the callbacks provided by the simulation environment.
@@ -130,127 +324,292 @@ void FaultWrapper::log(fmi2Status status, const std::string& category, const std
 }
 
 // --- FMI API Method Implementations ---
+// Reals go through the tables generated from modelDescription.xml; the output 'y' is read-only.
 fmi2Status FaultWrapper::setReal(const fmi2ValueReference vr[], size_t nvr, const fmi2Real value[]) {
-    for (size_t i = 0; i < nvr; i++) {
-        if (vr[i] == VR_U) m_u = value[i];
-        else if (vr[i] == VR_K) m_k = value[i];
+    if (!model::Dispatch<model::Real>::set(m_step.reals, vr, nvr, value)) {
+        log(fmi2Error, "error", "setReal: unknown or read-only value reference");
+        return fmi2Error;
     }
     return fmi2OK;
 }
 
 fmi2Status FaultWrapper::getReal(const fmi2ValueReference vr[], size_t nvr, fmi2Real value[]) {
+    if (!model::Dispatch<model::Real>::get(m_step.reals, vr, nvr, value)) {
+        log(fmi2Error, "error", "getReal: unknown value reference");
+        return fmi2Error;
+    }
+    return fmi2OK;
+}
+
+// Integer and Boolean variables are cached like the Reals; outputs hold the faulted inner values.
+fmi2Status FaultWrapper::setInteger(const fmi2ValueReference vr[], size_t nvr, const fmi2Integer value[]) {
+    if (!model::Dispatch<model::Integer>::set(m_integers, vr, nvr, value)) {
+        log(fmi2Error, "error", "setInteger: unknown or read-only value reference");
+        return fmi2Error;
+    }
+    return fmi2OK;
+}
+
+fmi2Status FaultWrapper::getInteger(const fmi2ValueReference vr[], size_t nvr, fmi2Integer value[]) {
+    if (!model::Dispatch<model::Integer>::get(m_integers, vr, nvr, value)) {
+        log(fmi2Error, "error", "getInteger: unknown value reference");
+        return fmi2Error;
+    }
+    return fmi2OK;
+}
+
+// Booleans live in a bitset rather than a Bank, so each value reference is resolved to its bit.
+fmi2Status FaultWrapper::setBoolean(const fmi2ValueReference vr[], size_t nvr, const fmi2Boolean value[]) {
     for (size_t i = 0; i < nvr; i++) {
-        if (vr[i] == VR_U) value[i] = m_u;
-        else if (vr[i] == VR_Y) value[i] = m_y;
-        else if (vr[i] == VR_K) value[i] = m_k;
+        const uint32_t index = model::Dispatch<model::Boolean>::setIndex(vr[i]);
+        if (index == model::Dispatch<model::Boolean>::NONE) {
+            log(fmi2Error, "error", "setBoolean: unknown or read-only value reference");
+            return fmi2Error;
+        }
+        m_booleans.set(index, value[i] != fmi2False);
+    }
+    return fmi2OK;
+}
+
+fmi2Status FaultWrapper::getBoolean(const fmi2ValueReference vr[], size_t nvr, fmi2Boolean value[]) {
+    for (size_t i = 0; i < nvr; i++) {
+        const uint32_t index = model::Dispatch<model::Boolean>::getIndex(vr[i]);
+        if (index == model::Dispatch<model::Boolean>::NONE) {
+            log(fmi2Error, "error", "getBoolean: unknown value reference");
+            return fmi2Error;
+        }
+        value[i] = m_booleans.get(index) ? fmi2True : fmi2False;
     }
     return fmi2OK;
 }
 
+// Applies the bit faults for the current time to whole words and sends the inputs to the inner FMU.
+fmi2Status FaultWrapper::forwardDiscreteInputs() {
+    fmi2Status status = fmi2OK;
+    if (!m_integerInputs.vrs.empty()) {
+        m_bitFaults.applyIntegers(m_integers.data(), m_faultyIntegers.data());
+        for (size_t i = 0; i < m_integerInputs.indices.size(); i++) m_integerValues[i] = m_faultyIntegers[m_integerInputs.indices[i]];
+        status = m_innerFunctions.SetInteger(m_step.innerInstance, m_integerInputs.vrs.data(), m_integerInputs.vrs.size(), m_integerValues.data());
+        if (status != fmi2OK) return status;
+    }
+    if (!m_booleanInputs.vrs.empty()) {
+        m_bitFaults.applyBooleans(m_booleans.words(), m_faultyBooleanWords.data());
+        for (size_t i = 0; i < m_booleanInputs.indices.size(); i++) {
+            const uint32_t b = m_booleanInputs.indices[i];
+            m_booleanValues[i] = static_cast<fmi2Boolean>((m_faultyBooleanWords[b >> 6] >> (b & 63)) & 1u);
+        }
+        status = m_innerFunctions.SetBoolean(m_step.innerInstance, m_booleanInputs.vrs.data(), m_booleanInputs.vrs.size(), m_booleanValues.data());
+    }
+    return status;
+}
+
+// Reads the inner FMU's discrete outputs into the banks, then replaces them with their faulted values.
+fmi2Status FaultWrapper::readDiscreteOutputs() {
+    fmi2Status status = fmi2OK;
+    if (!m_integerOutputs.vrs.empty()) {
+        status = m_innerFunctions.GetInteger(m_step.innerInstance, m_integerOutputs.vrs.data(), m_integerOutputs.vrs.size(), m_integerValues.data());
+        if (status != fmi2OK) return status;
+        for (size_t i = 0; i < m_integerOutputs.indices.size(); i++) m_integers[m_integerOutputs.indices[i]] = m_integerValues[i];
+        m_bitFaults.applyIntegers(m_integers.data(), m_faultyIntegers.data());
+        for (uint32_t index : m_integerOutputs.indices) m_integers[index] = m_faultyIntegers[index];
+    }
+    if (!m_booleanOutputs.vrs.empty()) {
+        status = m_innerFunctions.GetBoolean(m_step.innerInstance, m_booleanOutputs.vrs.data(), m_booleanOutputs.vrs.size(), m_booleanValues.data());
+        if (status != fmi2OK) return status;
+        for (size_t i = 0; i < m_booleanOutputs.indices.size(); i++) m_booleans.set(m_booleanOutputs.indices[i], m_booleanValues[i] != fmi2False);
+        m_bitFaults.applyBooleans(m_booleans.words(), m_faultyBooleanWords.data());
+        for (uint32_t b : m_booleanOutputs.indices) m_booleans.set(b, (m_faultyBooleanWords[b >> 6] >> (b & 63)) & 1u);
+    }
+    return status;
+}
+
 fmi2Status FaultWrapper::setupExperiment(fmi2Boolean tolDef, fmi2Real tol, fmi2Real start, fmi2Boolean stopDef, fmi2Real stop) {
-    m_currentTime = start;
-    return m_innerFunctions.SetupExperiment(m_innerFMUInstance, tolDef, tol, start, stopDef, stop);
+    m_step.currentTime = start;
+    return m_innerFunctions.SetupExperiment(m_step.innerInstance, tolDef, tol, start, stopDef, stop);
 }
 
-fmi2Status FaultWrapper::enterInitializationMode() { return m_innerFunctions.EnterInitializationMode(m_innerFMUInstance); }
+fmi2Status FaultWrapper::enterInitializationMode() { return m_innerFunctions.EnterInitializationMode(m_step.innerInstance); }
 
 // At the end of initialization, set the wrapper's parameters on the inner FMU.
 fmi2Status FaultWrapper::exitInitializationMode() {
     fmi2ValueReference vr_k = VR_K;
-    m_innerFunctions.SetReal(m_innerFMUInstance, &vr_k, 1, &m_k);
-    return m_innerFunctions.ExitInitializationMode(m_innerFMUInstance);
+    m_innerFunctions.SetReal(m_step.innerInstance, &vr_k, 1, &m_step.reals[model::Real::K]);
+    // Discrete parameters are forwarded as set; bit faults only act on inputs and outputs.
+    for (const model::Variable& var : model::Integer::VARIABLES) {
+        if (var.causality == model::Causality::Parameter) m_innerFunctions.SetInteger(m_step.innerInstance, &var.valueReference, 1, &m_integers[var.index]);
+    }
+    for (const model::Variable& var : model::Boolean::VARIABLES) {
+        const fmi2Boolean value = m_booleans.get(var.index) ? fmi2True : fmi2False;
+        if (var.causality == model::Causality::Parameter) m_innerFunctions.SetBoolean(m_step.innerInstance, &var.valueReference, 1, &value);
+    }
+    fmi2Status status = m_innerFunctions.ExitInitializationMode(m_step.innerInstance);
+    // Outputs are readable before the first step.
+    if (status == fmi2OK && (model::Integer::COUNT > 0 || model::Boolean::COUNT > 0)) {
+        m_bitFaults.update(m_step.currentTime);
+        status = readDiscreteOutputs();
+    }
+    return status;
 }
 
+// With the inner model compiled in, doStep calls it directly so that LTO can inline the
+// model; otherwise it goes through the pointers copied into m_step.
+#if defined(FAULT_WRAPPER_STATIC_INNER)
+#define INNER_STEP_CALL(field, Name) STATIC_INNER(Name)
+#else
+#define INNER_STEP_CALL(field, Name) m_step.field
+#endif
+
 // This is the core simulation step function.
 fmi2Status FaultWrapper::doStep(fmi2Real time, fmi2Real step, fmi2Boolean noSet) {
-    m_currentTime = time;
-    double u_to_set = m_u;
+    // An overrun leaves the inner FMU in an unknown state; the host must reschedule the scenario.
+    if (m_step.failed) {
+        log(fmi2Error, "watchdog", "doStep called on an instance that failed after a step timeout.");
+        return fmi2Error;
+    }
+    m_step.currentTime = time;
+    // A configured signal source generates 'u' natively, ignoring values set by the host.
+    using model::Real;
+    if (m_step.uSource) m_step.reals[Real::U] = m_step.uSource->sampleAt(time, step);
+    double u_to_set = m_step.reals[Real::U];
+
+    // Fault-model plugins run first; generated inputs were already processed per block.
+    if (m_step.hasPlugins && !m_step.uSource && !m_plugins.applyBatch(VR_U, &u_to_set, &m_step.currentTime, 1)) m_step.pluginFailed = true;
+    if (m_step.pluginFailed) {
+        log(fmi2Error, "plugin", "A fault plugin failed while processing input 'u'.");
+        return fmi2Error;
+    }
 
     // *** FAULT INJECTION LOGIC ***
     // Check if the current time is within the fault window.
-    if (m_currentTime >= FAULT_START_TIME && m_currentTime < FAULT_END_TIME) u_to_set += FAULT_VALUE;
+    if (m_step.currentTime >= FAULT_START_TIME && m_step.currentTime < FAULT_END_TIME) u_to_set += FAULT_VALUE;
 
     // --- Inner FMU Simulation Step ---
     // a. Set the (potentially faulty) input on the inner FMU.
     fmi2ValueReference vr_u = VR_U;
-    m_innerFunctions.SetReal(m_innerFMUInstance, &vr_u, 1, &u_to_set);
+    INNER_STEP_CALL(setReal, SetReal)(m_step.innerInstance, &vr_u, 1, &u_to_set);
+    // Integer and Boolean inputs get their bit faults applied word-wide before forwarding.
+    constexpr bool hasDiscrete = model::Integer::COUNT > 0 || model::Boolean::COUNT > 0;
+    if (hasDiscrete) {
+        m_bitFaults.update(m_step.currentTime);
+        fmi2Status discreteStatus = forwardDiscreteInputs();
+        if (discreteStatus != fmi2OK) return discreteStatus;
+    }
     // b. Tell the inner FMU to perform its calculation for the step.
-    m_innerFunctions.DoStep(m_innerFMUInstance, time, step, noSet);
+    if (m_step.watchdog) m_step.watchdog->begin();
+    INNER_STEP_CALL(doStep, DoStep)(m_step.innerInstance, time, step, noSet);
+    if (m_step.watchdog && m_step.watchdog->end()) {
+        m_step.failed = true;
+        log(fmi2Error, "watchdog", "Inner doStep at t=" + std::to_string(time) + " overran its time budget; the instance is marked failed.");
+        return fmi2Error;
+    }
     // c. Retrieve the result from the inner FMU and cache it.
     fmi2ValueReference vr_y = VR_Y;
-    fmi2Status status = m_innerFunctions.GetReal(m_innerFMUInstance, &vr_y, 1, &m_y);
+    fmi2Status status = INNER_STEP_CALL(getReal, GetReal)(m_step.innerInstance, &vr_y, 1, &m_step.reals[Real::Y]);
+    // Discrete outputs are read back and faulted for the host, like 'u' on the way in.
+    if (hasDiscrete && status == fmi2OK) status = readDiscreteOutputs();
+
+    const MetricsData sample{m_step.currentTime, m_step.reals[Real::U], m_step.reals[Real::Y], m_step.reals[Real::K]};
+    // Concurrent observers (fault_wrapper_read_snapshot) see the step only once it is complete.
+    m_snapshot.publish(sample);
 
     // --- Push metrics to the worker thread ---
-    // This is a non-blocking operation that sends the latest state to the Prometheus server.
-    m_metricsChannel.push({m_currentTime, m_u, m_y, m_k});
+    // This only appends to the current block; the worker sees it once per metrics.block_size steps,
+    // or at the next step after metrics.flush_interval_ms without a full block.
+    if (m_step.metrics) m_step.metrics->push(sample);
+    // Local observers get every step; this only writes to the instance's ring.
+    if (m_step.telemetry) {
+        const double values[] = {sample.time, sample.u, sample.y, sample.k};
+        m_step.telemetry->push(values);
+    }
 
     return status;
 }
+#undef INNER_STEP_CALL
+
+fmi2Status FaultWrapper::terminate() { return m_innerFunctions.Terminate(m_step.innerInstance); }
+
+// Loads the exporter library from the resources and resolves its interface once.
+// Metrics are optional, so failures are logged and the wrapper simply runs without them.
+bool FaultWrapper::loadMetricsExporter(const std::string& resourcePath) {
+    const std::string path = resourcePath + SEP + "metrics_exporter" + LIB_EXT;
+    m_metricsLibrary = LOAD_LIBRARY(path.c_str());
+    if (!m_metricsLibrary) {
+        log(fmi2Warning, "metrics", "Metrics are enabled but the exporter could not be loaded: " + path);
+        return false;
+    }
+    auto getApi = reinterpret_cast<MetricsExporterGetApiFn>(GET_FUNCTION(m_metricsLibrary, METRICS_EXPORTER_ENTRY));
+    m_metricsApi = getApi ? getApi(METRICS_EXPORTER_ABI_VERSION) : nullptr;
+    if (!m_metricsApi) {
+        log(fmi2Warning, "metrics", "Incompatible metrics exporter: " + path);
+        FREE_LIBRARY(m_metricsLibrary);
+        m_metricsLibrary = nullptr;
+        return false;
+    }
+    return true;
+}
 
-fmi2Status FaultWrapper::terminate() { return m_innerFunctions.Terminate(m_innerFMUInstance); }
+void FaultWrapper::metricsWorker() {
+    const MetricsSettings& settings = m_metricsSettings;
+    MetricsAttachOptions options{};
+    options.struct_size = sizeof(options);
+    options.instance_name = m_instanceName.c_str();
+    options.bind_address = settings.address.c_str();
+    options.exposition = settings.exposition.c_str();
+    options.log = [](void* ctx, int status, const char* message) {
+        static_cast<FaultWrapper*>(ctx)->log(static_cast<fmi2Status>(status), "metrics", message);
+    };
+    options.log_ctx = this;
+    // Push mode (metrics.exposition = push) for jobs that end before a scrape could reach them.
+    options.push_url = settings.pushUrl.c_str();
+    options.push_interval_ms = settings.pushIntervalMs;
+    options.push_retries = settings.pushRetries;
+    options.push_compression = settings.compression.empty() ? nullptr : settings.compression.c_str();
+    options.spool_dir = settings.spoolDir.c_str();
+    options.spool_max_bytes = settings.spoolMaxBytes;
+    void* handle = m_metricsApi->attach(&options);
+
+    // Scrapes only see the latest values, but a push sends every sample of a block, stamped
+    // within the wall-clock interval since the previous block arrived.
+    const bool pushSamples = settings.exposition == "push";
+    const auto wallClockMs = [] {
+        return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    };
+    std::vector<MetricsData> samples;
+    int64_t previousMs = wallClockMs();
+
+    // Main worker loop
+    MetricsSummary run;
+    while (true) {
+        // Wait for a block from the main thread.
+        // This call will block until a block is available or the channel is closed.
+        const MetricsBlock* block = m_step.metrics->pop();
+
+        // A null block means the channel was closed and drained.
+        if (!block) {
+            break; // Exit the loop
+        }
 
-void FaultWrapper::prometheusWorker() {
-    try {
-        // Create an exposer that will listen on port 8080
-        m_exposer = std::make_unique<prometheus::Exposer>("127.0.0.1:8080");
-
-        // Create a registry to hold the metrics
-        auto registry = std::make_shared<prometheus::Registry>();
-        m_exposer->RegisterCollectable(registry);
-
-        // Create Prometheus Gauge objects for each scalar variable.
-        // A Gauge is a metric that represents a single numerical value that can arbitrarily go up and down.
-        // We add a constant label "instance" to all metrics to identify which FMU they belong to.
-        const std::map<std::string, std::string> constant_labels = {{"instance", m_instanceName}};
-
-        // 1. Build the Family for the metric.
-        auto& time_gauge_family = prometheus::BuildGauge()
-                                      .Name("fmu_time_seconds")
-                                      .Help("Current simulation time in seconds")
-                                      .Register(*registry);
-        // 2. Get the specific Gauge instance from the Family using its labels.
-        auto& time_gauge = time_gauge_family.Add(constant_labels);
-
-        auto& u_gauge_family = prometheus::BuildGauge()
-                                   .Name("fmu_input_u")
-                                   .Help("Value of the input signal u")
-                                   .Register(*registry);
-        auto& u_gauge = u_gauge_family.Add(constant_labels);
-
-        auto& y_gauge_family = prometheus::BuildGauge()
-                                   .Name("fmu_output_y")
-                                   .Help("Value of the output signal y")
-                                   .Register(*registry);
-        auto& y_gauge = y_gauge_family.Add(constant_labels);
-
-        auto& k_gauge_family = prometheus::BuildGauge()
-                                   .Name("fmu_parameter_k")
-                                   .Help("Value of the gain parameter k")
-                                   .Register(*registry);
-        auto& k_gauge = k_gauge_family.Add(constant_labels);
-
-        log(fmi2OK, "info", "Prometheus server started on http://127.0.0.1:8080");
-
-        // Main worker loop
-        while (true) {
-            // Wait for a message from the main thread.
-            // This call will block until a message is available or the queue is closed.
-            auto data = m_metricsChannel.pop();
-
-            // If pop() returns nullopt, it means the queue was closed.
-            if (!data) {
-                break; // Exit the loop
-            }
-
-            // Update the Prometheus metrics with the new values.
-            time_gauge.Set(data->time);
-            u_gauge.Set(data->u);
-            y_gauge.Set(data->y);
-            k_gauge.Set(data->k);
+        run.add(*block);
+        if (!handle || block->count == 0) continue;
+        if (pushSamples) {
+            samples.resize(block->count);
+            for (uint32_t i = 0; i < block->count; i++) samples[i] = block->at(i);
+            const int64_t nowMs = wallClockMs();
+            m_metricsApi->publish_samples(handle, samples.data(), block->count, previousMs, nowMs);
+            previousMs = nowMs;
+        } else {
+            m_metricsApi->publish(handle, &run.last);
         }
+    }
 
-    } catch (const std::exception& e) {
-        log(fmi2Fatal, "prometheus_worker", "An exception occurred in the Prometheus worker thread: " + std::string(e.what()));
+    if (run.count > 0) {
+        char line[256];
+        std::snprintf(line, sizeof(line), "Metrics: %llu samples (%llu dropped); y min %g max %g mean %g; u min %g max %g mean %g.",
+                      static_cast<unsigned long long>(run.count), static_cast<unsigned long long>(run.dropped),
+                      run.min[2], run.max[2], run.mean(2), run.min[1], run.max[1], run.mean(1));
+        log(fmi2OK, "metrics", line);
     }
-    log(fmi2OK, "info", "Prometheus worker thread has finished.");
-}
\ No newline at end of file
+    if (handle) m_metricsApi->detach(handle);
+    log(fmi2OK, "info", "Metrics worker thread has finished.");
+}
@@ -13,14 +13,18 @@
 #include <thread>
 #include <atomic>
 #include <memory>
+#include <vector>
 
 // Local includes for concurrent architecture
-#include "ThreadSafeQueue.hpp"
-
-// Forward declarations for Prometheus types to reduce header dependency
-namespace prometheus {
-class Exposer;
-}
+#include "BitFaults.hpp"
+#include "FaultPluginHost.hpp"
+#include "metrics_exporter.h" // MetricsData and the exporter interface
+#include "MetricsBlockChannel.hpp"
+#include "SeqlockSnapshot.hpp"
+#include "SignalGenerator.hpp"
+#include "StepWatchdog.hpp"
+#include "TelemetrySegment.hpp"
+#include "WrapperConfig.hpp"
 
 // FMI standard headers are C headers, so we wrap them in extern "C" for C++ compatibility.
 extern "C" {
@@ -28,39 +32,19 @@ extern "C" {
 }
 
 // Platform-specific dynamic library loading
-#ifdef _WIN32
-#include <windows.h>
-#define DLL_HANDLE HMODULE
-#define LOAD_LIBRARY(path) LoadLibraryA(path)
-#define GET_FUNCTION(handle, name) GetProcAddress(handle, name)
-#define FREE_LIBRARY(handle) FreeLibrary(handle)
-#define SEP "\\"
-#else
-#include <dlfcn.h>
-#define DLL_HANDLE void*
-#define LOAD_LIBRARY(path) dlopen(path, RTLD_LAZY)
-#define GET_FUNCTION(handle, name) dlsym(handle, name)
-#define FREE_LIBRARY(handle) dlclose(handle)
-#define SEP "/"
-#endif
-
-// Value References for the FMU's variables, defined with C++ `constexpr` for compile-time safety.
-constexpr fmi2ValueReference VR_U = 0;
-constexpr fmi2ValueReference VR_Y = 1;
-constexpr fmi2ValueReference VR_K = 2;
+#include "PlatformLibrary.hpp"
+
+// Value references, start values and the get/set dispatch tables, generated from modelDescription.xml.
+#include "ModelBindings.hpp"
 
 // Hardcoded fault definition for demonstration purposes.
 constexpr double FAULT_START_TIME = 3.0;
 constexpr double FAULT_END_TIME = 7.0;
 constexpr double FAULT_VALUE = 0.5;
 
-// A struct to hold the data sent to the Prometheus worker thread.
-struct MetricsData {
-    double time;
-    double u;
-    double y;
-    double k;
-};
+// Integer and Boolean variables come from model::Integer and model::Boolean, i.e. from
+// the wrapper's modelDescription.xml, which must mirror the inner FMU's. Their bit faults
+// are configured in wrapper.cfg (bitfault.<n>.*); the amplifier has no discrete variables.
 
 // A dispatch table to hold function pointers loaded from the inner FMU's shared library.
 struct InnerFMU {
@@ -73,7 +57,12 @@ struct InnerFMU {
     fmi2ResetTYPE*                  Reset = nullptr;
     fmi2GetRealTYPE*                GetReal = nullptr;
     fmi2SetRealTYPE*                SetReal = nullptr;
+    fmi2GetIntegerTYPE*             GetInteger = nullptr;
+    fmi2SetIntegerTYPE*             SetInteger = nullptr;
+    fmi2GetBooleanTYPE*             GetBoolean = nullptr;
+    fmi2SetBooleanTYPE*             SetBoolean = nullptr;
     fmi2DoStepTYPE*                 DoStep = nullptr;
+    fmi2CancelStepTYPE*             CancelStep = nullptr; // Optional; only used by the step watchdog.
 };
 
 /**
@@ -102,32 +91,102 @@ public:
     // FMI API methods implemented as C++ class members.
     fmi2Status setReal(const fmi2ValueReference vr[], size_t nvr, const fmi2Real value[]);
     fmi2Status getReal(const fmi2ValueReference vr[], size_t nvr, fmi2Real value[]);
+    fmi2Status setInteger(const fmi2ValueReference vr[], size_t nvr, const fmi2Integer value[]);
+    fmi2Status getInteger(const fmi2ValueReference vr[], size_t nvr, fmi2Integer value[]);
+    fmi2Status setBoolean(const fmi2ValueReference vr[], size_t nvr, const fmi2Boolean value[]);
+    fmi2Status getBoolean(const fmi2ValueReference vr[], size_t nvr, fmi2Boolean value[]);
     fmi2Status setupExperiment(fmi2Boolean toleranceDefined, fmi2Real tolerance, fmi2Real startTime, fmi2Boolean stopTimeDefined, fmi2Real stopTime);
     fmi2Status enterInitializationMode();
     fmi2Status exitInitializationMode();
     fmi2Status doStep(fmi2Real currentCommunicationPoint, fmi2Real communicationStepSize, fmi2Boolean noSetFMUStatePriorToCurrentPoint);
     fmi2Status terminate();
 
+    /**
+     * @brief Copies the outputs of the last completed step; callable from any thread during doStep.
+     * @return The step count the copy belongs to; 0 before the first step (out untouched).
+     */
+    uint64_t readSnapshot(MetricsData& out) const { return m_snapshot.read(out); }
+
     /** @brief Provides access to the callback functions for the C adapter layer. */
     const fmi2CallbackFunctions* getCallbacks() const { return m_callbacks; }
 
 private:
-    // --- Prometheus Worker Thread ---
-    void prometheusWorker(); // The main function for the worker thread.
-    std::thread m_prometheusWorkerThread;
-    ThreadSafeQueue<MetricsData> m_metricsChannel;
-    std::unique_ptr<prometheus::Exposer> m_exposer;
+    // --- Step State ---
+    // Everything a doStep without discrete variables reads or writes, packed into the first
+    // two cache lines of the instance; with thousands of instances per core the scattered
+    // members used to cost a miss each. Keep cold state out of it. The output snapshot below
+    // is the one other per-step line, kept apart because other threads read it.
+    struct alignas(64) StepState {
+        // First line: the cached variables and the inner calls made on every step.
+        model::Bank<model::Real> reals = model::startValues<model::Real>(); // Cached u, y, k; see model::Real.
+        double currentTime = 0.0;
+        fmi2Component innerInstance = nullptr;           // The component instance of the inner FMU.
+        fmi2SetRealTYPE* setReal = nullptr;              // Copies of the InnerFMU entries each step calls.
+        fmi2DoStepTYPE* doStep = nullptr;
+        fmi2GetRealTYPE* getReal = nullptr;
+        // Second line: the optional stages, each null or false when unused.
+        std::unique_ptr<SignalGenerator> uSource;        // Native source driving 'u', or null for host input.
+        std::unique_ptr<MetricsBlockChannel> metrics;    // Samples in blocks of metrics.block_size; null without an exporter.
+        std::unique_ptr<TelemetryChannel> telemetry;     // Full-rate samples for local observers; null unless telemetry.enabled.
+        std::unique_ptr<StepWatchdog::Slot> watchdog;    // Armed around the inner doStep when watchdog.step_budget_ms is set.
+        bool hasPlugins = false;                         // Fault-model plugins are loaded; saves a look into m_plugins.
+        bool pluginFailed = false;                       // A plugin reported an error on a generated block.
+        bool failed = false;                             // A step overran its budget; later steps fail.
+    };
+    static_assert(sizeof(StepState) == 128, "the step state no longer fits two cache lines");
+    StepState m_step;
+
+    // --- Output Snapshot ---
+    // (time, u, y, k) of the last step, published at step end for lock-free readers.
+    SeqlockSnapshot<MetricsData> m_snapshot;
+
+    // --- Metrics Worker Thread ---
+    // The exporter library is only loaded when metrics are enabled in wrapper.cfg.
+    // Its options are read in the constructor with the rest of the configuration, so a bad
+    // value fails the instantiation rather than escaping from the worker thread.
+    struct MetricsSettings {
+        std::string address, exposition, pushUrl, compression, spoolDir;
+        uint32_t pushIntervalMs = 1000, pushRetries = 3;
+        uint64_t spoolMaxBytes = 64ull << 20;
+        size_t blockSize = 256;
+        uint32_t flushIntervalMs = 1000;
+        bool f32 = false;
+    };
+    MetricsSettings m_metricsSettings;
+    void metricsWorker(); // The main function for the worker thread.
+    bool loadMetricsExporter(const std::string& resourcePath);
+    std::thread m_metricsWorkerThread;
+    DLL_HANDLE m_metricsLibrary = nullptr;
+    const MetricsExporterApi* m_metricsApi = nullptr;
 
     // --- Private Member Variables ---
-    double m_u = 0.0, m_y = 0.0, m_k = 2.0, m_currentTime = 0.0; // Cached values of the wrapper's variables.
     DLL_HANDLE m_innerFMUHandle = nullptr;                       // Handle to the loaded inner FMU's shared library.
-    fmi2Component m_innerFMUInstance = nullptr;                  // The component instance of the inner FMU.
     InnerFMU m_innerFunctions;                                   // Struct containing function pointers to the inner FMU's API.
     const fmi2CallbackFunctions* m_callbacks;                    // Pointer to the simulator's callback functions.
     std::string m_instanceName;                                  // The name of this FMU instance.
+    WrapperConfig m_config;                                      // Options from resources/wrapper.cfg (empty if absent).
+    FaultPluginHost m_plugins;                                   // Fault-model plugins from resources/plugins.
+
+    // --- Discrete Variables ---
+    // Inputs and parameters hold the host's values and are forwarded with bit faults applied;
+    // outputs hold the inner FMU's values of the last step with bit faults applied.
+    struct DiscretePorts {
+        std::vector<fmi2ValueReference> vrs;                     // Value references, in bank order.
+        std::vector<uint32_t> indices;                           // Their positions in the bank.
+    };
+    model::Bank<model::Integer> m_integers = model::startValues<model::Integer>();
+    PackedBooleans m_booleans;                                   // Boolean bank as a bitset.
+    BitFaultEngine m_bitFaults;                                  // Compiled bit faults for both banks.
+    DiscretePorts m_integerInputs, m_integerOutputs, m_booleanInputs, m_booleanOutputs;
+    std::vector<fmi2Integer> m_faultyIntegers;                   // Scratch buffers for the faulted values.
+    std::vector<uint64_t> m_faultyBooleanWords;
+    std::vector<fmi2Integer> m_integerValues;                    // One value per port, as exchanged with the inner FMU.
+    std::vector<fmi2Boolean> m_booleanValues;
 
     // --- Private Helper Methods ---
     void loadInnerFmuFunctions();                                // Loads all required function pointers from the inner FMU.
+    fmi2Status forwardDiscreteInputs();                          // Applies bit faults and sets Integer/Boolean inputs on the inner FMU.
+    fmi2Status readDiscreteOutputs();                            // Gets Integer/Boolean outputs from the inner FMU and applies bit faults.
     void log(fmi2Status status, const std::string& category, const std::string& message); // A helper for logging messages via the FMI callbacks.
 };
 
@@ -0,0 +1,104 @@
+/**
+ * @file InnerLibraryPool.cpp
+ * @brief Implements the process-wide pool of dlmopen namespaces behind InnerLibraryPool.
+ */
+#include "InnerLibraryPool.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct Namespace {
+    std::string path;
+    DLL_HANDLE handle = nullptr;
+    unsigned users = 0;     // Live instances using the namespace; 0 means pooled.
+    InnerLibraryPool::Isolation isolation = InnerLibraryPool::Isolation::Instance; // Of the current users.
+    uint64_t thread = 0;    // threadSerial() of the leasing thread; shared with it under Thread isolation.
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<Namespace> namespaces; // Only grows; namespaces are never unloaded.
+};
+
+// Identifies the calling thread. Unlike std::thread::id it is never reused by a later
+// thread, which must not inherit the namespace of one that exited with live instances.
+uint64_t threadSerial() {
+    static std::atomic<uint64_t> next{1};
+    thread_local const uint64_t serial = next.fetch_add(1, std::memory_order_relaxed);
+    return serial;
+}
+
+// Never destroyed: pooled namespaces stay mapped until the process exits.
+Registry& registry() {
+    static Registry* instance = new Registry;
+    return *instance;
+}
+
+} // namespace
+
+bool InnerLibraryPool::parseIsolation(const std::string& text, Isolation& isolation) {
+    if (text == "none") isolation = Isolation::Shared;
+    else if (text == "instance") isolation = Isolation::Instance;
+    else if (text == "thread") isolation = Isolation::Thread;
+    else return false;
+    return true;
+}
+
+DLL_HANDLE InnerLibraryPool::acquire(const std::string& path, Isolation isolation, std::string& error) {
+    if (isolation == Isolation::Shared) {
+        return LOAD_LIBRARY(path.c_str());
+    }
+#if defined(__GLIBC__)
+    const uint64_t self = threadSerial();
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    // Prefer the namespace this thread already uses, then any pooled one for the binary.
+    Namespace* lease = nullptr;
+    for (Namespace& ns : r.namespaces) {
+        if (ns.path != path) continue;
+        if (isolation == Isolation::Thread && ns.users > 0 && ns.isolation == Isolation::Thread && ns.thread == self) {
+            lease = &ns;
+            break;
+        }
+        if (ns.users == 0 && !lease) lease = &ns;
+    }
+    if (!lease) {
+        // RTLD_NOW so missing symbols fail here rather than on the first step.
+        DLL_HANDLE handle = dlmopen(LM_ID_NEWLM, path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (!handle) {
+            const char* reason = dlerror();
+            error = std::string(reason ? reason : "dlmopen failed") + " (" + std::to_string(r.namespaces.size()) +
+                    " namespaces in use; glibc's static TLS reserve limits them, see GLIBC_TUNABLES=glibc.rtld.optional_static_tls)";
+            return nullptr;
+        }
+        r.namespaces.push_back(Namespace{path, handle, 0, isolation, 0});
+        lease = &r.namespaces.back();
+    }
+    if (lease->users++ == 0) {
+        lease->isolation = isolation;
+        lease->thread = self;
+    }
+    return lease->handle;
+#else
+    (void)path;
+    error = "inner.isolation needs dlmopen, which only glibc provides";
+    return nullptr;
+#endif
+}
+
+void InnerLibraryPool::release(DLL_HANDLE handle) {
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (Namespace& ns : r.namespaces) {
+            if (ns.handle != handle) continue;
+            if (--ns.users == 0) ns.thread = 0;
+            return;
+        }
+    }
+    FREE_LIBRARY(handle);
+}
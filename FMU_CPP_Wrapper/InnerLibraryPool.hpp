@@ -0,0 +1,43 @@
+/**
+ * @file InnerLibraryPool.hpp
+ * @brief Loads the inner FMU binary, optionally into its own link-map namespace (inner.isolation).
+ *
+ * A plain dlopen of the same path returns the same mapping, so all instances in a process
+ * share the inner library's global state, which many FMUs are not written for. With
+ * isolation the library is loaded with dlmopen(LM_ID_NEWLM), giving it private globals:
+ *   - Instance: one namespace per live instance;
+ *   - Thread:   one namespace per thread that instantiates, shared by the instances
+ *               created on that thread (which then must not step concurrently).
+ * Namespaces are expensive (each maps its own libc) and limited by glibc's static TLS
+ * reserve, so they are never unloaded: a released namespace goes back to the pool and is
+ * reused for the next instance of the same binary. The reused library keeps its globals
+ * from the previous user, as it would when instances are created one after another with
+ * a plain dlopen.
+ *
+ * Isolation needs glibc (dlmopen); elsewhere only Shared is available.
+ */
+#ifndef INNER_LIBRARY_POOL_HPP
+#define INNER_LIBRARY_POOL_HPP
+
+#include <string>
+
+#include "PlatformLibrary.hpp"
+
+class InnerLibraryPool {
+public:
+    enum class Isolation { Shared, Instance, Thread };
+
+    /** @brief Parses "none", "instance" or "thread"; returns false for anything else. */
+    static bool parseIsolation(const std::string& text, Isolation& isolation);
+
+    /**
+     * @brief Loads the library at path, or leases a pooled namespace that already holds it.
+     * @return The handle, or null; error then holds the reason where the loader gives one.
+     */
+    static DLL_HANDLE acquire(const std::string& path, Isolation isolation, std::string& error);
+
+    /** @brief Returns a namespace to the pool, or unloads a Shared handle. */
+    static void release(DLL_HANDLE handle);
+};
+
+#endif // INNER_LIBRARY_POOL_HPP
@@ -0,0 +1,145 @@
+/**
+ * @file MetricsBlockChannel.cpp
+ * @brief Implements the block hand-off and the block summaries.
+ */
+#include "MetricsBlockChannel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <new>
+
+static_assert(MetricsBlock::FIELDS == 4, "MetricsBlockChannel::push writes (time, u, y, k)");
+
+namespace {
+
+// Min, max and sum of one column. The samples are spread over LANES independent
+// accumulators so the loop vectorizes without -ffast-math: every lane still adds and
+// compares its own samples in order, and the lanes are only combined at the end.
+template <class T>
+void reduceColumn(const T* values, size_t n, double offset, double& min, double& max, double& sum) {
+    constexpr size_t LANES = 8;
+    double laneMin[LANES], laneMax[LANES], laneSum[LANES];
+    for (size_t l = 0; l < LANES; l++) {
+        laneMin[l] = std::numeric_limits<double>::infinity();
+        laneMax[l] = -std::numeric_limits<double>::infinity();
+        laneSum[l] = 0.0;
+    }
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        for (size_t l = 0; l < LANES; l++) {
+            const double v = static_cast<double>(values[i + l]);
+            laneMin[l] = v < laneMin[l] ? v : laneMin[l];
+            laneMax[l] = v > laneMax[l] ? v : laneMax[l];
+            laneSum[l] += v;
+        }
+    }
+    for (size_t l = 0; i < n; i++, l++) {
+        const double v = static_cast<double>(values[i]);
+        laneMin[l] = v < laneMin[l] ? v : laneMin[l];
+        laneMax[l] = v > laneMax[l] ? v : laneMax[l];
+        laneSum[l] += v;
+    }
+    double columnSum = 0.0;
+    for (size_t l = 0; l < LANES; l++) {
+        min = std::min(min, laneMin[l] + offset);
+        max = std::max(max, laneMax[l] + offset);
+        columnSum += laneSum[l];
+    }
+    sum += columnSum + offset * static_cast<double>(n);
+}
+
+} // namespace
+
+MetricsBlock::~MetricsBlock() {
+    if (m_storage) ::operator delete(m_storage, std::align_val_t(64));
+}
+
+void MetricsBlock::allocate(size_t capacity, bool quantize) {
+    // Each column starts on its own cache line.
+    const size_t itemSize = quantize ? sizeof(float) : sizeof(double);
+    const size_t columnBytes = (capacity * itemSize + 63) / 64 * 64;
+    auto* storage = static_cast<unsigned char*>(::operator new(FIELDS * columnBytes, std::align_val_t(64)));
+    if (m_storage) ::operator delete(m_storage, std::align_val_t(64));
+    m_storage = storage;
+    for (size_t f = 0; f < FIELDS; f++) {
+        f64[f] = quantize ? nullptr : reinterpret_cast<double*>(storage + f * columnBytes);
+        f32[f] = quantize ? reinterpret_cast<float*>(storage + f * columnBytes) : nullptr;
+    }
+    quantized = quantize;
+}
+
+MetricsData MetricsBlock::at(size_t i) const {
+    if (quantized) return {timeBase + f32[0][i], f32[1][i], f32[2][i], f32[3][i]};
+    return {f64[0][i], f64[1][i], f64[2][i], f64[3][i]};
+}
+
+MetricsSummary::MetricsSummary() {
+    std::fill(std::begin(min), std::end(min), std::numeric_limits<double>::infinity());
+    std::fill(std::begin(max), std::end(max), -std::numeric_limits<double>::infinity());
+}
+
+void MetricsSummary::add(const MetricsBlock& block) {
+    dropped += block.dropped;
+    if (block.count == 0) return;
+    for (size_t f = 0; f < MetricsBlock::FIELDS; f++) {
+        // Only the quantized time column is stored relative to the block.
+        const double offset = block.quantized && f == 0 ? block.timeBase : 0.0;
+        if (block.quantized) reduceColumn(block.f32[f], block.count, offset, min[f], max[f], sum[f]);
+        else reduceColumn(block.f64[f], block.count, offset, min[f], max[f], sum[f]);
+    }
+    count += block.count;
+    last = block.at(block.count - 1);
+}
+
+MetricsBlockChannel::MetricsBlockChannel(size_t blockSize, bool quantize, uint32_t flushIntervalMs)
+    : m_back(&m_blocks[0]), m_blockSize(static_cast<uint32_t>(std::min(std::max<size_t>(blockSize, 1), MetricsBlock::MAX_CAPACITY))),
+      m_quantize(quantize), m_front(&m_blocks[1]),
+      m_slot(reinterpret_cast<uintptr_t>(&m_blocks[2])), m_flushIntervalMs(flushIntervalMs) {
+    for (MetricsBlock& block : m_blocks) block.allocate(m_blockSize, quantize);
+}
+
+// The exchange publishes the filled block (release) and takes ownership of the block the
+// worker last returned (acquire). A block that comes back still FRESH was never read.
+void MetricsBlockChannel::handOff() {
+    const uintptr_t previous = m_slot.exchange(reinterpret_cast<uintptr_t>(m_back) | FRESH, std::memory_order_acq_rel);
+    m_back = reinterpret_cast<MetricsBlock*>(previous & ~FRESH);
+    m_back->dropped = (previous & FRESH) ? m_back->dropped + m_back->count : 0;
+    m_back->count = 0;
+    m_flushRequested.store(false, std::memory_order_relaxed);
+    // Taking the mutex orders this notify after a pop() that is about to sleep.
+    { std::lock_guard<std::mutex> lock(m_mutex); }
+    m_cond.notify_one();
+}
+
+const MetricsBlock* MetricsBlockChannel::pop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto ready = [this] { return (m_slot.load(std::memory_order_relaxed) & FRESH) || m_closed; };
+    if (m_flushIntervalMs == 0) {
+        m_cond.wait(lock, ready);
+    } else {
+        // No block for a whole interval: have the next push() hand off what it has.
+        while (!m_cond.wait_for(lock, std::chrono::milliseconds(m_flushIntervalMs), ready)) {
+            m_flushRequested.store(true, std::memory_order_relaxed);
+        }
+    }
+    if (!(m_slot.load(std::memory_order_relaxed) & FRESH)) return nullptr;
+    // Returns the block read last time and takes the fresh one.
+    const uintptr_t fresh = m_slot.exchange(reinterpret_cast<uintptr_t>(m_front), std::memory_order_acq_rel);
+    m_front = reinterpret_cast<MetricsBlock*>(fresh & ~FRESH);
+    m_taken.notify_one();
+    return m_front;
+}
+
+// A hand-off that overwrites an unread block leaves its count in the next block, so the
+// loop repeats until a hand-off went through without dropping anything.
+void MetricsBlockChannel::close() {
+    while (m_back->count > 0 || m_back->dropped > 0) {
+        handOff();
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_taken.wait(lock, [this] { return !(m_slot.load(std::memory_order_relaxed) & FRESH); });
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_closed = true;
+    m_cond.notify_all();
+}
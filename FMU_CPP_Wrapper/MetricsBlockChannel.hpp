@@ -0,0 +1,153 @@
+/**
+ * @file MetricsBlockChannel.hpp
+ * @brief Moves metrics samples from the step thread to the metrics worker in blocks.
+ *
+ * The step thread appends each sample to a block it owns, column by column, and only
+ * touches shared state when the block is full: one atomic exchange swaps the block
+ * into a hand-off slot and takes back whichever block the worker returned. Three
+ * blocks are recycled between the two threads, so steady state never allocates. If
+ * the worker falls behind, the unread block in the slot is overwritten and its samples
+ * are counted as dropped in the next block instead of the step thread ever waiting.
+ *
+ * Optionally the columns are quantized to float, with the time stored relative to the
+ * block's first sample, which halves the bytes written per step.
+ *
+ * With a flush interval, a worker that has waited that long for a block asks the step
+ * thread to hand off its partial block; the request is a flag the next push() reads, so
+ * slow simulations still publish regularly without a clock read per sample.
+ */
+#ifndef METRICS_BLOCK_CHANNEL_HPP
+#define METRICS_BLOCK_CHANNEL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "metrics_exporter.h" // MetricsData
+
+/** @brief A block of consecutive samples, stored as one column per MetricsData field. */
+struct MetricsBlock {
+    static constexpr size_t MAX_CAPACITY = 1024;
+    static constexpr size_t FIELDS = sizeof(MetricsData) / sizeof(double);
+
+    uint32_t count = 0;     // Samples in this block.
+    uint32_t dropped = 0;   // Samples lost between the previous delivered block and this one.
+    bool quantized = false; // Which column set below holds the samples.
+    double timeBase = 0.0;  // Time of the first sample; quantized times are relative to it.
+    // Cache-line aligned columns of the block's capacity; only the set matching `quantized` is allocated.
+    double* f64[FIELDS] = {};
+    float* f32[FIELDS] = {};
+
+    MetricsBlock() = default;
+    MetricsBlock(const MetricsBlock&) = delete;
+    MetricsBlock& operator=(const MetricsBlock&) = delete;
+    ~MetricsBlock();
+
+    /** @brief Allocates the columns for `capacity` samples in the given encoding. */
+    void allocate(size_t capacity, bool quantize);
+
+    /** @brief Decodes sample i back to a MetricsData. */
+    MetricsData at(size_t i) const;
+
+private:
+    void* m_storage = nullptr; // All columns, from an aligned operator new.
+};
+
+/** @brief Per-field count, min, max and sum over the samples of one or more blocks. */
+struct MetricsSummary {
+    uint64_t count = 0;
+    uint64_t dropped = 0;
+    MetricsData last{};
+    double min[MetricsBlock::FIELDS];
+    double max[MetricsBlock::FIELDS];
+    double sum[MetricsBlock::FIELDS] = {};
+
+    MetricsSummary();
+
+    /** @brief Folds a block into the summary; the column loops are written to vectorize. */
+    void add(const MetricsBlock& block);
+
+    /** @brief Mean of field i (a MetricsData field index), or 0 without samples. */
+    double mean(size_t i) const { return count ? sum[i] / static_cast<double>(count) : 0.0; }
+};
+
+/**
+ * @class MetricsBlockChannel
+ * @brief Single-producer, single-consumer block hand-off for metrics samples.
+ *
+ * push(), flush() and close() belong to the step thread, pop() to the worker.
+ */
+class MetricsBlockChannel {
+public:
+    /**
+     * @param blockSize Samples per hand-off, clamped to 1..MetricsBlock::MAX_CAPACITY; the
+     *        blocks are allocated for exactly that many.
+     * @param quantize Store the columns as float instead of double.
+     * @param flushIntervalMs Hand off a partial block once pop() has waited this long; 0 never does.
+     */
+    MetricsBlockChannel(size_t blockSize, bool quantize, uint32_t flushIntervalMs = 0);
+    MetricsBlockChannel(const MetricsBlockChannel&) = delete;
+    MetricsBlockChannel& operator=(const MetricsBlockChannel&) = delete;
+
+    /** @brief Appends a sample; hands the block off when it is full. */
+    void push(const MetricsData& sample) {
+        MetricsBlock& block = *m_back;
+        const uint32_t i = block.count;
+        if (m_quantize) {
+            if (i == 0) block.timeBase = sample.time;
+            block.f32[0][i] = static_cast<float>(sample.time - block.timeBase);
+            block.f32[1][i] = static_cast<float>(sample.u);
+            block.f32[2][i] = static_cast<float>(sample.y);
+            block.f32[3][i] = static_cast<float>(sample.k);
+        } else {
+            block.f64[0][i] = sample.time;
+            block.f64[1][i] = sample.u;
+            block.f64[2][i] = sample.y;
+            block.f64[3][i] = sample.k;
+        }
+        if (++block.count == m_blockSize || m_flushRequested.load(std::memory_order_relaxed)) handOff();
+    }
+
+    /** @brief Hands off a partially filled block, e.g. before shutting down. */
+    void flush() {
+        if (m_back->count > 0) handOff();
+    }
+
+    /**
+     * @brief Waits for the next block; it stays valid until the following pop().
+     * @return The block, or nullptr once the channel is closed and drained.
+     */
+    const MetricsBlock* pop();
+
+    /**
+     * @brief Hands off what is left and waits until the worker has taken it, so every sample
+     *        pushed before close() is either delivered or counted as dropped; pop() then
+     *        returns nullptr. The worker must keep calling pop() until then.
+     */
+    void close();
+
+private:
+    void handOff();
+
+    static constexpr uintptr_t FRESH = 1; // Set on the slot while it holds an unread block.
+
+    MetricsBlock m_blocks[3];
+    // The producer line is read on every push and the worker's m_front is written on every
+    // pop, so each side gets its own cache line and neither invalidates the other.
+    alignas(64) MetricsBlock* m_back; // Owned by the step thread.
+    const uint32_t m_blockSize;
+    const bool m_quantize;
+    alignas(64) MetricsBlock* m_front; // Owned by the worker.
+    alignas(64) std::atomic<uintptr_t> m_slot;
+    // Set by a pop() that timed out; only read by push() otherwise, so the line stays shared.
+    alignas(64) std::atomic<bool> m_flushRequested{false};
+    const uint32_t m_flushIntervalMs;
+    std::mutex m_mutex; // Only for sleeping; taken once per block, never per sample.
+    std::condition_variable m_cond;  // Worker waits for a block.
+    std::condition_variable m_taken; // close() waits for the worker to take the last block.
+    bool m_closed = false;
+};
+
+#endif // METRICS_BLOCK_CHANNEL_HPP
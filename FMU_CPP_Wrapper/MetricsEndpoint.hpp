@@ -0,0 +1,68 @@
+/**
+ * @file MetricsEndpoint.hpp
+ * @brief Internal interface of the metrics exporter library: one HTTP endpoint per bind address.
+ *
+ * Part of metrics_exporter.so only; the core wrapper talks to the exporter through
+ * metrics_exporter.h.
+ */
+#ifndef METRICS_ENDPOINT_HPP
+#define METRICS_ENDPOINT_HPP
+
+#include <string>
+
+#include "metrics_exporter.h"
+
+// The exported metric families, in MetricsData field order.
+struct MetricFamilyInfo {
+    const char* name;
+    const char* help;
+};
+constexpr MetricFamilyInfo METRIC_FAMILIES[] = {
+    {"fmu_time_seconds", "Current simulation time in seconds"},
+    {"fmu_input_u", "Value of the input signal u"},
+    {"fmu_output_y", "Value of the output signal y"},
+    {"fmu_parameter_k", "Value of the gain parameter k"},
+};
+constexpr size_t METRIC_FAMILY_COUNT = sizeof(METRIC_FAMILIES) / sizeof(METRIC_FAMILIES[0]);
+
+// Reads the i-th family's value from a sample.
+inline double metricValue(const MetricsData& data, size_t i) {
+    const double values[METRIC_FAMILY_COUNT] = {data.time, data.u, data.y, data.k};
+    return values[i];
+}
+
+// Escapes a label value for the Prometheus text format: backslash, double quote and line feed.
+inline std::string escapeLabelValue(const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value) {
+        if (c == '\\') escaped += "\\\\";
+        else if (c == '"') escaped += "\\\"";
+        else if (c == '\n') escaped += "\\n";
+        else escaped += c;
+    }
+    return escaped;
+}
+
+/**
+ * @class MetricsEndpoint
+ * @brief Serves the series of all instances attached to one bind address.
+ *
+ * add() and remove() are serialized by the exporter; publish() may be called
+ * concurrently from the worker threads of different instances.
+ */
+class MetricsEndpoint {
+public:
+    virtual ~MetricsEndpoint() = default;
+    virtual void* add(const MetricsAttachOptions& options) = 0;
+    virtual void publish(void* series, const MetricsData& data) = 0;
+    /** @brief Publishes consecutive samples taken over [startMs, endMs]; scrapes only see the last one. */
+    virtual void publishSamples(void* series, const MetricsData* samples, uint32_t count, int64_t startMs, int64_t endMs) {
+        (void)startMs;
+        (void)endMs;
+        if (count > 0) publish(series, samples[count - 1]);
+    }
+    virtual void remove(void* series) = 0;
+};
+
+#endif // METRICS_ENDPOINT_HPP
@@ -0,0 +1,162 @@
+/**
+ * @file ModelBindings.hpp
+ * @brief Compile-time variable bindings generated from modelDescription.xml (FMI 2.0).
+ *
+ * Generated by generate_model_bindings.py; do not edit. The build regenerates this file
+ * from the model description, so value references cannot drift from the XML.
+ */
+#ifndef MODEL_BINDINGS_HPP
+#define MODEL_BINDINGS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+extern "C" {
+#include "fmi2Functions.h"
+}
+
+// Value references of all variables.
+constexpr fmi2ValueReference VR_U = 0;
+constexpr fmi2ValueReference VR_Y = 1;
+constexpr fmi2ValueReference VR_K = 2;
+
+namespace model {
+
+using ValueReference = fmi2ValueReference;
+
+enum class Causality : uint8_t { Parameter, CalculatedParameter, Input, Output, Local, Independent, StructuralParameter };
+
+struct Variable {
+    const char* name;
+    ValueReference valueReference;
+    uint32_t index;     // Position in the bank of the variable's type.
+    Causality causality;
+    bool settable;      // Inputs and parameters; outputs, locals and the independent variable are read-only.
+};
+
+// Real variables.
+struct Real {
+    using Value = fmi2Real;
+    static constexpr size_t COUNT = 3;
+
+    static constexpr uint32_t U = 0;
+    static constexpr uint32_t Y = 1;
+    static constexpr uint32_t K = 2;
+
+    static constexpr std::array<Variable, COUNT> VARIABLES = {{
+        {"u", 0, 0, Causality::Input, true},
+        {"y", 1, 1, Causality::Output, false},
+        {"k", 2, 2, Causality::Parameter, true},
+    }};
+    static constexpr std::array<Value, COUNT> START = {{0.0, 0.0, 2.0}};
+};
+
+// Integer variables.
+struct Integer {
+    using Value = fmi2Integer;
+    static constexpr size_t COUNT = 0;
+
+    static constexpr std::array<Variable, COUNT> VARIABLES = {};
+    static constexpr std::array<Value, COUNT> START = {};
+};
+
+// Boolean variables.
+struct Boolean {
+    using Value = fmi2Boolean;
+    static constexpr size_t COUNT = 0;
+
+    static constexpr std::array<Variable, COUNT> VARIABLES = {};
+    static constexpr std::array<Value, COUNT> START = {};
+};
+
+// --- Compile-time dispatch -------------------------------------------------------------
+
+// The values of one variable type, indexed by the descriptor's bank indices.
+template <class Type>
+using Bank = std::array<typename Type::Value, Type::COUNT>;
+
+template <class Type>
+constexpr Bank<Type> startValues() {
+    Bank<Type> bank{};
+    for (size_t i = 0; i < Type::COUNT; i++) bank[i] = Type::START[i];
+    return bank;
+}
+
+/**
+ * @brief Value reference -> bank index tables for one variable type, built at compile time.
+ *
+ * get() and set() copy values between a Bank and the caller's array with one table index
+ * per element. They return false on the first value reference that is unknown for this
+ * type (or not settable, for set()); the caller reports the error. getIndex() and
+ * setIndex() expose the lookup for storage that is not a Bank; they return NONE instead.
+ */
+template <class Type>
+class Dispatch {
+public:
+    using Value = typename Type::Value;
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+    static uint32_t getIndex(ValueReference vr) { return vr < VR_LIMIT ? GET[vr] : NONE; }
+    static uint32_t setIndex(ValueReference vr) { return vr < VR_LIMIT ? SET[vr] : NONE; }
+
+    static bool get(const Bank<Type>& bank, const ValueReference vr[], size_t nvr, Value value[]) {
+        for (size_t i = 0; i < nvr; i++) {
+            const uint32_t index = getIndex(vr[i]);
+            if (index == NONE) return false;
+            value[i] = bank[index];
+        }
+        return true;
+    }
+
+    static bool set(Bank<Type>& bank, const ValueReference vr[], size_t nvr, const Value value[]) {
+        for (size_t i = 0; i < nvr; i++) {
+            const uint32_t index = setIndex(vr[i]);
+            if (index == NONE) return false;
+            bank[index] = value[i];
+        }
+        return true;
+    }
+
+private:
+    static constexpr ValueReference limit() {
+        ValueReference limit = 0;
+        for (const Variable& var : Type::VARIABLES) limit = var.valueReference >= limit ? var.valueReference + 1 : limit;
+        return limit;
+    }
+
+    static constexpr ValueReference VR_LIMIT = limit();
+
+    static constexpr std::array<uint32_t, VR_LIMIT> table(bool settableOnly) {
+        std::array<uint32_t, VR_LIMIT> table{};
+        for (uint32_t& entry : table) entry = NONE;
+        for (const Variable& var : Type::VARIABLES) {
+            if (!settableOnly || var.settable) table[var.valueReference] = var.index;
+        }
+        return table;
+    }
+
+    static constexpr std::array<uint32_t, VR_LIMIT> GET = table(false);
+    static constexpr std::array<uint32_t, VR_LIMIT> SET = table(true);
+
+    static constexpr bool consistent() {
+        for (size_t i = 0; i < Type::COUNT; i++) {
+            if (Type::VARIABLES[i].index != i || GET[Type::VARIABLES[i].valueReference] != i) return false;
+        }
+        return true;
+    }
+    static_assert(Type::COUNT == std::size(Type::VARIABLES) && Type::COUNT == std::size(Type::START),
+                  "descriptor tables disagree on the variable count");
+    static_assert(consistent(), "value references are not unique or bank indices are not dense");
+};
+
+// Layout checks: a descriptor that disagrees with the XML fails here rather than at run time.
+static_assert(sizeof(Bank<Real>) == 3 * sizeof(fmi2Real), "Real bank is not dense");
+static_assert(sizeof(Dispatch<Real>) > 0, "instantiates the Real table checks");
+static_assert(sizeof(Dispatch<Integer>) > 0, "instantiates the Integer table checks");
+static_assert(sizeof(Dispatch<Boolean>) > 0, "instantiates the Boolean table checks");
+
+} // namespace model
+
+#endif // MODEL_BINDINGS_HPP
@@ -0,0 +1,36 @@
+/**
+ * @file PlatformLibrary.hpp
+ * @brief Platform-specific macros for loading shared libraries at runtime.
+ *
+ * Shared by the inner-FMU loader and the plugin host so both use the same calls.
+ */
+#ifndef PLATFORM_LIBRARY_HPP
+#define PLATFORM_LIBRARY_HPP
+
+// Platform-specific dynamic library loading
+#ifdef _WIN32
+#include <windows.h>
+#define DLL_HANDLE HMODULE
+#define LOAD_LIBRARY(path) LoadLibraryA(path)
+#define GET_FUNCTION(handle, name) GetProcAddress(handle, name)
+#define FREE_LIBRARY(handle) FreeLibrary(handle)
+#define SEP "\\"
+#else
+#include <dlfcn.h>
+#define DLL_HANDLE void*
+#define LOAD_LIBRARY(path) dlopen(path, RTLD_LAZY)
+#define GET_FUNCTION(handle, name) dlsym(handle, name)
+#define FREE_LIBRARY(handle) dlclose(handle)
+#define SEP "/"
+#endif
+
+// File extension of shared libraries on this platform.
+#if defined(_WIN32)
+#define LIB_EXT ".dll"
+#elif defined(__APPLE__)
+#define LIB_EXT ".dylib"
+#else
+#define LIB_EXT ".so"
+#endif
+
+#endif // PLATFORM_LIBRARY_HPP
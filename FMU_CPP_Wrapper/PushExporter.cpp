@@ -0,0 +1,403 @@
+/**
+ * @file PushExporter.cpp
+ * @brief Implements the push-mode endpoint: batching, compression, HTTP POST, retries and spool.
+ */
+#include "PushExporter.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#ifdef METRICS_PUSH_ZSTD
+#include <zstd.h>
+#endif
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <csignal>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr int SOCKET_TIMEOUT_MS = 2000;
+// Bounds the batch a slow or unreachable receiver lets pile up between pushes.
+constexpr size_t MAX_PENDING_BYTES = 16u << 20;
+constexpr int BACKOFF_START_MS = 100;
+const char* const SPOOL_EXTENSION_ZSTD = ".zst";
+const char* const SPOOL_EXTENSION_PLAIN = ".txt";
+
+// FNV-1a, so the spool directory name of a URL is the same in every process and build.
+uint64_t hashUrl(const std::string& url) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : url) hash = (hash ^ c) * 1099511628211ull;
+    return hash;
+}
+
+int64_t wallClockMs() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+#ifndef _WIN32
+// Waits until fd is ready for `events`; false on timeout or error.
+bool waitFor(int fd, short events) {
+    pollfd pfd{fd, events, 0};
+    return poll(&pfd, 1, SOCKET_TIMEOUT_MS) > 0 && (pfd.revents & events);
+}
+
+// Connects without blocking for longer than SOCKET_TIMEOUT_MS; the socket stays non-blocking,
+// which is fine since every send and recv waits for readiness first.
+bool connectWithTimeout(int fd, const sockaddr* address, socklen_t length) {
+    const int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) return false;
+    if (connect(fd, address, length) == 0) return true;
+    if (errno != EINPROGRESS || !waitFor(fd, POLLOUT)) return false;
+    int error = 0;
+    socklen_t size = sizeof(error);
+    return getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &size) == 0 && error == 0;
+}
+#endif
+
+} // namespace
+
+PushExporter::PushExporter(const PushSettings& settings) : m_settings(settings) {
+#ifdef _WIN32
+    throw std::runtime_error("The push exporter is not supported on Windows.");
+#else
+    // Only plain http://host:port/path; the receiver is expected to run locally or behind a sidecar.
+    const std::string scheme = "http://";
+    if (m_settings.url.rfind(scheme, 0) != 0) throw std::runtime_error("Push URL must start with http://: " + m_settings.url);
+    const std::string rest = m_settings.url.substr(scheme.size());
+    const auto slash = rest.find('/');
+    const std::string authority = rest.substr(0, slash);
+    m_path = slash == std::string::npos ? "/" : rest.substr(slash);
+    const auto colon = authority.rfind(':');
+    m_host = authority.substr(0, colon);
+    m_port = colon == std::string::npos ? "80" : authority.substr(colon + 1);
+    if (m_host.empty()) throw std::runtime_error("Push URL has no host: " + m_settings.url);
+
+    if (m_settings.compression.empty()) {
+#ifdef METRICS_PUSH_ZSTD
+        m_settings.compression = "zstd";
+#else
+        m_settings.compression = "none";
+#endif
+    }
+#ifndef METRICS_PUSH_ZSTD
+    if (m_settings.compression == "zstd") throw std::runtime_error("The exporter was built without zstd (METRICS_PUSH_ZSTD).");
+#endif
+    if (m_settings.compression != "zstd" && m_settings.compression != "none") {
+        throw std::runtime_error("Unknown push compression '" + m_settings.compression + "'");
+    }
+    if (m_settings.intervalMs == 0) m_settings.intervalMs = 1000;
+    if (m_settings.spoolDir.empty()) m_settings.spoolDir = (fs::temp_directory_path() / "fmu_metrics_spool").string();
+    // Each process spools into its own "<url hash>-<pid>" directory, so concurrent jobs never
+    // resend each other's batches; those of exited processes are adopted in drainSpool().
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016" PRIx64, hashUrl(m_settings.url));
+    m_spoolPrefix = std::string(hash) + "-";
+    m_spoolPath = (fs::path(m_settings.spoolDir) / (m_spoolPrefix + std::to_string(getpid()))).string();
+
+    m_thread = std::thread(&PushExporter::run, this);
+#endif
+}
+
+PushExporter::~PushExporter() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    if (m_thread.joinable()) m_thread.join();
+    std::error_code ec;
+    fs::remove(m_spoolPath, ec); // Only succeeds if nothing is left to resend.
+}
+
+void* PushExporter::add(const MetricsAttachOptions& options) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_series.push_back(Series{escapeLabelValue(options.instance_name), options.log, options.log_ctx});
+    return &m_series.back();
+}
+
+// Called once per metrics block; every sample goes into the next batch. Encoding happens
+// outside the lock.
+size_t PushExporter::format(char* lines, const Series& series, const MetricsData& data, int64_t timestampMs) {
+    size_t size = 0;
+    for (size_t i = 0; i < METRIC_FAMILY_COUNT; i++) {
+        const int n = std::snprintf(lines + size, LINES_CAPACITY - size, "%s{instance=\"%s\"} %.17g %" PRId64 "\n",
+                                    METRIC_FAMILIES[i].name, series.label.c_str(), metricValue(data, i), timestampMs);
+        if (n > 0) size += std::min(static_cast<size_t>(n), LINES_CAPACITY - 1 - size);
+    }
+    return size;
+}
+
+void PushExporter::publish(void* handle, const MetricsData& data) {
+    char lines[LINES_CAPACITY];
+    const size_t size = format(lines, *static_cast<const Series*>(handle), data, wallClockMs());
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_pending.size() + size > MAX_PENDING_BYTES) {
+        m_dropped++;
+        return;
+    }
+    m_pending.append(lines, size);
+}
+
+// Sample i of the block gets the timestamp at (i + 1) / count of [startMs, endMs], so the last
+// one is stamped endMs. Prometheus keeps one value per series and timestamp, so of the samples
+// that fall into the same millisecond only the last is sent.
+void PushExporter::publishSamples(void* handle, const MetricsData* samples, uint32_t count, int64_t startMs, int64_t endMs) {
+    const auto* series = static_cast<const Series*>(handle);
+    const int64_t span = std::max<int64_t>(endMs - startMs, 0);
+    const auto stamp = [&](uint32_t i) { return startMs + span * (i + 1) / count; };
+    std::string text;
+    uint32_t formatted = 0;
+    char lines[LINES_CAPACITY];
+    for (uint32_t i = 0; i < count; i++) {
+        const int64_t timestamp = stamp(i);
+        if (i + 1 < count && stamp(i + 1) == timestamp) continue;
+        text.append(lines, format(lines, *series, samples[i], timestamp));
+        formatted++;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_pending.size() + text.size() > MAX_PENDING_BYTES) {
+        m_dropped += formatted;
+        return;
+    }
+    m_pending += text;
+}
+
+// Samples are buffered as they are published, so a detaching instance has nothing left to add.
+void PushExporter::remove(void* handle) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto* series = static_cast<Series*>(handle);
+    m_lastLog = series->log;
+    m_lastLogCtx = series->logCtx;
+    m_series.remove_if([handle](const Series& s) { return &s == handle; });
+}
+
+void PushExporter::log(int status, const std::string& message) {
+    MetricsLogFn fn = m_lastLog;
+    void* ctx = m_lastLogCtx;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_series.empty()) {
+            fn = m_series.front().log;
+            ctx = m_series.front().logCtx;
+        }
+    }
+    if (fn) fn(ctx, status, message.c_str());
+}
+
+void PushExporter::run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wake.wait_for(lock, std::chrono::milliseconds(m_settings.intervalMs), [this] { return m_stop; });
+        std::string batch;
+        batch.swap(m_pending);
+        const uint64_t dropped = m_dropped;
+        m_dropped = 0;
+        const bool stopping = m_stop;
+        lock.unlock();
+        if (dropped) log(1 /* fmi2Warning */, "Push batch full; dropped " + std::to_string(dropped) + " samples.");
+        if (!batch.empty()) deliver(std::move(batch));
+        if (stopping) return;
+        lock.lock();
+    }
+}
+
+void PushExporter::deliver(std::string batch) {
+    const std::string encoding = m_settings.compression == "zstd" ? "zstd" : "";
+    const std::string body = compress(batch);
+    // Older spooled batches go first so the receiver sees samples roughly in order.
+    if (drainSpool() && postWithRetries(body, encoding)) return;
+    if (m_permanentFailure) {
+        log(2 /* fmi2Error */, "Push receiver rejected a batch; dropping it.");
+        return;
+    }
+    spool(body, encoding);
+}
+
+std::string PushExporter::compress(const std::string& text) const {
+#ifdef METRICS_PUSH_ZSTD
+    if (m_settings.compression == "zstd") {
+        std::string out(ZSTD_compressBound(text.size()), '\0');
+        const size_t size = ZSTD_compress(&out[0], out.size(), text.data(), text.size(), 3);
+        if (!ZSTD_isError(size)) {
+            out.resize(size);
+            return out;
+        }
+    }
+#endif
+    return text;
+}
+
+bool PushExporter::postWithRetries(const std::string& body, const std::string& encoding) {
+    int backoffMs = BACKOFF_START_MS;
+    for (uint32_t attempt = 0; attempt <= m_settings.retries; attempt++) {
+        if (attempt > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(backoffMs));
+            backoffMs *= 2;
+        }
+        if (post(body, encoding)) return true;
+        if (m_permanentFailure) return false;
+    }
+    return false;
+}
+
+bool PushExporter::post(const std::string& body, const std::string& encoding) {
+    m_permanentFailure = false;
+#ifdef _WIN32
+    (void)body; (void)encoding;
+    return false;
+#else
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(m_host.c_str(), m_port.c_str(), &hints, &result) != 0 || !result) return false;
+    const int fd = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+    const bool connected = fd >= 0 && connectWithTimeout(fd, result->ai_addr, result->ai_addrlen);
+    freeaddrinfo(result);
+    if (!connected) {
+        if (fd >= 0) close(fd);
+        return false;
+    }
+
+    std::string request = "POST " + m_path + " HTTP/1.1\r\n"
+                          "Host: " + m_host + ":" + m_port + "\r\n"
+                          "Content-Type: text/plain; version=0.0.4\r\n"
+                          "Content-Length: " + std::to_string(body.size()) + "\r\n";
+    if (!encoding.empty()) request += "Content-Encoding: " + encoding + "\r\n";
+    request += "Connection: close\r\n\r\n";
+    request += body;
+
+    size_t sent = 0;
+    while (sent < request.size()) {
+        if (!waitFor(fd, POLLOUT)) break;
+        const ssize_t n = send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) break;
+        sent += static_cast<size_t>(n);
+    }
+    // Only the status line matters: "HTTP/1.x NNN ...".
+    char response[64] = {};
+    size_t received = 0;
+    while (sent == request.size() && received < 12 && waitFor(fd, POLLIN)) {
+        const ssize_t n = recv(fd, response + received, sizeof(response) - 1 - received, 0);
+        if (n <= 0) break;
+        received += static_cast<size_t>(n);
+    }
+    close(fd);
+
+    int status = 0;
+    if (received < 12 || std::sscanf(response, "HTTP/%*d.%*d %d", &status) != 1) return false;
+    if (status >= 200 && status < 300) return true;
+    // 4xx means the batch itself is bad; resending it would not help (429 excepted).
+    m_permanentFailure = status >= 400 && status < 500 && status != 429;
+    return false;
+#endif
+}
+
+void PushExporter::spool(const std::string& body, const std::string& encoding) {
+    std::error_code ec;
+    fs::create_directories(m_spoolPath, ec);
+
+    // Keep the spool bounded: evict the oldest batches until the new one fits.
+    std::vector<fs::path> files;
+    uint64_t total = 0;
+    for (const auto& entry : fs::directory_iterator(m_spoolPath, ec)) {
+        if (!entry.is_regular_file()) continue;
+        files.push_back(entry.path());
+        total += entry.file_size();
+    }
+    if (body.size() > m_settings.spoolMaxBytes) {
+        log(1 /* fmi2Warning */, "Push batch exceeds the spool limit; dropping it.");
+        return;
+    }
+    std::sort(files.begin(), files.end());
+    for (const fs::path& file : files) {
+        if (total + body.size() <= m_settings.spoolMaxBytes) break;
+        total -= std::min<uint64_t>(total, fs::file_size(file, ec));
+        fs::remove(file, ec);
+    }
+
+    // Names sort by creation time; the pid keeps them unique once adopted by another process.
+    char name[64];
+    std::snprintf(name, sizeof(name), "%016" PRIx64 "-%d-%06" PRIu64 "%s", static_cast<uint64_t>(wallClockMs()),
+                  static_cast<int>(getpid()), m_spoolSequence++, encoding.empty() ? SPOOL_EXTENSION_PLAIN : SPOOL_EXTENSION_ZSTD);
+    const fs::path target = fs::path(m_spoolPath) / name;
+    const fs::path partial = target.string() + ".tmp";
+    {
+        std::ofstream out(partial, std::ios::binary);
+        out.write(body.data(), static_cast<std::streamsize>(body.size()));
+        if (!out) {
+            log(1 /* fmi2Warning */, "Cannot write push spool file " + partial.string());
+            fs::remove(partial, ec);
+            return;
+        }
+    }
+    fs::rename(partial, target, ec); // Readers never see half-written batches.
+    log(1 /* fmi2Warning */, "Push receiver unreachable; spooled batch to " + target.string());
+}
+
+// Moves the batches of exited processes that pushed to the same URL into this process's spool.
+// rename() is atomic, so when several processes adopt at once each batch ends up in exactly one.
+void PushExporter::adoptOrphanedSpools() {
+    std::error_code ec;
+    std::vector<fs::path> orphans;
+    for (const auto& entry : fs::directory_iterator(m_settings.spoolDir, ec)) {
+        const std::string name = entry.path().filename().string();
+        if (!entry.is_directory() || name.rfind(m_spoolPrefix, 0) != 0) continue;
+        char* end = nullptr;
+        const long pid = std::strtol(name.c_str() + m_spoolPrefix.size(), &end, 10);
+        if (*end != '\0' || pid <= 0 || pid == getpid()) continue;
+        if (kill(static_cast<pid_t>(pid), 0) != 0 && errno == ESRCH) orphans.push_back(entry.path());
+    }
+    for (const fs::path& orphan : orphans) {
+        fs::create_directories(m_spoolPath, ec);
+        for (const auto& entry : fs::directory_iterator(orphan, ec)) {
+            if (entry.path().extension() == ".tmp") continue; // Never completed.
+            fs::rename(entry.path(), fs::path(m_spoolPath) / entry.path().filename(), ec);
+        }
+        fs::remove_all(orphan, ec);
+    }
+}
+
+// Resends spooled batches oldest-first; stops at the first failure. Returns true if the spool is empty.
+bool PushExporter::drainSpool() {
+    std::error_code ec;
+    if (!fs::is_directory(m_settings.spoolDir, ec)) return true;
+    adoptOrphanedSpools();
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::directory_iterator(m_spoolPath, ec)) {
+        const std::string ext = entry.path().extension().string();
+        if (entry.is_regular_file() && (ext == SPOOL_EXTENSION_ZSTD || ext == SPOOL_EXTENSION_PLAIN)) files.push_back(entry.path());
+    }
+    std::sort(files.begin(), files.end());
+    for (const fs::path& file : files) {
+        const bool compressed = file.extension() == SPOOL_EXTENSION_ZSTD;
+        std::ifstream in(file, std::ios::binary);
+        std::stringstream content;
+        content << in.rdbuf();
+        in.close();
+        if (!post(content.str(), compressed ? "zstd" : "") && !m_permanentFailure) return false;
+        fs::remove(file, ec);
+    }
+    return true;
+}
@@ -0,0 +1,86 @@
+/**
+ * @file PushExporter.hpp
+ * @brief Push-mode endpoint of the metrics exporter library, for jobs too short-lived to be scraped.
+ *
+ * publish() and publishSamples() encode every sample they are given as Prometheus text
+ * lines with millisecond timestamps and append them to the pending batch; the samples of
+ * a metrics block are spread over the wall-clock interval the block took. A sender thread wakes up every push interval, compresses the batch of all
+ * attached instances, and POSTs it to the configured URL. Failed batches are retried with backoff and then spooled to
+ * disk; the spool is bounded and drained oldest-first after the next successful push.
+ * Each process spools into its own subdirectory and takes over those of exited processes.
+ * The last batch is flushed when the final instance detaches.
+ */
+#ifndef PUSH_EXPORTER_HPP
+#define PUSH_EXPORTER_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "MetricsEndpoint.hpp"
+
+struct PushSettings {
+    std::string url;
+    uint32_t intervalMs = 1000;
+    uint32_t retries = 3;
+    std::string compression;       // "zstd" or "none".
+    std::string spoolDir;
+    uint64_t spoolMaxBytes = 64ull << 20;
+};
+
+class PushExporter : public MetricsEndpoint {
+public:
+    /** @throws std::runtime_error if the URL or the compression is not supported. */
+    explicit PushExporter(const PushSettings& settings);
+    ~PushExporter() override;
+
+    void* add(const MetricsAttachOptions& options) override;
+    void publish(void* series, const MetricsData& data) override;
+    void publishSamples(void* series, const MetricsData* samples, uint32_t count, int64_t startMs, int64_t endMs) override;
+    void remove(void* series) override;
+
+private:
+    struct Series {
+        std::string label;                       // Instance name, escaped for the label value.
+        MetricsLogFn log;
+        void* logCtx;
+    };
+
+    static constexpr size_t LINES_CAPACITY = METRIC_FAMILY_COUNT * 256;
+    // Writes the lines of one sample into `lines` (LINES_CAPACITY bytes); returns their size.
+    static size_t format(char* lines, const Series& series, const MetricsData& data, int64_t timestampMs);
+
+    void run();                                  // Sender thread.
+    void log(int status, const std::string& message);
+    void deliver(std::string batch);
+    bool post(const std::string& body, const std::string& encoding); // One HTTP attempt; true on 2xx.
+    bool postWithRetries(const std::string& body, const std::string& encoding);
+    std::string compress(const std::string& text) const;
+    void spool(const std::string& body, const std::string& encoding);
+    bool drainSpool();
+    void adoptOrphanedSpools();
+
+    PushSettings m_settings;
+    std::string m_host, m_port, m_path;
+    bool m_permanentFailure = false;             // Set by a 4xx answer for the current request.
+
+    std::mutex m_mutex;                          // Guards m_series, m_pending, m_dropped, m_lastLog and m_stop.
+    std::condition_variable m_wake;
+    std::list<Series> m_series;
+    std::string m_pending;                       // Lines of the next batch.
+    uint64_t m_dropped = 0;                      // Samples not buffered because the batch was full.
+    // Logger of the most recently removed series; only used for the final flush, which runs
+    // inside that instance's detach call while it is still alive.
+    MetricsLogFn m_lastLog = nullptr;
+    void* m_lastLogCtx = nullptr;
+    bool m_stop = false;
+    std::string m_spoolPrefix;                   // "<url hash>-" shared by the spools of all processes.
+    std::string m_spoolPath;                     // This process's spool: <spoolDir>/<prefix><pid>.
+    uint64_t m_spoolSequence = 0;
+    std::thread m_thread;
+};
+
+#endif // PUSH_EXPORTER_HPP
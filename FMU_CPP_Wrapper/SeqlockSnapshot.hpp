@@ -0,0 +1,64 @@
+/**
+ * @file SeqlockSnapshot.hpp
+ * @brief A single-writer value that any number of threads can read without locks.
+ *
+ * The writer bumps a sequence counter to odd, stores the value, and bumps it to even
+ * with a release store; publishing never waits. A reader copies the value between two
+ * reads of the counter and retries if the counter was odd or changed, which only
+ * happens when it overlaps a publish. The value is kept in atomic words with release/acquire
+ * ordering instead of fences, so the racy copy is well-defined and ThreadSanitizer-clean;
+ * on x86 these are plain loads and stores.
+ */
+#ifndef SEQLOCK_SNAPSHOT_HPP
+#define SEQLOCK_SNAPSHOT_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+template <class T>
+class SeqlockSnapshot {
+    static_assert(std::is_trivially_copyable<T>::value, "snapshots are copied word by word");
+
+public:
+    /** @brief Publishes a new value; must only be called from the one writer thread. */
+    void publish(const T& value) {
+        const uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        uint64_t words[WORDS] = {};
+        std::memcpy(words, &value, sizeof(T));
+        // Release orders the odd sequence before each word: a reader that sees a new word also sees the odd count.
+        for (size_t i = 0; i < WORDS; i++) m_words[i].store(words[i], std::memory_order_release);
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copies a consistent value into `out`.
+     * @return The number of publishes the copy reflects (0: nothing published yet, `out` untouched),
+     *         or UINT64_MAX if the writer kept overlapping for `maxAttempts` tries.
+     */
+    uint64_t read(T& out, unsigned maxAttempts = 1000) const {
+        for (unsigned attempt = 0; attempt < maxAttempts; attempt++) {
+            const uint64_t before = m_sequence.load(std::memory_order_acquire);
+            if (before & 1) continue;
+            if (before == 0) return 0;
+            uint64_t words[WORDS];
+            for (size_t i = 0; i < WORDS; i++) words[i] = m_words[i].load(std::memory_order_acquire);
+            if (m_sequence.load(std::memory_order_relaxed) == before) {
+                std::memcpy(&out, words, sizeof(T));
+                return before / 2;
+            }
+        }
+        return UINT64_MAX;
+    }
+
+private:
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    // Own cache line, so readers polling the snapshot do not slow down the writer's other fields.
+    alignas(64) std::atomic<uint64_t> m_sequence{0};
+    std::atomic<uint64_t> m_words[WORDS] = {};
+};
+
+#endif // SEQLOCK_SNAPSHOT_HPP
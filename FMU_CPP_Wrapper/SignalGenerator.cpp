@@ -0,0 +1,183 @@
+/**
+ * @file SignalGenerator.cpp
+ * @brief Implements the block kernels of the native signal sources.
+ */
+#include "SignalGenerator.hpp"
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+constexpr double TWO_PI = 6.283185307179586476925286766559;
+
+SignalType parseType(const std::string& name) {
+    if (name == "sine") return SignalType::Sine;
+    if (name == "chirp") return SignalType::Chirp;
+    if (name == "step") return SignalType::Step;
+    if (name == "ramp") return SignalType::Ramp;
+    if (name == "prbs") return SignalType::Prbs;
+    throw std::runtime_error("Unknown signal type: " + name);
+}
+} // namespace
+
+SignalGenerator::SignalGenerator(const SignalSpec& spec) : m_spec(spec), m_lfsr(spec.seed & 0x7FFF) {
+    if (m_lfsr == 0) throw std::runtime_error("PRBS seed must be non-zero.");
+    if (m_spec.type == SignalType::Prbs && m_spec.bitPeriod <= 0.0) throw std::runtime_error("PRBS bit period must be positive.");
+    // The sweep rate is (frequency_end - frequency) / duration.
+    if (m_spec.type == SignalType::Chirp && m_spec.duration <= 0.0) throw std::runtime_error("Chirp duration must be positive.");
+}
+
+std::unique_ptr<SignalGenerator> SignalGenerator::fromConfig(const WrapperConfig& config, const std::string& prefix) {
+    if (!config.has(prefix + ".type")) return nullptr;
+    SignalSpec spec;
+    spec.type = parseType(config.getString(prefix + ".type"));
+    spec.amplitude = config.getDouble(prefix + ".amplitude", spec.amplitude);
+    spec.offset = config.getDouble(prefix + ".offset", spec.offset);
+    spec.frequency = config.getDouble(prefix + ".frequency", spec.frequency);
+    spec.frequencyEnd = config.getDouble(prefix + ".frequency_end", spec.frequencyEnd);
+    spec.duration = config.getDouble(prefix + ".duration", spec.duration);
+    spec.phase = config.getDouble(prefix + ".phase", spec.phase);
+    spec.startTime = config.getDouble(prefix + ".start_time", spec.startTime);
+    spec.slope = config.getDouble(prefix + ".slope", spec.slope);
+    spec.bitPeriod = config.getDouble(prefix + ".bit_period", spec.bitPeriod);
+    spec.seed = static_cast<uint32_t>(config.getInt(prefix + ".seed", spec.seed));
+    return std::make_unique<SignalGenerator>(spec);
+}
+
+double SignalGenerator::sampleAt(double t, double h) {
+    if (m_valid && h == m_blockStep) {
+        const double pos = (t - m_blockStart) / h;
+        const double idx = std::nearbyint(pos);
+        // Accept masters that accumulate t += h, as long as t stays on the block's grid.
+        if (idx >= 0.0 && idx < static_cast<double>(BLOCK_SIZE) && std::fabs(pos - idx) < 1e-6) {
+            const size_t i = static_cast<size_t>(idx);
+            if (i >= m_used) m_used = i + 1;
+            return m_block[i];
+        }
+    }
+    if (m_valid && m_used < BLOCK_SIZE && m_discard) m_discard(m_used);
+    refill(t, h);
+    m_used = 1;
+    return m_block[0];
+}
+
+void SignalGenerator::refill(double t0, double h) {
+    m_blockStart = t0;
+    m_blockStep = h;
+    m_valid = true;
+
+    switch (m_spec.type) {
+    case SignalType::Sine:
+        fillSine(t0, h);
+        break;
+    case SignalType::Chirp:
+        fillChirp(t0, h);
+        break;
+    case SignalType::Step:
+        for (size_t i = 0; i < BLOCK_SIZE; i++) {
+            const double t = t0 + static_cast<double>(i) * h;
+            m_block[i] = m_spec.offset + (t >= m_spec.startTime ? m_spec.amplitude : 0.0);
+        }
+        break;
+    case SignalType::Ramp:
+        for (size_t i = 0; i < BLOCK_SIZE; i++) {
+            const double dt = t0 + static_cast<double>(i) * h - m_spec.startTime;
+            m_block[i] = m_spec.offset + m_spec.slope * (dt > 0.0 ? dt : 0.0);
+        }
+        break;
+    case SignalType::Prbs:
+        fillPrbs(t0, h);
+        break;
+    }
+
+    if (m_filter) {
+        for (size_t i = 0; i < BLOCK_SIZE; i++) m_times[i] = t0 + static_cast<double>(i) * h;
+        m_filter(m_block.data(), m_times.data(), BLOCK_SIZE);
+    }
+}
+
+// LANES phasors start one sample apart and each rotates by LANES samples per iteration,
+// so every iteration of the outer loop emits LANES consecutive samples from independent lanes.
+void SignalGenerator::fillSine(double t0, double h) {
+    const double omega = TWO_PI * m_spec.frequency;
+    alignas(64) double c[LANES], s[LANES];
+    for (size_t j = 0; j < LANES; j++) {
+        const double theta = omega * (t0 + static_cast<double>(j) * h) + m_spec.phase;
+        c[j] = std::cos(theta);
+        s[j] = std::sin(theta);
+    }
+    const double rc = std::cos(omega * h * LANES), rs = std::sin(omega * h * LANES);
+    const double amp = m_spec.amplitude, off = m_spec.offset;
+
+    for (size_t k = 0; k < BLOCK_SIZE; k += LANES) {
+        for (size_t j = 0; j < LANES; j++) {
+            m_block[k + j] = off + amp * s[j];
+            const double cn = c[j] * rc - s[j] * rs;
+            s[j] = s[j] * rc + c[j] * rs;
+            c[j] = cn;
+        }
+    }
+}
+
+double SignalGenerator::chirpPhase(double t) const {
+    const double T = m_spec.duration, f0 = m_spec.frequency, f1 = m_spec.frequencyEnd;
+    if (t <= T) return TWO_PI * (f0 * t + 0.5 * (f1 - f0) / T * t * t) + m_spec.phase;
+    return TWO_PI * (0.5 * (f0 + f1) * T + f1 * (t - T)) + m_spec.phase;
+}
+
+// Linear chirp: the per-sample rotation r itself rotates by a constant q = exp(i*2*pi*k*h^2),
+// so the phase is advanced with two complex multiplies and no transcendental calls.
+void SignalGenerator::fillChirp(double t0, double h) {
+    const double T = m_spec.duration;
+    const double k = (m_spec.frequencyEnd - m_spec.frequency) / T;
+    const double amp = m_spec.amplitude, off = m_spec.offset;
+
+    double pc = std::cos(chirpPhase(t0)), ps = std::sin(chirpPhase(t0));
+    const double d0 = chirpPhase(t0 + h) - chirpPhase(t0);
+    double rc = std::cos(d0), rs = std::sin(d0);
+    const double qc = std::cos(TWO_PI * k * h * h), qs = std::sin(TWO_PI * k * h * h);
+    bool sweeping = t0 < T;
+
+    for (size_t i = 0; i < BLOCK_SIZE; i++) {
+        m_block[i] = off + amp * ps;
+        const double t = t0 + static_cast<double>(i + 1) * h;
+        if (sweeping && t > T) {
+            // Leaving the sweep: re-seed exactly and continue at the constant end frequency.
+            sweeping = false;
+            pc = std::cos(chirpPhase(t));
+            ps = std::sin(chirpPhase(t));
+            rc = std::cos(TWO_PI * m_spec.frequencyEnd * h);
+            rs = std::sin(TWO_PI * m_spec.frequencyEnd * h);
+            continue;
+        }
+        const double pcn = pc * rc - ps * rs;
+        ps = ps * rc + pc * rs;
+        pc = pcn;
+        if (sweeping) {
+            const double rcn = rc * qc - rs * qs;
+            rs = rs * qc + rc * qs;
+            rc = rcn;
+        }
+    }
+}
+
+// PRBS15 (x^15 + x^14 + 1) held for `bitPeriod` seconds per bit, mapped to offset +/- amplitude.
+void SignalGenerator::fillPrbs(double t0, double h) {
+    auto advance = [this]() {
+        const uint32_t bit = ((m_lfsr >> 14) ^ (m_lfsr >> 13)) & 1u;
+        m_lfsr = ((m_lfsr << 1) | bit) & 0x7FFFu;
+        m_lfsrIndex++;
+    };
+
+    for (size_t i = 0; i < BLOCK_SIZE; i++) {
+        const double dt = t0 + static_cast<double>(i) * h - m_spec.startTime;
+        if (dt < 0.0) { m_block[i] = m_spec.offset; continue; }
+        const long long index = static_cast<long long>(std::floor(dt / m_spec.bitPeriod));
+        if (index < m_lfsrIndex) {
+            // Time went backwards (e.g. a reset): replay the register from the seed.
+            m_lfsr = m_spec.seed & 0x7FFFu;
+            m_lfsrIndex = 0;
+        }
+        while (m_lfsrIndex < index) advance();
+        m_block[i] = m_spec.offset + ((m_lfsr & 1u) ? m_spec.amplitude : -m_spec.amplitude);
+    }
+}
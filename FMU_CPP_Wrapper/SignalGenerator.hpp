@@ -0,0 +1,98 @@
+/**
+ * @file SignalGenerator.hpp
+ * @brief Native test-signal sources (sine, chirp, step, ramp, PRBS) that drive wrapper inputs.
+ *
+ * Samples are produced in blocks for a fixed communication step size. Periodic signals
+ * use phasor recurrences instead of calling sin() per sample: the sine runs several
+ * independent lanes side by side so the inner loop vectorizes, and the chirp advances
+ * its phasor with a second-order rotation. Each refill re-seeds from the closed form,
+ * which keeps the recurrence drift bounded to one block.
+ */
+#ifndef SIGNAL_GENERATOR_HPP
+#define SIGNAL_GENERATOR_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "WrapperConfig.hpp"
+
+enum class SignalType { Sine, Chirp, Step, Ramp, Prbs };
+
+// Parameters for one signal source; unused fields are ignored by the selected type.
+struct SignalSpec {
+    SignalType type = SignalType::Sine;
+    double amplitude = 1.0;
+    double offset = 0.0;
+    double frequency = 1.0;     // Hz; start frequency for the chirp.
+    double frequencyEnd = 10.0; // Chirp end frequency in Hz.
+    double duration = 10.0;     // Chirp sweep time in seconds; the frequency holds afterwards.
+    double phase = 0.0;         // Radians.
+    double startTime = 0.0;     // Step/ramp onset.
+    double slope = 1.0;         // Ramp slope per second.
+    double bitPeriod = 0.1;     // PRBS bit duration in seconds.
+    uint32_t seed = 0x7FFF;     // PRBS15 initial register (non-zero).
+};
+
+/**
+ * @class SignalGenerator
+ * @brief Produces samples of a SignalSpec at t0, t0+h, t0+2h, ... in blocks.
+ */
+class SignalGenerator {
+public:
+    static constexpr size_t BLOCK_SIZE = 256;
+
+    explicit SignalGenerator(const SignalSpec& spec);
+
+    /**
+     * @brief Builds a generator from the `<prefix>.*` keys of the config.
+     * @return nullptr if `<prefix>.type` is not set.
+     */
+    static std::unique_ptr<SignalGenerator> fromConfig(const WrapperConfig& config, const std::string& prefix);
+
+    /** @brief Returns the sample at time t for step size h, refilling the block when needed. */
+    double sampleAt(double t, double h);
+
+    /**
+     * @brief Installs a hook that post-processes each freshly generated block in place.
+     * times[i] is the simulation time of samples[i]; used to run fault plugins per block.
+     */
+    using BlockFilter = std::function<void(double* samples, const double* times, size_t n)>;
+    void setBlockFilter(BlockFilter filter) { m_filter = std::move(filter); }
+
+    /**
+     * @brief Installs a hook called before a block is replaced while samples past the first
+     * `used` ones were never returned (the step size changed or time jumped), so a stateful
+     * filter can take those samples back.
+     */
+    using DiscardHook = std::function<void(size_t used)>;
+    void setDiscardHook(DiscardHook hook) { m_discard = std::move(hook); }
+
+private:
+    static constexpr size_t LANES = 8;
+
+    void refill(double t0, double h);
+    void fillSine(double t0, double h);
+    void fillChirp(double t0, double h);
+    void fillPrbs(double t0, double h);
+    double chirpPhase(double t) const;
+
+    SignalSpec m_spec;
+    alignas(64) std::array<double, BLOCK_SIZE> m_block{};
+    std::array<double, BLOCK_SIZE> m_times{};
+    BlockFilter m_filter;
+    DiscardHook m_discard;
+    size_t m_used = 0;          // One past the last sample of the block returned so far.
+    double m_blockStart = 0.0;
+    double m_blockStep = 0.0;
+    bool m_valid = false;
+
+    // PRBS15 register and the bit index it currently represents.
+    uint32_t m_lfsr;
+    long long m_lfsrIndex = 0;
+};
+
+#endif // SIGNAL_GENERATOR_HPP
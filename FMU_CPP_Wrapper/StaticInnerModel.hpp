@@ -0,0 +1,40 @@
+/**
+ * @file StaticInnerModel.hpp
+ * @brief Entry points of an inner model compiled into the wrapper (FAULT_WRAPPER_STATIC_INNER).
+ *
+ * For trusted inner models shipped with the wrapper, build.sh (STATIC_INNER_MODEL=1)
+ * compiles the model's C sources with -DFMI2_FUNCTION_PREFIX=innerModel_, so their
+ * fmi2* functions become innerModel_fmi2* and do not clash with the wrapper's own API.
+ * The wrapper then calls them directly instead of through dlsym'd pointers, and with
+ * -flto the model's step can be inlined into FaultWrapper::doStep.
+ */
+#ifndef STATIC_INNER_MODEL_HPP
+#define STATIC_INNER_MODEL_HPP
+
+extern "C" {
+#include "fmi2Functions.h"
+}
+
+// Must match the FMI2_FUNCTION_PREFIX the model sources are compiled with.
+#define STATIC_INNER(Name) innerModel_fmi2##Name
+
+extern "C" {
+fmi2InstantiateTYPE             STATIC_INNER(Instantiate);
+fmi2FreeInstanceTYPE            STATIC_INNER(FreeInstance);
+fmi2SetupExperimentTYPE         STATIC_INNER(SetupExperiment);
+fmi2EnterInitializationModeTYPE STATIC_INNER(EnterInitializationMode);
+fmi2ExitInitializationModeTYPE  STATIC_INNER(ExitInitializationMode);
+fmi2TerminateTYPE               STATIC_INNER(Terminate);
+fmi2ResetTYPE                   STATIC_INNER(Reset);
+fmi2GetRealTYPE                 STATIC_INNER(GetReal);
+fmi2SetRealTYPE                 STATIC_INNER(SetReal);
+fmi2GetIntegerTYPE              STATIC_INNER(GetInteger);
+fmi2SetIntegerTYPE              STATIC_INNER(SetInteger);
+fmi2GetBooleanTYPE              STATIC_INNER(GetBoolean);
+fmi2SetBooleanTYPE              STATIC_INNER(SetBoolean);
+fmi2DoStepTYPE                  STATIC_INNER(DoStep);
+// Optional as in the dynamic build: the address is null unless the model defines it.
+fmi2CancelStepTYPE              STATIC_INNER(CancelStep) __attribute__((weak));
+}
+
+#endif // STATIC_INNER_MODEL_HPP
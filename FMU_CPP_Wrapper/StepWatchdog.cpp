@@ -0,0 +1,86 @@
+/**
+ * @file StepWatchdog.cpp
+ * @brief Implements the process-wide watchdog thread behind StepWatchdog::Slot.
+ */
+#include "StepWatchdog.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Deadlines are checked every quarter budget, within these bounds.
+constexpr std::chrono::nanoseconds MIN_POLL_INTERVAL = std::chrono::milliseconds(1);
+constexpr std::chrono::nanoseconds MAX_POLL_INTERVAL = std::chrono::milliseconds(100);
+
+struct Registry {
+    std::mutex lifecycle; // Serializes starting and joining the thread.
+    std::mutex mutex;     // Guards everything below; held while callbacks run.
+    std::condition_variable wake;
+    std::vector<StepWatchdog::Slot*> slots;
+    std::chrono::nanoseconds interval = MAX_POLL_INTERVAL;
+    bool stop = false;
+    std::thread thread;
+};
+
+// Never destroyed: the last Slot joins the thread, so nothing is left to clean up at exit.
+Registry& registry() {
+    static Registry* instance = new Registry;
+    return *instance;
+}
+
+} // namespace
+
+std::unique_ptr<StepWatchdog::Slot> StepWatchdog::watch(std::chrono::nanoseconds budget, ExpiredFn onExpired) {
+    std::unique_ptr<Slot> slot(new Slot(budget.count(), std::move(onExpired)));
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lifecycle(r.lifecycle);
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.slots.push_back(slot.get());
+        r.interval = std::min(r.interval, std::max(MIN_POLL_INTERVAL, budget / 4));
+        r.stop = false;
+    }
+    if (!r.thread.joinable()) r.thread = std::thread(&StepWatchdog::run);
+    return slot;
+}
+
+StepWatchdog::Slot::~Slot() { StepWatchdog::unwatch(this); }
+
+void StepWatchdog::unwatch(Slot* slot) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lifecycle(r.lifecycle);
+    bool last;
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.slots.erase(std::remove(r.slots.begin(), r.slots.end(), slot), r.slots.end());
+        r.interval = MAX_POLL_INTERVAL;
+        for (const Slot* other : r.slots) r.interval = std::min(r.interval, std::max(MIN_POLL_INTERVAL, std::chrono::nanoseconds(other->m_budget / 4)));
+        last = r.slots.empty();
+        if (last) r.stop = true;
+    }
+    if (last) {
+        r.wake.notify_all();
+        r.thread.join();
+    }
+}
+
+void StepWatchdog::run() {
+    Registry& r = registry();
+    std::unique_lock<std::mutex> lock(r.mutex);
+    while (!r.stop) {
+        r.wake.wait_for(lock, r.interval, [&] { return r.stop; });
+        const int64_t now = Slot::now();
+        for (Slot* slot : r.slots) {
+            int64_t deadline = slot->m_deadline.load(std::memory_order_acquire);
+            // The exchange loses against end(), so a step that just finished is never reported.
+            if (deadline > Slot::IDLE && now > deadline &&
+                slot->m_deadline.compare_exchange_strong(deadline, Slot::EXPIRED, std::memory_order_acq_rel)) {
+                slot->m_onExpired();
+            }
+        }
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ * @file StepWatchdog.hpp
+ * @brief Detects inner doStep calls that overrun a per-step time budget.
+ *
+ * Every watched instance publishes a monotonic deadline before it calls into the inner FMU
+ * and clears it afterwards; that is two atomic stores per step and no syscalls. One
+ * process-wide watchdog thread polls all deadlines and, when one has passed, runs the
+ * instance's expiry callback (which requests fmi2CancelStep on the inner FMU). The thread
+ * exists only while at least one instance is watched.
+ */
+#ifndef STEP_WATCHDOG_HPP
+#define STEP_WATCHDOG_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+class StepWatchdog {
+public:
+    using ExpiredFn = std::function<void()>;
+
+    /**
+     * @class Slot
+     * @brief One instance's deadline; unregisters from the watchdog on destruction.
+     *
+     * The destructor waits for a running expiry callback, so the callback may use
+     * anything that outlives the slot.
+     */
+    class Slot {
+    public:
+        ~Slot();
+        Slot(const Slot&) = delete;
+        Slot& operator=(const Slot&) = delete;
+
+        /** @brief Arms the deadline for a step that starts now. */
+        void begin() { m_deadline.store(now() + m_budget, std::memory_order_release); }
+
+        /** @brief Disarms the deadline; returns true if the step overran its budget. */
+        bool end() { return m_deadline.exchange(IDLE, std::memory_order_acq_rel) == EXPIRED; }
+
+        std::chrono::nanoseconds budget() const { return std::chrono::nanoseconds(m_budget); }
+
+    private:
+        friend class StepWatchdog;
+        static constexpr int64_t IDLE = 0;
+        static constexpr int64_t EXPIRED = -1;
+
+        Slot(int64_t budget, ExpiredFn onExpired) : m_budget(budget), m_onExpired(std::move(onExpired)) {}
+        static int64_t now() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        std::atomic<int64_t> m_deadline{IDLE}; // steady_clock nanoseconds, IDLE or EXPIRED.
+        const int64_t m_budget;
+        const ExpiredFn m_onExpired;
+    };
+
+    /**
+     * @brief Starts watching one instance.
+     * @param budget Maximum duration of one step (positive).
+     * @param onExpired Called once from the watchdog thread when a step overruns.
+     */
+    static std::unique_ptr<Slot> watch(std::chrono::nanoseconds budget, ExpiredFn onExpired);
+
+private:
+    static void unwatch(Slot* slot);
+    static void run();
+};
+
+#endif // STEP_WATCHDOG_HPP
@@ -0,0 +1,193 @@
+/**
+ * @file TelemetrySegment.cpp
+ * @brief Creates, shares and releases the process-wide telemetry segment.
+ */
+#include "TelemetrySegment.hpp"
+
+#include <cerrno>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr size_t CACHE_LINE = 64;
+
+size_t roundUp(size_t value, size_t alignment) { return (value + alignment - 1) / alignment * alignment; }
+
+#ifndef _WIN32
+// True if the existing segment `name` is complete and its writer process no longer exists.
+// A segment still being set up, or written by this process (another copy of the wrapper
+// library), counts as live.
+bool isStaleSegment(const std::string& name) {
+    const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+    struct stat info{};
+    void* base = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(TelemetryHeader)) {
+        base = mmap(nullptr, sizeof(TelemetryHeader), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (base == MAP_FAILED) return false;
+    const auto* header = static_cast<const TelemetryHeader*>(base);
+    const bool complete = __atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) == TELEMETRY_MAGIC;
+    const pid_t writer = static_cast<pid_t>(header->writer_pid);
+    munmap(base, sizeof(TelemetryHeader));
+    return complete && writer > 0 && writer != getpid() && kill(writer, 0) != 0 && errno == ESRCH;
+}
+#endif
+
+} // namespace
+
+// The mapped segment; shared by every channel of the process that uses the same name.
+class TelemetrySegment {
+public:
+    TelemetrySegment(const std::string& name, uint32_t maxInstances, uint32_t ringCapacity,
+                     const TelemetryVariable* variables, size_t count);
+    ~TelemetrySegment();
+
+    TelemetrySlotHeader* claim(const std::string& instanceName);
+    double* samples(TelemetrySlotHeader* slot) const {
+        return reinterpret_cast<double*>(reinterpret_cast<char*>(slot) + sizeof(TelemetrySlotHeader));
+    }
+    const TelemetryHeader& header() const { return *m_header; }
+    const std::string& name() const { return m_name; }
+
+private:
+    std::string m_name;
+    TelemetryHeader* m_header = nullptr;
+    size_t m_size = 0;
+};
+
+TelemetrySegment::TelemetrySegment(const std::string& name, uint32_t maxInstances, uint32_t ringCapacity,
+                                   const TelemetryVariable* variables, size_t count)
+    : m_name(name) {
+#ifdef _WIN32
+    (void)maxInstances; (void)ringCapacity; (void)variables; (void)count;
+    throw std::runtime_error("Shared-memory telemetry is not supported on Windows.");
+#else
+    if (count == 0 || count > TELEMETRY_MAX_VARIABLES) throw std::runtime_error("Unsupported number of telemetry variables.");
+    const size_t headerSize = roundUp(sizeof(TelemetryHeader), CACHE_LINE);
+    const size_t slotSize = roundUp(sizeof(TelemetrySlotHeader) + size_t(ringCapacity) * count * sizeof(double), CACHE_LINE);
+    m_size = headerSize + slotSize * maxInstances;
+
+    // Never take over a segment that another process may still be writing; only one left
+    // behind by a process that has exited (e.g. crashed) is removed and created again.
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    int openError = fd < 0 ? errno : 0;
+    if (openError == EEXIST && isStaleSegment(name)) {
+        shm_unlink(name.c_str());
+        fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        openError = fd < 0 ? errno : 0;
+    }
+    if (openError == EEXIST) {
+        throw std::runtime_error("Telemetry segment " + name + " is in use by another writer; set telemetry.name to a unique name.");
+    }
+    if (fd < 0) throw std::runtime_error("shm_open(" + name + ") failed: " + std::strerror(openError));
+    void* base = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(m_size)) == 0) {
+        base = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    const int err = errno;
+    close(fd);
+    if (base == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        throw std::runtime_error("Cannot map telemetry segment " + name + ": " + std::strerror(err));
+    }
+
+    // ftruncate zero-fills, so all slots start out free.
+    m_header = static_cast<TelemetryHeader*>(base);
+    m_header->version = TELEMETRY_VERSION;
+    m_header->header_size = static_cast<uint32_t>(headerSize);
+    m_header->slot_size = static_cast<uint32_t>(slotSize);
+    m_header->max_instances = maxInstances;
+    m_header->ring_capacity = ringCapacity;
+    m_header->variable_count = static_cast<uint32_t>(count);
+    m_header->segment_size = m_size;
+    m_header->writer_pid = getpid();
+    std::memcpy(m_header->variables, variables, count * sizeof(TelemetryVariable));
+    __atomic_store_n(&m_header->magic, TELEMETRY_MAGIC, __ATOMIC_RELEASE);
+#endif
+}
+
+TelemetrySegment::~TelemetrySegment() {
+#ifndef _WIN32
+    // Readers that still have the segment mapped keep their view; new readers can no longer open it.
+    munmap(m_header, m_size);
+    shm_unlink(m_name.c_str());
+#endif
+}
+
+TelemetrySlotHeader* TelemetrySegment::claim(const std::string& instanceName) {
+    char* slots = reinterpret_cast<char*>(m_header) + m_header->header_size;
+    for (uint32_t i = 0; i < m_header->max_instances; i++) {
+        auto* slot = reinterpret_cast<TelemetrySlotHeader*>(slots + size_t(i) * m_header->slot_size);
+        // Closed slots are reused too; the generation bump tells readers the ring restarted.
+        uint32_t state = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE);
+        if (state == TELEMETRY_SLOT_ACTIVE) continue;
+        if (!__atomic_compare_exchange_n(&slot->state, &state, TELEMETRY_SLOT_ACTIVE, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) continue;
+        __atomic_store_n(&slot->write_index, 0, __ATOMIC_RELEASE);
+        std::memset(slot->instance_name, 0, sizeof(slot->instance_name));
+        std::strncpy(slot->instance_name, instanceName.c_str(), sizeof(slot->instance_name) - 1);
+        __atomic_add_fetch(&slot->generation, 1, __ATOMIC_RELEASE);
+        return slot;
+    }
+    throw std::runtime_error("Telemetry segment " + m_name + " has no free slot (telemetry.max_instances = " +
+                             std::to_string(m_header->max_instances) + ").");
+}
+
+namespace {
+
+std::mutex g_mutex;
+std::map<std::string, std::weak_ptr<TelemetrySegment>> g_segments;
+
+} // namespace
+
+std::unique_ptr<TelemetryChannel> TelemetryChannel::open(const WrapperConfig& config, const std::string& instanceName,
+                                                         const TelemetryVariable* variables, size_t count) {
+    if (!config.getBool("telemetry.enabled", false)) return nullptr;
+
+#ifdef _WIN32
+    const std::string defaultName = "/fmu_telemetry";
+#else
+    const std::string defaultName = "/fmu_telemetry." + std::to_string(getpid());
+#endif
+    const std::string name = config.getString("telemetry.name", defaultName);
+    const long long capacity = config.getInt("telemetry.ring_capacity", 4096);
+    const long long maxInstances = config.getInt("telemetry.max_instances", 16);
+    if (capacity <= 0 || (capacity & (capacity - 1)) != 0 || capacity > (1LL << 24)) {
+        throw std::runtime_error("telemetry.ring_capacity must be a power of two up to 2^24.");
+    }
+    if (maxInstances <= 0 || maxInstances > 4096) throw std::runtime_error("telemetry.max_instances must be in 1..4096.");
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    std::shared_ptr<TelemetrySegment> segment = g_segments[name].lock();
+    if (!segment) {
+        segment = std::make_shared<TelemetrySegment>(name, static_cast<uint32_t>(maxInstances), static_cast<uint32_t>(capacity), variables, count);
+        g_segments[name] = segment;
+    } else if (segment->header().variable_count != count) {
+        throw std::runtime_error("Telemetry segment " + name + " already holds a different variable layout.");
+    }
+    TelemetrySlotHeader* slot = segment->claim(instanceName);
+    return std::unique_ptr<TelemetryChannel>(new TelemetryChannel(std::move(segment), slot));
+}
+
+TelemetryChannel::TelemetryChannel(std::shared_ptr<TelemetrySegment> segment, TelemetrySlotHeader* slot)
+    : m_segment(std::move(segment)), m_slot(slot), m_samples(m_segment->samples(slot)),
+      m_mask(m_segment->header().ring_capacity - 1), m_count(m_segment->header().variable_count) {}
+
+TelemetryChannel::~TelemetryChannel() {
+    __atomic_store_n(&m_slot->state, TELEMETRY_SLOT_CLOSED, __ATOMIC_RELEASE);
+    std::lock_guard<std::mutex> lock(g_mutex);
+    m_segment.reset(); // Unmaps and unlinks the segment with the last channel.
+}
+
+const std::string& TelemetryChannel::segmentName() const { return m_segment->name(); }
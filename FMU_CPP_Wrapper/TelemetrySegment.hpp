@@ -0,0 +1,61 @@
+/**
+ * @file TelemetrySegment.hpp
+ * @brief Writer side of the shared-memory telemetry segment (layout in telemetry_shm.h).
+ *
+ * All wrapper instances of a process that enable telemetry share one segment; each
+ * claims a slot and appends one sample per step to its ring. Pushing a sample is a
+ * handful of stores and one release store, with no syscalls and no locks, so local
+ * observers can follow every step without slowing down the simulation.
+ */
+#ifndef TELEMETRY_SEGMENT_HPP
+#define TELEMETRY_SEGMENT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "telemetry_shm.h"
+#include "WrapperConfig.hpp"
+
+class TelemetrySegment;
+
+/**
+ * @class TelemetryChannel
+ * @brief One instance's slot in the process-wide segment; releases the slot on destruction.
+ */
+class TelemetryChannel {
+public:
+    /**
+     * @brief Claims a slot according to the `telemetry.*` keys of the config.
+     * @param variables Descriptions of the sample values; variables[0] must be the time.
+     * @return nullptr if `telemetry.enabled` is not set.
+     * @throws std::runtime_error if the segment cannot be created or has no free slot.
+     */
+    static std::unique_ptr<TelemetryChannel> open(const WrapperConfig& config, const std::string& instanceName,
+                                                  const TelemetryVariable* variables, size_t count);
+    ~TelemetryChannel();
+    TelemetryChannel(const TelemetryChannel&) = delete;
+    TelemetryChannel& operator=(const TelemetryChannel&) = delete;
+
+    /** @brief Appends one sample of `count` values (as passed to open()). Never blocks. */
+    void push(const double* values) {
+        std::memcpy(m_samples + (m_writeIndex & m_mask) * m_count, values, m_count * sizeof(double));
+        __atomic_store_n(&m_slot->write_index, ++m_writeIndex, __ATOMIC_RELEASE);
+    }
+
+    const std::string& segmentName() const;
+
+private:
+    TelemetryChannel(std::shared_ptr<TelemetrySegment> segment, TelemetrySlotHeader* slot);
+
+    std::shared_ptr<TelemetrySegment> m_segment;
+    TelemetrySlotHeader* m_slot;
+    double* m_samples;
+    uint64_t m_writeIndex = 0; // Private copy, so push() never reads shared memory.
+    uint64_t m_mask;
+    size_t m_count;
+};
+
+#endif // TELEMETRY_SEGMENT_HPP
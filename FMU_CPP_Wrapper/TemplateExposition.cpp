@@ -0,0 +1,216 @@
+/**
+ * @file TemplateExposition.cpp
+ * @brief Implements the pre-rendered exposition and its minimal HTTP server.
+ */
+#include "TemplateExposition.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+TemplateExposition::TemplateExposition(const std::string& bindAddress) {
+#ifdef _WIN32
+    (void)bindAddress;
+    throw std::runtime_error("The template exposition is not supported on Windows.");
+#else
+    const auto colon = bindAddress.rfind(':');
+    if (colon == std::string::npos) throw std::runtime_error("Bind address must be host:port: " + bindAddress);
+    const std::string host = bindAddress.substr(0, colon), port = bindAddress.substr(colon + 1);
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &result) != 0 || !result) {
+        throw std::runtime_error("Cannot resolve bind address: " + bindAddress);
+    }
+    m_listenFd = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+    const int one = 1;
+    if (m_listenFd >= 0) setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    const bool ok = m_listenFd >= 0 && bind(m_listenFd, result->ai_addr, result->ai_addrlen) == 0 && listen(m_listenFd, 16) == 0;
+    freeaddrinfo(result);
+    if (!ok) {
+        const int err = errno;
+        if (m_listenFd >= 0) close(m_listenFd);
+        throw std::runtime_error("Cannot listen on " + bindAddress + ": " + std::strerror(err));
+    }
+
+    render();
+    m_thread = std::thread(&TemplateExposition::serve, this);
+#endif
+}
+
+TemplateExposition::~TemplateExposition() {
+    m_stop = true;
+    if (m_thread.joinable()) m_thread.join();
+#ifndef _WIN32
+    if (m_listenFd >= 0) close(m_listenFd);
+#endif
+}
+
+void* TemplateExposition::add(const MetricsAttachOptions& options) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_series.push_back(Series{escapeLabelValue(options.instance_name)});
+    render();
+    return &m_series.back();
+}
+
+void TemplateExposition::remove(void* series) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_series.remove_if([series](const Series& s) { return &s == series; });
+    render();
+}
+
+// Formatting happens outside the lock; only the fixed-width copies are serialized with scrapes.
+void TemplateExposition::publish(void* handle, const MetricsData& data) {
+    auto* series = static_cast<Series*>(handle);
+    char text[METRIC_FAMILY_COUNT][SLOT_WIDTH + 1];
+    for (size_t i = 0; i < METRIC_FAMILY_COUNT; i++) {
+        std::snprintf(text[i], sizeof(text[i]), "%*.17g", static_cast<int>(SLOT_WIDTH), metricValue(data, i));
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t i = 0; i < METRIC_FAMILY_COUNT; i++) {
+        series->values[i] = metricValue(data, i);
+        std::memcpy(m_response.data() + series->slots[i], text[i], SLOT_WIDTH);
+    }
+}
+
+void TemplateExposition::render() {
+    std::string body;
+    for (size_t f = 0; f < METRIC_FAMILY_COUNT; f++) {
+        body += std::string("# HELP ") + METRIC_FAMILIES[f].name + " " + METRIC_FAMILIES[f].help + "\n";
+        body += std::string("# TYPE ") + METRIC_FAMILIES[f].name + " gauge\n";
+        for (Series& s : m_series) {
+            // Prometheus allows any run of blanks before the value, so slots are right-aligned.
+            body += std::string(METRIC_FAMILIES[f].name) + "{instance=\"" + s.label + "\"} ";
+            s.slots[f] = body.size(); // Relative to the body for now.
+            char text[SLOT_WIDTH + 1];
+            std::snprintf(text, sizeof(text), "%*.17g", static_cast<int>(SLOT_WIDTH), s.values[f]);
+            body.append(text, SLOT_WIDTH);
+            body += "\n";
+        }
+    }
+
+    const std::string header = "HTTP/1.1 200 OK\r\n"
+                               "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                               "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                               "Connection: close\r\n\r\n";
+    for (Series& s : m_series) {
+        for (size_t f = 0; f < METRIC_FAMILY_COUNT; f++) s.slots[f] += header.size();
+    }
+    m_response.assign(header.begin(), header.end());
+    m_response.insert(m_response.end(), body.begin(), body.end());
+}
+
+void TemplateExposition::serve() {
+#ifndef _WIN32
+    Connection connections[MAX_CONNECTIONS];
+    pollfd fds[1 + MAX_CONNECTIONS];
+    Connection* polled[1 + MAX_CONNECTIONS];
+    const auto drop = [](Connection& c) { close(c.fd); c.fd = -1; };
+
+    while (!m_stop) {
+        size_t n = 0;
+        fds[n++] = pollfd{m_listenFd, POLLIN, 0};
+        for (Connection& c : connections) {
+            if (c.fd < 0) continue;
+            polled[n] = &c;
+            fds[n++] = pollfd{c.fd, POLLIN, 0};
+        }
+        // Wake up regularly to notice m_stop and expired deadlines.
+        if (poll(fds, n, 100) < 0) continue;
+
+        for (size_t i = 1; i < n; i++) {
+            if (!fds[i].revents) continue;
+            Connection& c = *polled[i];
+            const ReadState state = receive(c);
+            if (state == ReadState::Complete) respond(c.fd, c.request);
+            if (state != ReadState::Partial) drop(c);
+        }
+        const auto now = std::chrono::steady_clock::now();
+        for (Connection& c : connections) {
+            if (c.fd >= 0 && now >= c.deadline) drop(c);
+        }
+
+        if (fds[0].revents & POLLIN) {
+            const int client = accept(m_listenFd, nullptr, nullptr);
+            if (client < 0) continue;
+            // With every slot taken, the client closest to its deadline gives way.
+            Connection* slot = &connections[0];
+            for (Connection& c : connections) {
+                if (c.fd < 0) { slot = &c; break; }
+                if (c.deadline < slot->deadline) slot = &c;
+            }
+            if (slot->fd >= 0) drop(*slot);
+            // Bounds a scraper that stops reading the response; reads never block (see receive).
+            const timeval sendTimeout{0, SEND_TIMEOUT_MS * 1000};
+            setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &sendTimeout, sizeof(sendTimeout));
+            slot->fd = client;
+            slot->deadline = now + std::chrono::milliseconds(READ_TIMEOUT_MS);
+            slot->received = 0;
+            slot->request[0] = '\0';
+        }
+    }
+    for (Connection& c : connections) {
+        if (c.fd >= 0) drop(c);
+    }
+#endif
+}
+
+TemplateExposition::ReadState TemplateExposition::receive(Connection& c) {
+#ifndef _WIN32
+    const size_t before = c.received;
+    while (c.received < sizeof(c.request) - 1) {
+        const ssize_t n = recv(c.fd, c.request + c.received, sizeof(c.request) - 1 - c.received, MSG_DONTWAIT);
+        if (n <= 0) break;
+        c.received += static_cast<size_t>(n);
+    }
+    c.request[c.received] = '\0';
+    // Only the request line matters, so a head that fills the buffer is answered as it is.
+    if (std::strstr(c.request, "\r\n\r\n") || c.received == sizeof(c.request) - 1) return ReadState::Complete;
+    // Readable without data: the client closed or the connection failed.
+    return c.received == before ? ReadState::Closed : ReadState::Partial;
+#else
+    (void)c;
+    return ReadState::Closed;
+#endif
+}
+
+void TemplateExposition::respond(int client, const char* request) {
+#ifndef _WIN32
+    if (std::strncmp(request, "GET /metrics", 12) != 0) {
+        static const char notFound[] = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        send(client, notFound, sizeof(notFound) - 1, MSG_NOSIGNAL);
+        return;
+    }
+
+    size_t size;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size = m_response.size();
+        // Only grows when an instance was added since the last scrape.
+        m_sendBuffer.resize(size);
+        std::memcpy(m_sendBuffer.data(), m_response.data(), size);
+    }
+    size_t sent = 0;
+    while (sent < size) {
+        const ssize_t n = send(client, m_sendBuffer.data() + sent, size - sent, MSG_NOSIGNAL);
+        if (n <= 0) return;
+        sent += static_cast<size_t>(n);
+    }
+#else
+    (void)client;
+    (void)request;
+#endif
+}
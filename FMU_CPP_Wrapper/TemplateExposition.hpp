@@ -0,0 +1,71 @@
+/**
+ * @file TemplateExposition.hpp
+ * @brief Allocation-free Prometheus text exposition for the metrics exporter library.
+ *
+ * The complete HTTP response (headers and body) is rendered once whenever an instance
+ * attaches or detaches. Every value occupies a fixed-width, right-aligned slot, so
+ * publishing a sample only overwrites its slots and a scrape is a single memcpy of
+ * the response into a preallocated send buffer.
+ */
+#ifndef TEMPLATE_EXPOSITION_HPP
+#define TEMPLATE_EXPOSITION_HPP
+
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MetricsEndpoint.hpp"
+
+class TemplateExposition : public MetricsEndpoint {
+public:
+    // Wide enough for any %.17g double, e.g. "-1.2345678901234567e-308".
+    static constexpr size_t SLOT_WIDTH = 24;
+
+    /** @throws std::runtime_error if the address cannot be bound. */
+    explicit TemplateExposition(const std::string& bindAddress);
+    ~TemplateExposition() override;
+
+    void* add(const MetricsAttachOptions& options) override;
+    void publish(void* series, const MetricsData& data) override;
+    void remove(void* series) override;
+
+private:
+    struct Series {
+        std::string label;                      // Instance name, escaped for the label value.
+        double values[METRIC_FAMILY_COUNT] = {};
+        size_t slots[METRIC_FAMILY_COUNT] = {}; // Byte offsets into m_response.
+    };
+
+    // A client whose request head is still arriving. Each has its own read deadline, so an
+    // idle client only holds its slot and does not delay the others.
+    struct Connection {
+        int fd = -1;
+        std::chrono::steady_clock::time_point deadline;
+        size_t received = 0;
+        char request[2048];
+    };
+    enum class ReadState { Partial, Complete, Closed };
+    static constexpr size_t MAX_CONNECTIONS = 16;
+    static constexpr int READ_TIMEOUT_MS = 1000;
+    static constexpr int SEND_TIMEOUT_MS = 200;
+
+    void render();                // Rebuilds m_response and the slot offsets; caller holds m_mutex.
+    void serve();                 // Event loop of the HTTP thread: accepts and reads all clients.
+    ReadState receive(Connection& c); // Reads what is available without blocking.
+    void respond(int client, const char* request);
+
+    std::mutex m_mutex;           // Guards m_response, the slots and m_series.
+    std::list<Series> m_series;   // Stable addresses, handed out as series handles.
+    std::vector<char> m_response;
+    std::vector<char> m_sendBuffer; // Serve thread only: the response is copied under m_mutex, sent without it.
+
+    int m_listenFd = -1;
+    std::atomic<bool> m_stop{false};
+    std::thread m_thread;
+};
+
+#endif // TEMPLATE_EXPOSITION_HPP
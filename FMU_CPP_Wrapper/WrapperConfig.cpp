@@ -0,0 +1,74 @@
+/**
+ * @file WrapperConfig.cpp
+ * @brief Implements the key/value parser for `wrapper.cfg`.
+ */
+#include "WrapperConfig.hpp"
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+std::string trim(const std::string& s) {
+    const auto first = s.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) return "";
+    const auto last = s.find_last_not_of(" \t\r\n");
+    return s.substr(first, last - first + 1);
+}
+} // namespace
+
+WrapperConfig WrapperConfig::load(const std::string& path) {
+    WrapperConfig config;
+    std::ifstream in(path);
+    if (!in) return config;
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        // A '#' at the start of a line or after whitespace begins a comment.
+        for (size_t i = 0; i < line.size(); i++) {
+            if (line[i] == '#' && (i == 0 || line[i - 1] == ' ' || line[i - 1] == '\t')) { line.erase(i); break; }
+        }
+        line = trim(line);
+        if (line.empty()) continue;
+        const auto eq = line.find('=');
+        if (eq == std::string::npos) {
+            throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": expected 'key = value'");
+        }
+        config.m_values[trim(line.substr(0, eq))] = trim(line.substr(eq + 1));
+    }
+    return config;
+}
+
+std::string WrapperConfig::getString(const std::string& key, const std::string& fallback) const {
+    auto it = m_values.find(key);
+    return it == m_values.end() ? fallback : it->second;
+}
+
+double WrapperConfig::getDouble(const std::string& key, double fallback) const {
+    auto it = m_values.find(key);
+    if (it == m_values.end()) return fallback;
+    try {
+        return std::stod(it->second);
+    } catch (const std::exception&) {
+        throw std::runtime_error("wrapper.cfg: '" + key + "' is not a number: " + it->second);
+    }
+}
+
+long long WrapperConfig::getInt(const std::string& key, long long fallback) const {
+    auto it = m_values.find(key);
+    if (it == m_values.end()) return fallback;
+    try {
+        return std::stoll(it->second, nullptr, 0);
+    } catch (const std::exception&) {
+        throw std::runtime_error("wrapper.cfg: '" + key + "' is not an integer: " + it->second);
+    }
+}
+
+bool WrapperConfig::getBool(const std::string& key, bool fallback) const {
+    auto it = m_values.find(key);
+    if (it == m_values.end()) return fallback;
+    const std::string& v = it->second;
+    if (v == "1" || v == "true" || v == "on" || v == "yes") return true;
+    if (v == "0" || v == "false" || v == "off" || v == "no") return false;
+    throw std::runtime_error("wrapper.cfg: '" + key + "' is not a boolean: " + v);
+}
@@ -0,0 +1,32 @@
+/**
+ * @file WrapperConfig.hpp
+ * @brief Reads the optional `wrapper.cfg` file shipped in the wrapper FMU's resources.
+ *
+ * The file holds one `key = value` pair per line; blank lines are ignored and a
+ * '#' at the start of a line or after whitespace starts a comment. A missing file
+ * simply yields an empty configuration, so every option falls back to its default.
+ */
+#ifndef WRAPPER_CONFIG_HPP
+#define WRAPPER_CONFIG_HPP
+
+#include <map>
+#include <string>
+
+class WrapperConfig {
+public:
+    WrapperConfig() = default;
+
+    /** @brief Loads `path`; returns an empty configuration if the file does not exist. */
+    static WrapperConfig load(const std::string& path);
+
+    bool has(const std::string& key) const { return m_values.count(key) != 0; }
+    std::string getString(const std::string& key, const std::string& fallback = "") const;
+    double getDouble(const std::string& key, double fallback) const;
+    long long getInt(const std::string& key, long long fallback) const;
+    bool getBool(const std::string& key, bool fallback) const;
+
+private:
+    std::map<std::string, std::string> m_values;
+};
+
+#endif // WRAPPER_CONFIG_HPP
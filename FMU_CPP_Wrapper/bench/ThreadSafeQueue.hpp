@@ -1,6 +1,9 @@
 /**
  * @file ThreadSafeQueue.hpp
  * @brief A generic, thread-safe queue for inter-thread communication.
+ *
+ * No longer used by the wrapper, whose metrics path moved to MetricsBlockChannel; it is
+ * kept next to queue_bench as the baseline that channel is measured against.
  */
 #ifndef THREAD_SAFE_QUEUE_HPP
 #define THREAD_SAFE_QUEUE_HPP
@@ -0,0 +1,420 @@
+/**
+ * @file queue_bench.cpp
+ * @brief Throughput, latency and close() stress benchmark for the wrapper's inter-thread channels.
+ *
+ * Measures ThreadSafeQueue ("tsq") with any number of producers and consumers (SPSC, MPSC,
+ * MPMC) and payload sizes, and MetricsBlockChannel ("block", SPSC only, MetricsData payload)
+ * that replaced it on the metrics path. Every item carries its producer, a sequence number
+ * and a send timestamp; consumers check per-producer order and record the send-to-receive
+ * latency of every --latency-stride-th item. Unpaced runs measure peak throughput, so their
+ * latencies include queueing; use --rate to measure latency at a given load.
+ *
+ * Without --producers/--consumers a default grid of cases is run. --stress-close runs
+ * randomized close() races instead and exits non-zero on a lost, duplicated or reordered
+ * item or a consumer that does not wake up; build it with BUILD_QUEUE_BENCH=1, which also
+ * produces a ThreadSanitizer build (queue_bench_tsan) for this mode.
+ *
+ * Usage: queue_bench [--queue tsq|block] [--producers P] [--consumers C] [--payload 32|64|256|1024|4096]
+ *            [--items N] [--rate items/s per producer] [--latency-stride K] [--block-size B]
+ *            [--flush-interval-ms T] [--csv results.csv] [--stress-close iterations]
+ */
+#include "../MetricsBlockChannel.hpp"
+#include "ThreadSafeQueue.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t nowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count());
+}
+
+struct Options {
+    std::string queue = "tsq";
+    size_t producers = 0; // 0: run the default grid.
+    size_t consumers = 0;
+    size_t payload = 32;
+    uint64_t items = 200000;
+    double rate = 0.0; // Per producer; 0 is unpaced.
+    uint64_t latencyStride = 16;
+    size_t blockSize = 256;
+    uint32_t flushIntervalMs = 0;
+    std::string csv;
+    unsigned stressIterations = 0;
+};
+
+struct Case {
+    std::string queue;
+    size_t producers;
+    size_t consumers;
+    size_t payload;
+};
+
+struct Result {
+    double seconds = 0.0;
+    uint64_t received = 0;
+    uint64_t dropped = 0;
+    std::vector<uint64_t> latencies; // Nanoseconds, sampled.
+};
+
+// An item of the given size; the header is what the benchmark checks, the rest is copied along.
+template <size_t SIZE>
+struct Payload {
+    static_assert(SIZE >= 24, "the payload header is 24 bytes");
+    uint64_t producer;
+    uint64_t sequence;
+    uint64_t sentNs;
+    char padding[SIZE - 24];
+};
+
+// Releases all threads of a case at once, so thread start-up is not measured.
+class StartGate {
+public:
+    void wait() const {
+        while (!m_open.load(std::memory_order_acquire)) std::this_thread::yield();
+    }
+    void open() { m_open.store(true, std::memory_order_release); }
+
+private:
+    std::atomic<bool> m_open{false};
+};
+
+// Spins until the scheduled send time of item i; unpaced if rate is 0.
+void pace(uint64_t startNs, uint64_t i, double rate) {
+    if (rate <= 0.0) return;
+    const uint64_t due = startNs + static_cast<uint64_t>(static_cast<double>(i) * 1e9 / rate);
+    while (nowNs() < due) {}
+}
+
+// Consumer-side order check: sequences of one producer must arrive strictly increasing.
+class OrderCheck {
+public:
+    explicit OrderCheck(size_t producers) : m_next(producers, 0) {}
+
+    void accept(uint64_t producer, uint64_t sequence) {
+        if (producer >= m_next.size() || sequence < m_next[producer]) {
+            throw std::runtime_error("item " + std::to_string(sequence) + " of producer " + std::to_string(producer) + " is duplicated or out of order");
+        }
+        m_next[producer] = sequence + 1;
+    }
+
+private:
+    std::vector<uint64_t> m_next;
+};
+
+template <size_t SIZE>
+Result runQueue(const Case& c, const Options& options) {
+    using Item = Payload<SIZE>;
+    ThreadSafeQueue<Item> queue;
+    StartGate gate;
+    std::vector<std::vector<uint64_t>> latencies(c.consumers);
+    std::vector<uint64_t> received(c.consumers, 0);
+    std::vector<std::string> errors(c.consumers);
+    const uint64_t perProducer = options.items / c.producers;
+
+    std::vector<std::thread> consumers;
+    for (size_t k = 0; k < c.consumers; k++) {
+        consumers.emplace_back([&, k] {
+            OrderCheck order(c.producers);
+            gate.wait();
+            try {
+                while (auto item = queue.pop()) {
+                    const uint64_t now = nowNs();
+                    order.accept(item->producer, item->sequence);
+                    if (received[k]++ % options.latencyStride == 0) latencies[k].push_back(now - item->sentNs);
+                }
+            } catch (const std::exception& e) {
+                errors[k] = e.what();
+            }
+        });
+    }
+    std::vector<std::thread> producers;
+    for (size_t p = 0; p < c.producers; p++) {
+        producers.emplace_back([&, p] {
+            gate.wait();
+            const uint64_t start = nowNs();
+            Item item{};
+            item.producer = p;
+            for (uint64_t i = 0; i < perProducer; i++) {
+                pace(start, i, options.rate);
+                item.sequence = i;
+                item.sentNs = nowNs();
+                queue.push(item);
+            }
+        });
+    }
+
+    const auto start = Clock::now();
+    gate.open();
+    for (std::thread& producer : producers) producer.join();
+    queue.close();
+    for (std::thread& consumer : consumers) consumer.join();
+
+    Result result;
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    for (size_t k = 0; k < c.consumers; k++) {
+        if (!errors[k].empty()) throw std::runtime_error(errors[k]);
+        result.received += received[k];
+        result.latencies.insert(result.latencies.end(), latencies[k].begin(), latencies[k].end());
+    }
+    if (result.received != perProducer * c.producers) throw std::runtime_error("items were lost");
+    return result;
+}
+
+// The block channel carries MetricsData: time holds the send timestamp and u the sequence.
+// Samples age in the block until it is handed off, which is part of the measured latency.
+Result runBlockChannel(const Options& options) {
+    MetricsBlockChannel channel(options.blockSize, false, options.flushIntervalMs);
+    StartGate gate;
+    Result result;
+    std::string error;
+
+    std::thread consumer([&] {
+        OrderCheck order(1);
+        uint64_t seen = 0;
+        gate.wait();
+        try {
+            while (const MetricsBlock* block = channel.pop()) {
+                const uint64_t now = nowNs();
+                result.dropped += block->dropped;
+                for (uint32_t i = 0; i < block->count; i++, seen++) {
+                    const MetricsData sample = block->at(i);
+                    order.accept(0, static_cast<uint64_t>(sample.u));
+                    if (seen % options.latencyStride == 0) result.latencies.push_back(now - static_cast<uint64_t>(sample.time));
+                }
+            }
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        result.received = seen;
+    });
+
+    const auto start = Clock::now();
+    gate.open();
+    const uint64_t startNs = nowNs();
+    for (uint64_t i = 0; i < options.items; i++) {
+        pace(startNs, i, options.rate);
+        channel.push({static_cast<double>(nowNs()), static_cast<double>(i), 0.0, 0.0});
+    }
+    channel.close();
+    consumer.join();
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (!error.empty()) throw std::runtime_error(error);
+    if (result.received + result.dropped != options.items) throw std::runtime_error("items were neither delivered nor counted as dropped");
+    return result;
+}
+
+Result runCase(const Case& c, const Options& options) {
+    if (c.queue == "block") {
+        if (c.producers != 1 || c.consumers != 1) throw std::runtime_error("the block channel is single-producer, single-consumer");
+        return runBlockChannel(options);
+    }
+    if (c.queue != "tsq") throw std::runtime_error("unknown queue '" + c.queue + "'");
+    switch (c.payload) {
+        case 32: return runQueue<32>(c, options);
+        case 64: return runQueue<64>(c, options);
+        case 256: return runQueue<256>(c, options);
+        case 1024: return runQueue<1024>(c, options);
+        case 4096: return runQueue<4096>(c, options);
+        default: throw std::runtime_error("unsupported payload size " + std::to_string(c.payload));
+    }
+}
+
+uint64_t percentile(const std::vector<uint64_t>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * static_cast<double>(sorted.size())))];
+}
+
+const char* shape(const Case& c) {
+    if (c.producers == 1 && c.consumers == 1) return "spsc";
+    return c.consumers == 1 ? "mpsc" : "mpmc";
+}
+
+void report(const Case& c, Result& result, FILE* csv) {
+    std::sort(result.latencies.begin(), result.latencies.end());
+    const double mops = static_cast<double>(result.received) / result.seconds / 1e6;
+    const uint64_t p50 = percentile(result.latencies, 0.50), p99 = percentile(result.latencies, 0.99);
+    const uint64_t p999 = percentile(result.latencies, 0.999), max = result.latencies.empty() ? 0 : result.latencies.back();
+    std::printf("%-6s %-5s %3zu %3zu %7zu %10llu %9.3f %10llu %10llu %10llu %12llu %9llu\n", c.queue.c_str(), shape(c), c.producers, c.consumers,
+                c.payload, static_cast<unsigned long long>(result.received), mops, static_cast<unsigned long long>(p50),
+                static_cast<unsigned long long>(p99), static_cast<unsigned long long>(p999), static_cast<unsigned long long>(max),
+                static_cast<unsigned long long>(result.dropped));
+    std::fflush(stdout);
+    if (csv) {
+        std::fprintf(csv, "%s,%s,%zu,%zu,%zu,%llu,%.6f,%llu,%llu,%llu,%llu,%llu\n", c.queue.c_str(), shape(c), c.producers, c.consumers, c.payload,
+                     static_cast<unsigned long long>(result.received), mops, static_cast<unsigned long long>(p50), static_cast<unsigned long long>(p99),
+                     static_cast<unsigned long long>(p999), static_cast<unsigned long long>(max), static_cast<unsigned long long>(result.dropped));
+    }
+}
+
+// --- close() stress ---
+
+// Fails the run if the consumers have not all returned from pop() within a few seconds.
+void awaitConsumers(const std::atomic<size_t>& exited, size_t consumers, const char* scenario) {
+    const auto deadline = Clock::now() + std::chrono::seconds(5);
+    while (exited.load() < consumers) {
+        if (Clock::now() > deadline) {
+            std::fprintf(stderr, "%s: a consumer did not wake up after close()\n", scenario);
+            std::exit(1);
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+// One close() race on a ThreadSafeQueue. Scenarios:
+//   0: producers finish, then close: every item must be received.
+//   1: close while producers are still pushing: nothing duplicated or reordered, consumers exit.
+//   2: close while all consumers are blocked on an empty queue: all of them wake up.
+void stressQueueClose(std::mt19937& random, int scenario) {
+    const size_t producers = 1 + random() % 4, consumers = 1 + random() % 4;
+    ThreadSafeQueue<Payload<32>> queue;
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> exited{0};
+    std::atomic<uint64_t> pushed{0}, received{0};
+    std::atomic<bool> failed{false};
+
+    std::vector<std::thread> threads;
+    for (size_t k = 0; k < consumers; k++) {
+        threads.emplace_back([&] {
+            OrderCheck order(producers);
+            try {
+                while (auto item = queue.pop()) {
+                    order.accept(item->producer, item->sequence);
+                    received++;
+                }
+            } catch (const std::exception& e) {
+                std::fprintf(stderr, "close race: %s\n", e.what());
+                failed = true;
+            }
+            exited++;
+        });
+    }
+    const uint64_t limit = scenario == 2 ? 0 : 1 + random() % 20000;
+    for (size_t p = 0; p < producers; p++) {
+        threads.emplace_back([&, p] {
+            Payload<32> item{};
+            item.producer = p;
+            for (uint64_t i = 0; i < limit && !stop.load(std::memory_order_relaxed); i++) {
+                item.sequence = i;
+                queue.push(item);
+                pushed++;
+            }
+        });
+    }
+
+    if (scenario == 0) {
+        for (size_t p = 0; p < producers; p++) threads[consumers + p].join();
+        queue.close();
+    } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(random() % 200));
+        queue.close();
+        stop = true;
+        for (size_t p = 0; p < producers; p++) threads[consumers + p].join();
+    }
+    awaitConsumers(exited, consumers, "tsq");
+    for (size_t k = 0; k < consumers; k++) threads[k].join();
+
+    // Pushes that land after close() may stay queued once the consumers have left.
+    if (failed || received > pushed || (scenario == 0 && received != pushed)) {
+        std::fprintf(stderr, "tsq close scenario %d: pushed %llu, received %llu\n", scenario,
+                     static_cast<unsigned long long>(pushed.load()), static_cast<unsigned long long>(received.load()));
+        std::exit(1);
+    }
+}
+
+// The block channel is closed by its producer; every sample must be delivered or counted
+// as dropped, even when close() races the consumer's wake-up.
+void stressBlockClose(std::mt19937& random) {
+    Options options;
+    options.items = random() % 5000;
+    options.blockSize = 1 + random() % 300;
+    options.flushIntervalMs = random() % 2; // Also race flush requests against the hand-offs.
+    options.latencyStride = 1000000;
+    runBlockChannel(options);
+}
+
+int runStress(unsigned iterations) {
+    std::mt19937 random(12345);
+    for (unsigned i = 0; i < iterations; i++) {
+        stressQueueClose(random, static_cast<int>(i % 3));
+        stressBlockClose(random);
+    }
+    std::printf("close() stress: %u iterations passed\n", iterations);
+    return 0;
+}
+
+Options parseOptions(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        auto value = [&]() -> const char* {
+            if (i + 1 >= argc) throw std::runtime_error("missing value for " + arg);
+            return argv[++i];
+        };
+        if (arg == "--queue") options.queue = value();
+        else if (arg == "--producers") options.producers = std::strtoul(value(), nullptr, 10);
+        else if (arg == "--consumers") options.consumers = std::strtoul(value(), nullptr, 10);
+        else if (arg == "--payload") options.payload = std::strtoul(value(), nullptr, 10);
+        else if (arg == "--items") options.items = std::strtoull(value(), nullptr, 10);
+        else if (arg == "--rate") options.rate = std::atof(value());
+        else if (arg == "--latency-stride") options.latencyStride = std::max<uint64_t>(1, std::strtoull(value(), nullptr, 10));
+        else if (arg == "--block-size") options.blockSize = std::strtoul(value(), nullptr, 10);
+        else if (arg == "--flush-interval-ms") options.flushIntervalMs = static_cast<uint32_t>(std::strtoul(value(), nullptr, 10));
+        else if (arg == "--csv") options.csv = value();
+        else if (arg == "--stress-close") options.stressIterations = static_cast<unsigned>(std::strtoul(value(), nullptr, 10));
+        else throw std::runtime_error("unknown option " + arg + "; see queue_bench.cpp");
+    }
+    return options;
+}
+
+std::vector<Case> cases(const Options& options) {
+    if (options.producers || options.consumers) {
+        return {{options.queue, std::max<size_t>(1, options.producers), std::max<size_t>(1, options.consumers), options.queue == "block" ? sizeof(MetricsData) : options.payload}};
+    }
+    std::vector<Case> grid;
+    for (size_t payload : {32, 256, 1024}) {
+        for (const auto& shape : std::vector<std::pair<size_t, size_t>>{{1, 1}, {2, 1}, {4, 1}, {2, 2}, {4, 4}}) {
+            grid.push_back({"tsq", shape.first, shape.second, payload});
+        }
+    }
+    grid.push_back({"block", 1, 1, sizeof(MetricsData)});
+    return grid;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        const Options options = parseOptions(argc, argv);
+        if (options.stressIterations) return runStress(options.stressIterations);
+
+        FILE* csv = nullptr;
+        if (!options.csv.empty()) {
+            csv = std::fopen(options.csv.c_str(), "w");
+            if (!csv) throw std::runtime_error("cannot write " + options.csv);
+            std::fprintf(csv, "queue,shape,producers,consumers,payload,items,mops,p50_ns,p99_ns,p999_ns,max_ns,dropped\n");
+        }
+        std::printf("%-6s %-5s %3s %3s %7s %10s %9s %10s %10s %10s %12s %9s\n", "queue", "shape", "P", "C", "payload", "items",
+                    "Mitems/s", "p50 ns", "p99 ns", "p99.9 ns", "max ns", "dropped");
+        for (const Case& c : cases(options)) {
+            Result result = runCase(c, options);
+            report(c, result, csv);
+        }
+        if (csv) std::fclose(csv);
+        return 0;
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "queue_bench: %s\n", e.what());
+        return 1;
+    }
+}
@@ -3,7 +3,23 @@
 set -e
 
 FMU_NAME="Amplifier_CPP_Wrapper"
-WRAPPER_CPP_SOURCES="fmi_adapter.cpp FaultWrapper.cpp"
+WRAPPER_CPP_SOURCES="fmi_adapter.cpp FaultWrapper.cpp BitFaults.cpp SignalGenerator.cpp WrapperConfig.cpp FaultPluginHost.cpp TelemetrySegment.cpp StepWatchdog.cpp MetricsBlockChannel.cpp InnerLibraryPool.cpp"
+WRAPPER_CONFIG="wrapper.cfg"
+EXPORT_MAP="fault_wrapper.map"
+METRICS_EXPORTER_SOURCES="metrics_exporter.cpp TemplateExposition.cpp PushExporter.cpp"
+BUILD_METRICS_EXPORTER="${BUILD_METRICS_EXPORTER:-1}"
+# Set to 1 to also build the shared-memory telemetry reader library and the telemetry_tail tool.
+BUILD_TELEMETRY_READER="${BUILD_TELEMETRY_READER:-0}"
+# Set to 1 to also build the queue benchmark (queue_bench) and its ThreadSanitizer build for --stress-close.
+BUILD_QUEUE_BENCH="${BUILD_QUEUE_BENCH:-0}"
+# Set to 1 to compile a trusted inner model shipped with the wrapper (its C sources) into the
+# wrapper itself. Its fmi2* functions get the innerModel_ prefix, doStep calls them directly and
+# -flto can inline them; the unpacked inner FMU binary is then unused.
+STATIC_INNER_MODEL="${STATIC_INNER_MODEL:-0}"
+STATIC_INNER_SOURCES="${STATIC_INNER_SOURCES:-../Amplifier_files/model.c}"
+# Fault-model plugin sources to ship in resources/plugins (see fault_plugin.h), e.g.
+# FAULT_PLUGINS="plugins/gaussian_noise_plugin.c"
+FAULT_PLUGINS="${FAULT_PLUGINS:-}"
 WRAPPER_XML="modelDescription.xml"
 ORIGINAL_FMU="../Amplifier.fmu"
 
@@ -39,17 +55,78 @@ fi
 
 mkdir -p "${BUILD_DIR}/binaries/${PLATFORM_DIR}"
 
+# Regenerate the variable bindings from the model description; without Python the committed header is used.
+if command -v python3 >/dev/null 2>&1; then
+    python3 ../generate_model_bindings.py "${WRAPPER_XML}" ModelBindings.hpp
+fi
+
 echo "Compiling for platform: ${PLATFORM_DIR}"
-# Add linker flags for prometheus-cpp and pthreads
-# The user must have prometheus-cpp installed for this to work.
-PROMETHEUS_FLAGS="-lprometheus-cpp-core -lprometheus-cpp-pull"
 PTHREAD_FLAGS="-lpthread"
-g++ -shared -fPIC -std=c++17 -I"../Amplifier_files/headers" ${WRAPPER_CPP_SOURCES} -o "${BUILD_DIR}/binaries/${PLATFORM_DIR}/fault_wrapper${SHARED_LIB_EXT}" ${PROMETHEUS_FLAGS} ${PTHREAD_FLAGS}
+# shm_open lives in librt on older glibc; --as-needed drops it where it is not needed.
+RT_FLAGS=""
+if [[ "${PLATFORM_DIR}" == "linux64" ]]; then
+    RT_FLAGS="-lrt"
+fi
+# The core wrapper is built with hidden visibility; on Linux an export map also keeps
+# everything except the fmi2* API out of the dynamic symbol table.
+VISIBILITY_FLAGS="-fvisibility=hidden -fvisibility-inlines-hidden"
+if [[ "${PLATFORM_DIR}" == "linux64" ]]; then
+    VISIBILITY_FLAGS="${VISIBILITY_FLAGS} -Wl,--version-script=${EXPORT_MAP} -Wl,--as-needed"
+fi
+STATIC_INNER_FLAGS=""
+STATIC_INNER_OBJECTS=""
+if [[ "${STATIC_INNER_MODEL}" == "1" ]]; then
+    echo "Compiling the inner model into the wrapper: ${STATIC_INNER_SOURCES}"
+    # Objects go next to, not into, the build directory, which becomes the FMU.
+    mkdir -p "${BUILD_DIR}_inner"
+    for INNER_SOURCE in ${STATIC_INNER_SOURCES}; do
+        INNER_OBJECT="${BUILD_DIR}_inner/$(basename "${INNER_SOURCE%.*}").o"
+        gcc -c -fPIC -O2 -flto -fvisibility=hidden -DFMI2_FUNCTION_PREFIX=innerModel_ "${INNER_SOURCE}" -o "${INNER_OBJECT}"
+        STATIC_INNER_OBJECTS="${STATIC_INNER_OBJECTS} ${INNER_OBJECT}"
+    done
+    STATIC_INNER_FLAGS="-DFAULT_WRAPPER_STATIC_INNER -flto"
+fi
+g++ -shared -fPIC -std=c++17 -O2 ${VISIBILITY_FLAGS} ${STATIC_INNER_FLAGS} -I"../Amplifier_files/headers" ${WRAPPER_CPP_SOURCES} ${STATIC_INNER_OBJECTS} -o "${BUILD_DIR}/binaries/${PLATFORM_DIR}/fault_wrapper${SHARED_LIB_EXT}" ${PTHREAD_FLAGS} ${RT_FLAGS}
+rm -rf "${BUILD_DIR}_inner"
+
+# The Prometheus exporter is a separate library in resources, loaded only when metrics are enabled.
+# The user must have prometheus-cpp installed for this to work; set BUILD_METRICS_EXPORTER=0 to skip it.
+if [[ "${BUILD_METRICS_EXPORTER}" == "1" ]]; then
+    echo "Compiling metrics exporter"
+    PROMETHEUS_FLAGS="-lprometheus-cpp-core -lprometheus-cpp-pull"
+    # Push batches are zstd-compressed when libzstd is available (METRICS_PUSH_ZSTD=0 to disable).
+    PUSH_FLAGS=""
+    if [[ "${METRICS_PUSH_ZSTD:-1}" == "1" ]] && echo '#include <zstd.h>' | g++ -E -x c++ - >/dev/null 2>&1; then
+        PUSH_FLAGS="-DMETRICS_PUSH_ZSTD -lzstd"
+    fi
+    g++ -shared -fPIC -std=c++17 -O2 -fvisibility=hidden ${METRICS_EXPORTER_SOURCES} -o "${BUILD_DIR}/resources/metrics_exporter${SHARED_LIB_EXT}" ${PROMETHEUS_FLAGS} ${PUSH_FLAGS} ${PTHREAD_FLAGS}
+fi
+for PLUGIN_SOURCE in ${FAULT_PLUGINS}; do
+    mkdir -p "${BUILD_DIR}/resources/plugins"
+    PLUGIN_NAME="$(basename "${PLUGIN_SOURCE%.*}")"
+    echo "Compiling fault plugin: ${PLUGIN_NAME}"
+    gcc -shared -fPIC -O2 "${PLUGIN_SOURCE}" -o "${BUILD_DIR}/resources/plugins/${PLUGIN_NAME}${SHARED_LIB_EXT}" -lm
+done
+if [[ "${BUILD_TELEMETRY_READER}" == "1" && "${PLATFORM_DIR}" != "win64" ]]; then
+    echo "Compiling telemetry reader"
+    gcc -shared -fPIC -O2 telemetry/telemetry_reader.c -o "../libtelemetry_reader${SHARED_LIB_EXT}" ${RT_FLAGS}
+    gcc -O2 telemetry/telemetry_tail.c telemetry/telemetry_reader.c -o "../telemetry_tail" ${RT_FLAGS}
+fi
+if [[ "${BUILD_QUEUE_BENCH}" == "1" ]]; then
+    echo "Compiling queue benchmark"
+    g++ -std=c++17 -O2 bench/queue_bench.cpp MetricsBlockChannel.cpp -o "../queue_bench" ${PTHREAD_FLAGS}
+    g++ -std=c++17 -O1 -g -fsanitize=thread bench/queue_bench.cpp MetricsBlockChannel.cpp -o "../queue_bench_tsan" ${PTHREAD_FLAGS}
+fi
 echo "Compilation successful."
 
 # 4. Copy wrapper modelDescription.xml
 cp "${WRAPPER_XML}" "${BUILD_DIR}/"
 
+# 4b. Copy the optional wrapper configuration into the resources directory
+if [ -f "${WRAPPER_CONFIG}" ]; then
+    cp "${WRAPPER_CONFIG}" "${BUILD_DIR}/resources/"
+fi
+
 # 5. Unpack the original FMU into the resources directory
 echo "Unpacking original FMU into resources..."
 unzip -q "${ORIGINAL_FMU}" -d "${BUILD_DIR}/resources/Amplifier"
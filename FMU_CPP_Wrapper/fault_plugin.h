@@ -0,0 +1,83 @@
+/**
+ * @file fault_plugin.h
+ * @brief Stable C ABI for fault-model plugins loaded by the C++ wrapper FMU.
+ *
+ * A plugin is a shared library placed in the wrapper FMU's `resources/plugins/`
+ * directory. At instantiate time the wrapper loads every library found there and
+ * calls its `fault_plugin_get_api` entry point once; the returned function pointers
+ * are copied into the wrapper's dispatch table and called directly afterwards.
+ *
+ * Compatibility rules: the host passes the ABI version it implements and the plugin
+ * returns NULL if it cannot serve it. New members are only ever appended to the end
+ * of the structs, and `struct_size` tells the other side how much of them exists.
+ */
+#ifndef FAULT_PLUGIN_H
+#define FAULT_PLUGIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FAULT_PLUGIN_ABI_VERSION 1u
+#define FAULT_PLUGIN_ENTRY "fault_plugin_get_api"
+
+#if defined(_WIN32)
+#define FAULT_PLUGIN_EXPORT __declspec(dllexport)
+#else
+#define FAULT_PLUGIN_EXPORT __attribute__((visibility("default")))
+#endif
+
+/* Status codes returned by plugin functions. */
+#define FAULT_PLUGIN_OK 0
+#define FAULT_PLUGIN_ERROR 1
+
+/* Information the host hands to a plugin instance. Valid only during init(). */
+typedef struct FaultPluginContext {
+    uint32_t struct_size;
+    const char* instance_name;   /* Name of the wrapper FMU instance. */
+    const char* resource_path;   /* Filesystem path of the wrapper's resources directory. */
+    /* Looks up `plugin.<plugin name>.<key>` in wrapper.cfg; returns NULL if unset. */
+    const char* (*get_option)(void* host, const char* key);
+    /* Forwards a message to the FMI logger. status uses the fmi2Status values. */
+    void (*log)(void* host, int status, const char* message);
+    void* host;
+} FaultPluginContext;
+
+/* The function table a plugin exposes. Every member except name, init and apply_batch may be NULL. */
+typedef struct FaultPluginApi {
+    uint32_t abi_version;        /* FAULT_PLUGIN_ABI_VERSION the plugin was built against. */
+    uint32_t struct_size;        /* sizeof(FaultPluginApi) on the plugin side. */
+    const char* name;            /* Short identifier, used for option lookup and logging. */
+
+    /* Creates per-instance state; returns NULL on failure. */
+    void* (*init)(const FaultPluginContext* ctx);
+    void (*destroy)(void* state);
+
+    /*
+     * Applies the fault model in place to n consecutive samples of the variable `vr`.
+     * times[i] is the simulation time of values[i]. Called once per step with n == 1
+     * for host-driven inputs, or once per generated block for native signal sources.
+     */
+    int (*apply_batch)(void* state, uint32_t vr, double* values, const double* times, size_t n);
+
+    /*
+     * State support: size of the serialized state, then save/restore into that many bytes.
+     * The host checkpoints the state before each block of a native signal source and
+     * restores it when the block is replaced before all its samples were used. A plugin
+     * without these functions must be stateless, or its state runs ahead by those samples.
+     */
+    size_t (*state_size)(void* state);
+    int (*save_state)(void* state, void* buffer, size_t size);
+    int (*restore_state)(void* state, const void* buffer, size_t size);
+} FaultPluginApi;
+
+typedef const FaultPluginApi* (*FaultPluginGetApiFn)(uint32_t host_abi_version);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FAULT_PLUGIN_H */
@@ -0,0 +1,38 @@
+/**
+ * @file fault_wrapper_snapshot.h
+ * @brief Lock-free read access to a running wrapper instance's latest outputs.
+ *
+ * Besides the FMI 2.0 API the wrapper exports `fault_wrapper_read_snapshot`, which a
+ * monitoring thread of the simulator may call at any time, also while another thread
+ * is inside fmi2DoStep on the same instance. It never blocks the stepping thread; the
+ * instance must not be freed while the call runs. Resolve it with dlsym/GetProcAddress
+ * on the wrapper binary.
+ */
+#ifndef FAULT_WRAPPER_SNAPSHOT_H
+#define FAULT_WRAPPER_SNAPSHOT_H
+
+#include <stdint.h>
+
+#include "fmi2Functions.h"
+#include "metrics_exporter.h" /* MetricsData: time, u, y, k */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FAULT_WRAPPER_SNAPSHOT_ENTRY "fault_wrapper_read_snapshot"
+
+/*
+ * Copies (time, u, y, k) of the last completed step into *out; `time` is the step's start.
+ * Returns the number of completed steps the copy belongs to, 0 if no step has completed
+ * yet (*out untouched), or UINT64_MAX if the copy kept overlapping with steps.
+ */
+typedef uint64_t (*FaultWrapperReadSnapshotFn)(fmi2Component c, MetricsData* out);
+
+FMI2_Export uint64_t fault_wrapper_read_snapshot(fmi2Component c, MetricsData* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FAULT_WRAPPER_SNAPSHOT_H */
@@ -6,6 +6,7 @@
  * from the simulation environment into method calls on an instance of the C++ FaultWrapper class.
  */
 #include "FaultWrapper.hpp"
+#include "fault_wrapper_snapshot.h"
 
 // The FMI standard requires a C interface, so all functions must be declared `extern "C"`.
 extern "C" {
@@ -22,20 +23,27 @@ static inline FaultWrapper* to_wrapper(fmi2Component c) {
  *
  * It allocates memory using the simulator's provided callbacks and uses "placement new"
  * to construct a FaultWrapper object in that memory. This ensures the simulator manages
- * the memory lifecycle.
+ * the memory lifecycle. FaultWrapper has cache-line aligned members, which the simulator's
+ * allocator does not guarantee, so the block is over-allocated and aligned by hand; the
+ * original pointer is kept in front of the object for fmi2FreeInstance.
  */
 FMI2_Export fmi2Component fmi2Instantiate(fmi2String i, fmi2Type t, fmi2String g, fmi2String r, const fmi2CallbackFunctions* f, fmi2Boolean v, fmi2Boolean l) {
     if (!f || !f->logger || !f->allocateMemory) return nullptr;
+    void* block = nullptr;
     try {
         // Allocate memory using the simulator's allocator.
-        void* mem = f->allocateMemory(1, sizeof(FaultWrapper));
-        if (!mem) {
+        block = f->allocateMemory(1, sizeof(void*) + alignof(FaultWrapper) + sizeof(FaultWrapper));
+        if (!block) {
             f->logger(nullptr, i, fmi2Fatal, "error", "Failed to allocate memory for wrapper instance.");
             return nullptr;
         }
+        const uintptr_t first = reinterpret_cast<uintptr_t>(block) + sizeof(void*);
+        void* mem = reinterpret_cast<void*>((first + alignof(FaultWrapper) - 1) & ~(uintptr_t{alignof(FaultWrapper)} - 1));
+        static_cast<void**>(mem)[-1] = block;
         // Construct the object in the allocated memory (placement new).
         return new (mem) FaultWrapper(i, r, f, v, l);
     } catch (const std::exception& e) {
+        if (block && f->freeMemory) f->freeMemory(block);
         f->logger(nullptr, i, fmi2Fatal, "error", e.what());
         return nullptr;
     }
@@ -51,19 +59,31 @@ FMI2_Export void fmi2FreeInstance(fmi2Component c) {
     if (!c) return;
     FaultWrapper* wrapper = to_wrapper(c);
     const fmi2CallbackFunctions* callbacks = wrapper->getCallbacks();
+    void* block = reinterpret_cast<void**>(wrapper)[-1];
     wrapper->~FaultWrapper(); // Explicitly call the destructor.
-    callbacks->freeMemory(wrapper);
+    callbacks->freeMemory(block);
 }
 
 // --- Simple Delegation Functions ---
 FMI2_Export fmi2Status fmi2GetReal(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Real v[]) { return to_wrapper(c)->getReal(vr, nvr, v); }
 FMI2_Export fmi2Status fmi2SetReal(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Real v[]) { return to_wrapper(c)->setReal(vr, nvr, v); }
+FMI2_Export fmi2Status fmi2GetInteger(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Integer v[]) { return to_wrapper(c)->getInteger(vr, nvr, v); }
+FMI2_Export fmi2Status fmi2SetInteger(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Integer v[]) { return to_wrapper(c)->setInteger(vr, nvr, v); }
+FMI2_Export fmi2Status fmi2GetBoolean(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Boolean v[]) { return to_wrapper(c)->getBoolean(vr, nvr, v); }
+FMI2_Export fmi2Status fmi2SetBoolean(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Boolean v[]) { return to_wrapper(c)->setBoolean(vr, nvr, v); }
 FMI2_Export fmi2Status fmi2SetupExperiment(fmi2Component c, fmi2Boolean td, fmi2Real t, fmi2Real st, fmi2Boolean spd, fmi2Real sp) { return to_wrapper(c)->setupExperiment(td, t, st, spd, sp); }
 FMI2_Export fmi2Status fmi2EnterInitializationMode(fmi2Component c) { return to_wrapper(c)->enterInitializationMode(); }
 FMI2_Export fmi2Status fmi2ExitInitializationMode(fmi2Component c) { return to_wrapper(c)->exitInitializationMode(); }
 FMI2_Export fmi2Status fmi2DoStep(fmi2Component c, fmi2Real cp, fmi2Real cs, fmi2Boolean ns) { return to_wrapper(c)->doStep(cp, cs, ns); }
 FMI2_Export fmi2Status fmi2Terminate(fmi2Component c) { return to_wrapper(c)->terminate(); }
 
+// --- Extensions (see fault_wrapper_snapshot.h) ---
+// Safe to call from any thread while the instance steps.
+FMI2_Export uint64_t fault_wrapper_read_snapshot(fmi2Component c, MetricsData* out) {
+    if (!c || !out) return 0;
+    return to_wrapper(c)->readSnapshot(*out);
+}
+
 // --- Stub Functions for Unused FMI 2.0 API Calls ---
 // These functions are required to be present by the FMI standard, but are not
 // needed for this specific wrapper. They simply return an appropriate status
@@ -72,10 +92,6 @@ FMI2_Export const char* fmi2GetTypesPlatform(void) { return fmi2TypesPlatform; }
 FMI2_Export const char* fmi2GetVersion(void) { return fmi2Version; }
 FMI2_Export fmi2Status fmi2SetDebugLogging(fmi2Component c, fmi2Boolean l, size_t n, const fmi2String cat[]) { return fmi2OK; }
 FMI2_Export fmi2Status fmi2Reset(fmi2Component c) { return fmi2Error; }
-FMI2_Export fmi2Status fmi2GetInteger(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Integer v[]) { return fmi2Error; }
-FMI2_Export fmi2Status fmi2SetInteger(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Integer v[]) { return fmi2Error; }
-FMI2_Export fmi2Status fmi2GetBoolean(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Boolean v[]) { return fmi2Error; }
-FMI2_Export fmi2Status fmi2SetBoolean(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Boolean v[]) { return fmi2Error; }
 FMI2_Export fmi2Status fmi2GetString(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2String v[]) { return fmi2Error; }
 FMI2_Export fmi2Status fmi2SetString(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2String v[]) { return fmi2Error; }
 FMI2_Export fmi2Status fmi2GetFMUstate(fmi2Component c, fmi2FMUstate* s) { return fmi2Error; }
@@ -0,0 +1,177 @@
+/**
+ * @file metrics_exporter.cpp
+ * @brief Implementation of the metrics exporter interface (metrics_exporter.h).
+ *
+ * Built as a separate shared library. All wrapper instances in a process that use the
+ * same bind address share one endpoint; each instance contributes series labelled
+ * with its instance name. Three endpoint types exist: the prometheus-cpp registry,
+ * the allocation-free TemplateExposition, and the PushExporter for short-lived jobs.
+ */
+#include "metrics_exporter.h"
+#include "MetricsEndpoint.hpp"
+#include "PushExporter.hpp"
+#include "TemplateExposition.hpp"
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Prometheus C++ client library headers
+#include <prometheus/exposer.h>
+#include <prometheus/registry.h>
+#include <prometheus/gauge.h>
+
+namespace {
+
+// Serves the series through prometheus-cpp, which collects and serializes on every scrape.
+class PrometheusEndpoint : public MetricsEndpoint {
+public:
+    explicit PrometheusEndpoint(const std::string& address)
+        : m_exposer(address), m_registry(std::make_shared<prometheus::Registry>()) {
+        m_exposer.RegisterCollectable(m_registry);
+        // A Gauge is a metric that represents a single numerical value that can arbitrarily go up and down.
+        for (size_t i = 0; i < METRIC_FAMILY_COUNT; i++) {
+            m_families[i] = &prometheus::BuildGauge().Name(METRIC_FAMILIES[i].name).Help(METRIC_FAMILIES[i].help).Register(*m_registry);
+        }
+    }
+
+    void* add(const MetricsAttachOptions& options) override {
+        // We add a constant label "instance" to all metrics to identify which FMU they belong to.
+        const std::map<std::string, std::string> labels = {{"instance", options.instance_name}};
+        auto* series = new Series;
+        for (size_t i = 0; i < METRIC_FAMILY_COUNT; i++) series->gauges[i] = &m_families[i]->Add(labels);
+        return series;
+    }
+
+    // Gauges are atomic, so publishing needs no lock.
+    void publish(void* handle, const MetricsData& data) override {
+        auto* series = static_cast<Series*>(handle);
+        for (size_t i = 0; i < METRIC_FAMILY_COUNT; i++) series->gauges[i]->Set(metricValue(data, i));
+    }
+
+    void remove(void* handle) override {
+        auto* series = static_cast<Series*>(handle);
+        for (size_t i = 0; i < METRIC_FAMILY_COUNT; i++) m_families[i]->Remove(series->gauges[i]);
+        delete series;
+    }
+
+private:
+    struct Series {
+        prometheus::Gauge* gauges[METRIC_FAMILY_COUNT];
+    };
+    prometheus::Exposer m_exposer;
+    std::shared_ptr<prometheus::Registry> m_registry;
+    prometheus::Family<prometheus::Gauge>* m_families[METRIC_FAMILY_COUNT] = {};
+};
+
+struct Endpoint {
+    std::unique_ptr<MetricsEndpoint> impl;
+    std::string exposition;
+    size_t instances = 0;
+};
+
+struct Instance {
+    std::string address;
+    Endpoint* endpoint;
+    void* series;
+};
+
+std::mutex g_mutex;
+std::map<std::string, Endpoint> g_endpoints;
+
+// True if the caller's options struct is large enough to contain `member`.
+#define HAS_OPTION(options, member) \
+    ((options)->struct_size >= offsetof(MetricsAttachOptions, member) + sizeof((options)->member))
+
+PushSettings pushSettings(const MetricsAttachOptions* options) {
+    PushSettings settings;
+    if (!HAS_OPTION(options, spool_max_bytes) || !options->push_url || !*options->push_url) {
+        throw std::runtime_error("push mode requires a push URL");
+    }
+    settings.url = options->push_url;
+    settings.intervalMs = options->push_interval_ms;
+    settings.retries = options->push_retries;
+    if (options->push_compression) settings.compression = options->push_compression;
+    if (options->spool_dir) settings.spoolDir = options->spool_dir;
+    if (options->spool_max_bytes) settings.spoolMaxBytes = options->spool_max_bytes;
+    return settings;
+}
+
+void* attach(const MetricsAttachOptions* options) {
+    const std::string exposition = options->exposition ? options->exposition : "prometheus";
+    // Push endpoints are shared per receiver URL, the others per bind address.
+    const bool push = exposition == "push";
+    const std::string address = push ? "push " + std::string(HAS_OPTION(options, push_url) && options->push_url ? options->push_url : "")
+                                     : options->bind_address;
+    auto log = [options](int status, const std::string& message) {
+        if (options->log) options->log(options->log_ctx, status, message.c_str());
+    };
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    try {
+        Endpoint& endpoint = g_endpoints[address];
+        if (!endpoint.impl) {
+            if (exposition == "template") endpoint.impl = std::make_unique<TemplateExposition>(address);
+            else if (exposition == "prometheus") endpoint.impl = std::make_unique<PrometheusEndpoint>(address);
+            else if (push) endpoint.impl = std::make_unique<PushExporter>(pushSettings(options));
+            else throw std::runtime_error("unknown exposition '" + exposition + "'");
+            endpoint.exposition = exposition;
+            log(0, push ? "Pushing metrics to " + std::string(options->push_url)
+                        : "Metrics server (" + exposition + ") started on http://" + address + "/metrics");
+        } else if (endpoint.exposition != exposition) {
+            throw std::runtime_error(address + " already serves the '" + endpoint.exposition + "' exposition");
+        }
+        auto* instance = new Instance{address, &endpoint, endpoint.impl->add(*options)};
+        endpoint.instances++;
+        return instance;
+    } catch (const std::exception& e) {
+        if (!g_endpoints[address].impl) g_endpoints.erase(address);
+        log(4 /* fmi2Fatal */, std::string("Failed to start metrics exporter: ") + e.what());
+        return nullptr;
+    }
+}
+
+void publish(void* handle, const MetricsData* data) {
+    auto* instance = static_cast<Instance*>(handle);
+    instance->endpoint->impl->publish(instance->series, *data);
+}
+
+void publishSamples(void* handle, const MetricsData* samples, uint32_t count, int64_t startMs, int64_t endMs) {
+    auto* instance = static_cast<Instance*>(handle);
+    instance->endpoint->impl->publishSamples(instance->series, samples, count, startMs, endMs);
+}
+
+void detach(void* handle) {
+    auto* instance = static_cast<Instance*>(handle);
+    std::unique_ptr<MetricsEndpoint> last;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        Endpoint* endpoint = instance->endpoint;
+        endpoint->impl->remove(instance->series);
+        if (--endpoint->instances == 0) {
+            last = std::move(endpoint->impl);
+            g_endpoints.erase(instance->address);
+        }
+    }
+    delete instance;
+    // Shut the endpoint down without the lock: a push endpoint delivers its final batch
+    // (retries and backoff included) here, which must not stall the other instances.
+    last.reset();
+}
+
+const MetricsExporterApi API = {
+    METRICS_EXPORTER_ABI_VERSION,
+    sizeof(MetricsExporterApi),
+    attach,
+    publish,
+    detach,
+    publishSamples,
+};
+
+} // namespace
+
+extern "C" METRICS_EXPORTER_EXPORT const MetricsExporterApi* metrics_exporter_get_api(uint32_t hostAbiVersion) {
+    return hostAbiVersion == METRICS_EXPORTER_ABI_VERSION ? &API : nullptr;
+}
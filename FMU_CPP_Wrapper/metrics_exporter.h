@@ -0,0 +1,98 @@
+/**
+ * @file metrics_exporter.h
+ * @brief C interface between the core wrapper and the optional metrics exporter library.
+ *
+ * The exporter (and with it prometheus-cpp and civetweb) lives in its own shared
+ * library that the wrapper only loads when `metrics.enabled` is set, so batch runs
+ * without metrics never map or relocate those dependencies.
+ */
+#ifndef METRICS_EXPORTER_H
+#define METRICS_EXPORTER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define METRICS_EXPORTER_ABI_VERSION 3u
+#define METRICS_EXPORTER_ENTRY "metrics_exporter_get_api"
+
+#if defined(_WIN32)
+#define METRICS_EXPORTER_EXPORT __declspec(dllexport)
+#else
+#define METRICS_EXPORTER_EXPORT __attribute__((visibility("default")))
+#endif
+
+/* One sample of the wrapper's variables, as sent from the step thread to the exporter. */
+typedef struct MetricsData {
+    double time;
+    double u;
+    double y;
+    double k;
+} MetricsData;
+
+/* Logging callback; status uses the fmi2Status values. */
+typedef void (*MetricsLogFn)(void* ctx, int status, const char* message);
+
+/* Per-instance exporter settings; new members are only appended and guarded by struct_size. */
+typedef struct MetricsAttachOptions {
+    uint32_t struct_size;
+    const char* instance_name;
+    const char* bind_address;  /* e.g. "127.0.0.1:8080" */
+    /*
+     * How scrapes are served: "prometheus" uses prometheus-cpp's registry and serializer;
+     * "template" serves a pre-rendered exposition whose value slots are patched in place,
+     * so a scrape is a memcpy and never allocates.
+     */
+    const char* exposition;
+    MetricsLogFn log;
+    void* log_ctx;
+
+    /*
+     * Push mode (exposition "push"): instead of serving scrapes, batches of samples from all
+     * instances are POSTed to push_url as Prometheus text, so it must be a text-ingest endpoint
+     * (e.g. VictoriaMetrics' /api/v1/import/prometheus), not remote write. bind_address is unused. Batches that cannot be
+     * delivered after push_retries attempts are spooled to spool_dir (bounded by
+     * spool_max_bytes) and resent after the next successful push.
+     */
+    const char* push_url;          /* e.g. "http://127.0.0.1:9201/api/v1/import/prometheus" */
+    uint32_t push_interval_ms;     /* Batch period; 0 selects the default (1000). */
+    uint32_t push_retries;
+    const char* push_compression;  /* "zstd" or "none"; NULL selects zstd when available. */
+    const char* spool_dir;         /* NULL or "" selects <tmp>/fmu_metrics_spool. */
+    uint64_t spool_max_bytes;
+} MetricsAttachOptions;
+
+typedef struct MetricsExporterApi {
+    uint32_t abi_version;
+    uint32_t struct_size;
+
+    /*
+     * Registers one wrapper instance with the process-wide exporter serving `bind_address`;
+     * instances sharing an address share one HTTP endpoint and must use the same exposition.
+     * Returns NULL on failure.
+     */
+    void* (*attach)(const MetricsAttachOptions* options);
+
+    /* Publishes the latest values of an attached instance. */
+    void (*publish)(void* handle, const MetricsData* data);
+
+    /* Removes the instance's series; the endpoint shuts down with its last instance. */
+    void (*detach)(void* handle);
+
+    /*
+     * Publishes `count` consecutive samples of an instance, taken between start_ms and end_ms
+     * (Unix time in milliseconds). Scrape endpoints only keep the last one; the push endpoint
+     * sends them all, with timestamps spread over that interval.
+     */
+    void (*publish_samples)(void* handle, const MetricsData* samples, uint32_t count, int64_t start_ms, int64_t end_ms);
+} MetricsExporterApi;
+
+typedef const MetricsExporterApi* (*MetricsExporterGetApiFn)(uint32_t host_abi_version);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* METRICS_EXPORTER_H */
@@ -0,0 +1,97 @@
+/**
+ * @file gaussian_noise_plugin.c
+ * @brief Example fault plugin: adds zero-mean Gaussian noise to one variable inside a time window.
+ *
+ * Options (wrapper.cfg):
+ *   plugin.gaussian_noise.vr         value reference to disturb (default 0)
+ *   plugin.gaussian_noise.sigma      standard deviation (default 0.1)
+ *   plugin.gaussian_noise.start_time window start in s (default 0)
+ *   plugin.gaussian_noise.end_time   window end in s (default: never)
+ *   plugin.gaussian_noise.seed       random seed (default 1)
+ */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../fault_plugin.h"
+
+typedef struct {
+    uint32_t vr;
+    double sigma;
+    double startTime;
+    double endTime;
+    uint64_t rng; /* The only mutable state; this is what save/restore carry. */
+} NoiseState;
+
+static double option(const FaultPluginContext* ctx, const char* key, double fallback) {
+    const char* v = ctx->get_option(ctx->host, key);
+    return v ? strtod(v, NULL) : fallback;
+}
+
+static uint64_t nextRandom(uint64_t* s) {
+    *s ^= *s >> 12;
+    *s ^= *s << 25;
+    *s ^= *s >> 27;
+    return *s * 0x2545F4914F6CDD1Dull;
+}
+
+static double nextUniform(uint64_t* s) {
+    return ((double)(nextRandom(s) >> 11) + 1.0) * (1.0 / 9007199254740992.0);
+}
+
+static void* noiseInit(const FaultPluginContext* ctx) {
+    NoiseState* st = (NoiseState*)calloc(1, sizeof(NoiseState));
+    if (!st) return NULL;
+    st->vr = (uint32_t)option(ctx, "vr", 0.0);
+    st->sigma = option(ctx, "sigma", 0.1);
+    st->startTime = option(ctx, "start_time", 0.0);
+    st->endTime = option(ctx, "end_time", HUGE_VAL);
+    st->rng = (uint64_t)option(ctx, "seed", 1.0);
+    if (st->rng == 0) st->rng = 1;
+    return st;
+}
+
+static void noiseDestroy(void* state) { free(state); }
+
+/* Box-Muller produces two normal samples per pair of uniforms, so values are processed in pairs. */
+static int noiseApplyBatch(void* state, uint32_t vr, double* values, const double* times, size_t n) {
+    NoiseState* st = (NoiseState*)state;
+    if (vr != st->vr) return FAULT_PLUGIN_OK;
+    for (size_t i = 0; i < n; i += 2) {
+        const double r = st->sigma * sqrt(-2.0 * log(nextUniform(&st->rng)));
+        const double a = 6.283185307179586 * nextUniform(&st->rng);
+        if (times[i] >= st->startTime && times[i] < st->endTime) values[i] += r * cos(a);
+        if (i + 1 < n && times[i + 1] >= st->startTime && times[i + 1] < st->endTime) values[i + 1] += r * sin(a);
+    }
+    return FAULT_PLUGIN_OK;
+}
+
+static size_t noiseStateSize(void* state) { (void)state; return sizeof(uint64_t); }
+
+static int noiseSaveState(void* state, void* buffer, size_t size) {
+    if (size != sizeof(uint64_t)) return FAULT_PLUGIN_ERROR;
+    memcpy(buffer, &((NoiseState*)state)->rng, sizeof(uint64_t));
+    return FAULT_PLUGIN_OK;
+}
+
+static int noiseRestoreState(void* state, const void* buffer, size_t size) {
+    if (size != sizeof(uint64_t)) return FAULT_PLUGIN_ERROR;
+    memcpy(&((NoiseState*)state)->rng, buffer, sizeof(uint64_t));
+    return FAULT_PLUGIN_OK;
+}
+
+static const FaultPluginApi NOISE_API = {
+    FAULT_PLUGIN_ABI_VERSION,
+    sizeof(FaultPluginApi),
+    "gaussian_noise",
+    noiseInit,
+    noiseDestroy,
+    noiseApplyBatch,
+    noiseStateSize,
+    noiseSaveState,
+    noiseRestoreState,
+};
+
+FAULT_PLUGIN_EXPORT const FaultPluginApi* fault_plugin_get_api(uint32_t host_abi_version) {
+    return host_abi_version == FAULT_PLUGIN_ABI_VERSION ? &NOISE_API : NULL;
+}
@@ -0,0 +1,100 @@
+"""
+Local stand-in for a Prometheus text-ingest endpoint (such as VictoriaMetrics'
+/api/v1/import/prometheus), used to test the wrapper's push mode.
+
+Accepts POSTs on --path only (404 elsewhere), decompresses zstd bodies (with the
+`zstandard` module, or the `zstd` command line tool as a fallback), rejects batches
+that are not `name{labels} value timestamp` lines with 400, and prints or appends
+the received lines. --fail-first N answers the first N requests with 503 to exercise
+the exporter's retries and spool. --port 0 picks a free port; the listening line on
+stderr shows which.
+
+Usage: python push_receiver.py [--port 9201] [--path /api/v1/import/prometheus]
+                               [--output samples.txt] [--fail-first N]
+"""
+import argparse
+import re
+import shutil
+import subprocess
+import sys
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+try:
+    import zstandard
+except ImportError:
+    zstandard = None
+
+
+def decompress_zstd(body):
+    if zstandard is not None:
+        return zstandard.ZstdDecompressor().decompressobj().decompress(body)
+    if shutil.which("zstd"):
+        return subprocess.run(["zstd", "-d", "-c"], input=body, capture_output=True, check=True).stdout
+    raise RuntimeError("cannot decompress zstd: install 'zstandard' or the zstd tool")
+
+
+SAMPLE_LINE = re.compile(r'[a-zA-Z_:][a-zA-Z0-9_:]*(\{[^}]*\})? \S+ -?\d+$')
+
+
+class Receiver(BaseHTTPRequestHandler):
+    def do_POST(self):
+        state = self.server.state
+        body = self.rfile.read(int(self.headers.get("Content-Length", 0)))
+        if self.path != state["path"]:
+            print(f"Rejected POST to {self.path}", file=sys.stderr)
+            self.send_response(404)
+            self.end_headers()
+            return
+        state["requests"] += 1
+        if state["requests"] <= state["fail_first"]:
+            self.send_response(503)
+            self.end_headers()
+            return
+        try:
+            if self.headers.get("Content-Encoding") == "zstd":
+                body = decompress_zstd(body)
+            text = body.decode("utf-8")
+            bad = next((line for line in text.splitlines() if line and not SAMPLE_LINE.match(line)), None)
+            if bad is not None:
+                raise ValueError(f"not a sample line: {bad[:80]!r}")
+        except Exception as e:
+            print(f"Rejected batch: {e}", file=sys.stderr)
+            self.send_response(400)
+            self.end_headers()
+            return
+        lines = [line for line in text.splitlines() if line]
+        state["out"].write("".join(line + "\n" for line in lines))
+        state["out"].flush()
+        print(f"Received batch of {len(lines)} samples ({len(body)} bytes decoded)", file=sys.stderr)
+        self.send_response(204)
+        self.end_headers()
+
+    def log_message(self, format, *args):
+        pass
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=9201)
+    parser.add_argument("--path", default="/api/v1/import/prometheus", help="the only path that accepts POSTs")
+    parser.add_argument("--output", help="append samples to this file instead of stdout")
+    parser.add_argument("--fail-first", type=int, default=0, help="answer the first N requests with 503")
+    args = parser.parse_args()
+
+    server = ThreadingHTTPServer((args.host, args.port), Receiver)
+    server.state = {
+        "requests": 0,
+        "path": args.path,
+        "fail_first": args.fail_first,
+        "out": open(args.output, "a") if args.output else sys.stdout,
+    }
+    print(f"Push receiver listening on http://{args.host}:{server.server_address[1]}{args.path}", file=sys.stderr, flush=True)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,411 @@
+"""
+Soak harness: step jitter of the C++ wrapper under concurrent metrics scrapes.
+
+Runs --instances wrapper instances in real time, one thread each, while --scrapers
+separate processes fetch the metrics endpoint --scrape-rate times per second each. The
+scrapers run outside this interpreter so that their GIL and ctypes time does not show
+up as step jitter. It records:
+
+- Per step: how long the native fmi2DoStep call took (without fmpy's wrapper) and how
+  late the step started against its wall-clock schedule.
+- Per scrape: the latency, and whether the scrape failed.
+- Every --sample-interval: the process RSS and the CPU time of the native threads. The
+  native threads are those not created by Python: the metrics worker and the exporter.
+
+A line is printed every --report-interval. A JSON report is written at the end. It holds
+the overall and per-window step-latency percentiles, deadline misses, scrape latency,
+native-thread CPU, the RSS growth rate after warm-up, and how many instances of this
+model one core could step in real time. Run once with --scrapers 0 to get a baseline.
+
+Linux only (reads /proc). Build first: FMU_CPP_Wrapper/build.sh.
+
+Usage: python soak_scrape_jitter.py [--duration 3600] [--instances 1] [--step-size 0.001]
+           [--scrapers 4] [--scrape-rate 10] [--exposition template] [--address 127.0.0.1:8080]
+           [--block-size 256] [--report-interval 60] [--sample-interval 1] [--report soak_report.json]
+"""
+import argparse
+import http.client
+import json
+import math
+import multiprocessing
+import os
+import queue
+import shutil
+import sys
+import threading
+import time
+
+from fmpy import extract, read_model_description
+from fmpy.fmi2 import FMU2Slave, fmi2True, fmi2Warning
+
+WRAPPER_FMU_PATH = 'Amplifier_CPP_Wrapper.fmu'
+
+
+class LatencyHistogram:
+    """Log-spaced histogram from 100 ns to 100 s, so hours of steps fit in constant memory."""
+    PER_DECADE = 50
+    LOWEST = 1e-7
+    BUCKETS = 9 * PER_DECADE
+
+    def __init__(self):
+        self.counts = [0] * (self.BUCKETS + 1)
+        self.count = 0
+        self.total = 0.0
+        self.max = 0.0
+
+    def record(self, seconds):
+        index = 0 if seconds <= self.LOWEST else int(math.log10(seconds / self.LOWEST) * self.PER_DECADE) + 1
+        self.counts[min(index, self.BUCKETS)] += 1
+        self.count += 1
+        self.total += seconds
+        self.max = max(self.max, seconds)
+
+    def merge(self, other):
+        for i, n in enumerate(other.counts):
+            self.counts[i] += n
+        self.count += other.count
+        self.total += other.total
+        self.max = max(self.max, other.max)
+
+    def percentile(self, p):
+        """Upper edge of the bucket holding the p-th percentile (at most 5% high)."""
+        if self.count == 0:
+            return 0.0
+        rank = p / 100.0 * self.count
+        seen = 0
+        for i, n in enumerate(self.counts):
+            seen += n
+            if seen >= rank and n:
+                return min(self.max, self.LOWEST * 10 ** (i / self.PER_DECADE))
+        return self.max
+
+    def mean(self):
+        return self.total / self.count if self.count else 0.0
+
+    def summary(self):
+        return {'count': self.count, 'mean_us': self.mean() * 1e6,
+                **{f'p{p}_us': self.percentile(p) * 1e6 for p in (50, 90, 99, 99.9, 99.99)},
+                'max_us': self.max * 1e6}
+
+
+class Window:
+    """Statistics of one report interval; swapped out under the lock by the reporter."""
+
+    def __init__(self):
+        self.step = LatencyHistogram()
+        self.lateness = LatencyHistogram()
+        self.scrape = LatencyHistogram()
+        self.missed = 0
+        self.scrape_errors = 0
+
+
+class Soak:
+    def __init__(self, args, unzipdir):
+        self.args = args
+        self.unzipdir = unzipdir
+        self.model_description = read_model_description(unzipdir)
+        self.stop = threading.Event()
+        self.lock = threading.Lock()
+        self.window = Window()
+        self.total = Window()
+        self.python_tids = {threading.get_native_id()}
+        self.errors = []
+
+    def _register_thread(self):
+        with self.lock:
+            self.python_tids.add(threading.get_native_id())
+
+    def _flush(self, local):
+        with self.lock:
+            for target in (self.window, self.total):
+                target.step.merge(local.step)
+                target.lateness.merge(local.lateness)
+                target.scrape.merge(local.scrape)
+                target.missed += local.missed
+                target.scrape_errors += local.scrape_errors
+
+    def run_instance(self, index):
+        """Steps one instance on a wall-clock schedule until the soak ends."""
+        self._register_thread()
+        args = self.args
+        vrs = {variable.name: variable.valueReference for variable in self.model_description.modelVariables}
+        fmu = FMU2Slave(guid=self.model_description.guid, unzipDirectory=self.unzipdir,
+                        modelIdentifier=self.model_description.coSimulation.modelIdentifier,
+                        instanceName=f'soak{index}')
+        instantiated = False
+        try:
+            fmu.instantiate()
+            instantiated = True
+            fmu.setupExperiment(startTime=0.0)
+            fmu.enterInitializationMode()
+            fmu.exitInitializationMode()
+            # The ctypes function itself, so the timing leaves out fmpy's logging and status checks.
+            native_do_step = fmu.dll.fmi2DoStep
+            local = Window()
+            started = time.perf_counter()
+            last_flush = started
+            step = 0
+            while not self.stop.is_set():
+                t = step * args.step_size
+                due = started + t
+                now = time.perf_counter()
+                if due > now:
+                    time.sleep(due - now)
+                    now = time.perf_counter()
+                local.lateness.record(now - due)
+                fmu.setReal([vrs['u']], [math.sin(2 * math.pi * t)])
+                began = time.perf_counter()
+                status = native_do_step(fmu.component, t, args.step_size, fmi2True)
+                done = time.perf_counter()
+                if status > fmi2Warning:
+                    raise RuntimeError(f'fmi2DoStep returned status {status} at t={t}')
+                local.step.record(done - began)
+                if done - due > args.step_size:
+                    local.missed += 1
+                step += 1
+                if done - last_flush >= 0.25:
+                    self._flush(local)
+                    local = Window()
+                    last_flush = done
+            self._flush(local)
+            fmu.terminate()
+        except Exception as e:
+            self.errors.append(f'instance {index}: {e}')
+            self.stop.set()
+        finally:
+            if instantiated:
+                fmu.freeInstance()
+
+    def collect(self, results, scrapers):
+        """Merges the windows the scraper processes send until each has sent its final None."""
+        self._register_thread()
+        finished = 0
+        while finished < len(scrapers):
+            try:
+                local = results.get(timeout=0.5)
+            except queue.Empty:
+                if not any(scraper.is_alive() for scraper in scrapers):
+                    break  # A scraper died before its final None.
+                continue
+            if local is None:
+                finished += 1
+            else:
+                self._flush(local)
+
+
+def run_scraper(address, scrape_rate, stop, results):
+    """Scraper process: fetches /metrics at scrape_rate over a keep-alive connection,
+    reconnecting on errors, and sends its statistics to results every 0.25 s."""
+    host, port = address.rsplit(':', 1)
+    connection = None
+    period = 1.0 / scrape_rate
+    next_scrape = time.perf_counter()
+    local = Window()
+    last_flush = next_scrape
+    while not stop.is_set():
+        now = time.perf_counter()
+        if next_scrape > now:
+            time.sleep(next_scrape - now)
+        next_scrape += period
+        began = time.perf_counter()
+        try:
+            if connection is None:
+                connection = http.client.HTTPConnection(host, int(port), timeout=5)
+            connection.request('GET', '/metrics')
+            response = connection.getresponse()
+            response.read()
+            if response.status != 200:
+                raise RuntimeError(f'HTTP {response.status}')
+            local.scrape.record(time.perf_counter() - began)
+        except Exception:
+            local.scrape_errors += 1
+            if connection is not None:
+                connection.close()
+            connection = None
+        if began - last_flush >= 0.25:
+            results.put(local)
+            local = Window()
+            last_flush = began
+    results.put(local)
+    results.put(None)
+    if connection is not None:
+        connection.close()
+
+
+def native_thread_cpu(python_tids):
+    """Summed user+system CPU seconds of this process's threads that Python did not start."""
+    ticks = os.sysconf('SC_CLK_TCK')
+    total = 0.0
+    for tid in os.listdir('/proc/self/task'):
+        if int(tid) in python_tids:
+            continue
+        try:
+            with open(f'/proc/self/task/{tid}/stat') as stat:
+                # The command name may contain spaces; fields after it are fixed.
+                fields = stat.read().rsplit(')', 1)[1].split()
+        except OSError:
+            continue  # The thread exited.
+        total += (int(fields[11]) + int(fields[12])) / ticks
+    return total
+
+
+def rss_bytes():
+    with open('/proc/self/statm') as statm:
+        return int(statm.read().split()[1]) * os.sysconf('SC_PAGE_SIZE')
+
+
+def slope(points):
+    """Least-squares slope of (x, y) points, or 0 with fewer than two."""
+    if len(points) < 2:
+        return 0.0
+    n = len(points)
+    mean_x = sum(x for x, _ in points) / n
+    mean_y = sum(y for _, y in points) / n
+    var_x = sum((x - mean_x) ** 2 for x, _ in points)
+    return sum((x - mean_x) * (y - mean_y) for x, y in points) / var_x if var_x else 0.0
+
+
+def write_config(unzipdir, args):
+    """Appends the harness's metrics settings to the packaged wrapper.cfg; later keys win."""
+    path = os.path.join(unzipdir, 'resources', 'wrapper.cfg')
+    with open(path, 'a') as cfg:
+        cfg.write('\n# --- soak_scrape_jitter.py ---\n')
+        cfg.write(f'metrics.enabled = {"true" if args.scrapers or args.metrics else "false"}\n')
+        cfg.write(f'metrics.address = {args.address}\n')
+        cfg.write(f'metrics.exposition = {args.exposition}\n')
+        cfg.write(f'metrics.block_size = {args.block_size}\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--fmu', default=WRAPPER_FMU_PATH)
+    parser.add_argument('--duration', type=float, default=3600.0, help='seconds')
+    parser.add_argument('--instances', type=int, default=1)
+    parser.add_argument('--step-size', type=float, default=0.001, help='simulated and wall-clock seconds per step')
+    parser.add_argument('--scrapers', type=int, default=4)
+    parser.add_argument('--scrape-rate', type=float, default=10.0, help='scrapes per second per scraper')
+    parser.add_argument('--metrics', action='store_true', help='keep metrics enabled with --scrapers 0')
+    parser.add_argument('--exposition', default='template', choices=['template', 'prometheus'])
+    parser.add_argument('--address', default='127.0.0.1:8080')
+    parser.add_argument('--block-size', type=int, default=256)
+    parser.add_argument('--report-interval', type=float, default=60.0)
+    parser.add_argument('--sample-interval', type=float, default=1.0)
+    parser.add_argument('--warmup', type=float, default=0.1, help='fraction of the run excluded from the RSS slope')
+    parser.add_argument('--report', default='soak_report.json')
+    args = parser.parse_args()
+
+    if not os.path.exists(args.fmu):
+        print(f"Error: FMU '{args.fmu}' not found. Please build it first.")
+        return 1
+
+    unzipdir = extract(args.fmu)
+    write_config(unzipdir, args)
+    soak = Soak(args, unzipdir)
+    threads = [threading.Thread(target=soak.run_instance, args=(i,)) for i in range(args.instances)]
+    for thread in threads:
+        thread.start()
+    time.sleep(0.5)  # Let the first instance bring up the endpoint.
+    # Spawned rather than forked: the instance threads are already running native code.
+    context = multiprocessing.get_context('spawn')
+    scrapers_stop, results = context.Event(), context.Queue()
+    scrapers = [context.Process(target=run_scraper, args=(args.address, args.scrape_rate, scrapers_stop, results))
+                for _ in range(args.scrapers)]
+    for scraper in scrapers:
+        scraper.start()
+    collector = threading.Thread(target=soak.collect, args=(results, scrapers))
+    collector.start()
+
+    print(f"Soaking {args.instances} instance(s) at {1 / args.step_size:.0f} steps/s for {args.duration:.0f} s, "
+          f"{args.scrapers} scraper(s) at {args.scrape_rate:g}/s ({args.exposition})")
+    print(f"{'elapsed':>8} {'steps':>9} {'p50 us':>8} {'p99 us':>8} {'p99.9 us':>9} {'max us':>9} {'late p99':>9} "
+          f"{'missed':>7} {'scrapes':>8} {'scr p99':>8} {'errors':>6} {'native%':>8} {'RSS MB':>8}")
+    started = time.perf_counter()
+    rss_points = []
+    windows = []
+    last_report = last_sample = started
+    last_cpu = native_thread_cpu(soak.python_tids)
+    report_cpu, report_time = last_cpu, started
+    cpu_peak = 0.0
+    try:
+        while not soak.stop.is_set():
+            now = time.perf_counter()
+            if now - started >= args.duration:
+                break
+            time.sleep(min(args.sample_interval, max(0.0, started + args.duration - now)))
+            now = time.perf_counter()
+            if now - last_sample >= args.sample_interval:
+                with soak.lock:
+                    python_tids = set(soak.python_tids)
+                cpu = native_thread_cpu(python_tids)
+                cpu_peak = max(cpu_peak, (cpu - last_cpu) / (now - last_sample) * 100)
+                last_cpu, last_sample = cpu, now
+                rss_points.append((now - started, rss_bytes()))
+            if now - last_report >= args.report_interval or now - started >= args.duration:
+                with soak.lock:
+                    window, soak.window = soak.window, Window()
+                native = (last_cpu - report_cpu) / max(1e-9, last_sample - report_time) * 100
+                report_cpu, report_time = last_cpu, last_sample
+                last_report = now
+                windows.append({'elapsed_s': now - started, 'step': window.step.summary(),
+                                'lateness_p99_us': window.lateness.percentile(99) * 1e6, 'missed': window.missed,
+                                'scrape': window.scrape.summary(), 'scrape_errors': window.scrape_errors,
+                                'native_cpu_percent': native, 'rss_bytes': rss_points[-1][1] if rss_points else rss_bytes()})
+                print(f"{now - started:8.0f} {window.step.count:9d} {window.step.percentile(50) * 1e6:8.1f} "
+                      f"{window.step.percentile(99) * 1e6:8.1f} {window.step.percentile(99.9) * 1e6:9.1f} "
+                      f"{window.step.max * 1e6:9.1f} {window.lateness.percentile(99) * 1e6:9.1f} {window.missed:7d} "
+                      f"{window.scrape.count:8d} {window.scrape.percentile(99) * 1e6:8.0f} {window.scrape_errors:6d} "
+                      f"{native:8.1f} {windows[-1]['rss_bytes'] / 2**20:8.1f}", flush=True)
+    except KeyboardInterrupt:
+        print("Interrupted; writing the report for the elapsed time.")
+    finally:
+        # Scrapers first, so none of them hits the endpoint while it shuts down.
+        scrapers_stop.set()
+        collector.join()
+        for scraper in scrapers:
+            scraper.join()
+        soak.stop.set()
+        for thread in threads:
+            thread.join()
+        shutil.rmtree(unzipdir, ignore_errors=True)
+
+    elapsed = time.perf_counter() - started
+    total = soak.total
+    steady = [point for point in rss_points if point[0] >= args.warmup * elapsed]
+    growth = slope(steady) * 3600
+    step_mean, step_p99 = total.step.mean(), total.step.percentile(99)
+    report = {
+        'config': vars(args),
+        'elapsed_s': elapsed,
+        'step': total.step.summary(),
+        'lateness': total.lateness.summary(),
+        'missed_deadlines': total.missed,
+        'scrape': total.scrape.summary(),
+        'scrape_errors': total.scrape_errors,
+        'native_cpu_percent_mean': sum(w['native_cpu_percent'] for w in windows) / len(windows) if windows else 0.0,
+        'native_cpu_percent_peak': cpu_peak,
+        'rss_start_bytes': rss_points[0][1] if rss_points else 0,
+        'rss_end_bytes': rss_points[-1][1] if rss_points else 0,
+        'rss_growth_bytes_per_hour': growth,
+        # Real-time capacity of one core for this model, from the mean and the p99 step cost.
+        'instances_per_core_mean': math.floor(args.step_size / step_mean) if step_mean else None,
+        'instances_per_core_p99': math.floor(args.step_size / step_p99) if step_p99 else None,
+        'windows': windows,
+        'errors': soak.errors,
+    }
+    with open(args.report, 'w') as out:
+        json.dump(report, out, indent=2)
+
+    print(f"\nsteps {total.step.count}, doStep p50 {total.step.percentile(50) * 1e6:.1f} us, p99 {step_p99 * 1e6:.1f} us, "
+          f"p99.9 {total.step.percentile(99.9) * 1e6:.1f} us, max {total.step.max * 1e6:.1f} us; {total.missed} missed deadlines")
+    print(f"scrapes {total.scrape.count} ({total.scrape_errors} failed), p99 {total.scrape.percentile(99) * 1e3:.2f} ms; "
+          f"native threads {report['native_cpu_percent_mean']:.1f}% CPU (peak {cpu_peak:.1f}%)")
+    print(f"RSS growth after warm-up: {growth / 2**20:+.2f} MB/hour; "
+          f"one core fits ~{report['instances_per_core_p99']} instance(s) at the p99 step cost")
+    print(f"Report written to {args.report}")
+    for error in soak.errors:
+        print(f"Error: {error}")
+    return 1 if soak.errors else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
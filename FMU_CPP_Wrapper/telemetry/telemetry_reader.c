@@ -0,0 +1,135 @@
+/**
+ * @file telemetry_reader.c
+ * @brief Implements the telemetry reader library.
+ */
+#define _POSIX_C_SOURCE 200809L
+#include "telemetry_reader.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct TelemetryReader {
+    const TelemetryHeader* header;
+    size_t size;
+};
+
+static const TelemetrySlotHeader* slot_at(const TelemetryReader* reader, uint32_t slot) {
+    const char* base = (const char*)reader->header + reader->header->header_size;
+    return (const TelemetrySlotHeader*)(base + (size_t)slot * reader->header->slot_size);
+}
+
+static const double* ring_of(const TelemetrySlotHeader* slot) {
+    return (const double*)((const char*)slot + sizeof(TelemetrySlotHeader));
+}
+
+TelemetryReader* telemetry_open(const char* name) {
+    const int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(TelemetryHeader)) {
+        close(fd);
+        errno = EINVAL;
+        return NULL;
+    }
+    void* base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return NULL;
+
+    const TelemetryHeader* header = (const TelemetryHeader*)base;
+    /* The writer stores the magic last; a segment still being set up is reported as EAGAIN. */
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != TELEMETRY_MAGIC || header->version != TELEMETRY_VERSION ||
+        header->segment_size > (uint64_t)st.st_size) {
+        const int err = header->magic == 0 ? EAGAIN : EPROTO;
+        munmap(base, (size_t)st.st_size);
+        errno = err;
+        return NULL;
+    }
+
+    TelemetryReader* reader = (TelemetryReader*)malloc(sizeof(TelemetryReader));
+    if (!reader) {
+        munmap(base, (size_t)st.st_size);
+        return NULL;
+    }
+    reader->header = header;
+    reader->size = (size_t)st.st_size;
+    return reader;
+}
+
+void telemetry_close(TelemetryReader* reader) {
+    if (!reader) return;
+    munmap((void*)reader->header, reader->size);
+    free(reader);
+}
+
+const TelemetryHeader* telemetry_header(const TelemetryReader* reader) { return reader->header; }
+
+uint32_t telemetry_slot_state(const TelemetryReader* reader, uint32_t slot, char name[TELEMETRY_NAME_LENGTH]) {
+    if (slot >= reader->header->max_instances) return TELEMETRY_SLOT_FREE;
+    const TelemetrySlotHeader* s = slot_at(reader, slot);
+    const uint32_t state = __atomic_load_n(&s->state, __ATOMIC_ACQUIRE);
+    if (name) {
+        memcpy(name, s->instance_name, TELEMETRY_NAME_LENGTH);
+        name[TELEMETRY_NAME_LENGTH - 1] = '\0';
+    }
+    return state;
+}
+
+void telemetry_cursor_init(const TelemetryReader* reader, uint32_t slot, int from_latest, TelemetryCursor* cursor) {
+    const TelemetrySlotHeader* s = slot_at(reader, slot);
+    const uint64_t capacity = reader->header->ring_capacity;
+    cursor->slot = slot;
+    cursor->generation = __atomic_load_n(&s->generation, __ATOMIC_ACQUIRE);
+    const uint64_t head = __atomic_load_n(&s->write_index, __ATOMIC_ACQUIRE);
+    if (from_latest) cursor->next = head > 0 ? head - 1 : 0;
+    else cursor->next = head > capacity ? head - capacity : 0;
+    cursor->dropped = 0;
+}
+
+size_t telemetry_read(const TelemetryReader* reader, TelemetryCursor* cursor, double* out, size_t max_samples) {
+    const TelemetryHeader* h = reader->header;
+    const TelemetrySlotHeader* s = slot_at(reader, cursor->slot);
+    const uint64_t capacity = h->ring_capacity;
+    const size_t count = h->variable_count;
+    const double* ring = ring_of(s);
+
+    const uint32_t generation = __atomic_load_n(&s->generation, __ATOMIC_ACQUIRE);
+    if (generation != cursor->generation) {
+        cursor->generation = generation;
+        cursor->next = 0;
+    }
+    const uint64_t head = __atomic_load_n(&s->write_index, __ATOMIC_ACQUIRE);
+    if (head < cursor->next) cursor->next = 0; /* Slot reclaimed between the two loads. */
+    if (head - cursor->next > capacity) {
+        cursor->dropped += head - capacity - cursor->next;
+        cursor->next = head - capacity;
+    }
+    uint64_t available = head - cursor->next;
+    if (available > max_samples) available = max_samples;
+
+    for (uint64_t i = 0; i < available; i++) {
+        memcpy(out + i * count, ring + ((cursor->next + i) & (capacity - 1)) * count, count * sizeof(double));
+    }
+
+    /*
+     * The writer may have lapped us while copying: while it writes sample j it has
+     * published j samples and is overwriting sample j - capacity. Anything below
+     * (head_after + 1 - capacity) is therefore suspect and gets dropped.
+     */
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    const uint64_t headAfter = __atomic_load_n(&s->write_index, __ATOMIC_RELAXED);
+    const uint64_t firstValid = headAfter + 1 > capacity ? headAfter + 1 - capacity : 0;
+    uint64_t skip = 0;
+    if (firstValid > cursor->next) {
+        skip = firstValid - cursor->next;
+        if (skip > available) skip = available;
+        memmove(out, out + skip * count, (available - skip) * count * sizeof(double));
+        cursor->dropped += skip;
+    }
+    cursor->next += available;
+    return (size_t)(available - skip);
+}
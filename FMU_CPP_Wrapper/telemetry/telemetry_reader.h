@@ -0,0 +1,55 @@
+/**
+ * @file telemetry_reader.h
+ * @brief Reader library for the wrapper's shared-memory telemetry segment (see telemetry_shm.h).
+ *
+ * The segment is mapped read-only; after telemetry_open() every call is plain memory
+ * access, so an observer can poll at any rate without system calls and without any
+ * effect on the simulation. Readers that fall behind lose the oldest samples; the
+ * cursor counts how many.
+ */
+#ifndef TELEMETRY_READER_H
+#define TELEMETRY_READER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../telemetry_shm.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct TelemetryReader TelemetryReader;
+
+/* Read position in one instance's ring. */
+typedef struct TelemetryCursor {
+    uint32_t slot;
+    uint32_t generation;   /* Slot generation the cursor belongs to. */
+    uint64_t next;         /* Index of the next sample to return. */
+    uint64_t dropped;      /* Samples overwritten before they could be read. */
+} TelemetryCursor;
+
+/* Maps the segment `name` (e.g. "/fmu_telemetry.1234"). Returns NULL and sets errno on failure. */
+TelemetryReader* telemetry_open(const char* name);
+void telemetry_close(TelemetryReader* reader);
+
+const TelemetryHeader* telemetry_header(const TelemetryReader* reader);
+
+/* Returns the slot's state (TELEMETRY_SLOT_*) and, if name is not NULL, copies its instance name. */
+uint32_t telemetry_slot_state(const TelemetryReader* reader, uint32_t slot, char name[TELEMETRY_NAME_LENGTH]);
+
+/* Positions a cursor at the oldest retained sample, or at the newest one if from_latest is set. */
+void telemetry_cursor_init(const TelemetryReader* reader, uint32_t slot, int from_latest, TelemetryCursor* cursor);
+
+/*
+ * Copies up to max_samples samples (variable_count doubles each) into out and advances the cursor.
+ * Returns the number of samples copied. If the slot was reclaimed by a new instance, the cursor
+ * restarts at that instance's first sample.
+ */
+size_t telemetry_read(const TelemetryReader* reader, TelemetryCursor* cursor, double* out, size_t max_samples);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TELEMETRY_READER_H */
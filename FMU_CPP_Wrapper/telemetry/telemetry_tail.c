@@ -0,0 +1,66 @@
+/**
+ * @file telemetry_tail.c
+ * @brief Prints the samples of a telemetry segment as CSV while the simulation runs.
+ *
+ * Usage: telemetry_tail /fmu_telemetry.<pid> [poll interval in ms, default 10]
+ * Output columns: instance, then one column per variable described in the header.
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "telemetry_reader.h"
+
+#define MAX_SLOTS 4096
+#define BATCH 256
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <segment name> [poll ms]\n", argv[0]);
+        return 2;
+    }
+    const long pollMs = argc > 2 ? strtol(argv[2], NULL, 10) : 10;
+    TelemetryReader* reader = telemetry_open(argv[1]);
+    if (!reader) {
+        perror("telemetry_open");
+        return 1;
+    }
+    const TelemetryHeader* h = telemetry_header(reader);
+    const uint32_t slots = h->max_instances < MAX_SLOTS ? h->max_instances : MAX_SLOTS;
+
+    printf("instance");
+    for (uint32_t v = 0; v < h->variable_count; v++) printf(",%s", h->variables[v].name);
+    printf("\n");
+
+    static TelemetryCursor cursors[MAX_SLOTS];
+    for (uint32_t i = 0; i < slots; i++) telemetry_cursor_init(reader, i, 0, &cursors[i]);
+    double* samples = malloc(sizeof(double) * BATCH * h->variable_count);
+    const struct timespec pause = {pollMs / 1000, (pollMs % 1000) * 1000000L};
+
+    for (;;) {
+        int active = 0;
+        for (uint32_t i = 0; i < slots; i++) {
+            char name[TELEMETRY_NAME_LENGTH];
+            const uint32_t state = telemetry_slot_state(reader, i, name);
+            if (state == TELEMETRY_SLOT_FREE) continue;
+            active |= state == TELEMETRY_SLOT_ACTIVE;
+            size_t n;
+            while ((n = telemetry_read(reader, &cursors[i], samples, BATCH)) > 0) {
+                for (size_t s = 0; s < n; s++) {
+                    printf("%s", name);
+                    for (uint32_t v = 0; v < h->variable_count; v++) printf(",%.17g", samples[s * h->variable_count + v]);
+                    printf("\n");
+                }
+            }
+        }
+        fflush(stdout);
+        /* The segment is unlinked when the last instance closes; stop once nothing is left to follow. */
+        if (!active && h->writer_pid > 0 && kill((pid_t)h->writer_pid, 0) != 0) break;
+        nanosleep(&pause, NULL);
+    }
+    free(samples);
+    telemetry_close(reader);
+    return 0;
+}
@@ -0,0 +1,73 @@
+/**
+ * @file telemetry_shm.h
+ * @brief Memory layout of the shared-memory telemetry segment published by the C++ wrapper.
+ *
+ * One POSIX shared-memory object per process (default name "/fmu_telemetry.<pid>"):
+ *
+ *   TelemetryHeader                       describes the variables and the slot geometry
+ *   slot 0 .. max_instances-1, each       slot_size bytes, 64-byte aligned
+ *     TelemetrySlotHeader                 instance name, state and write index
+ *     double samples[ring_capacity][variable_count]
+ *
+ * Each wrapper instance owns one slot and is its only writer. A sample is written
+ * into ring entry `write_index % ring_capacity` and then published by storing
+ * `write_index + 1` with release semantics. Readers never write to the segment:
+ * they copy entries, then re-load `write_index` (acquire fence first) and discard
+ * anything the writer may have overwritten meanwhile. The simulation thread therefore
+ * never waits for, or even notices, its observers.
+ *
+ * All multi-byte fields use the host's native byte order; readers must run on the same machine.
+ */
+#ifndef TELEMETRY_SHM_H
+#define TELEMETRY_SHM_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TELEMETRY_MAGIC 0x4D4C5446u /* "FTLM"; stored last, once the header is complete. */
+#define TELEMETRY_VERSION 1u
+#define TELEMETRY_MAX_VARIABLES 16
+#define TELEMETRY_NAME_LENGTH 64
+
+/* TelemetrySlotHeader.state */
+#define TELEMETRY_SLOT_FREE 0u
+#define TELEMETRY_SLOT_ACTIVE 1u
+#define TELEMETRY_SLOT_CLOSED 2u   /* The instance was freed; its last samples stay readable. */
+
+typedef struct TelemetryVariable {
+    char name[32];
+    uint32_t value_reference;
+    uint32_t reserved;
+} TelemetryVariable;
+
+typedef struct TelemetryHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t header_size;          /* Byte offset of slot 0. */
+    uint32_t slot_size;            /* Byte distance between slots. */
+    uint32_t max_instances;
+    uint32_t ring_capacity;        /* Samples per ring; a power of two. */
+    uint32_t variable_count;       /* Doubles per sample; variable 0 is the simulation time. */
+    uint32_t reserved;
+    uint64_t segment_size;
+    int64_t writer_pid;
+    TelemetryVariable variables[TELEMETRY_MAX_VARIABLES];
+} TelemetryHeader;
+
+typedef struct TelemetrySlotHeader {
+    uint32_t state;                /* TELEMETRY_SLOT_*, accessed atomically. */
+    uint32_t generation;           /* Incremented whenever the slot is claimed, so readers notice reuse. */
+    char instance_name[TELEMETRY_NAME_LENGTH];
+    uint8_t pad0[56];
+    uint64_t write_index;          /* Number of samples ever written; on its own cache line. */
+    uint8_t pad1[56];
+} TelemetrySlotHeader;             /* Followed by the sample ring. */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TELEMETRY_SHM_H */
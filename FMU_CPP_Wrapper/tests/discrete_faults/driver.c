@@ -0,0 +1,65 @@
+/*
+ * Host for test_discrete_faults.sh: steps the wrapper from 0 to 10 s and checks that the
+ * bit faults of wrapper.cfg reach the discrete outputs and inputs in their time windows.
+ */
+#include <dlfcn.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "fmi2Functions.h"
+
+static void logger(fmi2ComponentEnvironment env, fmi2String name, fmi2Status status, fmi2String category, fmi2String message, ...) {
+    va_list args;
+    (void)env; (void)status;
+    va_start(args, message);
+    printf("[%s][%s] ", name, category);
+    vprintf(message, args);
+    printf("\n");
+    va_end(args);
+}
+
+#define LOAD(Name) fmi2##Name##TYPE* Name = (fmi2##Name##TYPE*)dlsym(lib, "fmi2" #Name)
+
+int main(int argc, char** argv) {
+    if (argc != 3) { fprintf(stderr, "usage: %s fault_wrapper.so resource-uri\n", argv[0]); return 2; }
+    void* lib = dlopen(argv[1], RTLD_NOW);
+    if (!lib) { fprintf(stderr, "%s\n", dlerror()); return 2; }
+    LOAD(Instantiate); LOAD(SetupExperiment); LOAD(EnterInitializationMode); LOAD(ExitInitializationMode);
+    LOAD(SetInteger); LOAD(GetInteger); LOAD(SetBoolean); LOAD(GetBoolean); LOAD(DoStep); LOAD(FreeInstance);
+
+    fmi2CallbackFunctions callbacks = {logger, calloc, free, NULL, NULL};
+    fmi2Component c = Instantiate("discrete", fmi2CoSimulation, "{a1b2c3d4-e5f6-4a00-8276-176fa3c9f001}", argv[2], &callbacks, fmi2False, fmi2False);
+    if (!c) { fprintf(stderr, "instantiation failed\n"); return 1; }
+    SetupExperiment(c, fmi2False, 0.0, 0.0, fmi2False, 0.0);
+    EnterInitializationMode(c);
+    ExitInitializationMode(c);
+
+    const fmi2ValueReference vrMode = 10, vrModeOut = 11, vrReady = 20, vrEnable = 21;
+    const fmi2Integer mode = 5;
+    const fmi2Boolean enable = fmi2False;
+    int failures = 0;
+    for (int i = 0; i < 20; i++) {
+        const double t = 0.5 * i;
+        SetInteger(c, &vrMode, 1, &mode);
+        SetBoolean(c, &vrEnable, 1, &enable);
+        if (DoStep(c, t, 0.5, fmi2True) != fmi2OK) { fprintf(stderr, "doStep failed at t=%g\n", t); return 1; }
+
+        fmi2Integer modeOut = 0, modeBack = 0;
+        fmi2Boolean ready = fmi2False;
+        GetInteger(c, &vrModeOut, 1, &modeOut);
+        GetInteger(c, &vrMode, 1, &modeBack);
+        GetBoolean(c, &vrReady, 1, &ready);
+
+        const int outputWindow = t >= 3.0 && t < 7.0, inputWindow = t >= 8.0 && t < 9.0;
+        const fmi2Integer expectedModeOut = inputWindow ? 4 : outputWindow ? (fmi2Integer)(5u ^ 0x80000000u) : 5;
+        const fmi2Boolean expectedReady = outputWindow ? fmi2True : fmi2False;
+        if (modeOut != expectedModeOut || ready != expectedReady || modeBack != mode) {
+            printf("t=%.1f: modeOut=%d (expected %d) ready=%d (expected %d) mode=%d (expected %d)\n",
+                   t, modeOut, expectedModeOut, ready, expectedReady, modeBack, mode);
+            failures++;
+        }
+    }
+    FreeInstance(c);
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
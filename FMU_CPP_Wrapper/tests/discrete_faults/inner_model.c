@@ -0,0 +1,87 @@
+/*
+ * Inner FMU for test_discrete_faults.sh: y = k * u, and the discrete outputs echo the
+ * discrete inputs at every step (modeOut = mode, ready = enable).
+ */
+#include <stdlib.h>
+#include "fmi2Functions.h"
+
+typedef struct {
+    double u, y, k;
+    fmi2Integer mode, modeOut;
+    fmi2Boolean ready, enable;
+} Echo;
+
+fmi2Component fmi2Instantiate(fmi2String n, fmi2Type t, fmi2String g, fmi2String r, const fmi2CallbackFunctions* f, fmi2Boolean v, fmi2Boolean l) {
+    (void)n; (void)t; (void)g; (void)r; (void)f; (void)v; (void)l;
+    Echo* e = (Echo*)calloc(1, sizeof(Echo));
+    if (e) e->k = 2.0;
+    return e;
+}
+void fmi2FreeInstance(fmi2Component c) { free(c); }
+fmi2Status fmi2SetupExperiment(fmi2Component c, fmi2Boolean a, fmi2Real b, fmi2Real d, fmi2Boolean e, fmi2Real f) { (void)c; (void)a; (void)b; (void)d; (void)e; (void)f; return fmi2OK; }
+fmi2Status fmi2EnterInitializationMode(fmi2Component c) { (void)c; return fmi2OK; }
+fmi2Status fmi2ExitInitializationMode(fmi2Component c) { (void)c; return fmi2OK; }
+fmi2Status fmi2Terminate(fmi2Component c) { (void)c; return fmi2OK; }
+fmi2Status fmi2Reset(fmi2Component c) { (void)c; return fmi2OK; }
+
+fmi2Status fmi2SetReal(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Real value[]) {
+    Echo* e = (Echo*)c;
+    for (size_t i = 0; i < nvr; i++) {
+        if (vr[i] == 0) e->u = value[i];
+        else if (vr[i] == 2) e->k = value[i];
+        else return fmi2Error;
+    }
+    return fmi2OK;
+}
+fmi2Status fmi2GetReal(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Real value[]) {
+    Echo* e = (Echo*)c;
+    for (size_t i = 0; i < nvr; i++) {
+        if (vr[i] == 0) value[i] = e->u;
+        else if (vr[i] == 1) value[i] = e->y;
+        else if (vr[i] == 2) value[i] = e->k;
+        else return fmi2Error;
+    }
+    return fmi2OK;
+}
+fmi2Status fmi2SetInteger(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Integer value[]) {
+    Echo* e = (Echo*)c;
+    for (size_t i = 0; i < nvr; i++) {
+        if (vr[i] != 10) return fmi2Error;
+        e->mode = value[i];
+    }
+    return fmi2OK;
+}
+fmi2Status fmi2GetInteger(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Integer value[]) {
+    Echo* e = (Echo*)c;
+    for (size_t i = 0; i < nvr; i++) {
+        if (vr[i] == 10) value[i] = e->mode;
+        else if (vr[i] == 11) value[i] = e->modeOut;
+        else return fmi2Error;
+    }
+    return fmi2OK;
+}
+fmi2Status fmi2SetBoolean(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Boolean value[]) {
+    Echo* e = (Echo*)c;
+    for (size_t i = 0; i < nvr; i++) {
+        if (vr[i] != 21) return fmi2Error;
+        e->enable = value[i];
+    }
+    return fmi2OK;
+}
+fmi2Status fmi2GetBoolean(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Boolean value[]) {
+    Echo* e = (Echo*)c;
+    for (size_t i = 0; i < nvr; i++) {
+        if (vr[i] == 20) value[i] = e->ready;
+        else if (vr[i] == 21) value[i] = e->enable;
+        else return fmi2Error;
+    }
+    return fmi2OK;
+}
+fmi2Status fmi2DoStep(fmi2Component c, fmi2Real t, fmi2Real h, fmi2Boolean n) {
+    Echo* e = (Echo*)c;
+    (void)t; (void)h; (void)n;
+    e->y = e->k * e->u;
+    e->modeOut = e->mode;
+    e->ready = e->enable;
+    return fmi2OK;
+}
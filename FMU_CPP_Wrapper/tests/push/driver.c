@@ -0,0 +1,51 @@
+/*
+ * Host for test_push.sh: runs the wrapper for STEPS steps with u = step index, pausing
+ * 2 ms per step so every sample gets its own millisecond timestamp, then frees the
+ * instance, which flushes the last push batch.
+ */
+#include <dlfcn.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "fmi2Functions.h"
+
+#define STEPS 50
+
+static void logger(fmi2ComponentEnvironment env, fmi2String name, fmi2Status status, fmi2String category, fmi2String message, ...) {
+    va_list args;
+    (void)env; (void)status;
+    va_start(args, message);
+    printf("[%s][%s] ", name, category);
+    vprintf(message, args);
+    printf("\n");
+    va_end(args);
+}
+
+#define LOAD(Name) fmi2##Name##TYPE* Name = (fmi2##Name##TYPE*)dlsym(lib, "fmi2" #Name)
+
+int main(int argc, char** argv) {
+    if (argc != 3) { fprintf(stderr, "usage: %s fault_wrapper.so resource-uri\n", argv[0]); return 2; }
+    void* lib = dlopen(argv[1], RTLD_NOW);
+    if (!lib) { fprintf(stderr, "%s\n", dlerror()); return 2; }
+    LOAD(Instantiate); LOAD(SetupExperiment); LOAD(EnterInitializationMode); LOAD(ExitInitializationMode);
+    LOAD(SetReal); LOAD(DoStep); LOAD(FreeInstance);
+
+    fmi2CallbackFunctions callbacks = {logger, calloc, free, NULL, NULL};
+    fmi2Component c = Instantiate("pushed", fmi2CoSimulation, "{a1b2c3d4-e5f6-4a00-8276-176fa3c9f001}", argv[2], &callbacks, fmi2False, fmi2False);
+    if (!c) { fprintf(stderr, "instantiation failed\n"); return 1; }
+    SetupExperiment(c, fmi2False, 0.0, 0.0, fmi2False, 0.0);
+    EnterInitializationMode(c);
+    ExitInitializationMode(c);
+
+    const fmi2ValueReference vrU = 0;
+    const struct timespec pause = {0, 2000000};
+    for (int i = 0; i < STEPS; i++) {
+        const fmi2Real u = i;
+        SetReal(c, &vrU, 1, &u);
+        if (DoStep(c, 0.1 * i, 0.1, fmi2True) != fmi2OK) { fprintf(stderr, "doStep failed at step %d\n", i); return 1; }
+        nanosleep(&pause, NULL);
+    }
+    FreeInstance(c);
+    return 0;
+}
@@ -0,0 +1,27 @@
+#!/bin/bash
+# Builds the wrapper against tests/discrete_faults/modelDescription.xml, which adds Integer
+# and Boolean variables to the amplifier, and checks the bit faults of its wrapper.cfg on
+# an inner FMU that echoes its discrete inputs to its outputs.
+# Usage: tests/test_discrete_faults.sh (from FMU_CPP_Wrapper or anywhere else)
+
+set -e
+
+WRAPPER_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+TEST_DIR="${WRAPPER_DIR}/tests/discrete_faults"
+WORK_DIR="$(mktemp -d)"
+trap 'rm -rf "${WORK_DIR}"' EXIT
+
+# The bindings are generated into a copy of the sources so the committed header is untouched.
+mkdir -p "${WORK_DIR}/src" "${WORK_DIR}/resources/Amplifier/binaries/linux64"
+cp "${WRAPPER_DIR}"/*.cpp "${WRAPPER_DIR}"/*.hpp "${WRAPPER_DIR}"/*.h "${WORK_DIR}/src/"
+python3 "${WRAPPER_DIR}/../generate_model_bindings.py" "${TEST_DIR}/modelDescription.xml" "${WORK_DIR}/src/ModelBindings.hpp"
+
+cd "${WORK_DIR}/src"
+g++ -shared -fPIC -std=c++17 -O2 -Wall fmi_adapter.cpp FaultWrapper.cpp BitFaults.cpp SignalGenerator.cpp WrapperConfig.cpp \
+    FaultPluginHost.cpp TelemetrySegment.cpp StepWatchdog.cpp MetricsBlockChannel.cpp InnerLibraryPool.cpp \
+    -o "${WORK_DIR}/fault_wrapper.so" -lpthread -lrt -ldl
+gcc -shared -fPIC -O2 -I. "${TEST_DIR}/inner_model.c" -o "${WORK_DIR}/resources/Amplifier/binaries/linux64/model.so"
+gcc -O2 -I. "${TEST_DIR}/driver.c" -o "${WORK_DIR}/driver" -ldl
+cp "${TEST_DIR}/wrapper.cfg" "${WORK_DIR}/resources/"
+
+"${WORK_DIR}/driver" "${WORK_DIR}/fault_wrapper.so" "file://${WORK_DIR}/resources"
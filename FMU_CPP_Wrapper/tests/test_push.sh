@@ -0,0 +1,72 @@
+#!/bin/bash
+# Runs the wrapper in push mode against push_receiver.py, which only accepts Prometheus
+# text on the text-ingest path (/api/v1/import/prometheus), and checks that every step
+# arrives once, in order, with increasing timestamps.
+# Needs prometheus-cpp, like the metrics exporter itself; skipped without it.
+# Usage: tests/test_push.sh (from FMU_CPP_Wrapper or anywhere else)
+
+set -e
+
+WRAPPER_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+TEST_DIR="${WRAPPER_DIR}/tests/push"
+WORK_DIR="$(mktemp -d)"
+RECEIVER_PID=""
+trap '[[ -n "${RECEIVER_PID}" ]] && kill "${RECEIVER_PID}" 2>/dev/null; rm -rf "${WORK_DIR}"' EXIT
+
+if ! echo '#include <prometheus/exposer.h>' | g++ -std=c++17 -E -x c++ - >/dev/null 2>&1; then
+    echo "SKIPPED: prometheus-cpp not found"
+    exit 0
+fi
+
+mkdir -p "${WORK_DIR}/resources/Amplifier/binaries/linux64"
+cd "${WRAPPER_DIR}"
+g++ -shared -fPIC -std=c++17 -O2 -Wall fmi_adapter.cpp FaultWrapper.cpp BitFaults.cpp SignalGenerator.cpp WrapperConfig.cpp \
+    FaultPluginHost.cpp TelemetrySegment.cpp StepWatchdog.cpp MetricsBlockChannel.cpp InnerLibraryPool.cpp \
+    -o "${WORK_DIR}/fault_wrapper.so" -lpthread -lrt -ldl
+g++ -shared -fPIC -std=c++17 -O2 -fvisibility=hidden metrics_exporter.cpp TemplateExposition.cpp PushExporter.cpp \
+    -o "${WORK_DIR}/resources/metrics_exporter.so" -lprometheus-cpp-core -lprometheus-cpp-pull -lpthread
+gcc -shared -fPIC -O2 -I. "${WRAPPER_DIR}/tests/discrete_faults/inner_model.c" -o "${WORK_DIR}/resources/Amplifier/binaries/linux64/model.so"
+gcc -O2 -I. "${TEST_DIR}/driver.c" -o "${WORK_DIR}/driver" -ldl
+
+python3 "${WRAPPER_DIR}/push_receiver.py" --port 0 --output "${WORK_DIR}/samples.txt" 2>"${WORK_DIR}/receiver.log" &
+RECEIVER_PID=$!
+for _ in $(seq 50); do
+    URL="$(sed -n 's/^Push receiver listening on //p' "${WORK_DIR}/receiver.log")"
+    [[ -n "${URL}" ]] && break
+    sleep 0.1
+done
+[[ -n "${URL}" ]] || { echo "push_receiver.py did not start"; cat "${WORK_DIR}/receiver.log"; exit 1; }
+cp "${TEST_DIR}/wrapper.cfg" "${WORK_DIR}/resources/"
+printf 'metrics.push_url = %s\nmetrics.spool_dir = %s\n' "${URL}" "${WORK_DIR}/spool" >> "${WORK_DIR}/resources/wrapper.cfg"
+
+"${WORK_DIR}/driver" "${WORK_DIR}/fault_wrapper.so" "file://${WORK_DIR}/resources"
+kill "${RECEIVER_PID}"
+wait "${RECEIVER_PID}" 2>/dev/null || true
+RECEIVER_PID=""
+
+python3 - "${WORK_DIR}/samples.txt" <<'PY'
+import sys
+from collections import defaultdict
+
+STEPS = 50  # driver.c
+series = defaultdict(list)
+with open(sys.argv[1]) as f:
+    for line in f:
+        name_labels, value, timestamp = line.split()
+        series[name_labels].append((int(timestamp), float(value)))
+
+failures = []
+for name in ("fmu_time_seconds", "fmu_input_u", "fmu_output_y", "fmu_parameter_k"):
+    samples = series.get(name + '{instance="pushed"}', [])
+    if len(samples) != STEPS:
+        failures.append(f"{name}: {len(samples)} samples, expected {STEPS}")
+    elif any(b[0] <= a[0] for a, b in zip(samples, samples[1:])):
+        failures.append(f"{name}: timestamps do not increase")
+inputs = [value for _, value in series.get('fmu_input_u{instance="pushed"}', [])]
+if inputs and inputs != [float(i) for i in range(STEPS)]:
+    failures.append(f"fmu_input_u: {inputs}, expected 0..{STEPS - 1}")
+for failure in failures:
+    print(failure)
+print("FAILED" if failures else "OK")
+sys.exit(1 if failures else 0)
+PY
@@ -6,6 +6,9 @@ FMU_NAME="Amplifier_C_Wrapper"
 WRAPPER_C_SOURCE="fault_wrapper.c"
 WRAPPER_XML="modelDescription.xml"
 ORIGINAL_FMU="../Amplifier.fmu"
+# "instance" or "thread" loads the inner binary into private dlmopen namespaces (glibc only),
+# for inner FMUs with global state; see INNER_ISOLATION in fault_wrapper.c. "none" shares it.
+INNER_ISOLATION="${INNER_ISOLATION:-none}"
 
 echo "--- Starting C Wrapper FMU Build Process ---"
 
@@ -39,8 +42,16 @@ fi
 
 mkdir -p "${BUILD_DIR}/binaries/${PLATFORM_DIR}"
 
+ISOLATION_FLAGS=""
+case "${INNER_ISOLATION}" in
+    none) ;;
+    instance) ISOLATION_FLAGS="-DINNER_ISOLATION=1 -lpthread -ldl" ;;
+    thread) ISOLATION_FLAGS="-DINNER_ISOLATION=2 -lpthread -ldl" ;;
+    *) echo >&2 "Build failed: INNER_ISOLATION must be none, instance or thread."; exit 1 ;;
+esac
+
 echo "Compiling for platform: ${PLATFORM_DIR}"
-gcc -shared -fPIC -I"../Amplifier_files/headers" "${WRAPPER_C_SOURCE}" -o "${BUILD_DIR}/binaries/${PLATFORM_DIR}/fault_wrapper${SHARED_LIB_EXT}"
+gcc -shared -fPIC -I"../Amplifier_files/headers" "${WRAPPER_C_SOURCE}" -o "${BUILD_DIR}/binaries/${PLATFORM_DIR}/fault_wrapper${SHARED_LIB_EXT}" ${ISOLATION_FLAGS}
 echo "Compilation successful."
 
 # 4. Copy wrapper modelDescription.xml
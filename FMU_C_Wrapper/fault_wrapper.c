@@ -1,3 +1,18 @@
+// --- Inner Library Isolation ---
+// Many inner FMUs keep global state, and a plain dlopen of the same binary returns the same
+// mapping to every instance. Building with INNER_ISOLATION (build.sh: INNER_ISOLATION=instance
+// or thread) loads the inner binary with dlmopen into a private link-map namespace instead:
+//   1 = one namespace per live instance,
+//   2 = one per instantiating thread, shared by the instances created on that thread.
+// Freed namespaces are pooled and reused (with the globals their last user left behind), since
+// glibc only has room for about a dozen per process. Needs glibc.
+#ifndef INNER_ISOLATION
+#define INNER_ISOLATION 0
+#endif
+#if INNER_ISOLATION && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // dlmopen
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -21,6 +36,87 @@
 #define SEP "/"
 #endif
 
+#if INNER_ISOLATION
+#if !defined(__GLIBC__)
+#error "INNER_ISOLATION needs dlmopen, which only glibc provides"
+#endif
+#include <pthread.h>
+
+#define MAX_NAMESPACES 64
+
+typedef struct {
+    char path[1024];
+    DLL_HANDLE handle;
+    unsigned users;       // Live instances; 0 means pooled.
+    unsigned long thread; // threadSerial() of the leasing thread while users > 0.
+} InnerNamespace;
+
+static InnerNamespace g_namespaces[MAX_NAMESPACES]; // Only grows; namespaces are never unloaded.
+static size_t g_namespaceCount = 0;
+static pthread_mutex_t g_namespaceMutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Identifies the calling thread; unlike pthread_self() it is never reused by a later thread.
+static unsigned long threadSerial(void) {
+    static unsigned long next = 0;
+    static __thread unsigned long serial = 0;
+    if (!serial) serial = __atomic_add_fetch(&next, 1, __ATOMIC_RELAXED);
+    return serial;
+}
+
+// Leases a namespace holding the binary at path: the calling thread's own (INNER_ISOLATION 2),
+// else a pooled one, else a new one. Returns NULL with a reason on failure.
+static DLL_HANDLE loadInnerLibrary(const char* path, const char** reason) {
+    InnerNamespace* lease = NULL;
+    pthread_mutex_lock(&g_namespaceMutex);
+    for (size_t i = 0; i < g_namespaceCount; i++) {
+        InnerNamespace* ns = &g_namespaces[i];
+        if (strcmp(ns->path, path) != 0) continue;
+        if (INNER_ISOLATION == 2 && ns->users > 0 && ns->thread == threadSerial()) {
+            lease = ns;
+            break;
+        }
+        if (ns->users == 0 && !lease) lease = ns;
+    }
+    if (!lease) {
+        DLL_HANDLE handle = NULL;
+        if (g_namespaceCount == MAX_NAMESPACES || strlen(path) >= sizeof(lease->path)) {
+            *reason = "no namespace slot left";
+        } else if (!(handle = dlmopen(LM_ID_NEWLM, path, RTLD_NOW | RTLD_LOCAL))) {
+            *reason = dlerror();
+        }
+        if (!handle) {
+            pthread_mutex_unlock(&g_namespaceMutex);
+            return NULL;
+        }
+        lease = &g_namespaces[g_namespaceCount++];
+        strcpy(lease->path, path);
+        lease->handle = handle;
+        lease->users = 0;
+    }
+    if (lease->users++ == 0) lease->thread = threadSerial();
+    pthread_mutex_unlock(&g_namespaceMutex);
+    return lease->handle;
+}
+
+// Returns the namespace to the pool; it stays loaded for the next instance.
+static void freeInnerLibrary(DLL_HANDLE handle) {
+    pthread_mutex_lock(&g_namespaceMutex);
+    for (size_t i = 0; i < g_namespaceCount; i++) {
+        if (g_namespaces[i].handle != handle) continue;
+        if (--g_namespaces[i].users == 0) g_namespaces[i].thread = 0;
+        break;
+    }
+    pthread_mutex_unlock(&g_namespaceMutex);
+}
+#else
+static DLL_HANDLE loadInnerLibrary(const char* path, const char** reason) {
+    *reason = "";
+    return LOAD_LIBRARY(path);
+}
+
+static void freeInnerLibrary(DLL_HANDLE handle) { FREE_LIBRARY(handle); }
+#endif
+
 // --- Value References for this wrapper FMU ---
 // These match the inner FMU for simplicity
 #define VR_U 0
@@ -135,16 +231,17 @@ fmi2Component fmi2Instantiate(fmi2String instanceName, fmi2Type fmuType, fmi2Str
     // The inner FMU is unzipped by the build script into "resources/Amplifier".
     snprintf(innerFmuPath, sizeof(innerFmuPath), "%s" SEP "Amplifier" SEP "binaries" SEP "%s" SEP "model%s", resourcePath, platform, lib_ext);
 
-    model->innerFMUHandle = LOAD_LIBRARY(innerFmuPath);
+    const char* loadError = "";
+    model->innerFMUHandle = loadInnerLibrary(innerFmuPath, &loadError);
     if (!model->innerFMUHandle) {
-        functions->logger(NULL, instanceName, fmi2Fatal, "error", "Could not load inner FMU binary: %s", innerFmuPath);
+        functions->logger(NULL, instanceName, fmi2Fatal, "error", "Could not load inner FMU binary: %s %s", innerFmuPath, loadError);
         functions->freeMemory(model);
         return NULL;
     }
 
     // --- 2. Load function pointers ---
     if (!loadInnerFmuFunctions(model)) {
-        FREE_LIBRARY(model->innerFMUHandle);
+        freeInnerLibrary(model->innerFMUHandle);
         functions->freeMemory(model);
         return NULL;
     }
@@ -160,7 +257,7 @@ fmi2Component fmi2Instantiate(fmi2String instanceName, fmi2Type fmuType, fmi2Str
                                                             innerResourcePath, functions, visible, loggingOn);
     if (!model->innerFMUInstance) {
         functions->logger(NULL, instanceName, fmi2Fatal, "error", "Failed to instantiate inner FMU.");
-        FREE_LIBRARY(model->innerFMUHandle);
+        freeInnerLibrary(model->innerFMUHandle);
         functions->freeMemory(model);
         return NULL;
     }
@@ -182,7 +279,7 @@ void fmi2FreeInstance(fmi2Component c) {
         model->functions.FreeInstance(model->innerFMUInstance);
     }
     if (model->innerFMUHandle) {
-        FREE_LIBRARY(model->innerFMUHandle);
+        freeInnerLibrary(model->innerFMUHandle);
     }
     model->callbacks->freeMemory(model);
 }
@@ -0,0 +1,177 @@
+/**
+ * @file RemoteProtocol.cpp
+ * @brief Socket helpers shared by the remote proxy FMU and proxy_server.
+ */
+#include "RemoteProtocol.hpp"
+
+#include <cerrno>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace remote {
+
+namespace {
+
+struct Address {
+    bool unixSocket = false;
+    std::string path; // Unix socket path
+    std::string host;
+    std::string port;
+};
+
+Address parseAddress(const std::string& address) {
+    Address parsed;
+    if (address.rfind("unix:", 0) == 0) {
+        parsed.unixSocket = true;
+        parsed.path = address.substr(5);
+        return parsed;
+    }
+    if (address.rfind("tcp://", 0) == 0) {
+        const std::string rest = address.substr(6);
+        const size_t colon = rest.rfind(':');
+        if (colon != std::string::npos && colon + 1 < rest.size()) {
+            parsed.host = rest.substr(0, colon);
+            parsed.port = rest.substr(colon + 1);
+            return parsed;
+        }
+    }
+    throw std::runtime_error("invalid address '" + address + "'; use tcp://host:port or unix:/path");
+}
+
+std::string lastError(const std::string& what) { return what + ": " + std::strerror(errno); }
+
+sockaddr_un unixAddress(const std::string& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) throw std::runtime_error("Unix socket path too long: " + path);
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return addr;
+}
+
+void setNoDelay(int fd) {
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // Fails harmlessly on Unix sockets.
+}
+
+// Resolves a TCP address and calls `use` on each candidate until it returns a socket.
+template <class Use>
+int withResolved(const Address& address, bool passive, Use use) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = passive ? AI_PASSIVE : 0;
+    addrinfo* results = nullptr;
+    const int rc = getaddrinfo(address.host.empty() ? nullptr : address.host.c_str(), address.port.c_str(), &hints, &results);
+    if (rc != 0) throw std::runtime_error("cannot resolve " + address.host + ": " + gai_strerror(rc));
+    int fd = -1;
+    std::string error = "no usable address";
+    for (addrinfo* ai = results; ai && fd < 0; ai = ai->ai_next) {
+        const int candidate = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (candidate < 0) continue;
+        if (use(candidate, ai)) {
+            fd = candidate;
+        } else {
+            error = lastError(address.host + ":" + address.port);
+            close(candidate);
+        }
+    }
+    freeaddrinfo(results);
+    if (fd < 0) throw std::runtime_error(error);
+    return fd;
+}
+
+} // namespace
+
+int connectTo(const std::string& text) {
+    const Address address = parseAddress(text);
+    if (address.unixSocket) {
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        const sockaddr_un addr = unixAddress(address.path);
+        if (fd < 0 || connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+            const std::string error = lastError("connect " + address.path);
+            if (fd >= 0) close(fd);
+            throw std::runtime_error(error);
+        }
+        return fd;
+    }
+    const int fd = withResolved(address, false, [](int fd, addrinfo* ai) { return connect(fd, ai->ai_addr, ai->ai_addrlen) == 0; });
+    setNoDelay(fd);
+    return fd;
+}
+
+int listenOn(const std::string& text) {
+    const Address address = parseAddress(text);
+    if (address.unixSocket) {
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        const sockaddr_un addr = unixAddress(address.path);
+        unlink(address.path.c_str());
+        if (fd < 0 || bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, 64) != 0) {
+            const std::string error = lastError("listen " + address.path);
+            if (fd >= 0) close(fd);
+            throw std::runtime_error(error);
+        }
+        return fd;
+    }
+    return withResolved(address, true, [](int fd, addrinfo* ai) {
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        return bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && listen(fd, 64) == 0;
+    });
+}
+
+int acceptFrom(int listener) {
+    int fd;
+    do {
+        fd = accept(listener, nullptr, nullptr);
+    } while (fd < 0 && errno == EINTR);
+    if (fd < 0) throw std::runtime_error(lastError("accept"));
+    setNoDelay(fd);
+    return fd;
+}
+
+void sendAll(int fd, const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t n = send(fd, p, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) throw std::runtime_error(lastError("send"));
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+}
+
+namespace {
+// Returns false if the peer closed the connection before the first byte.
+bool receiveAll(int fd, void* data, size_t size) {
+    char* p = static_cast<char*>(data);
+    const size_t total = size;
+    while (size > 0) {
+        const ssize_t n = recv(fd, p, size, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n == 0 && size == total) return false;
+        if (n <= 0) throw std::runtime_error(n == 0 ? std::string("connection closed mid-frame") : lastError("recv"));
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+} // namespace
+
+bool receiveFrame(int fd, std::vector<uint8_t>& payload) {
+    uint32_t length;
+    if (!receiveAll(fd, &length, sizeof(length))) return false;
+    if (length > MAX_FRAME_SIZE) throw ProtocolError("frame of " + std::to_string(length) + " bytes exceeds the limit");
+    payload.resize(length);
+    if (length > 0 && !receiveAll(fd, payload.data(), length)) throw std::runtime_error("connection closed mid-frame");
+    return true;
+}
+
+void closeSocket(int fd) {
+    if (fd >= 0) close(fd);
+}
+
+} // namespace remote
@@ -0,0 +1,149 @@
+/**
+ * @file RemoteProtocol.hpp
+ * @brief Binary protocol between the remote proxy FMU and proxy_server.
+ *
+ * Every message is a frame: a uint32 payload length followed by the payload. All integers
+ * and doubles are fixed-width little-endian, strings are a uint16 length plus bytes.
+ *
+ * Request payload:  uint8 op | sets | op arguments
+ *   sets:           uint16 n, n x (uint32 vr, float64)   -- Reals
+ *                   uint16 n, n x (uint32 vr, int32)     -- Integers
+ *                   uint16 n, n x (uint32 vr, uint8)     -- Booleans
+ * Reply payload:    uint8 fmi2Status | uint16 n, n x (uint8 status, string category, string message) | op results
+ *
+ * Values set on the proxy are buffered and travel in the sets block of the next request,
+ * where the server applies them before the operation. A step is therefore one round trip
+ * for set + doStep + get: the DoStep reply carries all Real variables. Replies arrive in
+ * request order, so the proxy may keep several DoStep requests in flight.
+ */
+#ifndef REMOTE_PROTOCOL_HPP
+#define REMOTE_PROTOCOL_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace remote {
+
+constexpr uint16_t PROTOCOL_VERSION = 1;
+constexpr uint32_t MAX_FRAME_SIZE = 64u << 20;
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "the wire format is little-endian; add byte swapping for this target");
+
+enum class Op : uint8_t {
+    Hello = 1,               // uint16 version, string instanceName, uint8 visible, uint8 loggingOn
+    SetupExperiment = 2,     // uint8 toleranceDefined, f64 tolerance, f64 startTime, uint8 stopTimeDefined, f64 stopTime
+    EnterInitializationMode = 3,
+    ExitInitializationMode = 4, // -> Reals
+    DoStep = 5,              // f64 currentCommunicationPoint, f64 communicationStepSize, uint8 noSetFMUStatePriorToCurrentPoint -> Reals
+    GetReal = 6,             // -> Reals
+    GetInteger = 7,          // uint16 n, n x uint32 vr -> n x int32
+    GetBoolean = 8,          // uint16 n, n x uint32 vr -> n x uint8
+    Terminate = 9,
+};
+// "Reals" is uint16 n followed by n float64 values, one per Real variable in model::Real order.
+
+class ProtocolError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/** @brief Builds one frame; the length prefix is filled in by finish(). */
+class FrameWriter {
+public:
+    FrameWriter() { m_bytes.resize(sizeof(uint32_t)); }
+
+    template <class T>
+    void put(T value) {
+        const size_t offset = m_bytes.size();
+        m_bytes.resize(offset + sizeof(T));
+        std::memcpy(m_bytes.data() + offset, &value, sizeof(T));
+    }
+
+    void putString(const std::string& text) {
+        const uint16_t length = static_cast<uint16_t>(std::min<size_t>(text.size(), UINT16_MAX));
+        put(length);
+        m_bytes.insert(m_bytes.end(), text.begin(), text.begin() + length);
+    }
+
+    /** @brief Reserves a uint16 count to be patched with setCount() once the entries are written. */
+    size_t placeCount() {
+        put<uint16_t>(0);
+        return m_bytes.size() - sizeof(uint16_t);
+    }
+
+    void setCount(size_t at, uint16_t count) { std::memcpy(m_bytes.data() + at, &count, sizeof(count)); }
+
+    const std::vector<uint8_t>& finish() {
+        const uint32_t length = static_cast<uint32_t>(m_bytes.size() - sizeof(uint32_t));
+        std::memcpy(m_bytes.data(), &length, sizeof(length));
+        return m_bytes;
+    }
+
+    /** @brief Appends the payload written to `other` so far. */
+    void append(const FrameWriter& other) { m_bytes.insert(m_bytes.end(), other.m_bytes.begin() + sizeof(uint32_t), other.m_bytes.end()); }
+
+    void clear() { m_bytes.resize(sizeof(uint32_t)); }
+
+private:
+    std::vector<uint8_t> m_bytes;
+};
+
+/** @brief Reads a frame payload; every read checks the remaining length. */
+class FrameReader {
+public:
+    FrameReader(const uint8_t* data, size_t size) : m_pos(data), m_end(data + size) {}
+
+    template <class T>
+    T get() {
+        T value;
+        need(sizeof(T));
+        std::memcpy(&value, m_pos, sizeof(T));
+        m_pos += sizeof(T);
+        return value;
+    }
+
+    std::string getString() {
+        const uint16_t length = get<uint16_t>();
+        need(length);
+        std::string text(reinterpret_cast<const char*>(m_pos), length);
+        m_pos += length;
+        return text;
+    }
+
+    bool atEnd() const { return m_pos == m_end; }
+
+private:
+    void need(size_t n) const {
+        if (static_cast<size_t>(m_end - m_pos) < n) throw ProtocolError("truncated frame");
+    }
+
+    const uint8_t* m_pos;
+    const uint8_t* m_end;
+};
+
+// --- Sockets (POSIX) ---
+// Addresses are tcp://host:port or unix:/path. All calls throw std::runtime_error on failure.
+
+/** @brief Connects to a listening server; TCP connections have Nagle's algorithm disabled. */
+int connectTo(const std::string& address);
+
+/** @brief Creates a listening socket; an existing Unix socket file is replaced. */
+int listenOn(const std::string& address);
+
+/** @brief Accepts one connection and disables Nagle's algorithm on TCP. */
+int acceptFrom(int listener);
+
+void sendAll(int fd, const void* data, size_t size);
+
+/** @brief Reads one frame's payload into `payload`; returns false on orderly shutdown before a frame. */
+bool receiveFrame(int fd, std::vector<uint8_t>& payload);
+
+void closeSocket(int fd);
+
+} // namespace remote
+
+#endif // REMOTE_PROTOCOL_HPP
@@ -0,0 +1,311 @@
+/**
+ * @file RemoteProxy.cpp
+ * @brief Implements the proxy FMU instance on top of the remote protocol.
+ */
+#include "RemoteProxy.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+// Converts a file URI (e.g. "file:///path/to/resources") to a filesystem path.
+std::string uriToPath(const char* uri) {
+    std::string path(uri ? uri : "");
+    const std::string scheme = "file://";
+    if (path.rfind(scheme, 0) == 0) path.erase(0, scheme.length());
+    return path;
+}
+
+fmi2Status worst(fmi2Status a, fmi2Status b) { return std::max(a, b); }
+
+struct IntegerResult { fmi2Integer* values; size_t count; };
+struct BooleanResult { fmi2Boolean* values; size_t count; };
+
+// Every count in a frame is a uint16.
+constexpr size_t MAX_FRAME_COUNT = UINT16_MAX;
+static_assert(model::Real::COUNT <= MAX_FRAME_COUNT, "the protocol sends one uint16 count for all Real variables");
+
+} // namespace
+
+RemoteProxy::RemoteProxy(fmi2String instanceName, fmi2String fmuResourceLocation, const fmi2CallbackFunctions* functions, fmi2Boolean visible, fmi2Boolean loggingOn)
+    : m_callbacks(functions), m_instanceName(instanceName) {
+    m_config = WrapperConfig::load(uriToPath(fmuResourceLocation) + "/proxy.cfg");
+    const std::string address = m_config.getString("remote.address", "tcp://127.0.0.1:9400");
+    m_pipelineDepth = static_cast<size_t>(std::max(1LL, m_config.getInt("remote.pipeline_depth", 1)));
+
+    m_socket = remote::connectTo(address);
+    log(fmi2OK, "info", "Connected to " + address + ", pipeline depth " + std::to_string(m_pipelineDepth));
+
+    // The server instantiates the wrapper with its own resources; only the instance settings travel.
+    beginRequest(remote::Op::Hello);
+    m_request.put<uint16_t>(remote::PROTOCOL_VERSION);
+    m_request.putString(m_instanceName);
+    m_request.put<uint8_t>(visible ? 1 : 0);
+    m_request.put<uint8_t>(loggingOn ? 1 : 0);
+    fmi2Status status;
+    try {
+        status = call();
+    } catch (...) {
+        remote::closeSocket(m_socket);
+        throw;
+    }
+    if (status > fmi2Warning) {
+        remote::closeSocket(m_socket);
+        throw std::runtime_error("The server failed to instantiate the wrapper.");
+    }
+}
+
+// Closing the connection makes the server free its wrapper instance.
+RemoteProxy::~RemoteProxy() { remote::closeSocket(m_socket); }
+
+void RemoteProxy::log(fmi2Status status, const std::string& category, const std::string& message) {
+    if (m_callbacks && m_callbacks->logger) {
+        m_callbacks->logger(m_callbacks->componentEnvironment, m_instanceName.c_str(), status, category.c_str(), "%s", message.c_str());
+    }
+}
+
+fmi2Status RemoteProxy::fail(const std::string& message) {
+    m_broken = true;
+    remote::closeSocket(m_socket);
+    m_socket = -1;
+    log(fmi2Fatal, "remote", message);
+    return fmi2Fatal;
+}
+
+// --- Request plumbing ---
+
+void RemoteProxy::beginRequest(remote::Op op) {
+    m_request.clear();
+    m_request.put(static_cast<uint8_t>(op));
+    m_request.put(static_cast<uint16_t>(m_pendingReals.size()));
+    for (const auto& set : m_pendingReals) { m_request.put<uint32_t>(set.first); m_request.put<double>(set.second); }
+    m_request.put(static_cast<uint16_t>(m_pendingIntegers.size()));
+    for (const auto& set : m_pendingIntegers) { m_request.put<uint32_t>(set.first); m_request.put<int32_t>(set.second); }
+    m_request.put(static_cast<uint16_t>(m_pendingBooleans.size()));
+    for (const auto& set : m_pendingBooleans) { m_request.put<uint32_t>(set.first); m_request.put<uint8_t>(set.second ? 1 : 0); }
+    m_pendingReals.clear();
+    m_pendingIntegers.clear();
+    m_pendingBooleans.clear();
+}
+
+void RemoteProxy::sendRequest(ResultReader reader, void* out) {
+    const std::vector<uint8_t>& frame = m_request.finish();
+    remote::sendAll(m_socket, frame.data(), frame.size());
+    m_outstanding.push_back({reader, out});
+}
+
+fmi2Status RemoteProxy::readReply() {
+    if (!remote::receiveFrame(m_socket, m_reply)) throw std::runtime_error("the server closed the connection");
+    const Outstanding pending = m_outstanding.front();
+    m_outstanding.erase(m_outstanding.begin());
+
+    remote::FrameReader reader(m_reply.data(), m_reply.size());
+    const fmi2Status status = static_cast<fmi2Status>(reader.get<uint8_t>());
+    const uint16_t logCount = reader.get<uint16_t>();
+    for (uint16_t i = 0; i < logCount; i++) {
+        const fmi2Status logStatus = static_cast<fmi2Status>(reader.get<uint8_t>());
+        const std::string category = reader.getString();
+        log(logStatus, category, reader.getString());
+    }
+    // Results are only sent when the operation succeeded.
+    if (pending.reader && status <= fmi2Warning) pending.reader(*this, reader, pending.out);
+    if (!reader.atEnd()) throw remote::ProtocolError("unexpected bytes at the end of a reply");
+    return status;
+}
+
+template <class Value>
+fmi2Status RemoteProxy::queueSets(const char* function, std::map<fmi2ValueReference, Value>& pending,
+                                  const fmi2ValueReference vr[], size_t nvr, const Value value[]) {
+    fmi2Status status = fmi2OK;
+    for (size_t i = 0; i < nvr; i++) {
+        if (pending.size() == MAX_FRAME_COUNT && pending.count(vr[i]) == 0) {
+            // GetReal only reads, so it can carry the full buffer on its own. The server applies
+            // every set even if some fail, so the rest are still queued after an error.
+            try {
+                beginRequest(remote::Op::GetReal);
+                status = worst(status, call(&RemoteProxy::readReals));
+            } catch (const std::exception& e) {
+                return fail(std::string(function) + ": " + e.what());
+            }
+        }
+        pending[vr[i]] = value[i];
+    }
+    return status;
+}
+
+fmi2Status RemoteProxy::drain() {
+    while (!m_outstanding.empty()) m_deferredStatus = worst(m_deferredStatus, readReply());
+    return m_deferredStatus;
+}
+
+fmi2Status RemoteProxy::call(ResultReader reader, void* out) {
+    sendRequest(reader, out);
+    while (m_outstanding.size() > 1) m_deferredStatus = worst(m_deferredStatus, readReply());
+    return readReply();
+}
+
+void RemoteProxy::readReals(RemoteProxy& self, remote::FrameReader& reader, void*) {
+    if (reader.get<uint16_t>() != model::Real::COUNT) throw remote::ProtocolError("the server's Real variables do not match this FMU");
+    for (fmi2Real& value : self.m_reals) value = reader.get<double>();
+    // Values set after this reply's request are newer than the server's copy.
+    for (const auto& set : self.m_pendingReals) model::Dispatch<model::Real>::set(self.m_reals, &set.first, 1, &set.second);
+    self.m_realsValid = true;
+}
+
+// --- FMI API ---
+
+// Reals are validated against the generated tables; the set travels with the next request.
+fmi2Status RemoteProxy::setReal(const fmi2ValueReference vr[], size_t nvr, const fmi2Real value[]) {
+    if (m_broken) return fmi2Fatal;
+    if (!model::Dispatch<model::Real>::set(m_reals, vr, nvr, value)) {
+        log(fmi2Error, "error", "setReal: unknown or read-only value reference");
+        return fmi2Error;
+    }
+    // Dispatch accepted every reference, so there are at most model::Real::COUNT distinct ones.
+    for (size_t i = 0; i < nvr; i++) m_pendingReals[vr[i]] = value[i];
+    return fmi2OK;
+}
+
+fmi2Status RemoteProxy::getReal(const fmi2ValueReference vr[], size_t nvr, fmi2Real value[]) {
+    if (m_broken) return fmi2Fatal;
+    try {
+        drain();
+        if (!m_realsValid) {
+            beginRequest(remote::Op::GetReal);
+            const fmi2Status status = call(&RemoteProxy::readReals);
+            if (status > fmi2Warning) return status;
+        }
+    } catch (const std::exception& e) {
+        return fail(std::string("getReal: ") + e.what());
+    }
+    if (!model::Dispatch<model::Real>::get(m_reals, vr, nvr, value)) {
+        log(fmi2Error, "error", "getReal: unknown value reference");
+        return fmi2Error;
+    }
+    return fmi2OK;
+}
+
+// Integers and Booleans are checked by the server, so a bad set is reported by the next call.
+fmi2Status RemoteProxy::setInteger(const fmi2ValueReference vr[], size_t nvr, const fmi2Integer value[]) {
+    if (m_broken) return fmi2Fatal;
+    return queueSets("setInteger", m_pendingIntegers, vr, nvr, value);
+}
+
+fmi2Status RemoteProxy::setBoolean(const fmi2ValueReference vr[], size_t nvr, const fmi2Boolean value[]) {
+    if (m_broken) return fmi2Fatal;
+    return queueSets("setBoolean", m_pendingBooleans, vr, nvr, value);
+}
+
+// Requests larger than a frame's uint16 count are split; the first failing part ends the call.
+fmi2Status RemoteProxy::getInteger(const fmi2ValueReference vr[], size_t nvr, fmi2Integer value[]) {
+    if (m_broken) return fmi2Fatal;
+    try {
+        drain();
+        fmi2Status status = fmi2OK;
+        for (size_t first = 0; first < nvr || first == 0; first += MAX_FRAME_COUNT) {
+            const size_t count = std::min(nvr - first, MAX_FRAME_COUNT);
+            beginRequest(remote::Op::GetInteger);
+            m_request.put(static_cast<uint16_t>(count));
+            for (size_t i = first; i < first + count; i++) m_request.put<uint32_t>(vr[i]);
+            IntegerResult result{value + first, count};
+            status = worst(status, call([](RemoteProxy&, remote::FrameReader& reader, void* out) {
+                auto* result = static_cast<IntegerResult*>(out);
+                for (size_t i = 0; i < result->count; i++) result->values[i] = reader.get<int32_t>();
+            }, &result));
+            if (status > fmi2Warning || count == 0) break;
+        }
+        return status;
+    } catch (const std::exception& e) {
+        return fail(std::string("getInteger: ") + e.what());
+    }
+}
+
+fmi2Status RemoteProxy::getBoolean(const fmi2ValueReference vr[], size_t nvr, fmi2Boolean value[]) {
+    if (m_broken) return fmi2Fatal;
+    try {
+        drain();
+        fmi2Status status = fmi2OK;
+        for (size_t first = 0; first < nvr || first == 0; first += MAX_FRAME_COUNT) {
+            const size_t count = std::min(nvr - first, MAX_FRAME_COUNT);
+            beginRequest(remote::Op::GetBoolean);
+            m_request.put(static_cast<uint16_t>(count));
+            for (size_t i = first; i < first + count; i++) m_request.put<uint32_t>(vr[i]);
+            BooleanResult result{value + first, count};
+            status = worst(status, call([](RemoteProxy&, remote::FrameReader& reader, void* out) {
+                auto* result = static_cast<BooleanResult*>(out);
+                for (size_t i = 0; i < result->count; i++) result->values[i] = reader.get<uint8_t>() ? fmi2True : fmi2False;
+            }, &result));
+            if (status > fmi2Warning || count == 0) break;
+        }
+        return status;
+    } catch (const std::exception& e) {
+        return fail(std::string("getBoolean: ") + e.what());
+    }
+}
+
+fmi2Status RemoteProxy::setupExperiment(fmi2Boolean tolDef, fmi2Real tol, fmi2Real start, fmi2Boolean stopDef, fmi2Real stop) {
+    if (m_broken) return fmi2Fatal;
+    try {
+        beginRequest(remote::Op::SetupExperiment);
+        m_request.put<uint8_t>(tolDef ? 1 : 0);
+        m_request.put<double>(tol);
+        m_request.put<double>(start);
+        m_request.put<uint8_t>(stopDef ? 1 : 0);
+        m_request.put<double>(stop);
+        return call();
+    } catch (const std::exception& e) {
+        return fail(std::string("setupExperiment: ") + e.what());
+    }
+}
+
+fmi2Status RemoteProxy::enterInitializationMode() {
+    if (m_broken) return fmi2Fatal;
+    try {
+        beginRequest(remote::Op::EnterInitializationMode);
+        return call();
+    } catch (const std::exception& e) {
+        return fail(std::string("enterInitializationMode: ") + e.what());
+    }
+}
+
+fmi2Status RemoteProxy::exitInitializationMode() {
+    if (m_broken) return fmi2Fatal;
+    try {
+        beginRequest(remote::Op::ExitInitializationMode);
+        return call(&RemoteProxy::readReals);
+    } catch (const std::exception& e) {
+        return fail(std::string("exitInitializationMode: ") + e.what());
+    }
+}
+
+// One frame carries the buffered sets and the step; the reply carries every Real.
+fmi2Status RemoteProxy::doStep(fmi2Real time, fmi2Real step, fmi2Boolean noSet) {
+    if (m_broken) return fmi2Fatal;
+    try {
+        beginRequest(remote::Op::DoStep);
+        m_request.put<double>(time);
+        m_request.put<double>(step);
+        m_request.put<uint8_t>(noSet ? 1 : 0);
+        sendRequest(&RemoteProxy::readReals, nullptr);
+        while (m_outstanding.size() >= m_pipelineDepth) m_deferredStatus = worst(m_deferredStatus, readReply());
+    } catch (const std::exception& e) {
+        return fail(std::string("doStep: ") + e.what());
+    }
+    const fmi2Status status = m_deferredStatus;
+    m_deferredStatus = fmi2OK;
+    return status;
+}
+
+fmi2Status RemoteProxy::terminate() {
+    if (m_broken) return fmi2Fatal;
+    try {
+        beginRequest(remote::Op::Terminate);
+        const fmi2Status status = call();
+        const fmi2Status deferred = m_deferredStatus;
+        m_deferredStatus = fmi2OK;
+        return worst(status, deferred);
+    } catch (const std::exception& e) {
+        return fail(std::string("terminate: ") + e.what());
+    }
+}
@@ -0,0 +1,105 @@
+/**
+ * @file RemoteProxy.hpp
+ * @brief The proxy FMU instance: forwards FMI 2.0 calls to a FaultWrapper in proxy_server.
+ *
+ * The proxy exposes the wrapper's variables (model::Real from the wrapper's ModelBindings.hpp)
+ * and keeps a local copy of them. Sets are validated locally and buffered until the next
+ * request, and every DoStep reply refreshes all Reals, so the usual set / doStep / get
+ * sequence costs one round trip. With `remote.pipeline_depth` > 1, doStep returns before
+ * its reply arrives and up to that many steps stay in flight; this pays off when the
+ * inputs are known ahead (e.g. a native signal source on the server) and outputs are read
+ * only occasionally. A get drains all outstanding replies first, and an error reported
+ * by a pipelined step is returned by the next doStep.
+ */
+#ifndef REMOTE_PROXY_HPP
+#define REMOTE_PROXY_HPP
+
+#include <map>
+#include <string>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include "fmi2Functions.h"
+}
+
+#include "ModelBindings.hpp"
+#include "RemoteProtocol.hpp"
+#include "WrapperConfig.hpp"
+
+/**
+ * @class RemoteProxy
+ * @brief One connection to proxy_server, which hosts one FaultWrapper instance for it.
+ */
+class RemoteProxy {
+public:
+    /**
+     * @brief Connects to the server named by `remote.address` in resources/proxy.cfg and instantiates the remote wrapper.
+     * @throws std::runtime_error if the server cannot be reached or the remote instantiation fails.
+     */
+    RemoteProxy(fmi2String instanceName, fmi2String fmuResourceLocation, const fmi2CallbackFunctions* functions, fmi2Boolean visible, fmi2Boolean loggingOn);
+    ~RemoteProxy();
+
+    RemoteProxy(const RemoteProxy&) = delete;
+    RemoteProxy& operator=(const RemoteProxy&) = delete;
+
+    fmi2Status setReal(const fmi2ValueReference vr[], size_t nvr, const fmi2Real value[]);
+    fmi2Status getReal(const fmi2ValueReference vr[], size_t nvr, fmi2Real value[]);
+    fmi2Status setInteger(const fmi2ValueReference vr[], size_t nvr, const fmi2Integer value[]);
+    fmi2Status getInteger(const fmi2ValueReference vr[], size_t nvr, fmi2Integer value[]);
+    fmi2Status setBoolean(const fmi2ValueReference vr[], size_t nvr, const fmi2Boolean value[]);
+    fmi2Status getBoolean(const fmi2ValueReference vr[], size_t nvr, fmi2Boolean value[]);
+    fmi2Status setupExperiment(fmi2Boolean toleranceDefined, fmi2Real tolerance, fmi2Real startTime, fmi2Boolean stopTimeDefined, fmi2Real stopTime);
+    fmi2Status enterInitializationMode();
+    fmi2Status exitInitializationMode();
+    fmi2Status doStep(fmi2Real currentCommunicationPoint, fmi2Real communicationStepSize, fmi2Boolean noSetFMUStatePriorToCurrentPoint);
+    fmi2Status terminate();
+
+    const fmi2CallbackFunctions* getCallbacks() const { return m_callbacks; }
+
+private:
+    using ResultReader = void (*)(RemoteProxy& self, remote::FrameReader& reader, void* out);
+
+    // Starts a request frame: op plus the buffered sets, which are then cleared.
+    void beginRequest(remote::Op op);
+    // Sends the request built in m_request; the reply is read later by readReply().
+    void sendRequest(ResultReader reader, void* out);
+    // Reads the oldest outstanding reply, forwards its log records and applies its results.
+    fmi2Status readReply();
+    // Sends the request and waits for its reply (and every earlier one).
+    fmi2Status call(ResultReader reader = nullptr, void* out = nullptr);
+    // Waits for all pipelined steps; returns the worst status among them.
+    fmi2Status drain();
+    fmi2Status fail(const std::string& message);
+    // Buffers sets of a type the server checks; sends the buffer early if its count would overflow.
+    template <class Value>
+    fmi2Status queueSets(const char* function, std::map<fmi2ValueReference, Value>& pending,
+                         const fmi2ValueReference vr[], size_t nvr, const Value value[]);
+
+    static void readReals(RemoteProxy& self, remote::FrameReader& reader, void* out);
+
+    void log(fmi2Status status, const std::string& category, const std::string& message);
+
+    const fmi2CallbackFunctions* m_callbacks;
+    std::string m_instanceName;
+    WrapperConfig m_config;
+    int m_socket = -1;
+    bool m_broken = false;                                  // Set after a transport or protocol error; all calls fail.
+    size_t m_pipelineDepth = 1;
+
+    model::Bank<model::Real> m_reals = model::startValues<model::Real>();
+    bool m_realsValid = false;                              // m_reals mirrors the server (after a reply carried them).
+    // Sets not sent yet, latest value per value reference; each travels as a uint16 count.
+    std::map<fmi2ValueReference, fmi2Real> m_pendingReals;
+    std::map<fmi2ValueReference, fmi2Integer> m_pendingIntegers;
+    std::map<fmi2ValueReference, fmi2Boolean> m_pendingBooleans;
+
+    remote::FrameWriter m_request;
+    std::vector<uint8_t> m_reply;
+    struct Outstanding { ResultReader reader; void* out; };
+    std::vector<Outstanding> m_outstanding;                 // Replies not read yet, oldest first.
+    fmi2Status m_deferredStatus = fmi2OK;                   // Worst status of pipelined steps not yet reported.
+};
+
+#endif // REMOTE_PROXY_HPP
@@ -0,0 +1,78 @@
+#!/bin/bash
+
+set -e
+
+FMU_NAME="Amplifier_Remote_Proxy"
+PROXY_SOURCES="proxy_adapter.cpp RemoteProxy.cpp RemoteProtocol.cpp ../FMU_CPP_Wrapper/WrapperConfig.cpp"
+SERVER_SOURCES="proxy_server.cpp RemoteProtocol.cpp"
+PROXY_CONFIG="proxy.cfg"
+# The proxy exposes the wrapper's variables, so it shares the wrapper's model description and bindings.
+WRAPPER_DIR="../FMU_CPP_Wrapper"
+
+echo "--- Starting Remote Proxy FMU Build Process ---"
+
+# 1. Check for required tools
+command -v g++ >/dev/null 2>&1 || { echo >&2 "Build failed: 'g++' not found."; exit 1; }
+command -v zip >/dev/null 2>&1 || { echo >&2 "Build failed: 'zip' not found."; exit 1; }
+
+# 2. Setup build directory
+BUILD_DIR="build_temp_proxy"
+rm -rf ${BUILD_DIR}
+mkdir -p ${BUILD_DIR}/binaries
+mkdir -p ${BUILD_DIR}/resources
+
+# 3. Determine platform and compile
+PLATFORM_DIR=""
+SHARED_LIB_EXT=""
+if [[ "$OSTYPE" == "linux-gnu"* ]]; then
+    PLATFORM_DIR="linux64"
+    SHARED_LIB_EXT=".so"
+elif [[ "$OSTYPE" == "darwin"* ]]; then
+    PLATFORM_DIR="darwin64"
+    SHARED_LIB_EXT=".dylib"
+else
+    # The transport uses POSIX sockets.
+    echo "Unsupported OS: $OSTYPE"
+    exit 1
+fi
+
+mkdir -p "${BUILD_DIR}/binaries/${PLATFORM_DIR}"
+
+if command -v python3 >/dev/null 2>&1; then
+    python3 ../generate_model_bindings.py "${WRAPPER_DIR}/modelDescription.xml" "${WRAPPER_DIR}/ModelBindings.hpp"
+fi
+
+echo "Compiling for platform: ${PLATFORM_DIR}"
+INCLUDE_FLAGS="-I. -I${WRAPPER_DIR}"
+EXPORT_FLAGS="-fvisibility=hidden -fvisibility-inlines-hidden"
+if [[ "${PLATFORM_DIR}" == "linux64" ]]; then
+    EXPORT_FLAGS="${EXPORT_FLAGS} -Wl,--version-script=${WRAPPER_DIR}/fault_wrapper.map"
+fi
+g++ -shared -fPIC -std=c++17 -O2 ${EXPORT_FLAGS} ${INCLUDE_FLAGS} ${PROXY_SOURCES} -o "${BUILD_DIR}/binaries/${PLATFORM_DIR}/remote_proxy${SHARED_LIB_EXT}"
+# The server runs next to the unpacked wrapper FMU on the host that holds the model license.
+g++ -std=c++17 -O2 ${INCLUDE_FLAGS} ${SERVER_SOURCES} -o proxy_server -lpthread -ldl
+echo "Compilation successful."
+
+# 4. The proxy's model description is the wrapper's with the proxy's model identifier.
+sed -e 's/fault_wrapper/remote_proxy/g' -e 's/description="A C++ wrapper/description="A remote proxy for a C++ wrapper/' \
+    "${WRAPPER_DIR}/modelDescription.xml" > "${BUILD_DIR}/modelDescription.xml"
+if [ -f "${PROXY_CONFIG}" ]; then
+    cp "${PROXY_CONFIG}" "${BUILD_DIR}/resources/"
+fi
+
+# 5. Create the final FMU zip archive
+OUTPUT_FMU="../${FMU_NAME}.fmu"
+if [ -f "${OUTPUT_FMU}" ]; then
+    rm "${OUTPUT_FMU}"
+fi
+
+echo "Creating FMU archive: ${OUTPUT_FMU}"
+cd ${BUILD_DIR}
+zip -r "${OUTPUT_FMU}" .
+cd ..
+
+rm -rf ${BUILD_DIR}
+
+echo "--- Build Process Finished Successfully! ---"
+echo "Your proxy FMU is ready: ${OUTPUT_FMU}"
+echo "Start the server next to the unpacked wrapper FMU: ./proxy_server --fmu-dir <dir> --listen tcp://0.0.0.0:9400"
@@ -0,0 +1,293 @@
+/**
+ * @file proxy_server.cpp
+ * @brief Hosts FaultWrapper instances for remote proxy FMUs (see RemoteProtocol.hpp).
+ *
+ * Loads the wrapper binary from an unpacked wrapper FMU once, then serves every incoming
+ * connection on its own thread with its own wrapper instance. The wrapper sees the FMU's
+ * resources directory on this host, so its wrapper.cfg, plugins and the licensed inner
+ * model all stay here. Log messages of an instance are returned with the next reply on
+ * its connection. Closing the connection frees the instance.
+ *
+ * Usage: proxy_server --fmu-dir <unpacked wrapper FMU> [--listen tcp://0.0.0.0:9400 | unix:/path]
+ *            [--model-identifier fault_wrapper]
+ */
+#include "RemoteProtocol.hpp"
+
+extern "C" {
+#include "fmi2Functions.h"
+}
+
+#include "ModelBindings.hpp"
+#include "PlatformLibrary.hpp"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// The wrapper functions the server calls, resolved once at startup.
+struct WrapperApi {
+    fmi2InstantiateTYPE* Instantiate = nullptr;
+    fmi2FreeInstanceTYPE* FreeInstance = nullptr;
+    fmi2SetupExperimentTYPE* SetupExperiment = nullptr;
+    fmi2EnterInitializationModeTYPE* EnterInitializationMode = nullptr;
+    fmi2ExitInitializationModeTYPE* ExitInitializationMode = nullptr;
+    fmi2TerminateTYPE* Terminate = nullptr;
+    fmi2GetRealTYPE* GetReal = nullptr;
+    fmi2SetRealTYPE* SetReal = nullptr;
+    fmi2GetIntegerTYPE* GetInteger = nullptr;
+    fmi2SetIntegerTYPE* SetInteger = nullptr;
+    fmi2GetBooleanTYPE* GetBoolean = nullptr;
+    fmi2SetBooleanTYPE* SetBoolean = nullptr;
+    fmi2DoStepTYPE* DoStep = nullptr;
+
+    void load(DLL_HANDLE library) {
+#define LOAD_FUNC(Name)                                                                 \
+    Name = (fmi2##Name##TYPE*)GET_FUNCTION(library, "fmi2" #Name);                     \
+    if (!Name) throw std::runtime_error("Failed to load function: fmi2" #Name);
+        LOAD_FUNC(Instantiate); LOAD_FUNC(FreeInstance); LOAD_FUNC(SetupExperiment);
+        LOAD_FUNC(EnterInitializationMode); LOAD_FUNC(ExitInitializationMode); LOAD_FUNC(Terminate);
+        LOAD_FUNC(GetReal); LOAD_FUNC(SetReal); LOAD_FUNC(GetInteger); LOAD_FUNC(SetInteger);
+        LOAD_FUNC(GetBoolean); LOAD_FUNC(SetBoolean); LOAD_FUNC(DoStep);
+#undef LOAD_FUNC
+    }
+};
+
+struct ServerOptions {
+    std::string fmuDir;
+    std::string listen = "tcp://0.0.0.0:9400";
+    std::string modelIdentifier = "fault_wrapper";
+};
+
+fmi2Status worst(fmi2Status a, fmi2Status b) { return a > b ? a : b; }
+
+// Value references of all Reals in bank order; every Reals result lists them in this order.
+constexpr std::array<fmi2ValueReference, model::Real::COUNT> realVrs() {
+    std::array<fmi2ValueReference, model::Real::COUNT> vrs{};
+    for (size_t i = 0; i < model::Real::COUNT; i++) vrs[model::Real::VARIABLES[i].index] = model::Real::VARIABLES[i].valueReference;
+    return vrs;
+}
+constexpr auto REAL_VRS = realVrs();
+
+/**
+ * @class Session
+ * @brief One proxy connection and the wrapper instance it owns.
+ */
+class Session {
+public:
+    Session(const WrapperApi& api, const ServerOptions& options, int socket) : m_api(api), m_options(options), m_socket(socket) {
+        m_callbacks.logger = &Session::logger;
+        m_callbacks.allocateMemory = std::calloc;
+        m_callbacks.freeMemory = std::free;
+        m_callbacks.componentEnvironment = this;
+    }
+
+    ~Session() {
+        if (m_instance) m_api.FreeInstance(m_instance);
+        remote::closeSocket(m_socket);
+    }
+
+    void serve() {
+        std::vector<uint8_t> request;
+        while (remote::receiveFrame(m_socket, request)) {
+            remote::FrameReader reader(request.data(), request.size());
+            m_reply.clear();
+            m_results.clear();
+            const fmi2Status status = handle(reader);
+            if (!reader.atEnd()) throw remote::ProtocolError("unexpected bytes at the end of a request");
+            sendReply(status);
+        }
+    }
+
+private:
+    // Wrapper log messages may come from its worker threads, so they are collected under a lock.
+    static void logger(fmi2ComponentEnvironment env, fmi2String, fmi2Status status, fmi2String category, fmi2String message, ...) {
+        char text[1024];
+        va_list args;
+        va_start(args, message);
+        std::vsnprintf(text, sizeof(text), message, args);
+        va_end(args);
+        auto* self = static_cast<Session*>(env);
+        std::lock_guard<std::mutex> lock(self->m_logMutex);
+        self->m_logs.push_back({status, category ? category : "", text});
+    }
+
+    fmi2Status handle(remote::FrameReader& reader) {
+        const auto op = static_cast<remote::Op>(reader.get<uint8_t>());
+        fmi2Status status = applySets(reader);
+        if (op == remote::Op::Hello) return hello(reader);
+        if (!m_instance) throw remote::ProtocolError("request before Hello");
+
+        switch (op) {
+        case remote::Op::SetupExperiment: {
+            const uint8_t tolDef = reader.get<uint8_t>();
+            const double tol = reader.get<double>(), start = reader.get<double>();
+            const uint8_t stopDef = reader.get<uint8_t>();
+            const double stop = reader.get<double>();
+            if (status > fmi2Warning) return status;
+            return worst(status, m_api.SetupExperiment(m_instance, tolDef, tol, start, stopDef, stop));
+        }
+        case remote::Op::EnterInitializationMode:
+            if (status > fmi2Warning) return status;
+            return worst(status, m_api.EnterInitializationMode(m_instance));
+        case remote::Op::ExitInitializationMode:
+            if (status > fmi2Warning) return status;
+            status = worst(status, m_api.ExitInitializationMode(m_instance));
+            return status > fmi2Warning ? status : putReals(status);
+        case remote::Op::DoStep: {
+            const double time = reader.get<double>(), step = reader.get<double>();
+            const uint8_t noSet = reader.get<uint8_t>();
+            if (status > fmi2Warning) return status;
+            status = worst(status, m_api.DoStep(m_instance, time, step, noSet ? fmi2True : fmi2False));
+            return status > fmi2Warning ? status : putReals(status);
+        }
+        case remote::Op::GetReal:
+            return status > fmi2Warning ? status : putReals(status);
+        case remote::Op::GetInteger:
+        case remote::Op::GetBoolean: {
+            std::vector<fmi2ValueReference> vrs(reader.get<uint16_t>());
+            for (fmi2ValueReference& vr : vrs) vr = reader.get<uint32_t>();
+            if (status > fmi2Warning) return status;
+            std::vector<fmi2Integer> values(vrs.size());
+            status = worst(status, op == remote::Op::GetInteger ? m_api.GetInteger(m_instance, vrs.data(), vrs.size(), values.data())
+                                                                : m_api.GetBoolean(m_instance, vrs.data(), vrs.size(), values.data()));
+            if (status > fmi2Warning) return status;
+            for (fmi2Integer value : values) {
+                if (op == remote::Op::GetInteger) m_results.put<int32_t>(value);
+                else m_results.put<uint8_t>(value ? 1 : 0);
+            }
+            return status;
+        }
+        case remote::Op::Terminate:
+            if (status > fmi2Warning) return status;
+            return worst(status, m_api.Terminate(m_instance));
+        default:
+            throw remote::ProtocolError("unknown operation " + std::to_string(static_cast<int>(op)));
+        }
+    }
+
+    fmi2Status hello(remote::FrameReader& reader) {
+        const uint16_t version = reader.get<uint16_t>();
+        const std::string instanceName = reader.getString();
+        const uint8_t visible = reader.get<uint8_t>(), loggingOn = reader.get<uint8_t>();
+        if (m_instance) throw remote::ProtocolError("duplicate Hello");
+        if (version != remote::PROTOCOL_VERSION) {
+            logger(this, "", fmi2Fatal, "remote", "protocol version %u is not supported (server speaks %u)", version, remote::PROTOCOL_VERSION);
+            return fmi2Fatal;
+        }
+        const std::string resources = "file://" + m_options.fmuDir + "/resources";
+        m_instance = m_api.Instantiate(instanceName.c_str(), fmi2CoSimulation, "", resources.c_str(), &m_callbacks,
+                                       visible ? fmi2True : fmi2False, loggingOn ? fmi2True : fmi2False);
+        return m_instance ? fmi2OK : fmi2Fatal;
+    }
+
+    // Sets are applied in every request, even if they fail, so the reader stays in sync.
+    fmi2Status applySets(remote::FrameReader& reader) {
+        fmi2Status status = fmi2OK;
+        std::vector<fmi2ValueReference> vrs(reader.get<uint16_t>());
+        std::vector<fmi2Real> reals(vrs.size());
+        for (size_t i = 0; i < vrs.size(); i++) { vrs[i] = reader.get<uint32_t>(); reals[i] = reader.get<double>(); }
+        if (!vrs.empty() && m_instance) status = worst(status, m_api.SetReal(m_instance, vrs.data(), vrs.size(), reals.data()));
+
+        vrs.resize(reader.get<uint16_t>());
+        std::vector<fmi2Integer> integers(vrs.size());
+        for (size_t i = 0; i < vrs.size(); i++) { vrs[i] = reader.get<uint32_t>(); integers[i] = reader.get<int32_t>(); }
+        if (!vrs.empty() && m_instance) status = worst(status, m_api.SetInteger(m_instance, vrs.data(), vrs.size(), integers.data()));
+
+        vrs.resize(reader.get<uint16_t>());
+        std::vector<fmi2Boolean> booleans(vrs.size());
+        for (size_t i = 0; i < vrs.size(); i++) { vrs[i] = reader.get<uint32_t>(); booleans[i] = reader.get<uint8_t>() ? fmi2True : fmi2False; }
+        if (!vrs.empty() && m_instance) status = worst(status, m_api.SetBoolean(m_instance, vrs.data(), vrs.size(), booleans.data()));
+        return status;
+    }
+
+    fmi2Status putReals(fmi2Status status) {
+        std::array<fmi2Real, model::Real::COUNT> values{};
+        const fmi2Status getStatus = m_api.GetReal(m_instance, REAL_VRS.data(), REAL_VRS.size(), values.data());
+        if (getStatus > fmi2Warning) return getStatus;
+        m_results.put(static_cast<uint16_t>(values.size()));
+        for (fmi2Real value : values) m_results.put<double>(value);
+        return worst(status, getStatus);
+    }
+
+    void sendReply(fmi2Status status) {
+        m_reply.put(static_cast<uint8_t>(status));
+        {
+            std::lock_guard<std::mutex> lock(m_logMutex);
+            m_reply.put(static_cast<uint16_t>(std::min<size_t>(m_logs.size(), UINT16_MAX)));
+            for (size_t i = 0; i < m_logs.size() && i < UINT16_MAX; i++) {
+                m_reply.put(static_cast<uint8_t>(m_logs[i].status));
+                m_reply.putString(m_logs[i].category);
+                m_reply.putString(m_logs[i].message);
+            }
+            m_logs.clear();
+        }
+        // The results were written before all log records were known, so they go last.
+        m_reply.append(m_results);
+        const std::vector<uint8_t>& frame = m_reply.finish();
+        remote::sendAll(m_socket, frame.data(), frame.size());
+    }
+
+    struct LogRecord { fmi2Status status; std::string category; std::string message; };
+
+    const WrapperApi& m_api;
+    const ServerOptions& m_options;
+    int m_socket;
+    fmi2CallbackFunctions m_callbacks{};
+    fmi2Component m_instance = nullptr;
+    remote::FrameWriter m_reply;
+    remote::FrameWriter m_results;
+    std::mutex m_logMutex;
+    std::vector<LogRecord> m_logs;
+};
+
+ServerOptions parseOptions(int argc, char** argv) {
+    ServerOptions options;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc) throw std::runtime_error("missing value for " + arg);
+        if (arg == "--fmu-dir") options.fmuDir = argv[++i];
+        else if (arg == "--listen") options.listen = argv[++i];
+        else if (arg == "--model-identifier") options.modelIdentifier = argv[++i];
+        else throw std::runtime_error("unknown option " + arg);
+    }
+    if (options.fmuDir.empty()) throw std::runtime_error("usage: proxy_server --fmu-dir <unpacked wrapper FMU> [--listen address] [--model-identifier id]");
+    return options;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        const ServerOptions options = parseOptions(argc, argv);
+#if defined(__APPLE__)
+        const std::string platform = "darwin64";
+#else
+        const std::string platform = "linux64";
+#endif
+        const std::string libraryPath = options.fmuDir + SEP "binaries" SEP + platform + SEP + options.modelIdentifier + LIB_EXT;
+        DLL_HANDLE library = LOAD_LIBRARY(libraryPath.c_str());
+        if (!library) throw std::runtime_error("cannot load " + libraryPath);
+        WrapperApi api;
+        api.load(library);
+
+        const int listener = remote::listenOn(options.listen);
+        std::fprintf(stderr, "proxy_server: serving %s on %s\n", libraryPath.c_str(), options.listen.c_str());
+        for (;;) {
+            const int socket = remote::acceptFrom(listener);
+            std::thread([&api, &options, socket] {
+                try {
+                    Session(api, options, socket).serve();
+                } catch (const std::exception& e) {
+                    std::fprintf(stderr, "proxy_server: connection dropped: %s\n", e.what());
+                }
+            }).detach();
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "proxy_server: %s\n", e.what());
+        return 1;
+    }
+}
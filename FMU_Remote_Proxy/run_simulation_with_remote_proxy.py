@@ -0,0 +1,119 @@
+"""
+Localhost check for the remote proxy FMU.
+
+Starts proxy_server on 127.0.0.1 next to the unpacked C++ wrapper FMU and runs the same
+input three times: through the wrapper directly, through the proxy with one step in
+flight, and through the proxy with --pipeline-depth steps in flight. The pipelined run
+sets the input of every step but reads the output only every --read-every steps (by
+default only after the last one), so doStep keeps returning before its reply arrives.
+Fails unless the proxy outputs are identical to the direct ones at every step read.
+Prints the step rate of each run.
+
+Build first: FMU_CPP_Wrapper/build.sh, then FMU_Remote_Proxy/build.sh.
+Needs numpy and fmpy (requirements.txt at the repository root).
+
+Usage: python run_simulation_with_remote_proxy.py [--steps 10000] [--pipeline-depth 8]
+           [--read-every STEPS]
+"""
+import argparse
+import os
+import shutil
+import subprocess
+import sys
+import time
+
+import numpy as np
+from fmpy import extract, read_model_description
+from fmpy.fmi2 import FMU2Slave
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+WRAPPER_FMU_PATH = os.path.join(HERE, '..', 'FMU_CPP_Wrapper', 'Amplifier_CPP_Wrapper.fmu')
+PROXY_FMU_PATH = os.path.join(HERE, 'Amplifier_Remote_Proxy.fmu')
+SERVER_PATH = os.path.join(HERE, 'proxy_server')
+ADDRESS = 'tcp://127.0.0.1:9400'
+
+
+def simulate(unzipdir, steps, read_every=1, step_size=0.001):
+    """Runs a sine input through one FMU, reading y after every read_every-th step and after
+    the last; returns (indices of the steps read, their outputs, steps per second)."""
+    model_description = read_model_description(unzipdir)
+    vrs = {variable.name: variable.valueReference for variable in model_description.modelVariables}
+    fmu = FMU2Slave(guid=model_description.guid, unzipDirectory=unzipdir,
+                    modelIdentifier=model_description.coSimulation.modelIdentifier, instanceName='instance1')
+    fmu.instantiate()
+    fmu.setupExperiment(startTime=0.0)
+    fmu.enterInitializationMode()
+    fmu.exitInitializationMode()
+    indices = [i for i in range(steps) if (i + 1) % read_every == 0 or i == steps - 1]
+    outputs = np.empty(len(indices))
+    read = 0
+    started = time.perf_counter()
+    for i in range(steps):
+        t = i * step_size
+        fmu.setReal([vrs['u']], [np.sin(2 * np.pi * t)])
+        fmu.doStep(currentCommunicationPoint=t, communicationStepSize=step_size)
+        if read < len(indices) and indices[read] == i:
+            outputs[read] = fmu.getReal([vrs['y']])[0]
+            read += 1
+    elapsed = time.perf_counter() - started
+    fmu.terminate()
+    fmu.freeInstance()
+    return np.array(indices), outputs, steps / elapsed
+
+
+def write_proxy_config(proxy_dir, pipeline_depth):
+    with open(os.path.join(proxy_dir, 'resources', 'proxy.cfg'), 'w') as cfg:
+        cfg.write(f"remote.address = {ADDRESS}\nremote.pipeline_depth = {pipeline_depth}\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--steps', type=int, default=10000)
+    parser.add_argument('--pipeline-depth', type=int, default=8, help='steps in flight in the pipelined run')
+    parser.add_argument('--read-every', type=int, help='steps between output reads in the pipelined run '
+                                                       '(default: only after the last step)')
+    args = parser.parse_args()
+    read_every = args.read_every or args.steps
+    if args.steps < 1 or args.pipeline_depth < 1 or read_every < 1:
+        parser.error('--steps, --pipeline-depth and --read-every must be positive')
+
+    for path in (WRAPPER_FMU_PATH, PROXY_FMU_PATH, SERVER_PATH):
+        if not os.path.exists(path):
+            print(f"Error: '{path}' not found. Please build it first.")
+            return 1
+
+    wrapper_dir = extract(WRAPPER_FMU_PATH)
+    proxy_dir = extract(PROXY_FMU_PATH)
+    server = subprocess.Popen([SERVER_PATH, '--fmu-dir', wrapper_dir, '--listen', ADDRESS])
+    try:
+        time.sleep(0.5)
+        _, direct, direct_rate = simulate(wrapper_dir, args.steps)
+        write_proxy_config(proxy_dir, 1)
+        _, remote, remote_rate = simulate(proxy_dir, args.steps)
+        write_proxy_config(proxy_dir, args.pipeline_depth)
+        read, pipelined, pipelined_rate = simulate(proxy_dir, args.steps, read_every)
+    finally:
+        server.terminate()
+        server.wait()
+        shutil.rmtree(wrapper_dir, ignore_errors=True)
+        shutil.rmtree(proxy_dir, ignore_errors=True)
+
+    print(f"direct:          {direct_rate:10.0f} steps/s")
+    print(f"proxy:           {remote_rate:10.0f} steps/s")
+    print(f"proxy pipelined: {pipelined_rate:10.0f} steps/s (pipeline depth {args.pipeline_depth}, "
+          f"{len(read)} output read(s))")
+    failed = False
+    if not np.array_equal(direct, remote):
+        print(f"FAIL: proxy outputs differ, max deviation {np.max(np.abs(direct - remote))}")
+        failed = True
+    if not np.array_equal(direct[read], pipelined):
+        print(f"FAIL: pipelined proxy outputs differ, max deviation {np.max(np.abs(direct[read] - pipelined))}")
+        failed = True
+    if failed:
+        return 1
+    print("PASS: proxy outputs match the wrapper, with and without pipelining")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,28 @@
+#!/bin/bash
+# Builds the optional native fast path for wrapper_slave.py (fault_accel.cpp).
+# The module must be built for the Python interpreter the simulator embeds through
+# pythonfmu; set PYTHON to select it (default: python3). create_wrapper_fmu.py ships
+# the resulting module in the FMU resources when it exists.
+
+set -e
+
+PYTHON="${PYTHON:-python3}"
+SOURCE="fault_accel.cpp"
+FMI_HEADERS="../Amplifier_files"
+
+command -v g++ >/dev/null 2>&1 || { echo >&2 "Build failed: 'g++' not found."; exit 1; }
+command -v "${PYTHON}" >/dev/null 2>&1 || { echo >&2 "Build failed: '${PYTHON}' not found."; exit 1; }
+
+PY_INCLUDES="$("${PYTHON}" -c 'import sysconfig; print("-I" + sysconfig.get_paths()["include"])')"
+EXT_SUFFIX="$("${PYTHON}" -c 'import sysconfig; print(sysconfig.get_config_var("EXT_SUFFIX"))')"
+OUTPUT="fault_accel${EXT_SUFFIX}"
+
+# Python symbols are resolved from the embedding interpreter at load time.
+LINK_FLAGS=""
+if [[ "$OSTYPE" == "darwin"* ]]; then
+    LINK_FLAGS="-undefined dynamic_lookup"
+fi
+
+echo "Compiling ${OUTPUT}"
+g++ -shared -fPIC -std=c++17 -O2 -fvisibility=hidden ${PY_INCLUDES} -I"${FMI_HEADERS}" "${SOURCE}" -o "${OUTPUT}" ${LINK_FLAGS}
+echo "Native fast path ready: ${OUTPUT}"
@@ -1,7 +1,11 @@
+import argparse
+import glob
 import os
 import subprocess
 import sys
 
+from generate_native_wrapper import generate as generate_native_wrapper
+
 # --- Configuration ---
 WRAPPER_SLAVE_SCRIPT = "wrapper_slave.py"
 
@@ -10,9 +14,15 @@ ORIGINAL_FMU = "Amplifier.fmu"
 
 FAULT_CONFIG = "fault_config.json"
 
+# Optional native fast path built by build_fault_accel.sh; shipped when present.
+NATIVE_ACCELERATOR_PATTERNS = ["fault_accel*.so", "fault_accel*.pyd"]
+
 # UPDATED: Output name reflects the new wrapped FMU
 OUTPUT_FMU_NAME = "Amplifier_fault_wrapper.fmu"
 
+# Output of --native: a compiled wrapper with the fault schedule baked in (no Python embedded).
+NATIVE_OUTPUT_FMU_NAME = "Amplifier_native_wrapper.fmu"
+
 def build_wrapper():
     """
     Automates the process of building a self-contained wrapper FMU.
@@ -38,6 +48,12 @@ def build_wrapper():
         ORIGINAL_FMU,
         FAULT_CONFIG
     ]
+    accelerators = sorted(f for pattern in NATIVE_ACCELERATOR_PATTERNS for f in glob.glob(pattern))
+    if accelerators:
+        print(f"Including native fast path: {', '.join(accelerators)}")
+        build_command += accelerators
+    else:
+        print("Native fast path not built (run build_fault_accel.sh); the wrapper will use the Python path.")
 
     print(f"\nRunning command: {' '.join(build_command)}")
 
@@ -79,5 +95,29 @@ def build_wrapper():
     print(f"Your wrapper FMU is ready: {OUTPUT_FMU_NAME}")
 
 
+def build_native_wrapper():
+    """
+    Generates C++ with the fault schedule as constexpr tables, compiles it and packages a native FMU.
+    """
+    print("--- Starting Native Wrapper FMU Build Process ---")
+    for f in [ORIGINAL_FMU, FAULT_CONFIG]:
+        if not os.path.exists(f):
+            print(f"Error: Required file not found: {f}")
+            sys.exit(1)
+    try:
+        generate_native_wrapper(ORIGINAL_FMU, FAULT_CONFIG, NATIVE_OUTPUT_FMU_NAME)
+    except subprocess.CalledProcessError as e:
+        print("\n--- Build Failed! ---")
+        print(f"The C++ compiler failed with return code {e.returncode}.")
+        sys.exit(1)
+    print("\n--- Build Process Finished Successfully! ---")
+
+
 if __name__ == "__main__":
-    build_wrapper()
\ No newline at end of file
+    parser = argparse.ArgumentParser(description="Build the fault-injecting wrapper FMU.")
+    parser.add_argument("--native", action="store_true",
+                        help="generate and compile a native C++ wrapper instead of the pythonfmu one")
+    if parser.parse_args().native:
+        build_native_wrapper()
+    else:
+        build_wrapper()
\ No newline at end of file
@@ -0,0 +1,457 @@
+/**
+ * @file fault_accel.cpp
+ * @brief Native fast path for the pythonfmu wrapper slave (wrapper_slave.py).
+ *
+ * Built as the CPython extension module `fault_accel` (see build_fault_accel.sh) and
+ * shipped next to wrapper_slave.py in the FMU resources. The slave hands it the
+ * parsed fault configuration, the typed input/output value references, and the
+ * addresses of the inner FMU's fmi2 functions and component as loaded by fmpy.
+ *
+ * The fault events are compiled once into a piecewise-constant table: the event
+ * start/end times split the time axis into segments, and every segment stores the
+ * action (none, stuck-at, offset) for each input. A step is then a cursor advance,
+ * one batched fmi2Set* call per type, fmi2DoStep and one batched fmi2Get* per type,
+ * all inside a single call from Python.
+ */
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "fmi2FunctionTypes.h"
+}
+
+namespace {
+
+enum class FaultAction : unsigned char { None, StuckAt, Offset };
+
+// Typed variable group; inputs and outputs are each split into these three.
+struct Channel {
+    std::vector<fmi2ValueReference> vrs;
+    std::vector<size_t> positions; // Index of each variable in the Python-side input/output sequence.
+};
+
+struct Accelerator {
+    PyObject_HEAD
+    fmi2Component component;
+    fmi2SetRealTYPE* setReal;
+    fmi2GetRealTYPE* getReal;
+    fmi2SetIntegerTYPE* setInteger;
+    fmi2GetIntegerTYPE* getInteger;
+    fmi2SetBooleanTYPE* setBoolean;
+    fmi2GetBooleanTYPE* getBoolean;
+    fmi2DoStepTYPE* doStep;
+
+    // Compiled fault table: segment s covers [breaks[s], breaks[s + 1]).
+    std::vector<double>* breaks;
+    std::vector<FaultAction>* actions; // [segment * inputCount + input]
+    std::vector<double>* values;       // Same layout as actions.
+    size_t segment;
+
+    size_t inputCount;
+    size_t outputCount;
+    Channel* inputs;  // Real, Integer, Boolean
+    Channel* outputs;
+
+    // Scratch buffers reused across steps.
+    std::vector<double>* faulted;
+    std::vector<fmi2Real>* reals;
+    std::vector<fmi2Integer>* integers;
+    std::vector<fmi2Boolean>* booleans;
+};
+
+constexpr int REAL = 0, INTEGER = 1, BOOLEAN = 2;
+
+int typeIndex(const char* name) {
+    const std::string type(name);
+    if (type == "Real") return REAL;
+    if (type == "Integer") return INTEGER;
+    if (type == "Boolean") return BOOLEAN;
+    return -1;
+}
+
+template <typename T>
+T* functionAt(PyObject* address) {
+    void* p = PyLong_AsVoidPtr(address);
+    return reinterpret_cast<T*>(p);
+}
+
+// Reads a float from a dict entry, or returns the fallback if the key is absent.
+bool dictDouble(PyObject* dict, const char* key, double fallback, double& out) {
+    PyObject* item = PyDict_GetItemString(dict, key); // Borrowed.
+    if (!item) {
+        out = fallback;
+        return true;
+    }
+    out = PyFloat_AsDouble(item);
+    return !(out == -1.0 && PyErr_Occurred());
+}
+
+/**
+ * Parses `[(vr, type name), ...]` into the three typed channels.
+ * @return false with a Python exception set on malformed input or unsupported types.
+ */
+bool parseVariables(PyObject* sequence, Channel* channels, size_t& count, const char* what) {
+    PyObject* fast = PySequence_Fast(sequence, what);
+    if (!fast) return false;
+    count = static_cast<size_t>(PySequence_Fast_GET_SIZE(fast));
+    for (size_t i = 0; i < count; i++) {
+        unsigned int vr;
+        const char* type;
+        if (!PyArg_ParseTuple(PySequence_Fast_GET_ITEM(fast, i), "Is", &vr, &type)) {
+            Py_DECREF(fast);
+            return false;
+        }
+        const int t = typeIndex(type);
+        if (t < 0) {
+            PyErr_Format(PyExc_TypeError, "%s: unsupported variable type '%s'", what, type);
+            Py_DECREF(fast);
+            return false;
+        }
+        channels[t].vrs.push_back(vr);
+        channels[t].positions.push_back(i);
+    }
+    Py_DECREF(fast);
+    return true;
+}
+
+struct Event {
+    double start, end;
+    fmi2ValueReference vr;
+    FaultAction action;
+    double value;
+};
+
+// Collects the variable faults of config["events"], in file order.
+bool parseEvents(PyObject* config, std::vector<Event>& events) {
+    if (!PyDict_Check(config)) {
+        PyErr_SetString(PyExc_TypeError, "fault config must be a dict");
+        return false;
+    }
+    PyObject* list = PyDict_GetItemString(config, "events");
+    if (!list) return true;
+    PyObject* fast = PySequence_Fast(list, "config['events'] must be a list");
+    if (!fast) return false;
+    bool ok = true;
+    for (Py_ssize_t e = 0; ok && e < PySequence_Fast_GET_SIZE(fast); e++) {
+        PyObject* event = PySequence_Fast_GET_ITEM(fast, e);
+        double start, duration;
+        if (!PyDict_Check(event) || !dictDouble(event, "startTime", 0.0, start) ||
+            !dictDouble(event, "duration", std::numeric_limits<double>::infinity(), duration)) {
+            if (!PyErr_Occurred()) PyErr_SetString(PyExc_TypeError, "fault events must be dicts");
+            ok = false;
+            break;
+        }
+        PyObject* variables = PyDict_GetItemString(event, "variables");
+        if (!variables) continue;
+        PyObject* vfast = PySequence_Fast(variables, "event['variables'] must be a list");
+        if (!vfast) {
+            ok = false;
+            break;
+        }
+        for (Py_ssize_t v = 0; ok && v < PySequence_Fast_GET_SIZE(vfast); v++) {
+            PyObject* fault = PySequence_Fast_GET_ITEM(vfast, v);
+            PyObject* vr = PyDict_Check(fault) ? PyDict_GetItemString(fault, "valueReference") : nullptr;
+            if (!vr || vr == Py_None) continue; // Same as the Python path: entries without a VR are ignored.
+            PyObject* type = PyDict_GetItemString(fault, "type");
+            const char* typeName = type ? PyUnicode_AsUTF8(type) : nullptr;
+            Event parsed{start, start + duration, static_cast<fmi2ValueReference>(PyLong_AsUnsignedLong(vr)), FaultAction::None, 0.0};
+            if (!typeName || !dictDouble(fault, "value", 0.0, parsed.value) || PyErr_Occurred()) {
+                if (!PyErr_Occurred()) PyErr_SetString(PyExc_ValueError, "variable faults need 'type' and 'value'");
+                ok = false;
+                break;
+            }
+            // Unknown types stay active but leave the value untouched, like the Python path.
+            if (std::string(typeName) == "stuckAtValue") parsed.action = FaultAction::StuckAt;
+            else if (std::string(typeName) == "offset") parsed.action = FaultAction::Offset;
+            events.push_back(parsed);
+        }
+        Py_DECREF(vfast);
+    }
+    Py_DECREF(fast);
+    return ok;
+}
+
+// Builds the segment table. Within one segment the set of active events is constant,
+// and later events override earlier ones on the same variable.
+void compile(Accelerator* self, const std::vector<Event>& events, const std::vector<fmi2ValueReference>& inputVrs) {
+    const double inf = std::numeric_limits<double>::infinity();
+    std::vector<double> breaks = {-inf};
+    for (const Event& e : events) {
+        breaks.push_back(e.start);
+        breaks.push_back(e.end);
+    }
+    std::sort(breaks.begin(), breaks.end());
+    breaks.erase(std::unique(breaks.begin(), breaks.end()), breaks.end());
+    if (breaks.back() != inf) breaks.push_back(inf);
+
+    const size_t segments = breaks.size() - 1;
+    self->actions->assign(segments * self->inputCount, FaultAction::None);
+    self->values->assign(segments * self->inputCount, 0.0);
+    for (size_t s = 0; s < segments; s++) {
+        const double t = breaks[s];
+        for (const Event& e : events) {
+            if (!(e.start <= t && t < e.end)) continue;
+            for (size_t i = 0; i < self->inputCount; i++) {
+                if (inputVrs[i] != e.vr) continue;
+                (*self->actions)[s * self->inputCount + i] = e.action;
+                (*self->values)[s * self->inputCount + i] = e.value;
+            }
+        }
+    }
+    *self->breaks = std::move(breaks);
+    self->segment = 0;
+}
+
+// Moves the cursor to the segment containing t; steps normally only move forward.
+size_t locate(Accelerator* self, double t) {
+    const std::vector<double>& breaks = *self->breaks;
+    size_t s = self->segment;
+    if (std::isnan(t)) {
+        s = 0; // No event is active at NaN; segment 0 starts at -inf and ends at the first start time.
+    } else if (t >= breaks[s]) {
+        while (s + 2 < breaks.size() && t >= breaks[s + 1]) s++;
+    } else {
+        s = static_cast<size_t>(std::upper_bound(breaks.begin(), breaks.end(), t) - breaks.begin()) - 1;
+    }
+    self->segment = s;
+    return s;
+}
+
+void Accelerator_dealloc(Accelerator* self) {
+    delete self->breaks;
+    delete self->actions;
+    delete self->values;
+    delete[] self->inputs;
+    delete[] self->outputs;
+    delete self->faulted;
+    delete self->reals;
+    delete self->integers;
+    delete self->booleans;
+    Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+PyObject* Accelerator_new(PyTypeObject* type, PyObject*, PyObject*) {
+    auto* self = reinterpret_cast<Accelerator*>(type->tp_alloc(type, 0));
+    if (!self) return nullptr;
+    self->breaks = new std::vector<double>();
+    self->actions = new std::vector<FaultAction>();
+    self->values = new std::vector<double>();
+    self->inputs = new Channel[3];
+    self->outputs = new Channel[3];
+    self->faulted = new std::vector<double>();
+    self->reals = new std::vector<fmi2Real>();
+    self->integers = new std::vector<fmi2Integer>();
+    self->booleans = new std::vector<fmi2Boolean>();
+    return reinterpret_cast<PyObject*>(self);
+}
+
+/*
+ * Accelerator(functions, component, config, inputs, outputs)
+ *   functions: dict of fmi2 function name -> address (int)
+ *   component: address of the inner fmi2Component (int)
+ *   config:    the parsed fault_config.json
+ *   inputs, outputs: [(inner value reference, "Real" | "Integer" | "Boolean"), ...]
+ */
+int Accelerator_init(Accelerator* self, PyObject* args, PyObject*) {
+    PyObject *functions, *component, *config, *inputs, *outputs;
+    if (!PyArg_ParseTuple(args, "O!OOOO", &PyDict_Type, &functions, &component, &config, &inputs, &outputs)) return -1;
+
+#define RESOLVE(member, Name)                                                                    \
+    do {                                                                                         \
+        PyObject* address = PyDict_GetItemString(functions, "fmi2" #Name);                       \
+        if (!address) {                                                                          \
+            PyErr_SetString(PyExc_KeyError, "missing function address: fmi2" #Name);             \
+            return -1;                                                                           \
+        }                                                                                        \
+        self->member = functionAt<fmi2##Name##TYPE>(address);                                    \
+        if (!self->member) {                                                                     \
+            if (!PyErr_Occurred()) PyErr_SetString(PyExc_ValueError, "null address: fmi2" #Name); \
+            return -1;                                                                           \
+        }                                                                                        \
+    } while (0)
+    RESOLVE(setReal, SetReal); RESOLVE(getReal, GetReal); RESOLVE(setInteger, SetInteger); RESOLVE(getInteger, GetInteger);
+    RESOLVE(setBoolean, SetBoolean); RESOLVE(getBoolean, GetBoolean); RESOLVE(doStep, DoStep);
+#undef RESOLVE
+
+    self->component = PyLong_AsVoidPtr(component);
+    if (!self->component) {
+        if (!PyErr_Occurred()) PyErr_SetString(PyExc_ValueError, "inner FMU component is not instantiated");
+        return -1;
+    }
+
+    for (int t = 0; t < 3; t++) self->inputs[t] = Channel{}, self->outputs[t] = Channel{};
+    if (!parseVariables(inputs, self->inputs, self->inputCount, "inputs must be a sequence of (vr, type)") ||
+        !parseVariables(outputs, self->outputs, self->outputCount, "outputs must be a sequence of (vr, type)")) {
+        return -1;
+    }
+
+    std::vector<Event> events;
+    if (!parseEvents(config, events)) return -1;
+    std::vector<fmi2ValueReference> inputVrs(self->inputCount);
+    for (int t = 0; t < 3; t++) {
+        for (size_t k = 0; k < self->inputs[t].vrs.size(); k++) inputVrs[self->inputs[t].positions[k]] = self->inputs[t].vrs[k];
+    }
+    compile(self, events, inputVrs);
+
+    const size_t scratch = std::max(self->inputCount, self->outputCount);
+    self->faulted->resize(self->inputCount);
+    self->reals->resize(scratch);
+    self->integers->resize(scratch);
+    self->booleans->resize(scratch);
+    return 0;
+}
+
+
+PyObject* statusError(const char* call, fmi2Status status) {
+    PyErr_Format(PyExc_RuntimeError, "inner %s returned status %d", call, static_cast<int>(status));
+    return nullptr;
+}
+
+/*
+ * step(current_time, step_size, inputs) -> tuple of outputs
+ * Applies the faults active at current_time to the input values (in the order given
+ * to the constructor), forwards them, steps the inner FMU and returns its outputs.
+ */
+PyObject* Accelerator_step(Accelerator* self, PyObject* args) {
+    double time, stepSize;
+    PyObject* inputs;
+    if (!PyArg_ParseTuple(args, "ddO", &time, &stepSize, &inputs)) return nullptr;
+    PyObject* fast = PySequence_Fast(inputs, "inputs must be a sequence");
+    if (!fast) return nullptr;
+    if (static_cast<size_t>(PySequence_Fast_GET_SIZE(fast)) != self->inputCount) {
+        Py_DECREF(fast);
+        PyErr_Format(PyExc_ValueError, "expected %zu input values", self->inputCount);
+        return nullptr;
+    }
+
+    // 1. Apply the compiled faults in double precision, as the Python path does.
+    const size_t row = locate(self, time) * self->inputCount;
+    std::vector<double>& faulted = *self->faulted;
+    for (size_t i = 0; i < self->inputCount; i++) {
+        double v = PyFloat_AsDouble(PySequence_Fast_GET_ITEM(fast, i));
+        if (v == -1.0 && PyErr_Occurred()) {
+            Py_DECREF(fast);
+            return nullptr;
+        }
+        const FaultAction action = (*self->actions)[row + i];
+        if (action == FaultAction::StuckAt) v = (*self->values)[row + i];
+        else if (action == FaultAction::Offset) v += (*self->values)[row + i];
+        faulted[i] = v;
+    }
+    Py_DECREF(fast);
+
+    // 2. Forward the inputs with one call per type.
+    fmi2Status status;
+    const Channel* in = self->inputs;
+    if (!in[REAL].vrs.empty()) {
+        for (size_t k = 0; k < in[REAL].vrs.size(); k++) (*self->reals)[k] = faulted[in[REAL].positions[k]];
+        if ((status = self->setReal(self->component, in[REAL].vrs.data(), in[REAL].vrs.size(), self->reals->data())) > fmi2Warning) return statusError("fmi2SetReal", status);
+    }
+    if (!in[INTEGER].vrs.empty()) {
+        for (size_t k = 0; k < in[INTEGER].vrs.size(); k++) (*self->integers)[k] = static_cast<fmi2Integer>(std::trunc(faulted[in[INTEGER].positions[k]]));
+        if ((status = self->setInteger(self->component, in[INTEGER].vrs.data(), in[INTEGER].vrs.size(), self->integers->data())) > fmi2Warning) return statusError("fmi2SetInteger", status);
+    }
+    if (!in[BOOLEAN].vrs.empty()) {
+        for (size_t k = 0; k < in[BOOLEAN].vrs.size(); k++) (*self->booleans)[k] = faulted[in[BOOLEAN].positions[k]] != 0.0 ? fmi2True : fmi2False;
+        if ((status = self->setBoolean(self->component, in[BOOLEAN].vrs.data(), in[BOOLEAN].vrs.size(), self->booleans->data())) > fmi2Warning) return statusError("fmi2SetBoolean", status);
+    }
+
+    // 3. Advance the inner FMU.
+    if ((status = self->doStep(self->component, time, stepSize, fmi2True)) > fmi2Warning) return statusError("fmi2DoStep", status);
+
+    // 4. Read the outputs back, again one call per type.
+    PyObject* result = PyTuple_New(static_cast<Py_ssize_t>(self->outputCount));
+    if (!result) return nullptr;
+    const Channel* out = self->outputs;
+    if (!out[REAL].vrs.empty()) {
+        if ((status = self->getReal(self->component, out[REAL].vrs.data(), out[REAL].vrs.size(), self->reals->data())) > fmi2Warning) {
+            Py_DECREF(result);
+            return statusError("fmi2GetReal", status);
+        }
+        for (size_t k = 0; k < out[REAL].vrs.size(); k++) PyTuple_SET_ITEM(result, out[REAL].positions[k], PyFloat_FromDouble((*self->reals)[k]));
+    }
+    if (!out[INTEGER].vrs.empty()) {
+        if ((status = self->getInteger(self->component, out[INTEGER].vrs.data(), out[INTEGER].vrs.size(), self->integers->data())) > fmi2Warning) {
+            Py_DECREF(result);
+            return statusError("fmi2GetInteger", status);
+        }
+        for (size_t k = 0; k < out[INTEGER].vrs.size(); k++) PyTuple_SET_ITEM(result, out[INTEGER].positions[k], PyLong_FromLong((*self->integers)[k]));
+    }
+    if (!out[BOOLEAN].vrs.empty()) {
+        if ((status = self->getBoolean(self->component, out[BOOLEAN].vrs.data(), out[BOOLEAN].vrs.size(), self->booleans->data())) > fmi2Warning) {
+            Py_DECREF(result);
+            return statusError("fmi2GetBoolean", status);
+        }
+        for (size_t k = 0; k < out[BOOLEAN].vrs.size(); k++) PyTuple_SET_ITEM(result, out[BOOLEAN].positions[k], PyBool_FromLong((*self->booleans)[k]));
+    }
+    return result;
+}
+
+/* active_faults(time) -> {vr: (type, value)}; the schedule as the Python path would see it, for debugging. */
+PyObject* Accelerator_active_faults(Accelerator* self, PyObject* args) {
+    double time;
+    if (!PyArg_ParseTuple(args, "d", &time)) return nullptr;
+    const size_t row = locate(self, time) * self->inputCount;
+    PyObject* result = PyDict_New();
+    for (int t = 0; result && t < 3; t++) {
+        for (size_t k = 0; k < self->inputs[t].vrs.size(); k++) {
+            const size_t i = self->inputs[t].positions[k];
+            const FaultAction action = (*self->actions)[row + i];
+            if (action == FaultAction::None) continue;
+            PyObject* key = PyLong_FromUnsignedLong(self->inputs[t].vrs[k]);
+            PyObject* value = Py_BuildValue("(sd)", action == FaultAction::StuckAt ? "stuckAtValue" : "offset", (*self->values)[row + i]);
+            if (!key || !value || PyDict_SetItem(result, key, value) < 0) Py_CLEAR(result);
+            Py_XDECREF(key);
+            Py_XDECREF(value);
+        }
+    }
+    return result;
+}
+
+PyMethodDef Accelerator_methods[] = {
+    {"step", reinterpret_cast<PyCFunction>(Accelerator_step), METH_VARARGS,
+     "step(current_time, step_size, inputs) -> outputs: apply faults, forward inputs, step and read outputs."},
+    {"active_faults", reinterpret_cast<PyCFunction>(Accelerator_active_faults), METH_VARARGS,
+     "active_faults(time) -> {vr: (type, value)} for the compiled schedule."},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+PyTypeObject AcceleratorType = {PyVarObject_HEAD_INIT(nullptr, 0)};
+
+PyModuleDef module = {
+    PyModuleDef_HEAD_INIT,
+    "fault_accel",
+    "Native fault scheduling and typed forwarding for the pythonfmu wrapper slave.",
+    -1,
+    nullptr,
+};
+
+} // namespace
+
+PyMODINIT_FUNC PyInit_fault_accel() {
+    AcceleratorType.tp_name = "fault_accel.Accelerator";
+    AcceleratorType.tp_basicsize = sizeof(Accelerator);
+    AcceleratorType.tp_flags = Py_TPFLAGS_DEFAULT;
+    AcceleratorType.tp_doc = "Compiled fault table bound to one inner FMU instance.";
+    AcceleratorType.tp_new = Accelerator_new;
+    AcceleratorType.tp_init = reinterpret_cast<initproc>(Accelerator_init);
+    AcceleratorType.tp_dealloc = reinterpret_cast<destructor>(Accelerator_dealloc);
+    AcceleratorType.tp_methods = Accelerator_methods;
+    if (PyType_Ready(&AcceleratorType) < 0) return nullptr;
+
+    PyObject* m = PyModule_Create(&module);
+    if (!m) return nullptr;
+    Py_INCREF(&AcceleratorType);
+    if (PyModule_AddObject(m, "Accelerator", reinterpret_cast<PyObject*>(&AcceleratorType)) < 0) {
+        Py_DECREF(&AcceleratorType);
+        Py_DECREF(m);
+        return nullptr;
+    }
+    return m;
+}
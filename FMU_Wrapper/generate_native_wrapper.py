@@ -0,0 +1,317 @@
+"""
+Generates a native (C++) fault-injecting wrapper FMU from an FMU and fault_config.json.
+
+The pythonfmu wrapper interprets the fault schedule at run time. This generator bakes it
+into native_wrapper_tables.hpp as constexpr tables instead:
+  * the wrapper mirrors the inner FMU's variables; per type, a dense VR -> bank index table
+    and the start values are compile-time arrays,
+  * the event start/end times split the time axis into segments, and every segment lists
+    the fault action (none, stuck-at, offset) and value for each input.
+native_wrapper_template.cpp is then compiled with optimization against those tables and
+packaged together with the original FMU into a self-contained .fmu.
+
+Usage: python generate_native_wrapper.py [--fmu Amplifier.fmu] [--config fault_config.json]
+                                         [--output Amplifier_native_wrapper.fmu] [--keep-build]
+"""
+import argparse
+import hashlib
+import json
+import math
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import uuid
+import zipfile
+import xml.etree.ElementTree as ET
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+TEMPLATE = os.path.join(HERE, "native_wrapper_template.cpp")
+FMI_HEADERS = os.path.join(HERE, "..", "Amplifier_files")
+TABLES_HEADER = "native_wrapper_tables.hpp"
+
+SUPPORTED_TYPES = ("Real", "Integer", "Boolean")
+MAX_DENSE_VR = 1 << 16
+FAULT_ACTIONS = {"stuckAtValue": "FaultAction::StuckAt", "offset": "FaultAction::Offset"}
+
+
+def platform_info():
+    if sys.platform.startswith("linux"):
+        return "linux64", ".so"
+    if sys.platform == "darwin":
+        return "darwin64", ".dylib"
+    if sys.platform in ("win32", "cygwin", "msys"):
+        return "win64", ".dll"
+    raise SystemExit(f"Unsupported platform: {sys.platform}")
+
+
+def read_variables(root):
+    """Returns [(name, vr, type, causality, variability, start)] in model description order."""
+    variables = []
+    for sv in root.find("ModelVariables").findall("ScalarVariable"):
+        typed = next((child for child in sv if child.tag in SUPPORTED_TYPES + ("String", "Enumeration")), None)
+        if typed is None:
+            raise SystemExit(f"Variable '{sv.get('name')}' has no type element")
+        if typed.tag not in SUPPORTED_TYPES:
+            raise SystemExit(f"Variable '{sv.get('name')}' has unsupported type {typed.tag}; "
+                             "use the pythonfmu wrapper for this FMU")
+        variables.append((sv.get("name"), int(sv.get("valueReference")), typed.tag,
+                          sv.get("causality", "local"), sv.get("variability", "continuous"),
+                          typed.get("start")))
+    return variables
+
+
+def find_inner_library(archive, platform, ext, model_identifier):
+    """The binary is normally <modelIdentifier><ext>, but not every exporter follows that."""
+    prefix = f"binaries/{platform}/"
+    candidates = [n for n in archive.namelist() if n.startswith(prefix) and n.endswith(ext)]
+    preferred = prefix + model_identifier + ext
+    if preferred in candidates:
+        return model_identifier
+    if not candidates:
+        raise SystemExit(f"The FMU has no binary for {platform}")
+    return os.path.splitext(os.path.basename(sorted(candidates)[0]))[0]
+
+
+def compile_schedule(config, input_vrs):
+    """Splits time into segments with a constant set of active events. Later events win, as in wrapper_slave.py."""
+    events = []
+    for event in config.get("events", []):
+        start = float(event.get("startTime", 0.0))
+        end = start + float(event.get("duration", math.inf))
+        for vf in event.get("variables", []):
+            vr = vf.get("valueReference")
+            if vr is None:
+                continue
+            events.append((start, end, int(vr), FAULT_ACTIONS.get(vf["type"], "FaultAction::None"), float(vf["value"])))
+
+    breaks = sorted({-math.inf, math.inf} | {e[0] for e in events} | {e[1] for e in events})
+    actions, values = [], []
+    for s in range(len(breaks) - 1):
+        t = breaks[s]
+        row = [("FaultAction::None", 0.0)] * len(input_vrs)
+        for start, end, vr, action, value in events:
+            if start <= t < end:
+                for i, input_vr in enumerate(input_vrs):
+                    if input_vr == vr:
+                        row[i] = (action, value)
+        actions += [a for a, _ in row]
+        values += [v for _, v in row]
+    return breaks, actions, values
+
+
+def cpp_double(value):
+    if value == math.inf:
+        return "std::numeric_limits<double>::infinity()"
+    if value == -math.inf:
+        return "-std::numeric_limits<double>::infinity()"
+    return repr(float(value))
+
+
+def cpp_array(ctype, name, items, fmt=str):
+    # Empty tables get one dummy element so they remain valid arrays.
+    body = ", ".join(fmt(v) for v in items) if items else fmt(0) if ctype != "FaultAction" else "FaultAction::None"
+    return f"constexpr {ctype} {name}[] = {{{body}}};"
+
+
+def start_value(vtype, text):
+    if vtype == "Real":
+        return float(text) if text is not None else 0.0
+    if vtype == "Integer":
+        return int(text) if text is not None else 0
+    return 1 if text in ("true", "1") else 0
+
+
+def render_tables(variables, config, wrapper_guid, inner_guid, inner_library, model_name):
+    banks = {t: [v for v in variables if v[2] == t] for t in SUPPORTED_TYPES}
+    inputs = [v for v in variables if v[3] == "input"]
+    input_position = {v[1]: i for i, v in enumerate(inputs)}
+    breaks, actions, values = compile_schedule(config, [v[1] for v in inputs])
+
+    lines = [
+        "/**",
+        f" * @file {TABLES_HEADER}",
+        f" * @brief Compile-time tables for the native wrapper of '{model_name}'.",
+        " *",
+        " * Generated by generate_native_wrapper.py from the FMU's modelDescription.xml and",
+        " * fault_config.json; do not edit.",
+        " */",
+        "#ifndef NATIVE_WRAPPER_TABLES_HPP",
+        "#define NATIVE_WRAPPER_TABLES_HPP",
+        "",
+        "#include <cstddef>",
+        "#include <limits>",
+        "",
+        "enum class FaultAction : unsigned char { None, StuckAt, Offset };",
+        "",
+        f'constexpr const char* WRAPPER_GUID = "{wrapper_guid}";',
+        f'constexpr const char* INNER_GUID = "{inner_guid}";',
+        'constexpr const char* INNER_DIRECTORY = "model";',
+        f'constexpr const char* INNER_LIBRARY = "{inner_library}";',
+        'constexpr const char* INNER_INSTANCE_NAME = "wrapped_instance";',
+        "#if defined(_WIN32)",
+        'constexpr const char* INNER_LIBRARY_EXT = ".dll";',
+        "#elif defined(__APPLE__)",
+        'constexpr const char* INNER_LIBRARY_EXT = ".dylib";',
+        "#else",
+        'constexpr const char* INNER_LIBRARY_EXT = ".so";',
+        "#endif",
+        "",
+        "// Variable banks: index tables are dense in the value reference (-1: not of this type).",
+    ]
+    bank_index = {}
+    for vtype in SUPPORTED_TYPES:
+        upper = vtype.upper()
+        bank = banks[vtype]
+        bank_index[vtype] = {v[1]: i for i, v in enumerate(bank)}
+        size = max((v[1] for v in bank), default=-1) + 1
+        if size > MAX_DENSE_VR:
+            raise SystemExit(f"{vtype} value references up to {size - 1} are too sparse for the dense VR tables")
+        dense = [-1] * size
+        for i, v in enumerate(bank):
+            dense[v[1]] = i
+        ctype = {"Real": "double", "Integer": "int", "Boolean": "int"}[vtype]
+        lines.append(f"constexpr size_t {upper}_COUNT = {len(bank)};")
+        lines.append(cpp_array("int", f"{upper}_INDEX", dense or [-1]))
+        lines.append(cpp_array(ctype, f"{upper}_START", [start_value(vtype, v[5]) for v in bank],
+                               cpp_double if vtype == "Real" else str))
+    lines += [
+        "",
+        "// Variables forwarded to the inner FMU, grouped by type for one batched call each.",
+        "struct Forwarding {",
+    ]
+    for vtype in SUPPORTED_TYPES:
+        lower = vtype.lower()
+        members = [
+            (f"size_t {lower}Count;", ""),
+            (f"const unsigned int* {lower}Vrs;", "Inner value references."),
+            (f"const int* {lower}Indices;", "Bank indices of the cached values."),
+            (f"const int* {lower}Inputs;", "Input positions in the fault tables (inputs only)."),
+        ]
+        lines += [f"    {decl.ljust(36)}// {note}" if note else f"    {decl}" for decl, note in members]
+    lines.append("};")
+
+    def forwarding(role, selected):
+        out = []
+        fields = []
+        for vtype in SUPPORTED_TYPES:
+            lower = vtype.lower()
+            chosen = [v for v in selected if v[2] == vtype]
+            prefix = f"{role}_{vtype.upper()}"
+            out.append(cpp_array("unsigned int", f"{prefix}_VRS", [v[1] for v in chosen]))
+            out.append(cpp_array("int", f"{prefix}_INDICES", [bank_index[vtype][v[1]] for v in chosen]))
+            out.append(cpp_array("int", f"{prefix}_INPUTS", [input_position.get(v[1], 0) for v in chosen]))
+            fields.append(f"{len(chosen)}, {prefix}_VRS, {prefix}_INDICES, {prefix}_INPUTS")
+        out.append(f"constexpr Forwarding {role} = {{{', '.join(fields)}}};")
+        return out
+
+    parameters = [v for v in variables if v[3] == "parameter" or v[4] == "fixed"]
+    outputs = [v for v in variables if v[3] == "output"]
+    lines += [""] + forwarding("INPUTS", inputs)
+    lines += [""] + forwarding("PARAMETERS", parameters)
+    lines += [""] + forwarding("OUTPUTS", outputs)
+
+    lines += [
+        "",
+        "// Fault schedule: segment s covers [FAULT_BREAKS[s], FAULT_BREAKS[s + 1]);",
+        "// row s of FAULT_ACTIONS/FAULT_VALUES holds the action for each input.",
+        f"constexpr size_t INPUT_COUNT = {len(inputs)};",
+        f"constexpr size_t FAULT_SEGMENT_COUNT = {len(breaks) - 1};",
+        cpp_array("double", "FAULT_BREAKS", breaks, cpp_double),
+        cpp_array("FaultAction", "FAULT_ACTIONS", actions),
+        cpp_array("double", "FAULT_VALUES", values, cpp_double),
+        "",
+        "#endif // NATIVE_WRAPPER_TABLES_HPP",
+        "",
+    ]
+    return "\n".join(lines)
+
+
+def wrapper_model_description(root, model_identifier, wrapper_guid):
+    inner_name = root.get("modelName")
+    root.set("modelName", f"{inner_name}_NativeFaultWrapper")
+    root.set("guid", wrapper_guid)
+    root.set("description", f"Native fault-injecting wrapper around '{inner_name}'")
+    root.set("generationTool", "generate_native_wrapper.py")
+    cs = root.find("CoSimulation")
+    cs.set("modelIdentifier", model_identifier)
+    for source_files in cs.findall("SourceFiles"):
+        cs.remove(source_files)
+    return ET.tostring(root, encoding="unicode", xml_declaration=True)
+
+
+def generate(fmu_path, config_path, output_path, keep_build=False, cxx="g++"):
+    platform, ext = platform_info()
+    with open(config_path) as f:
+        config_text = f.read()
+    config = json.loads(config_text)
+
+    with zipfile.ZipFile(fmu_path) as archive:
+        root = ET.fromstring(archive.read("modelDescription.xml"))
+        if root.get("fmiVersion") != "2.0" or root.find("CoSimulation") is None:
+            raise SystemExit("Only FMI 2.0 co-simulation FMUs can be wrapped")
+        inner_identifier = root.find("CoSimulation").get("modelIdentifier")
+        inner_library = find_inner_library(archive, platform, ext, inner_identifier)
+
+    variables = read_variables(root)
+    inner_guid = root.get("guid")
+    model_name = root.get("modelName")
+    # Deterministic GUID: the same inputs give the same FMU.
+    digest = hashlib.sha1((inner_guid + config_text).encode()).digest()
+    wrapper_guid = "{" + str(uuid.UUID(bytes=digest[:16])) + "}"
+    model_identifier = f"{model_name}_native_wrapper"
+
+    build_dir = tempfile.mkdtemp(prefix="native_wrapper_")
+    try:
+        with open(os.path.join(build_dir, TABLES_HEADER), "w") as f:
+            f.write(render_tables(variables, config, wrapper_guid, inner_guid, inner_library, model_name))
+        shutil.copy(TEMPLATE, build_dir)
+
+        fmu_dir = os.path.join(build_dir, "fmu")
+        binary_dir = os.path.join(fmu_dir, "binaries", platform)
+        os.makedirs(binary_dir)
+        command = [cxx, "-shared", "-fPIC", "-std=c++17", "-O2", "-fvisibility=hidden",
+                   "-I", build_dir, "-I", FMI_HEADERS,
+                   os.path.join(build_dir, os.path.basename(TEMPLATE)),
+                   "-o", os.path.join(binary_dir, model_identifier + ext)]
+        if platform == "linux64":
+            command.append("-ldl")
+        print(f"Running command: {' '.join(command)}")
+        subprocess.run(command, check=True)
+
+        with open(os.path.join(fmu_dir, "modelDescription.xml"), "w") as f:
+            f.write(wrapper_model_description(root, model_identifier, wrapper_guid))
+        with zipfile.ZipFile(fmu_path) as archive:
+            archive.extractall(os.path.join(fmu_dir, "resources", "model"))
+        shutil.copy(config_path, os.path.join(fmu_dir, "resources", "fault_config.json"))
+
+        if os.path.exists(output_path):
+            os.remove(output_path)
+        with zipfile.ZipFile(output_path, "w", zipfile.ZIP_DEFLATED) as out:
+            for folder, _, files in os.walk(fmu_dir):
+                for name in files:
+                    path = os.path.join(folder, name)
+                    out.write(path, os.path.relpath(path, fmu_dir))
+    finally:
+        if keep_build:
+            print(f"Build directory kept: {build_dir}")
+        else:
+            shutil.rmtree(build_dir, ignore_errors=True)
+    print(f"Your native wrapper FMU is ready: {output_path}")
+    return output_path
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--fmu", default="Amplifier.fmu", help="FMU to wrap")
+    parser.add_argument("--config", default="fault_config.json", help="fault schedule")
+    parser.add_argument("--output", default="Amplifier_native_wrapper.fmu")
+    parser.add_argument("--cxx", default=os.environ.get("CXX", "g++"), help="C++ compiler")
+    parser.add_argument("--keep-build", action="store_true", help="keep the generated sources")
+    args = parser.parse_args()
+    generate(args.fmu, args.config, args.output, args.keep_build, args.cxx)
+
+
+if __name__ == "__main__":
+    main()
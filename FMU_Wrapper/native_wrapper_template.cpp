@@ -0,0 +1,365 @@
+/**
+ * @file native_wrapper_template.cpp
+ * @brief Native fault-injecting wrapper FMU, specialized at compile time by generate_native_wrapper.py.
+ *
+ * Everything model- or schedule-specific comes from the generated header
+ * native_wrapper_tables.hpp: the inner FMU's identity, the variables as compile-time
+ * value-reference tables, and the fault schedule as constexpr segment tables (the
+ * event start/end times split the time axis into segments, and every segment lists
+ * the action for each input). The code below only indexes those tables, so the
+ * compiler can unroll and constant-fold the per-step work for the given model.
+ */
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+
+extern "C" {
+#include "fmi2Functions.h"
+}
+
+#include "native_wrapper_tables.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#define DLL_HANDLE HMODULE
+#define LOAD_LIBRARY(path) LoadLibraryA(path)
+#define GET_FUNCTION(handle, name) GetProcAddress(handle, name)
+#define FREE_LIBRARY(handle) FreeLibrary(handle)
+#define SEP "\\"
+#else
+#include <dlfcn.h>
+#define DLL_HANDLE void*
+#define LOAD_LIBRARY(path) dlopen(path, RTLD_LAZY)
+#define GET_FUNCTION(handle, name) dlsym(handle, name)
+#define FREE_LIBRARY(handle) dlclose(handle)
+#define SEP "/"
+#endif
+
+#if defined(_WIN32)
+#define PLATFORM "win64"
+#elif defined(__APPLE__)
+#define PLATFORM "darwin64"
+#else
+#define PLATFORM "linux64"
+#endif
+
+namespace {
+
+// Index of a value reference in its type's bank, or -1. The generated tables are dense in the VR.
+template <size_t N>
+constexpr int indexOf(const int (&table)[N], fmi2ValueReference vr) {
+    return vr < N ? table[vr] : -1;
+}
+
+// Segment containing t; `cursor` is the previous result, since time normally only moves forward.
+size_t locateSegment(double t, size_t cursor) {
+    constexpr size_t last = FAULT_SEGMENT_COUNT - 1;
+    if (std::isnan(t)) return 0;
+    if (t >= FAULT_BREAKS[cursor]) {
+        while (cursor < last && t >= FAULT_BREAKS[cursor + 1]) cursor++;
+        return cursor;
+    }
+    size_t s = 0;
+    while (s < last && t >= FAULT_BREAKS[s + 1]) s++;
+    return s;
+}
+
+double applyFault(FaultAction action, double faultValue, double value) {
+    switch (action) {
+    case FaultAction::StuckAt: return faultValue;
+    case FaultAction::Offset: return value + faultValue;
+    default: return value;
+    }
+}
+
+struct InnerFMU {
+    fmi2InstantiateTYPE* Instantiate = nullptr;
+    fmi2FreeInstanceTYPE* FreeInstance = nullptr;
+    fmi2SetupExperimentTYPE* SetupExperiment = nullptr;
+    fmi2EnterInitializationModeTYPE* EnterInitializationMode = nullptr;
+    fmi2ExitInitializationModeTYPE* ExitInitializationMode = nullptr;
+    fmi2TerminateTYPE* Terminate = nullptr;
+    fmi2ResetTYPE* Reset = nullptr;
+    fmi2GetRealTYPE* GetReal = nullptr;
+    fmi2SetRealTYPE* SetReal = nullptr;
+    fmi2GetIntegerTYPE* GetInteger = nullptr;
+    fmi2SetIntegerTYPE* SetInteger = nullptr;
+    fmi2GetBooleanTYPE* GetBoolean = nullptr;
+    fmi2SetBooleanTYPE* SetBoolean = nullptr;
+    fmi2DoStepTYPE* DoStep = nullptr;
+};
+
+// One wrapper instance. Values are cached per type bank, in the order of the generated tables.
+struct Wrapper {
+    const fmi2CallbackFunctions* callbacks;
+    std::string instanceName;
+    DLL_HANDLE library = nullptr;
+    fmi2Component inner = nullptr;
+    InnerFMU fmi;
+    size_t segment = 0;
+
+    fmi2Real reals[REAL_COUNT + 1];
+    fmi2Integer integers[INTEGER_COUNT + 1];
+    fmi2Boolean booleans[BOOLEAN_COUNT + 1];
+    // Scratch buffers for one batched call per type.
+    fmi2Real realBuffer[REAL_COUNT + 1];
+    fmi2Integer integerBuffer[INTEGER_COUNT + 1];
+    fmi2Boolean booleanBuffer[BOOLEAN_COUNT + 1];
+
+    void log(fmi2Status status, const char* category, const std::string& message) const {
+        if (callbacks && callbacks->logger) {
+            callbacks->logger(callbacks->componentEnvironment, instanceName.c_str(), status, category, message.c_str());
+        }
+    }
+};
+
+std::string uriToPath(const char* uri) {
+    std::string path(uri ? uri : "");
+    const std::string scheme = "file://";
+    if (path.rfind(scheme, 0) == 0) {
+        path.erase(0, scheme.length());
+#ifdef _WIN32
+        if (path.length() > 2 && path[0] == '/' && path[2] == ':') path.erase(0, 1);
+#endif
+    }
+    return path;
+}
+
+bool loadInner(Wrapper* w, const std::string& resourcePath) {
+    const std::string path = resourcePath + SEP + INNER_DIRECTORY + SEP "binaries" SEP PLATFORM SEP + INNER_LIBRARY + INNER_LIBRARY_EXT;
+    w->library = LOAD_LIBRARY(path.c_str());
+    if (!w->library) {
+        w->log(fmi2Fatal, "error", "Could not load inner FMU binary: " + path);
+        return false;
+    }
+#define LOAD_FUNC(Name)                                                                      \
+    w->fmi.Name = (fmi2##Name##TYPE*)GET_FUNCTION(w->library, "fmi2" #Name);                \
+    if (!w->fmi.Name) {                                                                      \
+        w->log(fmi2Fatal, "error", "Failed to load function: fmi2" #Name);                   \
+        return false;                                                                        \
+    }
+    LOAD_FUNC(Instantiate); LOAD_FUNC(FreeInstance); LOAD_FUNC(SetupExperiment);
+    LOAD_FUNC(EnterInitializationMode); LOAD_FUNC(ExitInitializationMode);
+    LOAD_FUNC(Terminate); LOAD_FUNC(Reset); LOAD_FUNC(GetReal);
+    LOAD_FUNC(SetReal); LOAD_FUNC(GetInteger); LOAD_FUNC(SetInteger);
+    LOAD_FUNC(GetBoolean); LOAD_FUNC(SetBoolean); LOAD_FUNC(DoStep);
+#undef LOAD_FUNC
+    return true;
+}
+
+// Sends the variables of the given role from the cache to the inner FMU, one call per type.
+// Inputs get the faults of the current segment applied first.
+template <bool WithFaults>
+fmi2Status forward(Wrapper* w, const Forwarding& f) {
+    const size_t row = w->segment * INPUT_COUNT;
+    fmi2Status status = fmi2OK;
+    if (f.realCount > 0) {
+        for (size_t i = 0; i < f.realCount; i++) {
+            double v = w->reals[f.realIndices[i]];
+            if (WithFaults) v = applyFault(FAULT_ACTIONS[row + f.realInputs[i]], FAULT_VALUES[row + f.realInputs[i]], v);
+            w->realBuffer[i] = v;
+        }
+        status = w->fmi.SetReal(w->inner, f.realVrs, f.realCount, w->realBuffer);
+        if (status > fmi2Warning) return status;
+    }
+    if (f.integerCount > 0) {
+        for (size_t i = 0; i < f.integerCount; i++) {
+            double v = w->integers[f.integerIndices[i]];
+            if (WithFaults) v = applyFault(FAULT_ACTIONS[row + f.integerInputs[i]], FAULT_VALUES[row + f.integerInputs[i]], v);
+            w->integerBuffer[i] = static_cast<fmi2Integer>(std::trunc(v));
+        }
+        status = w->fmi.SetInteger(w->inner, f.integerVrs, f.integerCount, w->integerBuffer);
+        if (status > fmi2Warning) return status;
+    }
+    if (f.booleanCount > 0) {
+        for (size_t i = 0; i < f.booleanCount; i++) {
+            double v = w->booleans[f.booleanIndices[i]] ? 1.0 : 0.0;
+            if (WithFaults) v = applyFault(FAULT_ACTIONS[row + f.booleanInputs[i]], FAULT_VALUES[row + f.booleanInputs[i]], v);
+            w->booleanBuffer[i] = v != 0.0 ? fmi2True : fmi2False;
+        }
+        status = w->fmi.SetBoolean(w->inner, f.booleanVrs, f.booleanCount, w->booleanBuffer);
+    }
+    return status;
+}
+
+fmi2Status readOutputs(Wrapper* w) {
+    const Forwarding& f = OUTPUTS;
+    fmi2Status status = fmi2OK;
+    if (f.realCount > 0) {
+        status = w->fmi.GetReal(w->inner, f.realVrs, f.realCount, w->realBuffer);
+        if (status > fmi2Warning) return status;
+        for (size_t i = 0; i < f.realCount; i++) w->reals[f.realIndices[i]] = w->realBuffer[i];
+    }
+    if (f.integerCount > 0) {
+        status = w->fmi.GetInteger(w->inner, f.integerVrs, f.integerCount, w->integerBuffer);
+        if (status > fmi2Warning) return status;
+        for (size_t i = 0; i < f.integerCount; i++) w->integers[f.integerIndices[i]] = w->integerBuffer[i];
+    }
+    if (f.booleanCount > 0) {
+        status = w->fmi.GetBoolean(w->inner, f.booleanVrs, f.booleanCount, w->booleanBuffer);
+        if (status > fmi2Warning) return status;
+        for (size_t i = 0; i < f.booleanCount; i++) w->booleans[f.booleanIndices[i]] = w->booleanBuffer[i];
+    }
+    return status;
+}
+
+template <typename T, size_t N>
+fmi2Status getValues(Wrapper* w, const int (&index)[N], const T* bank, const fmi2ValueReference vr[], size_t nvr, T value[], const char* fn) {
+    for (size_t i = 0; i < nvr; i++) {
+        const int k = indexOf(index, vr[i]);
+        if (k < 0) {
+            w->log(fmi2Error, "error", std::string(fn) + ": unknown value reference " + std::to_string(vr[i]));
+            return fmi2Error;
+        }
+        value[i] = bank[k];
+    }
+    return fmi2OK;
+}
+
+template <typename T, size_t N>
+fmi2Status setValues(Wrapper* w, const int (&index)[N], T* bank, const fmi2ValueReference vr[], size_t nvr, const T value[], const char* fn) {
+    for (size_t i = 0; i < nvr; i++) {
+        const int k = indexOf(index, vr[i]);
+        if (k < 0) {
+            w->log(fmi2Error, "error", std::string(fn) + ": unknown value reference " + std::to_string(vr[i]));
+            return fmi2Error;
+        }
+        bank[k] = value[i];
+    }
+    return fmi2OK;
+}
+
+} // namespace
+
+extern "C" {
+
+FMI2_Export const char* fmi2GetTypesPlatform(void) { return fmi2TypesPlatform; }
+FMI2_Export const char* fmi2GetVersion(void) { return fmi2Version; }
+
+FMI2_Export fmi2Component fmi2Instantiate(fmi2String instanceName, fmi2Type fmuType, fmi2String fmuGUID, fmi2String fmuResourceLocation,
+                                          const fmi2CallbackFunctions* functions, fmi2Boolean visible, fmi2Boolean loggingOn) {
+    if (fmuType != fmi2CoSimulation || !functions || !functions->allocateMemory || !functions->freeMemory) return nullptr;
+    if (!fmuGUID || std::strcmp(fmuGUID, WRAPPER_GUID) != 0) {
+        if (functions->logger) functions->logger(functions->componentEnvironment, instanceName, fmi2Error, "error", "GUID mismatch");
+        return nullptr;
+    }
+    void* memory = functions->allocateMemory(1, sizeof(Wrapper));
+    if (!memory) return nullptr;
+    Wrapper* w = new (memory) Wrapper();
+    w->callbacks = functions;
+    w->instanceName = instanceName ? instanceName : "";
+    for (size_t i = 0; i < REAL_COUNT; i++) w->reals[i] = REAL_START[i];
+    for (size_t i = 0; i < INTEGER_COUNT; i++) w->integers[i] = INTEGER_START[i];
+    for (size_t i = 0; i < BOOLEAN_COUNT; i++) w->booleans[i] = BOOLEAN_START[i];
+
+    const std::string resourcePath = uriToPath(fmuResourceLocation);
+    const std::string innerResources = std::string(fmuResourceLocation ? fmuResourceLocation : "") + "/" + INNER_DIRECTORY + "/resources";
+    if (loadInner(w, resourcePath)) {
+        w->inner = w->fmi.Instantiate(INNER_INSTANCE_NAME, fmi2CoSimulation, INNER_GUID, innerResources.c_str(), functions, visible, loggingOn);
+        if (!w->inner) w->log(fmi2Fatal, "error", "Failed to instantiate inner FMU.");
+    }
+    if (!w->inner) {
+        if (w->library) FREE_LIBRARY(w->library);
+        w->~Wrapper();
+        functions->freeMemory(memory);
+        return nullptr;
+    }
+    return w;
+}
+
+FMI2_Export void fmi2FreeInstance(fmi2Component c) {
+    if (!c) return;
+    Wrapper* w = static_cast<Wrapper*>(c);
+    const fmi2CallbackFunctions* callbacks = w->callbacks;
+    w->fmi.FreeInstance(w->inner);
+    FREE_LIBRARY(w->library);
+    w->~Wrapper();
+    callbacks->freeMemory(w);
+}
+
+FMI2_Export fmi2Status fmi2SetupExperiment(fmi2Component c, fmi2Boolean tolDef, fmi2Real tol, fmi2Real start, fmi2Boolean stopDef, fmi2Real stop) {
+    Wrapper* w = static_cast<Wrapper*>(c);
+    w->segment = locateSegment(start, 0);
+    return w->fmi.SetupExperiment(w->inner, tolDef, tol, start, stopDef, stop);
+}
+
+FMI2_Export fmi2Status fmi2EnterInitializationMode(fmi2Component c) {
+    Wrapper* w = static_cast<Wrapper*>(c);
+    return w->fmi.EnterInitializationMode(w->inner);
+}
+
+// Parameters are forwarded once, at the end of initialization.
+FMI2_Export fmi2Status fmi2ExitInitializationMode(fmi2Component c) {
+    Wrapper* w = static_cast<Wrapper*>(c);
+    const fmi2Status status = forward<false>(w, PARAMETERS);
+    if (status > fmi2Warning) return status;
+    return w->fmi.ExitInitializationMode(w->inner);
+}
+
+FMI2_Export fmi2Status fmi2Terminate(fmi2Component c) {
+    Wrapper* w = static_cast<Wrapper*>(c);
+    return w->fmi.Terminate(w->inner);
+}
+
+FMI2_Export fmi2Status fmi2Reset(fmi2Component c) {
+    Wrapper* w = static_cast<Wrapper*>(c);
+    w->segment = 0;
+    for (size_t i = 0; i < REAL_COUNT; i++) w->reals[i] = REAL_START[i];
+    for (size_t i = 0; i < INTEGER_COUNT; i++) w->integers[i] = INTEGER_START[i];
+    for (size_t i = 0; i < BOOLEAN_COUNT; i++) w->booleans[i] = BOOLEAN_START[i];
+    return w->fmi.Reset(w->inner);
+}
+
+FMI2_Export fmi2Status fmi2DoStep(fmi2Component c, fmi2Real currentCommunicationPoint, fmi2Real communicationStepSize, fmi2Boolean noSetFMUStatePriorToCurrentPoint) {
+    Wrapper* w = static_cast<Wrapper*>(c);
+    w->segment = locateSegment(currentCommunicationPoint, w->segment);
+    fmi2Status status = forward<true>(w, INPUTS);
+    if (status > fmi2Warning) return status;
+    status = w->fmi.DoStep(w->inner, currentCommunicationPoint, communicationStepSize, noSetFMUStatePriorToCurrentPoint);
+    if (status > fmi2Warning) return status;
+    return readOutputs(w);
+}
+
+FMI2_Export fmi2Status fmi2GetReal(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Real value[]) {
+    return getValues(static_cast<Wrapper*>(c), REAL_INDEX, static_cast<Wrapper*>(c)->reals, vr, nvr, value, "fmi2GetReal");
+}
+FMI2_Export fmi2Status fmi2SetReal(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Real value[]) {
+    return setValues(static_cast<Wrapper*>(c), REAL_INDEX, static_cast<Wrapper*>(c)->reals, vr, nvr, value, "fmi2SetReal");
+}
+FMI2_Export fmi2Status fmi2GetInteger(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Integer value[]) {
+    return getValues(static_cast<Wrapper*>(c), INTEGER_INDEX, static_cast<Wrapper*>(c)->integers, vr, nvr, value, "fmi2GetInteger");
+}
+FMI2_Export fmi2Status fmi2SetInteger(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Integer value[]) {
+    return setValues(static_cast<Wrapper*>(c), INTEGER_INDEX, static_cast<Wrapper*>(c)->integers, vr, nvr, value, "fmi2SetInteger");
+}
+FMI2_Export fmi2Status fmi2GetBoolean(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Boolean value[]) {
+    return getValues(static_cast<Wrapper*>(c), BOOLEAN_INDEX, static_cast<Wrapper*>(c)->booleans, vr, nvr, value, "fmi2GetBoolean");
+}
+FMI2_Export fmi2Status fmi2SetBoolean(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Boolean value[]) {
+    return setValues(static_cast<Wrapper*>(c), BOOLEAN_INDEX, static_cast<Wrapper*>(c)->booleans, vr, nvr, value, "fmi2SetBoolean");
+}
+
+// --- Unsupported functions ---
+FMI2_Export fmi2Status fmi2SetDebugLogging(fmi2Component, fmi2Boolean, size_t, const fmi2String[]) { return fmi2OK; }
+FMI2_Export fmi2Status fmi2GetString(fmi2Component, const fmi2ValueReference[], size_t, fmi2String[]) { return fmi2Error; }
+FMI2_Export fmi2Status fmi2SetString(fmi2Component, const fmi2ValueReference[], size_t, const fmi2String[]) { return fmi2Error; }
+FMI2_Export fmi2Status fmi2GetFMUstate(fmi2Component, fmi2FMUstate*) { return fmi2Error; }
+FMI2_Export fmi2Status fmi2SetFMUstate(fmi2Component, fmi2FMUstate) { return fmi2Error; }
+FMI2_Export fmi2Status fmi2FreeFMUstate(fmi2Component, fmi2FMUstate*) { return fmi2Error; }
+FMI2_Export fmi2Status fmi2SerializedFMUstateSize(fmi2Component, fmi2FMUstate, size_t*) { return fmi2Error; }
+FMI2_Export fmi2Status fmi2SerializeFMUstate(fmi2Component, fmi2FMUstate, fmi2Byte[], size_t) { return fmi2Error; }
+FMI2_Export fmi2Status fmi2DeSerializeFMUstate(fmi2Component, const fmi2Byte[], size_t, fmi2FMUstate*) { return fmi2Error; }
+FMI2_Export fmi2Status fmi2GetDirectionalDerivative(fmi2Component, const fmi2ValueReference[], size_t, const fmi2ValueReference[], size_t, const fmi2Real[], fmi2Real[]) { return fmi2Error; }
+FMI2_Export fmi2Status fmi2SetRealInputDerivatives(fmi2Component, const fmi2ValueReference[], size_t, const fmi2Integer[], const fmi2Real[]) { return fmi2Error; }
+FMI2_Export fmi2Status fmi2GetRealOutputDerivatives(fmi2Component, const fmi2ValueReference[], size_t, const fmi2Integer[], fmi2Real[]) { return fmi2Error; }
+FMI2_Export fmi2Status fmi2CancelStep(fmi2Component) { return fmi2Error; }
+FMI2_Export fmi2Status fmi2GetStatus(fmi2Component, const fmi2StatusKind, fmi2Status*) { return fmi2Error; }
+FMI2_Export fmi2Status fmi2GetRealStatus(fmi2Component, const fmi2StatusKind, fmi2Real*) { return fmi2Error; }
+FMI2_Export fmi2Status fmi2GetIntegerStatus(fmi2Component, const fmi2StatusKind, fmi2Integer*) { return fmi2Error; }
+FMI2_Export fmi2Status fmi2GetBooleanStatus(fmi2Component, const fmi2StatusKind, fmi2Boolean*) { return fmi2Error; }
+FMI2_Export fmi2Status fmi2GetStringStatus(fmi2Component, const fmi2StatusKind, fmi2String*) { return fmi2Error; }
+
+} // extern "C"
@@ -1,4 +1,6 @@
+import ctypes
 import json
+import os
 from pathlib import Path
 import importlib.resources
 import traceback
@@ -9,6 +11,19 @@ from fmpy.fmi2 import FMU2Slave as FMPY_FMU2Slave
 from pythonfmu.fmi2slave import Fmi2Slave, Fmi2Causality, Fmi2Variability, Fmi2Initial
 from pythonfmu.variables import Real, Integer, Boolean, String
 
+# Optional native fast path (fault_accel.cpp, built by build_fault_accel.sh and shipped
+# in the FMU resources). Without it the wrapper runs the pure Python path below.
+try:
+    import fault_accel
+except ImportError:
+    fault_accel = None
+
+# Inner FMU functions the native fast path calls directly.
+ACCELERATED_FUNCTIONS = (
+    "fmi2SetReal", "fmi2GetReal", "fmi2SetInteger", "fmi2GetInteger",
+    "fmi2SetBoolean", "fmi2GetBoolean", "fmi2DoStep",
+)
+
 # Map FMPy model types to pythonfmu variable classes
 FMPY_TO_PYTHONFMU_VAR_TYPE = {
     "Real": Real,
@@ -35,6 +50,15 @@ class FMUWrapper(Fmi2Slave):
 
         # name -> innerFMU valueReference (from original modelDescription)
         self.value_references = {}
+        # innerFMU valueReference -> name, and name -> FMI type name ("Real", ...)
+        self.names_by_vr = {}
+        self.variable_types = {}
+        # Variable names by role, in model description order.
+        self.inputs = []
+        self.outputs = []
+        self.parameters = []
+        # Native fault table and forwarding, created once the inner FMU is initialized.
+        self.accelerator = None
 
         # ----------------------------
         # 1) locate resources
@@ -52,6 +76,8 @@ class FMUWrapper(Fmi2Slave):
         # ----------------------------
         with open(config_path, "r") as f:
             self.fault_config = json.load(f)
+        # Per-call tracing is costly; enable it with "debug": true or FAULT_WRAPPER_DEBUG=1.
+        self.debug = bool(self.fault_config.get("debug", False)) or os.environ.get("FAULT_WRAPPER_DEBUG") == "1"
 
         # ----------------------------
         # 3) mirror original FMU interface
@@ -75,6 +101,14 @@ class FMUWrapper(Fmi2Slave):
             )
             # valueReference here is the inner/original FMU VR (we'll use it when talking to the inner FMU)
             self.value_references[var.name] = var.valueReference
+            self.names_by_vr[int(var.valueReference)] = var.name
+            self.variable_types[var.name] = var.type
+            if var.causality == "input":
+                self.inputs.append(var.name)
+            elif var.causality == "output":
+                self.outputs.append(var.name)
+            elif var.causality == "parameter" or var.variability == "fixed":
+                self.parameters.append(var.name)
 
             # set default start values safely
             start_value = var.start
@@ -115,31 +149,38 @@ class FMUWrapper(Fmi2Slave):
 
     def exit_initialization_mode(self):
         # copy fixed/parameter values from wrapper state -> inner FMU (typed)
-        for name, var in self.vars.items():
-            if var.causality == Fmi2Causality.parameter or var.variability == Fmi2Variability.fixed:
-                value = getattr(self, name)
-                vr = self.value_references[name]
-                vtype = var.type.__name__
-                print(f"[exit_initialization_mode] Setting {name} (vr={vr}, type={vtype}) = {value}")
-                if vtype == "Real":
-                    self.original_fmu_instance.setReal([vr], [float(value)])
-                elif vtype == "Integer":
-                    self.original_fmu_instance.setInteger([vr], [int(value)])
-                elif vtype == "Boolean":
-                    self.original_fmu_instance.setBoolean([vr], [bool(value)])
-                elif vtype == "String":
-                    self.original_fmu_instance.setString([vr], [str(value)])
+        for name in self.parameters:
+            value = getattr(self, name)
+            vr = self.value_references[name]
+            vtype = self.variable_types[name]
+            self._debug(f"[exit_initialization_mode] Setting {name} (vr={vr}, type={vtype}) = {value}")
+            if vtype == "Real":
+                self.original_fmu_instance.setReal([vr], [float(value)])
+            elif vtype == "Integer":
+                self.original_fmu_instance.setInteger([vr], [int(value)])
+            elif vtype == "Boolean":
+                self.original_fmu_instance.setBoolean([vr], [bool(value)])
+            elif vtype == "String":
+                self.original_fmu_instance.setString([vr], [str(value)])
 
         self.original_fmu_instance.exitInitializationMode()
+        self.accelerator = self._create_accelerator()
 
     def do_step(self, current_time, step_size):
         self.current_time = current_time
+
+        # Fast path: fault lookup, typed forwarding, doStep and output reads in one native call.
+        if self.accelerator is not None:
+            outputs = self.accelerator.step(current_time, step_size, [getattr(self, name) for name in self.inputs])
+            for name, value in zip(self.outputs, outputs):
+                setattr(self, name, value)
+            return True
+
         self._update_active_faults()
 
         # Push inputs (wrapper -> inner) using typed _set_value (this applies faults here)
-        for name, var in self.vars.items():
-            if var.causality == Fmi2Causality.input:
-                self._set_value(name, getattr(self, name))
+        for name in self.inputs:
+            self._set_value(name, getattr(self, name))
 
         # Advance the inner FMU
         self.original_fmu_instance.doStep(
@@ -149,12 +190,11 @@ class FMUWrapper(Fmi2Slave):
         )
 
         # Pull outputs from inner FMU -> wrapper attributes
-        for name, var in self.vars.items():
-            if var.causality == Fmi2Causality.output:
-                got = self._get_value(name)
-                if got is not None:
-                    # fmpy get* returns a list, take first item
-                    setattr(self, name, got[0] if isinstance(got, (list, tuple)) else got)
+        for name in self.outputs:
+            got = self._get_value(name)
+            if got is not None:
+                # fmpy get* returns a list, take first item
+                setattr(self, name, got[0] if isinstance(got, (list, tuple)) else got)
 
         return True
 
@@ -162,15 +202,47 @@ class FMUWrapper(Fmi2Slave):
         self.original_fmu_instance.reset()
 
     def terminate(self):
+        # The accelerator holds raw pointers into the inner FMU; drop it before freeing the instance.
+        self.accelerator = None
         self.original_fmu_instance.terminate()
         self.original_fmu_instance.freeInstance()
 
+    # ----------------------
+    # native fast path
+    # ----------------------
+    def _create_accelerator(self):
+        """Build the native fault table bound to the inner FMU, or return None to use the Python path."""
+        if fault_accel is None or not self.fault_config.get("native", True):
+            return None
+        if any(self.variable_types[name] == "String" for name in self.inputs + self.outputs):
+            self._debug("[accelerator] String inputs/outputs are not supported natively; using the Python path")
+            return None
+        try:
+            fmu = self.original_fmu_instance
+            functions = {name: ctypes.cast(getattr(fmu.dll, name), ctypes.c_void_p).value for name in ACCELERATED_FUNCTIONS}
+            component = getattr(fmu.component, "value", fmu.component)
+            return fault_accel.Accelerator(
+                functions,
+                component,
+                self.fault_config,
+                [(int(self.value_references[name]), self.variable_types[name]) for name in self.inputs],
+                [(int(self.value_references[name]), self.variable_types[name]) for name in self.outputs],
+            )
+        except Exception:
+            traceback.print_exc()
+            print("[accelerator] native fast path unavailable; using the Python path")
+            return None
+
+    def _debug(self, message):
+        if self.debug:
+            print(message)
+
     # ----------------------
     # typed access to inner FMU
     # ----------------------
     def _get_value(self, var_name):
         vr = self.value_references[var_name]
-        var_type = self.vars[var_name].type.__name__
+        var_type = self.variable_types[var_name]
         if var_type == "Real":
             return self.original_fmu_instance.getReal([vr])
         elif var_type == "Integer":
@@ -184,7 +256,7 @@ class FMUWrapper(Fmi2Slave):
     def _set_value(self, var_name, value):
         """Set value on the *inner* FMU (called from do_step), applying faults."""
         vr = self.value_references[var_name]
-        var_type = self.vars[var_name].type.__name__
+        var_type = self.variable_types[var_name]
         modified_value = value
 
         if vr in self.active_faults:
@@ -195,10 +267,10 @@ class FMUWrapper(Fmi2Slave):
             elif fault_type == "offset":
                 modified_value = value + fault["value"]
             if modified_value != value:
-                print(f"--- FAULT INJECTED at t={self.current_time:.2f}s on '{var_name}' (vr={vr}) ---")
-                print(f"  Original: {value}, Faulty: {modified_value} (Type: {fault_type})")
+                self._debug(f"--- FAULT INJECTED at t={self.current_time:.2f}s on '{var_name}' (vr={vr}) ---")
+                self._debug(f"  Original: {value}, Faulty: {modified_value} (Type: {fault_type})")
 
-        print(f"[_set_value] innerFMU set {var_name} (vr={vr}, type={var_type}) = {modified_value}")
+        self._debug(f"[_set_value] innerFMU set {var_name} (vr={vr}, type={var_type}) = {modified_value}")
 
         if var_type == "Real":
             self.original_fmu_instance.setReal([vr], [float(modified_value)])
@@ -225,15 +297,11 @@ class FMUWrapper(Fmi2Slave):
                         self.active_faults[vr] = {"type": vf["type"], "value": vf["value"]}
 
     def _get_name_by_vr(self, vr):
-        # value_references maps name -> inner VR; convert vr to int and search
+        # names_by_vr maps inner VR -> name
         try:
-            ival = int(vr)
-        except Exception:
-            ival = vr
-        for name, value_ref in self.value_references.items():
-            if int(value_ref) == int(ival):
-                return name
-        return None
+            return self.names_by_vr.get(int(vr))
+        except (TypeError, ValueError):
+            return None
 
     # ----------------------
     # Explicit handlers called by the pythonfmu C glue
@@ -259,8 +327,7 @@ class FMUWrapper(Fmi2Slave):
                         continue
                     val = float(values[i])
                     setattr(self, name, val)
-                    # debug
-                    print(f"[setReal] wrapper attr set {name} (vr={vr}) = {val}")
+                    self._debug(f"[setReal] wrapper attr set {name} (vr={vr}) = {val}")
                 except Exception:
                     traceback.print_exc()
                     print(f"[setReal] failed to set VR {vr} -> skipping (no exception raised to glue)")
@@ -286,7 +353,7 @@ class FMUWrapper(Fmi2Slave):
                         continue
                     val = int(values[i])
                     setattr(self, name, val)
-                    print(f"[setInteger] wrapper attr set {name} (vr={vr}) = {val}")
+                    self._debug(f"[setInteger] wrapper attr set {name} (vr={vr}) = {val}")
                 except Exception:
                     traceback.print_exc()
         except Exception:
@@ -309,7 +376,7 @@ class FMUWrapper(Fmi2Slave):
                         continue
                     val = bool(values[i])
                     setattr(self, name, val)
-                    print(f"[setBoolean] wrapper attr set {name} (vr={vr}) = {val}")
+                    self._debug(f"[setBoolean] wrapper attr set {name} (vr={vr}) = {val}")
                 except Exception:
                     traceback.print_exc()
         except Exception:
@@ -332,7 +399,7 @@ class FMUWrapper(Fmi2Slave):
                         continue
                     val = str(values[i])
                     setattr(self, name, val)
-                    print(f"[setString] wrapper attr set {name} (vr={vr}) = {val}")
+                    self._debug(f"[setString] wrapper attr set {name} (vr={vr}) = {val}")
                 except Exception:
                     traceback.print_exc()
         except Exception:
@@ -349,7 +416,7 @@ class FMUWrapper(Fmi2Slave):
                     out.append(0.0)
                 else:
                     out.append(float(getattr(self, name, 0.0)))
-            print(f"[getReal] returning {out} for vrs {list(vrs)}")
+            self._debug(f"[getReal] returning {out} for vrs {list(vrs)}")
             return out
         except Exception:
             traceback.print_exc()
@@ -365,7 +432,7 @@ class FMUWrapper(Fmi2Slave):
                     out.append(0)
                 else:
                     out.append(int(getattr(self, name, 0)))
-            print(f"[getInteger] returning {out}")
+            self._debug(f"[getInteger] returning {out}")
             return out
         except Exception:
             traceback.print_exc()
@@ -381,7 +448,7 @@ class FMUWrapper(Fmi2Slave):
                     out.append(False)
                 else:
                     out.append(bool(getattr(self, name, False)))
-            print(f"[getBoolean] returning {out}")
+            self._debug(f"[getBoolean] returning {out}")
             return out
         except Exception:
             traceback.print_exc()
@@ -397,7 +464,7 @@ class FMUWrapper(Fmi2Slave):
                     out.append("")
                 else:
                     out.append(str(getattr(self, name, "")))
-            print(f"[getString] returning {out}")
+            self._debug(f"[getString] returning {out}")
             return out
         except Exception:
             traceback.print_exc()
@@ -0,0 +1,410 @@
+"""
+Distributes a simulation campaign over worker processes on one or more nodes.
+
+A campaign is a JSON file naming a scenario count and a command template. The
+coordinator cuts the scenarios into ranges and leases them to workers over TCP or
+a Unix socket. A worker runs the command once per scenario, with {scenario}
+replaced by the scenario index and {output} by a CSV file the command must
+write. While it works, the worker sends a heartbeat every `heartbeat_seconds`.
+A lease that is not renewed within `lease_seconds`, or whose worker disconnects,
+goes back to the queue and is handed to the next worker that asks. Each finished
+range is stored as one part file under <out>.parts/. When the last range
+arrives, the parts are merged in scenario order into <out>, with a leading
+`scenario` column. Scenarios whose command failed are listed in <out>.failed.
+
+Campaign file (example_campaign.json):
+    {"scenarios": 64, "range_size": 4, "heartbeat_seconds": 2, "lease_seconds": 10,
+     "command": ["python3", "run_scenario.py", "{scenario}", "{output}"]}
+
+Usage:
+    python campaign.py coordinator CAMPAIGN --listen tcp://0.0.0.0:9300 --out results.csv [--local-workers N]
+    python campaign.py worker --connect tcp://coordinator-host:9300 [--workdir DIR]
+
+Addresses are tcp://host:port or unix:/path/to/socket. --local-workers starts N
+worker processes on this node, which is also how campaigns are tested locally.
+tests/test_campaign.py runs the coordinator and workers end to end on a stub command.
+"""
+import argparse
+import json
+import os
+import shutil
+import socket
+import socketserver
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+import uuid
+
+PROTOCOL_VERSION = 1
+
+
+# --- Transport: one JSON object per line over a stream socket ---
+
+def parse_address(address):
+    if address.startswith("unix:"):
+        return socket.AF_UNIX, address[len("unix:"):]
+    if address.startswith("tcp://"):
+        host, _, port = address[len("tcp://"):].rpartition(":")
+        return socket.AF_INET, (host or "127.0.0.1", int(port))
+    raise ValueError(f"invalid address '{address}'; use tcp://host:port or unix:/path")
+
+
+class Connection:
+    """Request/response channel; a lock lets the heartbeat thread share it with the main loop."""
+
+    def __init__(self, sock):
+        self.sock = sock
+        self.reader = sock.makefile("r", encoding="utf-8", newline="\n")
+        self.lock = threading.Lock()
+
+    def send(self, message):
+        self.sock.sendall((json.dumps(message, separators=(",", ":")) + "\n").encode("utf-8"))
+
+    def receive(self):
+        line = self.reader.readline()
+        if not line:
+            raise ConnectionError("connection closed")
+        return json.loads(line)
+
+    def request(self, message):
+        with self.lock:
+            self.send(message)
+            return self.receive()
+
+    def close(self):
+        try:
+            self.sock.close()
+        except OSError:
+            pass
+
+
+# --- Coordinator ---
+
+class Campaign:
+    """Lease bookkeeping; every method is called with `lock` held."""
+
+    def __init__(self, spec, out):
+        self.command = spec["command"]
+        self.scenarios = int(spec["scenarios"])
+        self.range_size = max(1, int(spec.get("range_size", 1)))
+        self.heartbeat_seconds = float(spec.get("heartbeat_seconds", 2.0))
+        self.lease_seconds = float(spec.get("lease_seconds", 5 * self.heartbeat_seconds))
+        self.out = out
+        self.parts_dir = out + ".parts"
+        self.lock = threading.Lock()
+        self.finished = threading.Event()
+        self.pending = [(start, min(start + self.range_size, self.scenarios))
+                        for start in range(0, self.scenarios, self.range_size)]
+        self.leases = {}     # lease id -> {"range", "worker", "expires"}
+        self.completed = {}  # range start -> part file
+        self.failed = []
+        self.reassigned = 0
+        os.makedirs(self.parts_dir, exist_ok=True)
+        # Ranges already stored by an earlier, interrupted coordinator are not run again.
+        for name in os.listdir(self.parts_dir):
+            if not (name.startswith("range_") and name.endswith(".csv")):
+                continue
+            start, end = (int(v) for v in name[len("range_"):-len(".csv")].split("-"))
+            if (start, end) in self.pending:
+                self.pending.remove((start, end))
+                self.completed[start] = os.path.join(self.parts_dir, name)
+                failed_path = os.path.join(self.parts_dir, name[:-len(".csv")] + ".failed")
+                if os.path.exists(failed_path):
+                    with open(failed_path) as f:
+                        self.failed.extend(int(line) for line in f if line.strip())
+        self.total_ranges = len(self.pending) + len(self.completed)
+
+    def lease(self, worker):
+        self.expire()
+        if not self.pending:
+            return None
+        scenario_range = self.pending.pop(0)
+        lease_id = uuid.uuid4().hex
+        self.leases[lease_id] = {"range": scenario_range, "worker": worker, "expires": time.monotonic() + self.lease_seconds}
+        return lease_id, scenario_range
+
+    def renew(self, lease_id):
+        lease = self.leases.get(lease_id)
+        if lease is None:
+            return False
+        lease["expires"] = time.monotonic() + self.lease_seconds
+        return True
+
+    def complete(self, lease_id, rows, failed):
+        lease = self.leases.pop(lease_id, None)
+        if lease is None:
+            return False  # Expired and reassigned; the new holder's result counts.
+        start, end = lease["range"]
+        path = os.path.join(self.parts_dir, f"range_{start}-{end}.csv")
+        if failed:
+            with open(path[:-len(".csv")] + ".failed", "w") as f:
+                f.write("".join(f"{index}\n" for index in failed))
+        with open(path + ".tmp", "w") as f:
+            f.write(rows)
+        os.replace(path + ".tmp", path)
+        self.completed[start] = path
+        self.failed.extend(failed)
+        if len(self.completed) == self.total_ranges:
+            self.merge()
+            self.finished.set()
+        return True
+
+    def release_worker(self, worker, reason):
+        for lease_id in [k for k, v in self.leases.items() if v["worker"] == worker]:
+            self.requeue(lease_id, reason)
+
+    def expire(self):
+        now = time.monotonic()
+        for lease_id in [k for k, v in self.leases.items() if v["expires"] < now]:
+            self.requeue(lease_id, "lease expired")
+
+    def requeue(self, lease_id, reason):
+        lease = self.leases.pop(lease_id)
+        start, end = lease["range"]
+        self.pending.insert(0, lease["range"])
+        self.reassigned += 1
+        print(f"Requeued scenarios {start}-{end - 1} from {lease['worker']}: {reason}", file=sys.stderr)
+
+    def merge(self):
+        header_written = False
+        with open(self.out + ".tmp", "w") as out:
+            for start in sorted(self.completed):
+                with open(self.completed[start]) as part:
+                    header = part.readline()
+                    if header and not header_written:
+                        out.write(header)
+                        header_written = True
+                    shutil.copyfileobj(part, out)
+        os.replace(self.out + ".tmp", self.out)
+        if self.failed:
+            with open(self.out + ".failed", "w") as f:
+                f.write("".join(f"{index}\n" for index in sorted(self.failed)))
+        shutil.rmtree(self.parts_dir)
+
+
+class CoordinatorHandler(socketserver.StreamRequestHandler):
+    def handle(self):
+        campaign = self.server.campaign
+        connection = Connection(self.request)
+        worker = None
+        try:
+            while True:
+                message = connection.receive()
+                kind = message.get("type")
+                with campaign.lock:
+                    if kind == "hello":
+                        if message.get("version") != PROTOCOL_VERSION:
+                            connection.send({"type": "error", "message": "protocol version mismatch"})
+                            return
+                        worker = message["worker"]
+                        reply = {"type": "welcome", "command": campaign.command,
+                                 "heartbeat_seconds": campaign.heartbeat_seconds}
+                    elif worker is None:
+                        reply = {"type": "error", "message": "expected hello"}
+                    elif kind == "lease":
+                        granted = None if campaign.finished.is_set() else campaign.lease(worker)
+                        if granted:
+                            lease_id, (start, end) = granted
+                            reply = {"type": "range", "lease": lease_id, "start": start, "end": end}
+                        elif campaign.finished.is_set():
+                            reply = {"type": "done"}
+                        else:
+                            # Everything is leased; wait in case a holder dies.
+                            reply = {"type": "wait", "seconds": campaign.heartbeat_seconds}
+                    elif kind == "heartbeat":
+                        reply = {"type": "ok" if campaign.renew(message["lease"]) else "revoked"}
+                    elif kind == "result":
+                        accepted = campaign.complete(message["lease"], message["rows"], message.get("failed", []))
+                        reply = {"type": "ok" if accepted else "revoked"}
+                    else:
+                        reply = {"type": "error", "message": f"unknown message type '{kind}'"}
+                connection.send(reply)
+        except (ConnectionError, OSError, ValueError):
+            pass
+        finally:
+            if worker is not None:
+                with campaign.lock:
+                    campaign.release_worker(worker, "worker disconnected")
+
+
+class UnixCoordinatorServer(socketserver.ThreadingMixIn, socketserver.UnixStreamServer):
+    daemon_threads = True
+
+
+class TcpCoordinatorServer(socketserver.ThreadingMixIn, socketserver.TCPServer):
+    daemon_threads = True
+    allow_reuse_address = True
+
+
+def run_coordinator(args):
+    with open(args.campaign) as f:
+        spec = json.load(f)
+    campaign = Campaign(spec, args.out)
+    family, address = parse_address(args.listen)
+    if family == socket.AF_UNIX:
+        if os.path.exists(address):
+            os.unlink(address)
+        server = UnixCoordinatorServer(address, CoordinatorHandler)
+    else:
+        server = TcpCoordinatorServer(address, CoordinatorHandler)
+    server.campaign = campaign
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+    print(f"Coordinator: {campaign.scenarios} scenarios in {campaign.total_ranges} ranges "
+          f"({len(campaign.completed)} already stored), listening on {args.listen}", file=sys.stderr)
+
+    workers = []
+    connect = args.listen.replace("0.0.0.0", "127.0.0.1")
+    for i in range(args.local_workers):
+        workers.append(subprocess.Popen([sys.executable, os.path.abspath(__file__), "worker", "--connect", connect,
+                                         "--workdir", os.path.dirname(os.path.abspath(args.campaign))]))
+
+    started = time.monotonic()
+    if campaign.total_ranges == len(campaign.completed):
+        with campaign.lock:
+            campaign.merge()
+            campaign.finished.set()
+    # Expire leases of silent workers even when nobody asks for work.
+    while not campaign.finished.wait(campaign.heartbeat_seconds / 2):
+        with campaign.lock:
+            campaign.expire()
+    # Give connected workers a moment to ask for work and receive "done".
+    deadline = time.monotonic() + 2 * campaign.heartbeat_seconds
+    for worker in workers:
+        try:
+            worker.wait(max(0.1, deadline - time.monotonic()))
+        except subprocess.TimeoutExpired:
+            worker.terminate()
+    server.shutdown()
+    server.server_close()
+    if family == socket.AF_UNIX:
+        os.unlink(address)
+    print(f"Campaign finished in {time.monotonic() - started:.1f} s: {len(campaign.failed)} failed scenarios, "
+          f"{campaign.reassigned} ranges reassigned; results in {args.out}", file=sys.stderr)
+    return 1 if campaign.failed else 0
+
+
+# --- Worker ---
+
+class Heartbeat(threading.Thread):
+    """Renews a lease until stopped; sets `revoked` if the coordinator took the range back."""
+
+    def __init__(self, connection, lease_id, interval):
+        super().__init__(daemon=True)
+        self.connection = connection
+        self.lease_id = lease_id
+        self.interval = interval
+        self.stopped = threading.Event()
+        self.revoked = threading.Event()
+
+    def run(self):
+        while not self.stopped.wait(self.interval):
+            try:
+                if self.connection.request({"type": "heartbeat", "lease": self.lease_id})["type"] != "ok":
+                    self.revoked.set()
+                    return
+            except (ConnectionError, OSError):
+                self.revoked.set()
+                return
+
+    def stop(self):
+        self.stopped.set()
+        self.join()
+
+
+def run_range(command, start, end, workdir, heartbeat):
+    """Runs scenarios [start, end); returns (csv rows with a scenario column, failed indices) or None if revoked."""
+    header = None
+    rows = []
+    failed = []
+    with tempfile.TemporaryDirectory(prefix="campaign_") as scratch:
+        for scenario in range(start, end):
+            output = os.path.join(scratch, f"scenario_{scenario}.csv")
+            argv = [part.replace("{scenario}", str(scenario)).replace("{output}", output) for part in command]
+            process = subprocess.Popen(argv, cwd=workdir)
+            while process.poll() is None:
+                if heartbeat.revoked.wait(0.05):
+                    process.kill()
+                    process.wait()
+                    return None
+            if process.returncode != 0 or not os.path.exists(output):
+                print(f"Scenario {scenario} failed with exit code {process.returncode}", file=sys.stderr)
+                failed.append(scenario)
+                continue
+            with open(output) as f:
+                lines = f.read().splitlines()
+            if not lines:
+                continue
+            if header is None:
+                header = "scenario," + lines[0]
+            rows.extend(f"{scenario},{line}" for line in lines[1:])
+    text = "".join(line + "\n" for line in ([header] if header else []) + rows)
+    return text, failed
+
+
+def run_worker(args):
+    family, address = parse_address(args.connect)
+    worker_id = f"{socket.gethostname()}:{os.getpid()}"
+    # Workers may start before the coordinator is listening.
+    for attempt in range(50):
+        try:
+            sock = socket.socket(family, socket.SOCK_STREAM)
+            sock.connect(address)
+            break
+        except OSError:
+            sock.close()
+            time.sleep(0.1 * min(attempt + 1, 10))
+    else:
+        print(f"Worker {worker_id}: cannot connect to {args.connect}", file=sys.stderr)
+        return 1
+    connection = Connection(sock)
+    welcome = connection.request({"type": "hello", "version": PROTOCOL_VERSION, "worker": worker_id})
+    if welcome.get("type") != "welcome":
+        print(f"Worker {worker_id}: rejected: {welcome.get('message')}", file=sys.stderr)
+        return 1
+    completed = 0
+    try:
+        while True:
+            reply = connection.request({"type": "lease"})
+            if reply["type"] == "done":
+                break
+            if reply["type"] == "wait":
+                time.sleep(reply["seconds"])
+                continue
+            heartbeat = Heartbeat(connection, reply["lease"], welcome["heartbeat_seconds"])
+            heartbeat.start()
+            result = run_range(welcome["command"], reply["start"], reply["end"], args.workdir, heartbeat)
+            heartbeat.stop()
+            if result is None:
+                print(f"Worker {worker_id}: lease on {reply['start']}-{reply['end'] - 1} was revoked", file=sys.stderr)
+                continue
+            rows, failed = result
+            connection.request({"type": "result", "lease": reply["lease"], "rows": rows, "failed": failed})
+            completed += reply["end"] - reply["start"]
+    except (ConnectionError, OSError) as e:
+        print(f"Worker {worker_id}: lost the coordinator: {e}", file=sys.stderr)
+        return 1
+    finally:
+        connection.close()
+    print(f"Worker {worker_id}: ran {completed} scenarios", file=sys.stderr)
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="role", required=True)
+    coordinator = commands.add_parser("coordinator", help="lease scenario ranges and merge the results")
+    coordinator.add_argument("campaign", help="campaign JSON file")
+    coordinator.add_argument("--listen", default="tcp://127.0.0.1:9300")
+    coordinator.add_argument("--out", default="results.csv")
+    coordinator.add_argument("--local-workers", type=int, default=0, help="start N workers on this node")
+    worker = commands.add_parser("worker", help="run leased scenario ranges")
+    worker.add_argument("--connect", default="tcp://127.0.0.1:9300")
+    worker.add_argument("--workdir", default=".", help="working directory of the scenario command")
+    args = parser.parse_args()
+    sys.exit(run_coordinator(args) if args.role == "coordinator" else run_worker(args))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,31 @@
+"""
+Example scenario for example_campaign.json: simulates the C++ wrapper FMU with a
+gain taken from the scenario index and writes time, u and y as CSV.
+
+Usage: python run_scenario.py SCENARIO OUTPUT.csv [--fmu ../FMU_CPP_Wrapper/Amplifier_CPP_Wrapper.fmu]
+"""
+import argparse
+
+import numpy as np
+from fmpy import simulate_fmu
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("scenario", type=int)
+    parser.add_argument("output")
+    parser.add_argument("--fmu", default="../FMU_CPP_Wrapper/Amplifier_CPP_Wrapper.fmu")
+    args = parser.parse_args()
+
+    # Scenario i sweeps the gain from 0.5 upwards in steps of 0.1.
+    gain = 0.5 + 0.1 * args.scenario
+    time = np.linspace(0.0, 10.0, 101)
+    inputs = np.array(list(zip(time, np.sin(2 * np.pi * 0.5 * time))), dtype=[("time", np.double), ("u", np.double)])
+    result = simulate_fmu(args.fmu, stop_time=10.0, output_interval=0.1, start_values={"k": gain},
+                          input=inputs, output=["u", "y"])
+    np.savetxt(args.output, np.column_stack([result["time"], result["u"], result["y"]]),
+               delimiter=",", header="time,u,y", comments="", fmt="%.17g")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,169 @@
+"""
+End-to-end tests of campaign.py: a coordinator and local workers run a trivial
+scenario command over a Unix socket in a temporary directory.
+
+Covers the merged output (including failed scenarios), requeueing of the range
+held by a worker that dies or stops heartbeating, and resuming an interrupted
+campaign from its stored parts.
+
+Usage: python3 tests/test_campaign.py (from campaign/ or anywhere else)
+"""
+import json
+import os
+import signal
+import subprocess
+import sys
+import tempfile
+import time
+import unittest
+
+CAMPAIGN = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "campaign.py")
+
+# Logs "<scenario> <worker pid>" to runs.log in the working directory, then writes one row.
+SCENARIO = """
+import os, sys, time
+scenario, output = int(sys.argv[1]), sys.argv[2]
+with open("runs.log", "a") as log:
+    log.write(f"{scenario} {os.getppid()}\\n")
+time.sleep(float(os.environ.get("SCENARIO_SECONDS", "0")))
+if str(scenario) in os.environ.get("SCENARIO_FAIL", "").split(","):
+    sys.exit(3)
+with open(output, "w") as f:
+    f.write(f"value,square\\n{scenario / 2},{scenario * scenario}\\n")
+"""
+
+TIMEOUT = 60
+
+
+class CampaignTest(unittest.TestCase):
+    def setUp(self):
+        self.scratch = tempfile.TemporaryDirectory(prefix="campaign_test_")
+        self.dir = self.scratch.name
+        self.socket = "unix:" + os.path.join(self.dir, "coordinator.sock")
+        self.out = os.path.join(self.dir, "results.csv")
+        self.processes = []
+
+    def tearDown(self):
+        for process in self.processes:
+            if process.poll() is None:
+                process.kill()
+            process.wait()
+            process.stderr.close()
+        self.scratch.cleanup()
+
+    def write_campaign(self, scenarios, range_size, heartbeat_seconds=0.2, lease_seconds=1.0):
+        path = os.path.join(self.dir, "campaign.json")
+        with open(path, "w") as f:
+            json.dump({"scenarios": scenarios, "range_size": range_size, "heartbeat_seconds": heartbeat_seconds,
+                       "lease_seconds": lease_seconds, "command": [sys.executable, "-c", SCENARIO, "{scenario}", "{output}"]}, f)
+        return path
+
+    def start(self, args, env=None):
+        process = subprocess.Popen([sys.executable, CAMPAIGN] + args, cwd=self.dir, stderr=subprocess.PIPE, text=True,
+                                   env=dict(os.environ, **(env or {})))
+        self.processes.append(process)
+        return process
+
+    def coordinator(self, campaign, local_workers=0, env=None):
+        return self.start(["coordinator", campaign, "--listen", self.socket, "--out", self.out,
+                           "--local-workers", str(local_workers)], env)
+
+    def worker(self, env=None):
+        return self.start(["worker", "--connect", self.socket, "--workdir", self.dir], env)
+
+    def finish(self, process):
+        _, stderr = process.communicate(timeout=TIMEOUT)
+        return process.returncode, stderr
+
+    def runs(self):
+        """Scenario index -> list of worker pids that started it."""
+        runs = {}
+        path = os.path.join(self.dir, "runs.log")
+        if os.path.exists(path):
+            with open(path) as f:
+                for line in f:
+                    scenario, pid = line.split()
+                    runs.setdefault(int(scenario), []).append(int(pid))
+        return runs
+
+    def wait_until(self, condition, what):
+        deadline = time.monotonic() + TIMEOUT
+        while not condition():
+            if time.monotonic() > deadline:
+                self.fail(f"timed out waiting for {what}")
+            time.sleep(0.02)
+
+    def assert_merged(self, scenarios, failed=()):
+        with open(self.out) as f:
+            lines = f.read().splitlines()
+        self.assertEqual(lines[0], "scenario,value,square")
+        expected = [f"{i},{i / 2},{i * i}" for i in range(scenarios) if i not in failed]
+        self.assertEqual(lines[1:], expected)
+        self.assertFalse(os.path.exists(self.out + ".parts"))
+
+    def test_merges_ranges_in_scenario_order(self):
+        campaign = self.write_campaign(scenarios=11, range_size=3)
+        code, stderr = self.finish(self.coordinator(campaign, local_workers=3, env={"SCENARIO_FAIL": "4"}))
+        self.assertEqual(code, 1, stderr)  # Failed scenarios make the campaign fail.
+        self.assert_merged(11, failed={4})
+        with open(self.out + ".failed") as f:
+            self.assertEqual(f.read(), "4\n")
+        self.assertEqual(sorted(self.runs()), list(range(11)))
+
+    def test_requeues_the_range_of_a_killed_worker(self):
+        campaign = self.write_campaign(scenarios=8, range_size=4)
+        env = {"SCENARIO_SECONDS": "0.2"}
+        coordinator = self.coordinator(campaign, env=env)
+        victim = self.worker(env)
+        self.wait_until(lambda: any(victim.pid in pids for pids in self.runs().values()), "the first worker to start a range")
+        victim.kill()
+        self.worker(env)
+        code, stderr = self.finish(coordinator)
+        self.assertEqual(code, 0, stderr)
+        self.assertIn("worker disconnected", stderr)
+        self.assert_merged(8)
+
+    def test_requeues_an_expired_lease(self):
+        campaign = self.write_campaign(scenarios=8, range_size=4)
+        env = {"SCENARIO_SECONDS": "0.2"}
+        coordinator = self.coordinator(campaign, env=env)
+        stalled = self.worker(env)
+        self.wait_until(lambda: any(stalled.pid in pids for pids in self.runs().values()), "the first worker to start a range")
+        # A stopped worker keeps its connection open but no longer renews its lease.
+        os.kill(stalled.pid, signal.SIGSTOP)
+        try:
+            self.worker(env)
+            code, stderr = self.finish(coordinator)
+        finally:
+            os.kill(stalled.pid, signal.SIGKILL)
+        self.assertEqual(code, 0, stderr)
+        self.assertIn("lease expired", stderr)
+        self.assert_merged(8)
+
+    def test_resumes_from_stored_parts(self):
+        campaign = self.write_campaign(scenarios=12, range_size=2)
+        env = {"SCENARIO_SECONDS": "0.1"}
+        coordinator = self.coordinator(campaign, env=env)
+        worker = self.worker(env)
+        parts = os.path.join(self.dir, "results.csv.parts")
+        stored = lambda: [name for name in os.listdir(parts) if name.endswith(".csv")] if os.path.isdir(parts) else []
+        self.wait_until(lambda: len(stored()) >= 2, "two stored ranges")
+        coordinator.kill()
+        coordinator.wait()
+        worker.wait(timeout=TIMEOUT)  # Exits once it loses the coordinator.
+        done = stored()
+
+        code, stderr = self.finish(self.coordinator(campaign, local_workers=2, env=env))
+        self.assertEqual(code, 0, stderr)
+        self.assertIn(f"({len(done)} already stored)", stderr)
+        self.assert_merged(12)
+        # Scenarios of the stored ranges are not run again.
+        runs = self.runs()
+        for name in done:
+            start, end = (int(v) for v in name[len("range_"):-len(".csv")].split("-"))
+            for scenario in range(start, end):
+                self.assertEqual(len(runs[scenario]), 1, f"scenario {scenario} ran again after the restart")
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,232 @@
+/**
+ * @file ModelBindings.hpp
+ * @brief Compile-time variable bindings generated from modelDescription.xml (FMI 3.0).
+ *
+ * Generated by generate_model_bindings.py; do not edit. The build regenerates this file
+ * from the model description, so value references cannot drift from the XML.
+ */
+#ifndef MODEL_BINDINGS_HPP
+#define MODEL_BINDINGS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+#include "fmi3Functions.h"
+
+// Value references of all variables.
+constexpr fmi3ValueReference VR_TIME             = 0;
+constexpr fmi3ValueReference VR_U                = 1;
+constexpr fmi3ValueReference VR_Y                = 2;
+constexpr fmi3ValueReference VR_K                = 3;
+constexpr fmi3ValueReference VR_N_CHANNELS       = 4;
+constexpr fmi3ValueReference VR_N_THREADS        = 5;
+constexpr fmi3ValueReference VR_PIN_THREADS      = 6;
+constexpr fmi3ValueReference VR_U32              = 7;
+constexpr fmi3ValueReference VR_Y32              = 8;
+constexpr fmi3ValueReference VR_SINGLE_PRECISION = 9;
+
+namespace model {
+
+using ValueReference = fmi3ValueReference;
+
+enum class Causality : uint8_t { Parameter, CalculatedParameter, Input, Output, Local, Independent, StructuralParameter };
+
+struct Variable {
+    const char* name;
+    ValueReference valueReference;
+    uint32_t index;     // Position in the bank of the variable's type.
+    Causality causality;
+    bool settable;      // Inputs and parameters; outputs, locals and the independent variable are read-only.
+};
+
+// Float64 variables.
+struct Float64 {
+    using Value = fmi3Float64;
+    static constexpr size_t COUNT = 2;
+
+    static constexpr uint32_t TIME = 0;
+    static constexpr uint32_t K    = 1;
+
+    static constexpr std::array<Variable, COUNT> VARIABLES = {{
+        {"time", 0, 0, Causality::Independent, false},
+        {"k", 3, 1, Causality::Parameter, true},
+    }};
+    static constexpr std::array<Value, COUNT> START = {{0.0, 2.0}};
+};
+
+// UInt32 variables.
+struct UInt32 {
+    using Value = fmi3UInt32;
+    static constexpr size_t COUNT = 1;
+
+    static constexpr uint32_t N_THREADS = 0;
+
+    static constexpr std::array<Variable, COUNT> VARIABLES = {{
+        {"nThreads", 5, 0, Causality::StructuralParameter, true},
+    }};
+    static constexpr std::array<Value, COUNT> START = {{1}};
+};
+
+// UInt64 variables.
+struct UInt64 {
+    using Value = fmi3UInt64;
+    static constexpr size_t COUNT = 1;
+
+    static constexpr uint32_t N_CHANNELS = 0;
+
+    static constexpr std::array<Variable, COUNT> VARIABLES = {{
+        {"nChannels", 4, 0, Causality::StructuralParameter, true},
+    }};
+    static constexpr std::array<Value, COUNT> START = {{1}};
+};
+
+// Boolean variables.
+struct Boolean {
+    using Value = fmi3Boolean;
+    static constexpr size_t COUNT = 2;
+
+    static constexpr uint32_t PIN_THREADS      = 0;
+    static constexpr uint32_t SINGLE_PRECISION = 1;
+
+    static constexpr std::array<Variable, COUNT> VARIABLES = {{
+        {"pinThreads", 6, 0, Causality::StructuralParameter, true},
+        {"singlePrecision", 9, 1, Causality::StructuralParameter, true},
+    }};
+    static constexpr std::array<Value, COUNT> START = {{fmi3False, fmi3False}};
+};
+
+// An array variable; its extent is the current value of the structural parameter `dimension`.
+struct ArrayVariable {
+    const char* name;
+    ValueReference valueReference;
+    uint32_t index;
+    ValueReference dimension;
+    Causality causality;
+    bool settable;
+};
+
+// Float64 array variables; the model owns their storage.
+struct Float64Array {
+    using Value = fmi3Float64;
+    static constexpr size_t COUNT = 2;
+
+    static constexpr uint32_t U = 0;
+    static constexpr uint32_t Y = 1;
+
+    static constexpr std::array<ArrayVariable, COUNT> VARIABLES = {{
+        {"u", 1, 0, 4, Causality::Input, true},
+        {"y", 2, 1, 4, Causality::Output, false},
+    }};
+    static constexpr std::array<Value, COUNT> START = {{0.0, 0.0}};
+};
+
+// Float32 array variables; the model owns their storage.
+struct Float32Array {
+    using Value = fmi3Float32;
+    static constexpr size_t COUNT = 2;
+
+    static constexpr uint32_t U32 = 0;
+    static constexpr uint32_t Y32 = 1;
+
+    static constexpr std::array<ArrayVariable, COUNT> VARIABLES = {{
+        {"u32", 7, 0, 4, Causality::Input, true},
+        {"y32", 8, 1, 4, Causality::Output, false},
+    }};
+    static constexpr std::array<Value, COUNT> START = {{0.0f, 0.0f}};
+};
+
+// --- Compile-time dispatch -------------------------------------------------------------
+
+// The values of one variable type, indexed by the descriptor's bank indices.
+template <class Type>
+using Bank = std::array<typename Type::Value, Type::COUNT>;
+
+template <class Type>
+constexpr Bank<Type> startValues() {
+    Bank<Type> bank{};
+    for (size_t i = 0; i < Type::COUNT; i++) bank[i] = Type::START[i];
+    return bank;
+}
+
+/**
+ * @brief Value reference -> bank index tables for one variable type, built at compile time.
+ *
+ * get() and set() copy values between a Bank and the caller's array with one table index
+ * per element. They return false on the first value reference that is unknown for this
+ * type (or not settable, for set()); the caller reports the error. getIndex() and
+ * setIndex() expose the lookup for storage that is not a Bank; they return NONE instead.
+ */
+template <class Type>
+class Dispatch {
+public:
+    using Value = typename Type::Value;
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+    static uint32_t getIndex(ValueReference vr) { return vr < VR_LIMIT ? GET[vr] : NONE; }
+    static uint32_t setIndex(ValueReference vr) { return vr < VR_LIMIT ? SET[vr] : NONE; }
+
+    static bool get(const Bank<Type>& bank, const ValueReference vr[], size_t nvr, Value value[]) {
+        for (size_t i = 0; i < nvr; i++) {
+            const uint32_t index = getIndex(vr[i]);
+            if (index == NONE) return false;
+            value[i] = bank[index];
+        }
+        return true;
+    }
+
+    static bool set(Bank<Type>& bank, const ValueReference vr[], size_t nvr, const Value value[]) {
+        for (size_t i = 0; i < nvr; i++) {
+            const uint32_t index = setIndex(vr[i]);
+            if (index == NONE) return false;
+            bank[index] = value[i];
+        }
+        return true;
+    }
+
+private:
+    static constexpr ValueReference limit() {
+        ValueReference limit = 0;
+        for (const Variable& var : Type::VARIABLES) limit = var.valueReference >= limit ? var.valueReference + 1 : limit;
+        return limit;
+    }
+
+    static constexpr ValueReference VR_LIMIT = limit();
+
+    static constexpr std::array<uint32_t, VR_LIMIT> table(bool settableOnly) {
+        std::array<uint32_t, VR_LIMIT> table{};
+        for (uint32_t& entry : table) entry = NONE;
+        for (const Variable& var : Type::VARIABLES) {
+            if (!settableOnly || var.settable) table[var.valueReference] = var.index;
+        }
+        return table;
+    }
+
+    static constexpr std::array<uint32_t, VR_LIMIT> GET = table(false);
+    static constexpr std::array<uint32_t, VR_LIMIT> SET = table(true);
+
+    static constexpr bool consistent() {
+        for (size_t i = 0; i < Type::COUNT; i++) {
+            if (Type::VARIABLES[i].index != i || GET[Type::VARIABLES[i].valueReference] != i) return false;
+        }
+        return true;
+    }
+    static_assert(Type::COUNT == std::size(Type::VARIABLES) && Type::COUNT == std::size(Type::START),
+                  "descriptor tables disagree on the variable count");
+    static_assert(consistent(), "value references are not unique or bank indices are not dense");
+};
+
+// Layout checks: a descriptor that disagrees with the XML fails here rather than at run time.
+static_assert(sizeof(Bank<Float64>) == 2 * sizeof(fmi3Float64), "Float64 bank is not dense");
+static_assert(sizeof(Dispatch<Float64>) > 0, "instantiates the Float64 table checks");
+static_assert(sizeof(Bank<UInt32>) == 1 * sizeof(fmi3UInt32), "UInt32 bank is not dense");
+static_assert(sizeof(Dispatch<UInt32>) > 0, "instantiates the UInt32 table checks");
+static_assert(sizeof(Bank<UInt64>) == 1 * sizeof(fmi3UInt64), "UInt64 bank is not dense");
+static_assert(sizeof(Dispatch<UInt64>) > 0, "instantiates the UInt64 table checks");
+static_assert(sizeof(Bank<Boolean>) == 2 * sizeof(fmi3Boolean), "Boolean bank is not dense");
+static_assert(sizeof(Dispatch<Boolean>) > 0, "instantiates the Boolean table checks");
+
+} // namespace model
+
+#endif // MODEL_BINDINGS_HPP
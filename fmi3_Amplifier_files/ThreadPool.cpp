@@ -0,0 +1,120 @@
+/**
+ * @file ThreadPool.cpp
+ * @brief Implements the persistent fork-join pool used by the amplifier's parallel doStep.
+ */
+#include "ThreadPool.hpp"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+// Workers poll this many times for the next step before sleeping on the condition variable.
+// Back-to-back steps then skip the futex wake-up; idle instances still sleep.
+constexpr int SPIN_ITERATIONS = 2000;
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+#if defined(__linux__)
+// Pins a thread to the index-th CPU the process may run on; errors leave the thread unpinned.
+void pinToCpu(std::thread& thread, size_t index) {
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return;
+    const int count = CPU_COUNT(&allowed);
+    if (count == 0) return;
+    size_t target = index % static_cast<size_t>(count);
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &allowed)) continue;
+        if (target-- == 0) {
+            cpu_set_t one;
+            CPU_ZERO(&one);
+            CPU_SET(cpu, &one);
+            pthread_setaffinity_np(thread.native_handle(), sizeof(one), &one);
+            return;
+        }
+    }
+}
+#endif
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t workers, bool pinThreads) {
+    if (workers < 1) workers = 1;
+    // Spinning only pays off when every worker has a CPU of its own.
+    const unsigned cpus = std::thread::hardware_concurrency();
+    m_spin = cpus != 0 && workers <= cpus ? SPIN_ITERATIONS : 0;
+    m_threads.reserve(workers - 1);
+    for (size_t w = 1; w < workers; w++) {
+        m_threads.emplace_back(&ThreadPool::workerLoop, this, w);
+#if defined(__linux__)
+        if (pinThreads) pinToCpu(m_threads.back(), w);
+#else
+        (void)pinThreads;
+#endif
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+        m_generation.fetch_add(1, std::memory_order_release);
+    }
+    m_wake.notify_all();
+    for (std::thread& thread : m_threads) thread.join();
+}
+
+void ThreadPool::dispatch(TaskFn fn, void* ctx) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_fn = fn;
+        m_ctx = ctx;
+        m_pending.store(m_threads.size(), std::memory_order_relaxed);
+        m_generation.fetch_add(1, std::memory_order_release);
+    }
+    m_wake.notify_all();
+
+    fn(ctx, 0);
+
+    // Chunks are equal, so the others usually finish within the spin; otherwise sleep.
+    for (int i = 0; i < m_spin && m_pending.load(std::memory_order_acquire) != 0; i++) cpuRelax();
+    if (m_pending.load(std::memory_order_acquire) != 0) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return m_pending.load(std::memory_order_acquire) == 0; });
+    }
+}
+
+void ThreadPool::workerLoop(size_t worker) {
+    uint64_t seen = 0;
+    for (;;) {
+        uint64_t generation = m_generation.load(std::memory_order_acquire);
+        for (int i = 0; i < m_spin && generation == seen; i++) {
+            cpuRelax();
+            generation = m_generation.load(std::memory_order_acquire);
+        }
+        TaskFn fn;
+        void* ctx;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stop || m_generation.load(std::memory_order_relaxed) != seen; });
+            if (m_stop) return;
+            seen = m_generation.load(std::memory_order_relaxed);
+            fn = m_fn;
+            ctx = m_ctx;
+        }
+        fn(ctx, worker);
+        if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            // Taking the lock orders this notify after the caller's predicate check.
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_done.notify_one();
+        }
+    }
+}
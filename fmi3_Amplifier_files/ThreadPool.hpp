@@ -0,0 +1,81 @@
+/**
+ * @file ThreadPool.hpp
+ * @brief A persistent fork-join pool for splitting one doStep across the cores of a socket.
+ *
+ * The pool is created once per instance when its structural parameters are applied and
+ * lives until the instance is freed, so a step costs a wake-up rather than thread creation.
+ * Every run() hands worker w the same chunk of the channel range, which keeps each page of
+ * the channel arrays on the NUMA node of the thread that first touched it.
+ */
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @class ThreadPool
+ * @brief Runs a task on N workers at once; worker 0 is the calling thread.
+ */
+class ThreadPool {
+public:
+    /**
+     * @param workers Total number of workers including the caller (at least 1).
+     * @param pinThreads Pins worker w (w >= 1) to the w-th CPU of the process's affinity mask.
+     */
+    ThreadPool(size_t workers, bool pinThreads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return m_threads.size() + 1; }
+
+    /** @brief Calls task(w) for every worker w in [0, size()) and returns when all calls have returned. */
+    template <class Task>
+    void run(Task&& task) {
+        if (m_threads.empty()) {
+            task(size_t{0});
+            return;
+        }
+        using Fn = std::remove_reference_t<Task>;
+        dispatch([](void* ctx, size_t worker) { (*static_cast<Fn*>(ctx))(worker); }, &task);
+    }
+
+    /**
+     * @brief The part of [0, n) that worker w of `workers` owns.
+     * Boundaries are multiples of `align` elements so neighbouring workers never share a cache line.
+     */
+    static std::pair<size_t, size_t> chunk(size_t worker, size_t workers, size_t n, size_t align) {
+        const size_t blocks = (n + align - 1) / align;
+        const size_t begin = blocks * worker / workers * align;
+        const size_t end = blocks * (worker + 1) / workers * align;
+        return {begin < n ? begin : n, end < n ? end : n};
+    }
+
+private:
+    using TaskFn = void (*)(void* ctx, size_t worker);
+
+    void dispatch(TaskFn fn, void* ctx);
+    void workerLoop(size_t worker);
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    TaskFn m_fn = nullptr;
+    void* m_ctx = nullptr;
+    std::atomic<uint64_t> m_generation{0}; // Bumped for every run(); workers wait for a new value.
+    std::atomic<size_t> m_pending{0};      // Workers (excluding the caller) still running the task.
+    bool m_stop = false;
+    int m_spin = 0;                        // Poll iterations before blocking; 0 when oversubscribed.
+};
+
+#endif // THREAD_POOL_HPP
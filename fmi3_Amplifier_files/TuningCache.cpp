@@ -0,0 +1,163 @@
+/**
+ * @file TuningCache.cpp
+ * @brief Implements the doStep layout cache shared by the amplifier and autotune_amplifier.
+ */
+#include "TuningCache.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#include <unistd.h>
+#endif
+
+namespace tuning {
+
+namespace {
+
+std::string environment(const char* name) {
+    const char* value = std::getenv(name);
+    return value ? value : "";
+}
+
+std::string formatKey(const TuningKey& key) {
+    return key.binaryHash + " " + key.host + " " + std::to_string(key.channelBucket) + " " + (key.singlePrecision ? "f32" : "f64");
+}
+
+} // namespace
+
+std::string cachePath() {
+    std::string path = environment("FMI3_AMPLIFIER_TUNING_CACHE");
+    if (!path.empty()) return path;
+#if defined(_WIN32)
+    path = environment("LOCALAPPDATA");
+    return path.empty() ? "" : path + "\\fmi3_amplifier_tuning.txt";
+#else
+    path = environment("XDG_CACHE_HOME");
+    if (!path.empty()) return path + "/fmi3_amplifier_tuning.txt";
+    path = environment("HOME");
+    return path.empty() ? "" : path + "/.cache/fmi3_amplifier_tuning.txt";
+#endif
+}
+
+std::string hostKey() {
+    std::string name;
+#if defined(_WIN32)
+    name = environment("COMPUTERNAME");
+#else
+    char buffer[256] = {};
+    if (gethostname(buffer, sizeof(buffer) - 1) == 0) name = buffer;
+#endif
+    for (char& c : name) {
+        if (c == ' ' || c == '\t') c = '_';
+    }
+    return (name.empty() ? "unknown" : name) + "/" + std::to_string(std::thread::hardware_concurrency());
+}
+
+std::string hashFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return "";
+    uint64_t hash = 0xcbf29ce484222325ull;
+    std::vector<char> buffer(1 << 16);
+    while (in) {
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        const std::streamsize n = in.gcount();
+        for (std::streamsize i = 0; i < n; i++) {
+            hash ^= static_cast<unsigned char>(buffer[i]);
+            hash *= 0x100000001b3ull;
+        }
+    }
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+    return hex;
+}
+
+std::string hashBinaryContaining(const void* address) {
+#if defined(_WIN32)
+    HMODULE module = nullptr;
+    char path[MAX_PATH];
+    if (!GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                            static_cast<LPCSTR>(address), &module) ||
+        GetModuleFileNameA(module, path, MAX_PATH) == 0) {
+        return "";
+    }
+    return hashFile(path);
+#else
+    Dl_info info;
+    if (!dladdr(address, &info) || !info.dli_fname) return "";
+    return hashFile(info.dli_fname);
+#endif
+}
+
+uint64_t channelBucket(uint64_t channels) {
+    uint64_t bucket = 1;
+    while (bucket < channels && bucket < (uint64_t{1} << 63)) bucket <<= 1;
+    return bucket;
+}
+
+bool lookup(const std::string& path, const TuningKey& key, TunedLayout& layout) {
+    if (path.empty() || key.binaryHash.empty()) return false;
+    std::ifstream in(path);
+    const std::string wanted = formatKey(key);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.compare(0, wanted.size(), wanted) != 0 || line.size() <= wanted.size() || line[wanted.size()] != ' ') continue;
+        std::istringstream values(line.substr(wanted.size()));
+        unsigned threads, pin;
+        double rate = 0.0;
+        if (!(values >> threads >> pin) || threads == 0) continue;
+        values >> rate;
+        layout.threads = threads;
+        layout.pinThreads = pin != 0;
+        layout.channelsPerSecond = rate;
+        return true;
+    }
+    return false;
+}
+
+// Rewrites the file through a temporary, so a concurrently starting instance never reads half a line.
+void store(const std::string& path, const TuningKey& key, const TunedLayout& layout) {
+    if (path.empty()) throw std::runtime_error("no tuning cache location; set FMI3_AMPLIFIER_TUNING_CACHE");
+    const std::string prefix = formatKey(key) + " ";
+    std::vector<std::string> lines;
+    {
+        std::ifstream in(path);
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.compare(0, prefix.size(), prefix) != 0) lines.push_back(line);
+        }
+    }
+    if (lines.empty()) lines.push_back("# <binary hash> <host> <channel bucket> <f64|f32> <threads> <pin> <channels per second>");
+    char rate[32];
+    std::snprintf(rate, sizeof(rate), "%.4g", layout.channelsPerSecond);
+    lines.push_back(prefix + std::to_string(layout.threads) + " " + (layout.pinThreads ? "1" : "0") + " " + rate);
+
+    const std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    std::error_code ignored;
+    if (!parent.empty()) std::filesystem::create_directories(parent, ignored);
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::trunc);
+        for (const std::string& line : lines) out << line << '\n';
+        if (!out) throw std::runtime_error("cannot write " + temporary);
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+#if defined(_WIN32)
+        // rename() does not replace an existing file on Windows.
+        std::remove(path.c_str());
+        if (std::rename(temporary.c_str(), path.c_str()) == 0) return;
+#endif
+        throw std::runtime_error("cannot replace " + path);
+    }
+}
+
+} // namespace tuning
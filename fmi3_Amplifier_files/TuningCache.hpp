@@ -0,0 +1,60 @@
+/**
+ * @file TuningCache.hpp
+ * @brief Per-host cache of the fastest doStep layout, written by autotune_amplifier.
+ *
+ * The best thread count and pinning depend on the model binary, the host and how many
+ * channels an instance steps, so entries are keyed by a hash of the FMU binary, the host
+ * name with its CPU count, the channel count rounded up to a power of two, and the
+ * precision. The amplifier consults the cache when nThreads is 0.
+ *
+ * The cache is a text file with one entry per line:
+ *     <binary hash> <host> <channel bucket> <f64|f32> <threads> <pin 0|1> <channels per second>
+ * Its path is $FMI3_AMPLIFIER_TUNING_CACHE, else $XDG_CACHE_HOME/fmi3_amplifier_tuning.txt,
+ * else ~/.cache/fmi3_amplifier_tuning.txt.
+ */
+#ifndef TUNING_CACHE_HPP
+#define TUNING_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+struct TunedLayout {
+    unsigned threads = 0;
+    bool pinThreads = false;
+    double channelsPerSecond = 0.0; // Measured by the tuner; informational.
+};
+
+struct TuningKey {
+    std::string binaryHash; // 16 hex digits; empty if the binary could not be hashed.
+    std::string host;
+    uint64_t channelBucket = 0;
+    bool singlePrecision = false;
+};
+
+namespace tuning {
+
+/** @brief The cache file path (see the file comment). Empty if no location is known. */
+std::string cachePath();
+
+/** @brief "<hostname>/<CPU count>", so a resized VM or container gets new entries. */
+std::string hostKey();
+
+/** @brief FNV-1a hash of a file's bytes as 16 hex digits, or "" if it cannot be read. */
+std::string hashFile(const std::string& path);
+
+/** @brief The hash of the shared library (or executable) that contains `address`. */
+std::string hashBinaryContaining(const void* address);
+
+/** @brief The smallest power of two >= channels (and >= 1). */
+uint64_t channelBucket(uint64_t channels);
+
+/** @brief Looks up a key; returns false if the file or the entry does not exist. */
+bool lookup(const std::string& path, const TuningKey& key, TunedLayout& layout);
+
+/** @brief Adds or replaces the entry for a key. @throws std::runtime_error if the file cannot be written. */
+void store(const std::string& path, const TuningKey& key, const TunedLayout& layout);
+
+} // namespace tuning
+
+#endif // TUNING_CACHE_HPP
@@ -0,0 +1,245 @@
+/**
+ * @file autotune_amplifier.cpp
+ * @brief Finds the fastest doStep layout of the FMI 3.0 amplifier on this host and caches it.
+ *
+ * For every requested channel count (the batch an instance steps at once) and precision, the
+ * tuner runs short calibration bursts over a grid of thread counts and pinning layouts through
+ * the FMI 3 API of the given binary, and stores the layout with the highest median channel
+ * throughput in the tuning cache (see TuningCache.hpp). Instances created with nThreads = 0
+ * then pick that layout up, so campaigns run at the measured optimum without manual tuning.
+ * Entries that are already cached are reported and skipped unless --force is given.
+ *
+ * Usage: autotune_amplifier <fmu binary> [--channels N[,N...]] [--precision f64|f32|both]
+ *            [--max-threads T] [--burst-ms 200] [--repeats 3] [--cache path] [--force]
+ */
+#include "fmi3Functions.h"
+#include "ModelBindings.hpp"
+#include "TuningCache.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#define DLL_HANDLE HMODULE
+#define LOAD_LIBRARY(path) LoadLibraryA(path)
+#define GET_FUNCTION(handle, name) GetProcAddress(handle, name)
+#define FREE_LIBRARY(handle) FreeLibrary(handle)
+#else
+#include <dlfcn.h>
+#define DLL_HANDLE void*
+#define LOAD_LIBRARY(path) dlopen(path, RTLD_NOW | RTLD_LOCAL)
+#define GET_FUNCTION(handle, name) dlsym(handle, name)
+#define FREE_LIBRARY(handle) dlclose(handle)
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Mirrors AmplifierModel::MIN_CHANNELS_PER_THREAD: the model clamps larger thread counts,
+// so measuring them would only repeat the clamped layout.
+constexpr uint64_t MIN_CHANNELS_PER_THREAD = uint64_t{1} << 15;
+
+// The FMI 3 functions the tuner needs, resolved once from the FMU binary.
+struct Fmi3Api {
+    fmi3InstantiateCoSimulationTYPE* InstantiateCoSimulation = nullptr;
+    fmi3FreeInstanceTYPE* FreeInstance = nullptr;
+    fmi3EnterInitializationModeTYPE* EnterInitializationMode = nullptr;
+    fmi3ExitInitializationModeTYPE* ExitInitializationMode = nullptr;
+    fmi3SetFloat64TYPE* SetFloat64 = nullptr;
+    fmi3SetUInt32TYPE* SetUInt32 = nullptr;
+    fmi3SetUInt64TYPE* SetUInt64 = nullptr;
+    fmi3SetBooleanTYPE* SetBoolean = nullptr;
+    fmi3DoStepTYPE* DoStep = nullptr;
+
+    void load(DLL_HANDLE library) {
+#define LOAD_FUNC(name)                                                                     \
+    name = reinterpret_cast<fmi3##name##TYPE*>(GET_FUNCTION(library, "fmi3" #name));       \
+    if (!name) throw std::runtime_error("FMU binary does not export fmi3" #name);
+        LOAD_FUNC(InstantiateCoSimulation); LOAD_FUNC(FreeInstance);
+        LOAD_FUNC(EnterInitializationMode); LOAD_FUNC(ExitInitializationMode);
+        LOAD_FUNC(SetFloat64); LOAD_FUNC(SetUInt32); LOAD_FUNC(SetUInt64); LOAD_FUNC(SetBoolean);
+        LOAD_FUNC(DoStep);
+#undef LOAD_FUNC
+    }
+};
+
+struct Options {
+    std::string library;
+    std::vector<uint64_t> channels{uint64_t{1} << 20};
+    std::vector<bool> precisions{false}; // singlePrecision values to tune.
+    unsigned maxThreads = 0;             // 0: every CPU.
+    double burstMs = 200.0;
+    unsigned repeats = 3;
+    std::string cache;
+    bool force = false;
+};
+
+void check(fmi3Status status, const char* what) {
+    if (status != fmi3OK && status != fmi3Warning) throw std::runtime_error(std::string(what) + " failed with status " + std::to_string(status));
+}
+
+void logMessage(fmi3InstanceEnvironment, fmi3Status status, fmi3String category, fmi3String message) {
+    if (status != fmi3OK) std::fprintf(stderr, "[%s] %s\n", category, message);
+}
+
+// Median channels per second of `repeats` bursts with one layout, after a warm-up burst.
+double measure(const Fmi3Api& api, const Options& options, uint64_t channels, bool singlePrecision, unsigned threads, bool pin) {
+    fmi3Instance instance = api.InstantiateCoSimulation("autotune", "", nullptr, fmi3False, fmi3False, fmi3False, fmi3False,
+                                                        nullptr, 0, nullptr, logMessage, nullptr);
+    if (!instance) throw std::runtime_error("instantiation failed");
+    double median = 0.0;
+    try {
+        const fmi3ValueReference nChannels = VR_N_CHANNELS, nThreads = VR_N_THREADS, pinThreads = VR_PIN_THREADS, precision = VR_SINGLE_PRECISION;
+        const fmi3ValueReference vrU = VR_U;
+        const fmi3UInt32 threadCount = threads;
+        const fmi3Boolean pinValue = pin ? fmi3True : fmi3False, single = singlePrecision ? fmi3True : fmi3False;
+        check(api.SetUInt64(instance, &nChannels, 1, &channels, 1), "fmi3SetUInt64");
+        check(api.SetUInt32(instance, &nThreads, 1, &threadCount, 1), "fmi3SetUInt32");
+        check(api.SetBoolean(instance, &pinThreads, 1, &pinValue, 1), "fmi3SetBoolean");
+        check(api.SetBoolean(instance, &precision, 1, &single, 1), "fmi3SetBoolean");
+        check(api.EnterInitializationMode(instance, fmi3False, 0.0, 0.0, fmi3False, 0.0), "fmi3EnterInitializationMode");
+        check(api.ExitInitializationMode(instance), "fmi3ExitInitializationMode");
+        std::vector<fmi3Float64> u(channels);
+        std::mt19937_64 rng(42);
+        std::uniform_real_distribution<fmi3Float64> distribution(-1.0, 1.0);
+        for (fmi3Float64& value : u) value = distribution(rng);
+        check(api.SetFloat64(instance, &vrU, 1, u.data(), u.size()), "fmi3SetFloat64");
+
+        fmi3Boolean eventHandlingNeeded, terminateSimulation, earlyReturn;
+        fmi3Float64 lastSuccessfulTime;
+        double time = 0.0;
+        const double h = 1e-3;
+        auto burst = [&](double ms) {
+            const auto start = Clock::now();
+            const auto end = start + std::chrono::duration<double, std::milli>(ms);
+            uint64_t steps = 0;
+            do {
+                check(api.DoStep(instance, time, h, fmi3True, &eventHandlingNeeded, &terminateSimulation, &earlyReturn, &lastSuccessfulTime), "fmi3DoStep");
+                time += h;
+                steps++;
+            } while (Clock::now() < end);
+            return static_cast<double>(steps * channels) / std::chrono::duration<double>(Clock::now() - start).count();
+        };
+        burst(options.burstMs / 4); // Warms the pool, the caches and the page tables.
+        std::vector<double> rates;
+        for (unsigned r = 0; r < options.repeats; r++) rates.push_back(burst(options.burstMs));
+        std::sort(rates.begin(), rates.end());
+        median = rates[rates.size() / 2];
+    } catch (...) {
+        api.FreeInstance(instance);
+        throw;
+    }
+    api.FreeInstance(instance);
+    return median;
+}
+
+// 1, 2, 4, ... up to the usable maximum, plus the maximum itself.
+std::vector<unsigned> threadCandidates(unsigned maxThreads, uint64_t channels) {
+    const unsigned usable = static_cast<unsigned>(std::min<uint64_t>(maxThreads, std::max<uint64_t>(1, channels / MIN_CHANNELS_PER_THREAD)));
+    std::vector<unsigned> candidates;
+    for (unsigned t = 1; t < usable; t *= 2) candidates.push_back(t);
+    candidates.push_back(usable);
+    return candidates;
+}
+
+std::vector<uint64_t> parseList(const char* text) {
+    std::vector<uint64_t> values;
+    for (const char* p = text; *p;) {
+        char* end;
+        values.push_back(std::strtoull(p, &end, 10));
+        if (end == p || values.back() == 0) throw std::runtime_error(std::string("invalid channel list '") + text + "'");
+        p = *end == ',' ? end + 1 : end;
+    }
+    return values;
+}
+
+Options parseOptions(int argc, char** argv) {
+    if (argc < 2) throw std::runtime_error("usage: autotune_amplifier <fmu binary> [options]; see autotune_amplifier.cpp");
+    Options options;
+    options.library = argv[1];
+    for (int i = 2; i < argc; i++) {
+        const std::string arg = argv[i];
+        auto value = [&]() -> const char* {
+            if (i + 1 >= argc) throw std::runtime_error("missing value for " + arg);
+            return argv[++i];
+        };
+        if (arg == "--channels") options.channels = parseList(value());
+        else if (arg == "--precision") {
+            const std::string precision = value();
+            if (precision == "f64") options.precisions = {false};
+            else if (precision == "f32") options.precisions = {true};
+            else if (precision == "both") options.precisions = {false, true};
+            else throw std::runtime_error("invalid --precision '" + precision + "'; use f64, f32 or both");
+        }
+        else if (arg == "--max-threads") options.maxThreads = static_cast<unsigned>(std::strtoul(value(), nullptr, 10));
+        else if (arg == "--burst-ms") options.burstMs = std::atof(value());
+        else if (arg == "--repeats") options.repeats = std::max(1u, static_cast<unsigned>(std::strtoul(value(), nullptr, 10)));
+        else if (arg == "--cache") options.cache = value();
+        else if (arg == "--force") options.force = true;
+        else throw std::runtime_error("unknown option " + arg);
+    }
+    if (options.maxThreads == 0) options.maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    if (options.cache.empty()) options.cache = tuning::cachePath();
+    return options;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        const Options options = parseOptions(argc, argv);
+        DLL_HANDLE library = LOAD_LIBRARY(options.library.c_str());
+        if (!library) throw std::runtime_error("cannot load " + options.library);
+        Fmi3Api api;
+        api.load(library);
+
+        TuningKey key;
+        key.binaryHash = tuning::hashFile(options.library);
+        key.host = tuning::hostKey();
+        if (key.binaryHash.empty()) throw std::runtime_error("cannot hash " + options.library);
+        std::printf("Tuning %s (%s) on %s; cache %s\n", options.library.c_str(), key.binaryHash.c_str(), key.host.c_str(), options.cache.c_str());
+
+        for (const uint64_t channels : options.channels) {
+            for (const bool singlePrecision : options.precisions) {
+                key.channelBucket = tuning::channelBucket(channels);
+                key.singlePrecision = singlePrecision;
+                const char* precisionName = singlePrecision ? "f32" : "f64";
+                TunedLayout best;
+                if (!options.force && tuning::lookup(options.cache, key, best)) {
+                    std::printf("%llu channels %s: cached %u threads%s (%.3g channels/s); --force to re-measure\n",
+                                static_cast<unsigned long long>(channels), precisionName, best.threads, best.pinThreads ? " pinned" : "",
+                                best.channelsPerSecond);
+                    continue;
+                }
+                std::printf("%llu channels %s (bucket %llu):\n", static_cast<unsigned long long>(channels), precisionName,
+                            static_cast<unsigned long long>(key.channelBucket));
+                best = TunedLayout{};
+                for (const unsigned threads : threadCandidates(options.maxThreads, channels)) {
+                    for (const bool pin : {false, true}) {
+                        if (pin && threads == 1) continue; // Worker 0 is the caller and never pinned.
+                        const double rate = measure(api, options, channels, singlePrecision, threads, pin);
+                        std::printf("  %3u threads %-8s %10.3f Gchannels/s\n", threads, pin ? "pinned" : "unpinned", rate / 1e9);
+                        if (rate > best.channelsPerSecond) best = TunedLayout{threads, pin, rate};
+                    }
+                }
+                tuning::store(options.cache, key, best);
+                std::printf("  best: %u threads%s, cached\n", best.threads, best.pinThreads ? " pinned" : "");
+            }
+        }
+        FREE_LIBRARY(library);
+        return 0;
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "autotune_amplifier: %s\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,147 @@
+/**
+ * @file benchmark_amplifier.cpp
+ * @brief Throughput benchmark and accuracy check for the FMI 3.0 amplifier's channel kernels.
+ *
+ * Runs the same random input through a float64 and a singlePrecision instance via the FMI 3
+ * API, reports step time and effective memory bandwidth for both, and compares the float32
+ * outputs with the float64 reference. The check fails (exit code 1) if any channel's relative
+ * error exceeds MAX_RELATIVE_ERROR: u and k are each rounded to float32 once and the product
+ * once more, so a correct float32 path stays within about 1.5 ulp.
+ *
+ * Usage: benchmark_amplifier [channels] [threads] [steps]
+ *
+ * channels and steps must be positive, threads may be 0 (every CPU). Anything else,
+ * including an option such as --help, prints the usage and exits with code 3.
+ */
+#include "fmi3Functions.h"
+#include "ModelBindings.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr double MAX_RELATIVE_ERROR = 2.0 * FLT_EPSILON;
+constexpr fmi3Float64 GAIN = 1.7; // Not exactly representable in float32.
+
+void logMessage(fmi3InstanceEnvironment, fmi3Status status, fmi3String category, fmi3String message) {
+    if (status != fmi3OK) std::fprintf(stderr, "[%s] %s\n", category, message);
+}
+
+struct Result {
+    double secondsPerStep = 0.0;
+    std::vector<fmi3Float64> y;
+};
+
+// Instantiates the amplifier with the given layout, sets u, runs `steps` steps and returns y.
+bool run(const std::vector<fmi3Float64>& u, fmi3UInt32 threads, bool singlePrecision, int steps, Result& result) {
+    fmi3Instance instance = fmi3InstantiateCoSimulation("benchmark", "", nullptr, fmi3False, fmi3False, fmi3False, fmi3False,
+                                                        nullptr, 0, nullptr, logMessage, nullptr);
+    if (!instance) return false;
+    const fmi3ValueReference nChannels = VR_N_CHANNELS, nThreads = VR_N_THREADS, precision = VR_SINGLE_PRECISION;
+    const fmi3ValueReference vrU = VR_U, vrY = VR_Y, vrK = VR_K;
+    const fmi3UInt64 channels = u.size();
+    const fmi3Boolean single = singlePrecision ? fmi3True : fmi3False;
+    bool ok = fmi3SetUInt64(instance, &nChannels, 1, &channels, 1) == fmi3OK &&
+              fmi3SetUInt32(instance, &nThreads, 1, &threads, 1) == fmi3OK &&
+              fmi3SetBoolean(instance, &precision, 1, &single, 1) == fmi3OK &&
+              fmi3EnterInitializationMode(instance, fmi3False, 0.0, 0.0, fmi3False, 0.0) == fmi3OK &&
+              fmi3SetFloat64(instance, &vrK, 1, &GAIN, 1) == fmi3OK &&
+              fmi3ExitInitializationMode(instance) == fmi3OK &&
+              fmi3SetFloat64(instance, &vrU, 1, u.data(), u.size()) == fmi3OK;
+
+    // One untimed step warms the pool and the caches.
+    fmi3Boolean eventHandlingNeeded, terminateSimulation, earlyReturn;
+    fmi3Float64 lastSuccessfulTime;
+    double time = 0.0;
+    const double h = 1e-3;
+    ok = ok && fmi3DoStep(instance, time, h, fmi3True, &eventHandlingNeeded, &terminateSimulation, &earlyReturn, &lastSuccessfulTime) == fmi3OK;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; ok && i < steps; i++) {
+        time += h;
+        ok = fmi3DoStep(instance, time, h, fmi3True, &eventHandlingNeeded, &terminateSimulation, &earlyReturn, &lastSuccessfulTime) == fmi3OK;
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    result.secondsPerStep = std::chrono::duration<double>(stop - start).count() / std::max(1, steps);
+
+    result.y.resize(u.size());
+    ok = ok && fmi3GetFloat64(instance, &vrY, 1, result.y.data(), result.y.size()) == fmi3OK;
+    fmi3FreeInstance(instance);
+    return ok;
+}
+
+// Parses a whole decimal argument in [min, max]; rejects signs, junk and overflow.
+bool parseCount(const char* text, unsigned long long min, unsigned long long max, unsigned long long& value) {
+    if (!std::isdigit(static_cast<unsigned char>(text[0]))) return false;
+    char* end = nullptr;
+    errno = 0;
+    value = std::strtoull(text, &end, 10);
+    return *end == '\0' && errno == 0 && value >= min && value <= max;
+}
+
+int usage(const char* program) {
+    std::fprintf(stderr, "usage: %s [channels] [threads] [steps]\n"
+                         "  channels  amplifier channels, > 0 (default 4194304)\n"
+                         "  threads   doStep threads, 0 = all CPUs (default 0)\n"
+                         "  steps     timed steps, > 0 (default 100)\n", program);
+    return 3;
+}
+
+void report(const char* label, const Result& result, size_t channels, size_t bytesPerValue) {
+    // Each step reads u and writes y once.
+    const double bytes = 2.0 * static_cast<double>(channels) * static_cast<double>(bytesPerValue);
+    std::printf("%-8s %12.1f us/step %10.2f Gchannels/s %8.2f GB/s\n", label, result.secondsPerStep * 1e6,
+                channels / result.secondsPerStep / 1e9, bytes / result.secondsPerStep / 1e9);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    unsigned long long channelsArg = 1ull << 22, threadsArg = 0, stepsArg = 100;
+    if (argc > 4 || (argc > 1 && !parseCount(argv[1], 1, SIZE_MAX / sizeof(fmi3Float64), channelsArg))
+        || (argc > 2 && !parseCount(argv[2], 0, UINT32_MAX, threadsArg)) || (argc > 3 && !parseCount(argv[3], 1, INT_MAX, stepsArg))) {
+        return usage(argv[0]);
+    }
+    const size_t channels = static_cast<size_t>(channelsArg);
+    const fmi3UInt32 threads = static_cast<fmi3UInt32>(threadsArg);
+    const int steps = static_cast<int>(stepsArg);
+
+    std::vector<fmi3Float64> u(channels);
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<fmi3Float64> distribution(-1.0, 1.0);
+    for (fmi3Float64& value : u) value = distribution(rng);
+
+    std::printf("%zu channels, %u threads (0 = all CPUs), %d steps\n", channels, threads, steps);
+    Result reference, single;
+    if (!run(u, threads, false, steps, reference) || !run(u, threads, true, steps, single)) {
+        std::fprintf(stderr, "Benchmark failed: the amplifier returned an error.\n");
+        return 2;
+    }
+    report("float64", reference, channels, sizeof(fmi3Float64));
+    report("float32", single, channels, sizeof(fmi3Float32));
+    std::printf("float32 speedup: %.2fx\n", reference.secondsPerStep / single.secondsPerStep);
+
+    double maxRelative = 0.0;
+    size_t worst = 0;
+    for (size_t i = 0; i < channels; i++) {
+        const double relative = std::fabs(single.y[i] - reference.y[i]) / std::max(std::fabs(reference.y[i]), static_cast<double>(FLT_MIN));
+        if (relative > maxRelative) {
+            maxRelative = relative;
+            worst = i;
+        }
+    }
+    const bool pass = maxRelative <= MAX_RELATIVE_ERROR;
+    std::printf("accuracy: max relative error %.3g (%.2f ulp) at channel %zu, limit %.3g: %s\n", maxRelative,
+                maxRelative / FLT_EPSILON, worst, MAX_RELATIVE_ERROR, pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
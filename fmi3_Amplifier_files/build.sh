@@ -3,9 +3,15 @@
 set -e
 
 FMU_NAME="Amplifier_FMI3"
-CPP_SOURCE="fmi3_amplifier.cpp"
+CPP_SOURCE="fmi3_amplifier.cpp ThreadPool.cpp TuningCache.cpp"
 XML_DESCRIPTION="modelDescription.xml"
 HEADER_DIR="." # Assumes fmi3*.h files are in the same directory
+# Set to 1 to also build benchmark_amplifier (float64 vs. float32 throughput and accuracy check).
+BUILD_BENCHMARK="${BUILD_BENCHMARK:-0}"
+# Set to 1 to also build parareal_runner (parallel-in-time runner for any FMI 3 binary with serializable state).
+BUILD_PARAREAL="${BUILD_PARAREAL:-0}"
+# Set to 1 to also build autotune_amplifier (caches the fastest nThreads/pinThreads layout per host for nThreads = 0).
+BUILD_AUTOTUNE="${BUILD_AUTOTUNE:-0}"
 
 echo "--- Starting FMI 3.0 Amplifier FMU Build Process ---"
 
@@ -37,8 +43,31 @@ fi
 
 mkdir -p "${BUILD_DIR}/binaries/${PLATFORM_DIR}"
 
+# Regenerate the variable bindings from the model description; without Python the committed header is used.
+if command -v python3 >/dev/null 2>&1; then
+    python3 ../generate_model_bindings.py "${XML_DESCRIPTION}" ModelBindings.hpp
+fi
+
 echo "Compiling for platform: ${PLATFORM_DIR}"
-g++ -shared -fPIC -std=c++17 -I"${HEADER_DIR}" "${CPP_SOURCE}" -o "${BUILD_DIR}/binaries/${PLATFORM_DIR}/fmi3_amplifier${SHARED_LIB_EXT}"
+# -O3 vectorizes the per-channel kernel; the worker pool needs pthreads and the tuning cache
+# lookup needs dladdr (libdl on older glibc).
+DL_FLAGS=""
+if [[ "${PLATFORM_DIR}" != "win64" ]]; then
+    DL_FLAGS="-ldl"
+fi
+g++ -shared -fPIC -std=c++17 -O3 -I"${HEADER_DIR}" ${CPP_SOURCE} -o "${BUILD_DIR}/binaries/${PLATFORM_DIR}/fmi3_amplifier${SHARED_LIB_EXT}" -lpthread ${DL_FLAGS}
+if [[ "${BUILD_BENCHMARK}" == "1" ]]; then
+    echo "Compiling benchmark_amplifier"
+    g++ -std=c++17 -O3 -I"${HEADER_DIR}" benchmark_amplifier.cpp ${CPP_SOURCE} -o benchmark_amplifier -lpthread ${DL_FLAGS}
+fi
+if [[ "${BUILD_PARAREAL}" == "1" ]]; then
+    echo "Compiling parareal_runner"
+    g++ -std=c++17 -O2 -I"${HEADER_DIR}" parareal_runner.cpp -o parareal_runner -lpthread -ldl
+fi
+if [[ "${BUILD_AUTOTUNE}" == "1" ]]; then
+    echo "Compiling autotune_amplifier"
+    g++ -std=c++17 -O2 -I"${HEADER_DIR}" autotune_amplifier.cpp TuningCache.cpp -o autotune_amplifier -lpthread ${DL_FLAGS}
+fi
 echo "Compilation successful."
 
 # 4. Copy modelDescription.xml
@@ -4,18 +4,36 @@
  */
 
 #include "fmi3_amplifier.hpp"
+#include "TuningCache.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <string>
 #include <stdexcept>
+#include <thread>
+#include <type_traits>
+
+namespace {
+
+// The per-channel kernel; restrict lets the compiler vectorize it without alias checks.
+template <class T>
+void amplify(const T* __restrict u, T* __restrict y, T k, size_t n) {
+    for (size_t i = 0; i < n; i++) y[i] = k * u[i];
+}
+
+// Hash of this binary, the model part of the tuning cache key; computed once per process.
+const std::string& binaryHash() {
+    static const char anchor = 0;
+    static const std::string hash = tuning::hashBinaryContaining(&anchor);
+    return hash;
+}
+
+} // namespace
 
 // --- C++ Class Implementation ---
 
 AmplifierModel::AmplifierModel(fmi3String instanceName, fmi3InstanceEnvironment instanceEnvironment, fmi3LogMessageCallback logger)
-    : m_instanceName(instanceName), m_instanceEnvironment(instanceEnvironment), m_logger(logger) {
-    // Initialize default values
-    m_u = 0.0;
-    m_y = 0.0;
-    m_k = 2.0; // Default gain
-}
+    : m_instanceName(instanceName), m_instanceEnvironment(instanceEnvironment), m_logger(logger) {}
 
 AmplifierModel::~AmplifierModel() {}
 
@@ -25,26 +43,549 @@ void AmplifierModel::log(fmi3Status status, const std::string& category, const s
     }
 }
 
-fmi3Status AmplifierModel::getFloat64(const fmi3ValueReference vr[], size_t nvr, fmi3Float64 value[], size_t nValues) {
+// Pages are left untouched here; applyStructure() has each worker write its own chunk first.
+template <class T>
+AmplifierModel::ChannelArray<T> AmplifierModel::allocateChannels(size_t n) {
+    return ChannelArray<T>(static_cast<T*>(::operator new[](std::max<size_t>(1, n) * sizeof(T), std::align_val_t{64})));
+}
+
+// Sizes the channel arrays and the worker pool. Each worker initializes its own chunk so that
+// the first touch places those pages on its NUMA node; doStep later hands it the same chunk.
+fmi3Status AmplifierModel::applyStructure() {
+    if (!m_structureDirty) return fmi3OK;
+    using model::UInt32;
+    using model::UInt64;
+    using model::Float32Array;
+    using model::Float64Array;
+
+    const fmi3UInt64 channels = m_uint64[UInt64::N_CHANNELS];
+    const bool singlePrecision = m_boolean[model::Boolean::SINGLE_PRECISION] != fmi3False;
+    size_t threads = m_uint32[UInt32::N_THREADS];
+    bool pinThreads = m_boolean[model::Boolean::PIN_THREADS] != fmi3False;
+    if (threads == 0) {
+        // Use the layout autotune_amplifier measured for this binary, host and channel count, if any.
+        const TuningKey key{binaryHash(), tuning::hostKey(), tuning::channelBucket(channels), singlePrecision};
+        TunedLayout tuned;
+        if (tuning::lookup(tuning::cachePath(), key, tuned)) {
+            threads = tuned.threads;
+            pinThreads = tuned.pinThreads;
+            log(fmi3OK, "info", "Using the tuned layout for this host: " + std::to_string(threads) + " threads" + (pinThreads ? ", pinned" : ""));
+        } else {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+    }
+    threads = std::min<size_t>(threads, std::max<size_t>(1, channels / MIN_CHANNELS_PER_THREAD));
+
+    m_pool.reset();
+    for (auto& array : m_float64Arrays) array.reset();
+    for (auto& array : m_float32Arrays) array.reset();
+    m_channels = 0;
+    try {
+        m_pool = std::make_unique<ThreadPool>(threads, pinThreads);
+        if (singlePrecision) {
+            for (auto& array : m_float32Arrays) array = allocateChannels<fmi3Float32>(channels);
+        } else {
+            for (auto& array : m_float64Arrays) array = allocateChannels<fmi3Float64>(channels);
+        }
+    } catch (const std::exception& e) {
+        m_pool.reset();
+        for (auto& array : m_float64Arrays) array.reset();
+        for (auto& array : m_float32Arrays) array.reset();
+        log(fmi3Error, "error", "Cannot allocate " + std::to_string(channels) + " channels: " + e.what());
+        return fmi3Error;
+    }
+    m_channels = static_cast<size_t>(channels);
+    m_singlePrecision = singlePrecision;
+
+    forEachChunk(m_channels, [this](size_t begin, size_t end) {
+        for (size_t a = 0; a < Float64Array::COUNT; a++) {
+            if (m_singlePrecision) {
+                std::fill(m_float32Arrays[a].get() + begin, m_float32Arrays[a].get() + end, Float32Array::START[a]);
+            } else {
+                std::fill(m_float64Arrays[a].get() + begin, m_float64Arrays[a].get() + end, Float64Array::START[a]);
+            }
+        }
+    });
+    m_structureDirty = false;
+    if (m_pool->size() > 1 || m_singlePrecision) {
+        log(fmi3OK, "info", "doStep runs on " + std::to_string(m_pool->size()) + " threads for " + std::to_string(m_channels) +
+            (m_singlePrecision ? " float32" : " float64") + " channels");
+    }
+    return fmi3OK;
+}
+
+template <class Arrays>
+int AmplifierModel::arrayIndex(fmi3ValueReference vr, bool forWriting) {
+    for (const model::ArrayVariable& var : Arrays::VARIABLES) {
+        if (var.valueReference == vr) return forWriting && !var.settable ? -1 : static_cast<int>(var.index);
+    }
+    return -1;
+}
+
+// Copies count channels in parallel; converts when the stored precision differs from the requested one.
+// States pass their own count, which differs from m_channels once the structure has changed.
+template <class Dst, class Src>
+void AmplifierModel::copyChannels(Dst* out, const Src* in, size_t count) {
+    forEachChunk(count, [=](size_t begin, size_t end) {
+        if constexpr (std::is_same_v<Dst, Src>) {
+            std::memcpy(out + begin, in + begin, (end - begin) * sizeof(Dst));
+        } else {
+            for (size_t i = begin; i < end; i++) out[i] = static_cast<Dst>(in[i]);
+        }
+    });
+}
+
+// Arrays contribute nChannels values each to the flattened value vector, scalars one.
+template <class Arrays>
+fmi3Status AmplifierModel::getFloats(const char* function, const fmi3ValueReference vr[], size_t nvr, typename Arrays::Value value[], size_t nValues) {
+    using Value = typename Arrays::Value;
+    if (applyStructure() != fmi3OK) return fmi3Error;
+    size_t position = 0;
     for (size_t i = 0; i < nvr; i++) {
-        if (vr[i] == VR_U) value[i] = m_u;
-        else if (vr[i] == VR_Y) value[i] = m_y;
-        else if (vr[i] == VR_K) value[i] = m_k;
+        const int array = arrayIndex<Arrays>(vr[i], false);
+        if (array >= 0 ? nValues - position < m_channels : position >= nValues) {
+            log(fmi3Error, "error", std::string(function) + ": nValues is too small for the requested variables");
+            return fmi3Error;
+        }
+        if (array >= 0) {
+            if (m_singlePrecision) copyChannels(value + position, m_float32Arrays[array].get(), m_channels);
+            else copyChannels(value + position, m_float64Arrays[array].get(), m_channels);
+            position += m_channels;
+            continue;
+        }
+        bool found = false;
+        if constexpr (std::is_same_v<Value, fmi3Float64>) found = model::Dispatch<model::Float64>::get(m_float64, &vr[i], 1, &value[position]);
+        if (!found) {
+            log(fmi3Error, "error", std::string(function) + ": unknown value reference " + std::to_string(vr[i]));
+            return fmi3Error;
+        }
+        position++;
+    }
+    if (position != nValues) {
+        log(fmi3Error, "error", std::string(function) + ": nValues does not match the sizes of the requested variables");
+        return fmi3Error;
     }
     return fmi3OK;
 }
 
-fmi3Status AmplifierModel::setFloat64(const fmi3ValueReference vr[], size_t nvr, const fmi3Float64 value[], size_t nValues) {
+template <class Arrays>
+fmi3Status AmplifierModel::setFloats(const char* function, const fmi3ValueReference vr[], size_t nvr, const typename Arrays::Value value[], size_t nValues) {
+    using Value = typename Arrays::Value;
+    if (applyStructure() != fmi3OK) return fmi3Error;
+    size_t position = 0;
     for (size_t i = 0; i < nvr; i++) {
-        if (vr[i] == VR_U) m_u = value[i];
-        else if (vr[i] == VR_K) m_k = value[i];
+        const int array = arrayIndex<Arrays>(vr[i], true);
+        if (array >= 0 ? nValues - position < m_channels : position >= nValues) {
+            log(fmi3Error, "error", std::string(function) + ": nValues is too small for the given variables");
+            return fmi3Error;
+        }
+        if (array >= 0) {
+            if (m_singlePrecision) copyChannels(m_float32Arrays[array].get(), value + position, m_channels);
+            else copyChannels(m_float64Arrays[array].get(), value + position, m_channels);
+            position += m_channels;
+            continue;
+        }
+        bool found = false;
+        if constexpr (std::is_same_v<Value, fmi3Float64>) found = model::Dispatch<model::Float64>::set(m_float64, &vr[i], 1, &value[position]);
+        if (!found) {
+            log(fmi3Error, "error", std::string(function) + ": unknown or read-only value reference " + std::to_string(vr[i]));
+            return fmi3Error;
+        }
+        position++;
+    }
+    if (position != nValues) {
+        log(fmi3Error, "error", std::string(function) + ": nValues does not match the sizes of the given variables");
+        return fmi3Error;
     }
     return fmi3OK;
 }
 
+fmi3Status AmplifierModel::getFloat64(const fmi3ValueReference vr[], size_t nvr, fmi3Float64 value[], size_t nValues) {
+    return getFloats<model::Float64Array>("getFloat64", vr, nvr, value, nValues);
+}
+
+fmi3Status AmplifierModel::setFloat64(const fmi3ValueReference vr[], size_t nvr, const fmi3Float64 value[], size_t nValues) {
+    return setFloats<model::Float64Array>("setFloat64", vr, nvr, value, nValues);
+}
+
+fmi3Status AmplifierModel::getFloat32(const fmi3ValueReference vr[], size_t nvr, fmi3Float32 value[], size_t nValues) {
+    return getFloats<model::Float32Array>("getFloat32", vr, nvr, value, nValues);
+}
+
+fmi3Status AmplifierModel::setFloat32(const fmi3ValueReference vr[], size_t nvr, const fmi3Float32 value[], size_t nValues) {
+    return setFloats<model::Float32Array>("setFloat32", vr, nvr, value, nValues);
+}
+
+template <class Type>
+fmi3Status AmplifierModel::getScalars(const char* function, const model::Bank<Type>& bank, const fmi3ValueReference vr[], size_t nvr, typename Type::Value value[], size_t nValues) {
+    if (nValues != nvr || !model::Dispatch<Type>::get(bank, vr, nvr, value)) {
+        log(fmi3Error, "error", std::string(function) + ": unknown value reference");
+        return fmi3Error;
+    }
+    return fmi3OK;
+}
+
+// All UInt32, UInt64 and Boolean variables are structural parameters; a change takes effect
+// when configuration mode is left or initialization starts.
+template <class Type>
+fmi3Status AmplifierModel::setStructural(const char* function, model::Bank<Type>& bank, const fmi3ValueReference vr[], size_t nvr, const typename Type::Value value[], size_t nValues) {
+    if (m_mode != Mode::Instantiated && m_mode != Mode::Configuration) {
+        log(fmi3Error, "error", std::string(function) + ": structural parameters can only be set before initialization or in configuration mode");
+        return fmi3Error;
+    }
+    if (nValues != nvr || !model::Dispatch<Type>::set(bank, vr, nvr, value)) {
+        log(fmi3Error, "error", std::string(function) + ": unknown or read-only value reference");
+        return fmi3Error;
+    }
+    m_structureDirty = true;
+    return fmi3OK;
+}
+
+fmi3Status AmplifierModel::getUInt32(const fmi3ValueReference vr[], size_t nvr, fmi3UInt32 value[], size_t nValues) {
+    return getScalars<model::UInt32>("getUInt32", m_uint32, vr, nvr, value, nValues);
+}
+
+fmi3Status AmplifierModel::setUInt32(const fmi3ValueReference vr[], size_t nvr, const fmi3UInt32 value[], size_t nValues) {
+    return setStructural<model::UInt32>("setUInt32", m_uint32, vr, nvr, value, nValues);
+}
+
+fmi3Status AmplifierModel::getUInt64(const fmi3ValueReference vr[], size_t nvr, fmi3UInt64 value[], size_t nValues) {
+    return getScalars<model::UInt64>("getUInt64", m_uint64, vr, nvr, value, nValues);
+}
+
+fmi3Status AmplifierModel::setUInt64(const fmi3ValueReference vr[], size_t nvr, const fmi3UInt64 value[], size_t nValues) {
+    return setStructural<model::UInt64>("setUInt64", m_uint64, vr, nvr, value, nValues);
+}
+
+fmi3Status AmplifierModel::getBoolean(const fmi3ValueReference vr[], size_t nvr, fmi3Boolean value[], size_t nValues) {
+    return getScalars<model::Boolean>("getBoolean", m_boolean, vr, nvr, value, nValues);
+}
+
+fmi3Status AmplifierModel::setBoolean(const fmi3ValueReference vr[], size_t nvr, const fmi3Boolean value[], size_t nValues) {
+    return setStructural<model::Boolean>("setBoolean", m_boolean, vr, nvr, value, nValues);
+}
+
+fmi3Status AmplifierModel::enterConfigurationMode() {
+    if (m_mode != Mode::Instantiated) {
+        log(fmi3Error, "error", "Configuration mode can only be entered before initialization");
+        return fmi3Error;
+    }
+    m_mode = Mode::Configuration;
+    return fmi3OK;
+}
+
+fmi3Status AmplifierModel::exitConfigurationMode() {
+    m_mode = Mode::Instantiated;
+    return applyStructure();
+}
+
+fmi3Status AmplifierModel::enterInitializationMode(fmi3Float64 startTime) {
+    m_mode = Mode::Initialization;
+    m_float64[model::Float64::TIME] = startTime;
+    return applyStructure();
+}
+
+fmi3Status AmplifierModel::exitInitializationMode() {
+    m_mode = Mode::Step;
+    return fmi3OK;
+}
+
 fmi3Status AmplifierModel::doStep(fmi3Float64 currentCommunicationPoint, fmi3Float64 communicationStepSize) {
-    // Core model equation
-    m_y = m_k * m_u;
+    using model::Float64Array;
+    if (applyStructure() != fmi3OK) return fmi3Error;
+    // Core model equation, per channel; each worker streams through the chunk it first touched.
+    const fmi3Float64 k = m_float64[model::Float64::K];
+    if (m_singlePrecision) {
+        const fmi3Float32* u = m_float32Arrays[model::Float32Array::U32].get();
+        fmi3Float32* y = m_float32Arrays[model::Float32Array::Y32].get();
+        forEachChunk(m_channels, [=](size_t begin, size_t end) { amplify(u + begin, y + begin, static_cast<fmi3Float32>(k), end - begin); });
+    } else {
+        const fmi3Float64* u = m_float64Arrays[Float64Array::U].get();
+        fmi3Float64* y = m_float64Arrays[Float64Array::Y].get();
+        forEachChunk(m_channels, [=](size_t begin, size_t end) { amplify(u + begin, y + begin, k, end - begin); });
+    }
+    m_float64[model::Float64::TIME] = currentCommunicationPoint + communicationStepSize;
+    return fmi3OK;
+}
+
+// --- FMU State ---
+
+// A snapshot of the instance. The arrays hold the channels in the precision they were stored in
+// and may be larger than `channels` when the state object is reused from the pool.
+struct AmplifierModel::State {
+    model::Bank<model::Float64> float64;
+    model::Bank<model::UInt32> uint32;
+    model::Bank<model::UInt64> uint64;
+    model::Bank<model::Boolean> boolean;
+    Mode mode = Mode::Instantiated;
+    bool singlePrecision = false;
+    size_t channels = 0;
+
+    size_t capacity = 0;
+    bool capacitySinglePrecision = false;
+    ChannelArray<fmi3Float64> float64Arrays[model::Float64Array::COUNT];
+    ChannelArray<fmi3Float32> float32Arrays[model::Float32Array::COUNT];
+};
+
+namespace {
+
+/*
+ * Serialized layout (version 1), in host byte order:
+ *   SerializedStateHeader
+ *   Float64 bank, UInt64 bank, UInt32 bank, Boolean bank (sizes from the header)
+ *   zero padding to a multiple of 8 bytes
+ *   the channel arrays in model order, `channels` values each, as float32 if
+ *   STATE_SINGLE_PRECISION is set and as float64 otherwise
+ * The bank sizes are checked against the generated descriptors on load, so a state written
+ * by a build with a different model description is rejected instead of misread.
+ */
+constexpr char STATE_MAGIC[4] = {'A', 'M', 'P', 'S'};
+constexpr uint16_t STATE_VERSION = 1;
+constexpr uint32_t STATE_SINGLE_PRECISION = 1u << 0;
+constexpr uint32_t STATE_BIG_ENDIAN = 1u << 1;
+
+struct SerializedStateHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t flags;
+    uint32_t mode;
+    uint64_t channels;
+    uint16_t float64Count;
+    uint16_t uint64Count;
+    uint16_t uint32Count;
+    uint16_t booleanCount;
+    uint16_t arrayCount;
+    uint16_t reserved[3];
+};
+static_assert(sizeof(SerializedStateHeader) == 40, "serialized state header layout changed");
+
+constexpr uint32_t hostByteOrderFlag() {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return STATE_BIG_ENDIAN;
+#else
+    return 0;
+#endif
+}
+
+constexpr size_t BANKS_SIZE = sizeof(model::Bank<model::Float64>) + sizeof(model::Bank<model::UInt64>) +
+                              sizeof(model::Bank<model::UInt32>) + sizeof(model::Bank<model::Boolean>);
+constexpr size_t ARRAYS_OFFSET = (sizeof(SerializedStateHeader) + BANKS_SIZE + 7) / 8 * 8;
+
+size_t serializedSize(size_t channels, bool singlePrecision) {
+    return ARRAYS_OFFSET + model::Float64Array::COUNT * channels * (singlePrecision ? sizeof(fmi3Float32) : sizeof(fmi3Float64));
+}
+
+template <class Bank>
+void putBank(fmi3Byte*& out, const Bank& bank) {
+    std::memcpy(out, bank.data(), sizeof(Bank));
+    out += sizeof(Bank);
+}
+
+template <class Bank>
+void getBank(const fmi3Byte*& in, Bank& bank) {
+    std::memcpy(bank.data(), in, sizeof(Bank));
+    in += sizeof(Bank);
+}
+
+} // namespace
+
+// Takes a state from the pool (or creates one) whose arrays can hold `channels` values.
+AmplifierModel::State* AmplifierModel::acquireState(size_t channels, bool singlePrecision) {
+    std::unique_ptr<State> state;
+    if (!m_statePool.empty()) {
+        state = std::move(m_statePool.back());
+        m_statePool.pop_back();
+    } else {
+        state = std::make_unique<State>();
+    }
+    if (state->capacity < channels || state->capacitySinglePrecision != singlePrecision ||
+        (!state->float64Arrays[0] && !state->float32Arrays[0])) {
+        for (auto& array : state->float64Arrays) array.reset();
+        for (auto& array : state->float32Arrays) array.reset();
+        state->capacity = 0;
+        if (singlePrecision) {
+            for (auto& array : state->float32Arrays) array = allocateChannels<fmi3Float32>(channels);
+        } else {
+            for (auto& array : state->float64Arrays) array = allocateChannels<fmi3Float64>(channels);
+        }
+        state->capacity = channels;
+        state->capacitySinglePrecision = singlePrecision;
+    }
+    state->channels = channels;
+    state->singlePrecision = singlePrecision;
+    return state.release();
+}
+
+void AmplifierModel::releaseState(State* state) {
+    std::unique_ptr<State> owned(state);
+    if (m_statePool.size() < MAX_POOLED_STATES) m_statePool.push_back(std::move(owned));
+}
+
+fmi3Status AmplifierModel::getFMUState(fmi3FMUState* fmuState) {
+    if (!fmuState) return fmi3Error;
+    if (applyStructure() != fmi3OK) return fmi3Error;
+    // An existing state is overwritten in place; it is reallocated only if it is too small.
+    State* state = static_cast<State*>(*fmuState);
+    try {
+        if (state) {
+            releaseState(state);
+            *fmuState = nullptr;
+        }
+        state = acquireState(m_channels, m_singlePrecision);
+    } catch (const std::exception& e) {
+        log(fmi3Error, "error", std::string("getFMUState: ") + e.what());
+        return fmi3Error;
+    }
+    state->float64 = m_float64;
+    state->uint32 = m_uint32;
+    state->uint64 = m_uint64;
+    state->boolean = m_boolean;
+    state->mode = m_mode;
+    for (size_t a = 0; a < model::Float64Array::COUNT; a++) {
+        if (state->singlePrecision) copyChannels(state->float32Arrays[a].get(), m_float32Arrays[a].get(), state->channels);
+        else copyChannels(state->float64Arrays[a].get(), m_float64Arrays[a].get(), state->channels);
+    }
+    *fmuState = state;
+    return fmi3OK;
+}
+
+fmi3Status AmplifierModel::setFMUState(fmi3FMUState fmuState) {
+    const State* state = static_cast<const State*>(fmuState);
+    if (!state) return fmi3Error;
+    m_float64 = state->float64;
+    m_uint32 = state->uint32;
+    m_uint64 = state->uint64;
+    m_boolean = state->boolean;
+    m_mode = state->mode;
+    // The layout only changes if the state was taken with different structural parameters.
+    if (m_structureDirty || m_channels != state->channels || m_singlePrecision != state->singlePrecision) {
+        m_structureDirty = true;
+        if (applyStructure() != fmi3OK) return fmi3Error;
+    }
+    // Only a deserialized state whose header disagrees with its nChannels/singlePrecision gets here.
+    if (m_channels != state->channels || m_singlePrecision != state->singlePrecision) {
+        log(fmi3Error, "error", "setFMUState: the state's channel arrays do not match its structural parameters");
+        return fmi3Error;
+    }
+    for (size_t a = 0; a < model::Float64Array::COUNT; a++) {
+        if (state->singlePrecision) copyChannels(m_float32Arrays[a].get(), state->float32Arrays[a].get(), state->channels);
+        else copyChannels(m_float64Arrays[a].get(), state->float64Arrays[a].get(), state->channels);
+    }
+    return fmi3OK;
+}
+
+fmi3Status AmplifierModel::freeFMUState(fmi3FMUState* fmuState) {
+    if (!fmuState || !*fmuState) return fmi3OK;
+    releaseState(static_cast<State*>(*fmuState));
+    *fmuState = nullptr;
+    return fmi3OK;
+}
+
+fmi3Status AmplifierModel::serializedFMUStateSize(fmi3FMUState fmuState, size_t* size) {
+    const State* state = static_cast<const State*>(fmuState);
+    if (!state || !size) return fmi3Error;
+    *size = serializedSize(state->channels, state->singlePrecision);
+    return fmi3OK;
+}
+
+fmi3Status AmplifierModel::serializeFMUState(fmi3FMUState fmuState, fmi3Byte serialized[], size_t size) {
+    const State* state = static_cast<const State*>(fmuState);
+    if (!state || !serialized || size < serializedSize(state->channels, state->singlePrecision)) {
+        log(fmi3Error, "error", "serializeFMUState: buffer too small");
+        return fmi3Error;
+    }
+    SerializedStateHeader header{};
+    std::memcpy(header.magic, STATE_MAGIC, sizeof(header.magic));
+    header.version = STATE_VERSION;
+    header.headerSize = sizeof(SerializedStateHeader);
+    header.flags = (state->singlePrecision ? STATE_SINGLE_PRECISION : 0) | hostByteOrderFlag();
+    header.mode = static_cast<uint32_t>(state->mode);
+    header.channels = state->channels;
+    header.float64Count = model::Float64::COUNT;
+    header.uint64Count = model::UInt64::COUNT;
+    header.uint32Count = model::UInt32::COUNT;
+    header.booleanCount = model::Boolean::COUNT;
+    header.arrayCount = model::Float64Array::COUNT;
+
+    fmi3Byte* out = serialized;
+    std::memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    putBank(out, state->float64);
+    putBank(out, state->uint64);
+    putBank(out, state->uint32);
+    putBank(out, state->boolean);
+    std::memset(out, 0, static_cast<size_t>(serialized + ARRAYS_OFFSET - out));
+    out = serialized + ARRAYS_OFFSET;
+    for (size_t a = 0; a < model::Float64Array::COUNT; a++) {
+        if (state->singlePrecision) {
+            copyChannels(reinterpret_cast<fmi3Float32*>(out), state->float32Arrays[a].get(), state->channels);
+            out += state->channels * sizeof(fmi3Float32);
+        } else {
+            copyChannels(reinterpret_cast<fmi3Float64*>(out), state->float64Arrays[a].get(), state->channels);
+            out += state->channels * sizeof(fmi3Float64);
+        }
+    }
+    return fmi3OK;
+}
+
+fmi3Status AmplifierModel::deserializeFMUState(const fmi3Byte serialized[], size_t size, fmi3FMUState* fmuState) {
+    if (!serialized || !fmuState) return fmi3Error;
+    SerializedStateHeader header;
+    if (size < sizeof(header)) {
+        log(fmi3Error, "error", "deserializeFMUState: truncated state");
+        return fmi3Error;
+    }
+    std::memcpy(&header, serialized, sizeof(header));
+    if (std::memcmp(header.magic, STATE_MAGIC, sizeof(header.magic)) != 0 || header.version != STATE_VERSION ||
+        header.headerSize != sizeof(SerializedStateHeader) || (header.flags & STATE_BIG_ENDIAN) != hostByteOrderFlag() ||
+        header.mode > static_cast<uint32_t>(Mode::Step)) {
+        log(fmi3Error, "error", "deserializeFMUState: not an amplifier state of version " + std::to_string(STATE_VERSION) + " for this host");
+        return fmi3Error;
+    }
+    if (header.float64Count != model::Float64::COUNT || header.uint64Count != model::UInt64::COUNT ||
+        header.uint32Count != model::UInt32::COUNT || header.booleanCount != model::Boolean::COUNT ||
+        header.arrayCount != model::Float64Array::COUNT) {
+        log(fmi3Error, "error", "deserializeFMUState: the state was written for a different model description");
+        return fmi3Error;
+    }
+    const bool singlePrecision = (header.flags & STATE_SINGLE_PRECISION) != 0;
+    const size_t maxChannels = (SIZE_MAX - ARRAYS_OFFSET) / model::Float64Array::COUNT / sizeof(fmi3Float64);
+    if (header.channels > maxChannels || size != serializedSize(static_cast<size_t>(header.channels), singlePrecision)) {
+        log(fmi3Error, "error", "deserializeFMUState: size does not match the state header");
+        return fmi3Error;
+    }
+    if (applyStructure() != fmi3OK) return fmi3Error;
+
+    State* state;
+    try {
+        if (*fmuState) {
+            releaseState(static_cast<State*>(*fmuState));
+            *fmuState = nullptr;
+        }
+        state = acquireState(static_cast<size_t>(header.channels), singlePrecision);
+    } catch (const std::exception& e) {
+        log(fmi3Error, "error", std::string("deserializeFMUState: ") + e.what());
+        return fmi3Error;
+    }
+    state->mode = static_cast<Mode>(header.mode);
+    const fmi3Byte* in = serialized + sizeof(header);
+    getBank(in, state->float64);
+    getBank(in, state->uint64);
+    getBank(in, state->uint32);
+    getBank(in, state->boolean);
+    in = serialized + ARRAYS_OFFSET;
+    for (size_t a = 0; a < model::Float64Array::COUNT; a++) {
+        // The buffer need not be aligned, so the values are copied bytewise.
+        if (singlePrecision) {
+            std::memcpy(state->float32Arrays[a].get(), in, state->channels * sizeof(fmi3Float32));
+            in += state->channels * sizeof(fmi3Float32);
+        } else {
+            std::memcpy(state->float64Arrays[a].get(), in, state->channels * sizeof(fmi3Float64));
+            in += state->channels * sizeof(fmi3Float64);
+        }
+    }
+    *fmuState = state;
     return fmi3OK;
 }
 
@@ -106,11 +647,75 @@ FMI3_Export const char* fmi3GetVersion(void) {
 }
 
 FMI3_Export fmi3Status fmi3EnterInitializationMode(fmi3Instance instance, fmi3Boolean toleranceDefined, fmi3Float64 tolerance, fmi3Float64 startTime, fmi3Boolean stopTimeDefined, fmi3Float64 stopTime) {
-    return fmi3OK;
+    return to_model(instance)->enterInitializationMode(startTime);
 }
 
 FMI3_Export fmi3Status fmi3ExitInitializationMode(fmi3Instance instance) {
-    return fmi3OK;
+    return to_model(instance)->exitInitializationMode();
+}
+
+FMI3_Export fmi3Status fmi3EnterConfigurationMode(fmi3Instance instance) {
+    return to_model(instance)->enterConfigurationMode();
+}
+
+FMI3_Export fmi3Status fmi3ExitConfigurationMode(fmi3Instance instance) {
+    return to_model(instance)->exitConfigurationMode();
+}
+
+FMI3_Export fmi3Status fmi3GetFMUState(fmi3Instance instance, fmi3FMUState* FMUState) {
+    return to_model(instance)->getFMUState(FMUState);
+}
+
+FMI3_Export fmi3Status fmi3SetFMUState(fmi3Instance instance, fmi3FMUState FMUState) {
+    return to_model(instance)->setFMUState(FMUState);
+}
+
+FMI3_Export fmi3Status fmi3FreeFMUState(fmi3Instance instance, fmi3FMUState* FMUState) {
+    return to_model(instance)->freeFMUState(FMUState);
+}
+
+FMI3_Export fmi3Status fmi3SerializedFMUStateSize(fmi3Instance instance, fmi3FMUState FMUState, size_t* size) {
+    return to_model(instance)->serializedFMUStateSize(FMUState, size);
+}
+
+FMI3_Export fmi3Status fmi3SerializeFMUState(fmi3Instance instance, fmi3FMUState FMUState, fmi3Byte serializedState[], size_t size) {
+    return to_model(instance)->serializeFMUState(FMUState, serializedState, size);
+}
+
+FMI3_Export fmi3Status fmi3DeserializeFMUState(fmi3Instance instance, const fmi3Byte serializedState[], size_t size, fmi3FMUState* FMUState) {
+    return to_model(instance)->deserializeFMUState(serializedState, size, FMUState);
+}
+
+FMI3_Export fmi3Status fmi3GetFloat32(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, fmi3Float32 v[], size_t nv) {
+    return to_model(c)->getFloat32(vr, nvr, v, nv);
+}
+
+FMI3_Export fmi3Status fmi3SetFloat32(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, const fmi3Float32 v[], size_t nv) {
+    return to_model(c)->setFloat32(vr, nvr, v, nv);
+}
+
+FMI3_Export fmi3Status fmi3GetUInt32(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, fmi3UInt32 v[], size_t nv) {
+    return to_model(c)->getUInt32(vr, nvr, v, nv);
+}
+
+FMI3_Export fmi3Status fmi3SetUInt32(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, const fmi3UInt32 v[], size_t nv) {
+    return to_model(c)->setUInt32(vr, nvr, v, nv);
+}
+
+FMI3_Export fmi3Status fmi3GetUInt64(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, fmi3UInt64 v[], size_t nv) {
+    return to_model(c)->getUInt64(vr, nvr, v, nv);
+}
+
+FMI3_Export fmi3Status fmi3SetUInt64(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, const fmi3UInt64 v[], size_t nv) {
+    return to_model(c)->setUInt64(vr, nvr, v, nv);
+}
+
+FMI3_Export fmi3Status fmi3GetBoolean(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, fmi3Boolean v[], size_t nv) {
+    return to_model(c)->getBoolean(vr, nvr, v, nv);
+}
+
+FMI3_Export fmi3Status fmi3SetBoolean(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, const fmi3Boolean v[], size_t nv) {
+    return to_model(c)->setBoolean(vr, nvr, v, nv);
 }
 
 FMI3_Export fmi3Status fmi3Terminate(fmi3Instance instance) {
@@ -121,30 +726,22 @@ FMI3_Export fmi3Status fmi3Reset(fmi3Instance instance) {
     return fmi3Error; // Not implemented
 }
 // Stubs for other data types
-FMI3_Export fmi3Status fmi3GetFloat32(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, fmi3Float32 v[], size_t nv) { return fmi3Error; }
 FMI3_Export fmi3Status fmi3GetInt8(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, fmi3Int8 v[], size_t nv) { return fmi3Error; }
 FMI3_Export fmi3Status fmi3GetUInt8(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, fmi3UInt8 v[], size_t nv) { return fmi3Error; }
 FMI3_Export fmi3Status fmi3GetInt16(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, fmi3Int16 v[], size_t nv) { return fmi3Error; }
 FMI3_Export fmi3Status fmi3GetUInt16(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, fmi3UInt16 v[], size_t nv) { return fmi3Error; }
 FMI3_Export fmi3Status fmi3GetInt32(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, fmi3Int32 v[], size_t nv) { return fmi3Error; }
-FMI3_Export fmi3Status fmi3GetUInt32(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, fmi3UInt32 v[], size_t nv) { return fmi3Error; }
 FMI3_Export fmi3Status fmi3GetInt64(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, fmi3Int64 v[], size_t nv) { return fmi3Error; }
-FMI3_Export fmi3Status fmi3GetUInt64(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, fmi3UInt64 v[], size_t nv) { return fmi3Error; }
-FMI3_Export fmi3Status fmi3GetBoolean(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, fmi3Boolean v[], size_t nv) { return fmi3Error; }
 FMI3_Export fmi3Status fmi3GetString(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, fmi3String v[], size_t nv) { return fmi3Error; }
 FMI3_Export fmi3Status fmi3GetBinary(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, size_t s[], fmi3Binary v[], size_t nv) { return fmi3Error; }
 FMI3_Export fmi3Status fmi3GetClock(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, fmi3Clock v[]) { return fmi3Error; }
 
-FMI3_Export fmi3Status fmi3SetFloat32(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, const fmi3Float32 v[], size_t nv) { return fmi3Error; }
 FMI3_Export fmi3Status fmi3SetInt8(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, const fmi3Int8 v[], size_t nv) { return fmi3Error; }
 FMI3_Export fmi3Status fmi3SetUInt8(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, const fmi3UInt8 v[], size_t nv) { return fmi3Error; }
 FMI3_Export fmi3Status fmi3SetInt16(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, const fmi3Int16 v[], size_t nv) { return fmi3Error; }
 FMI3_Export fmi3Status fmi3SetUInt16(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, const fmi3UInt16 v[], size_t nv) { return fmi3Error; }
 FMI3_Export fmi3Status fmi3SetInt32(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, const fmi3Int32 v[], size_t nv) { return fmi3Error; }
-FMI3_Export fmi3Status fmi3SetUInt32(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, const fmi3UInt32 v[], size_t nv) { return fmi3Error; }
 FMI3_Export fmi3Status fmi3SetInt64(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, const fmi3Int64 v[], size_t nv) { return fmi3Error; }
-FMI3_Export fmi3Status fmi3SetUInt64(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, const fmi3UInt64 v[], size_t nv) { return fmi3Error; }
-FMI3_Export fmi3Status fmi3SetBoolean(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, const fmi3Boolean v[], size_t nv) { return fmi3Error; }
 FMI3_Export fmi3Status fmi3SetString(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, const fmi3String v[], size_t nv) { return fmi3Error; }
 FMI3_Export fmi3Status fmi3SetBinary(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, const size_t s[], const fmi3Binary v[], size_t nv) { return fmi3Error; }
 FMI3_Export fmi3Status fmi3SetClock(fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, const fmi3Clock v[]) { return fmi3Error; }
@@ -154,15 +751,7 @@ FMI3_Export fmi3Status fmi3SetDebugLogging(fmi3Instance c, fmi3Boolean l, size_t
 FMI3_Export fmi3Instance fmi3InstantiateModelExchange(fmi3String i, fmi3String t, fmi3String r, fmi3Boolean v, fmi3Boolean l, fmi3InstanceEnvironment e, fmi3LogMessageCallback cl) { return NULL; }
 FMI3_Export fmi3Instance fmi3InstantiateScheduledExecution(fmi3String i, fmi3String t, fmi3String r, fmi3Boolean v, fmi3Boolean l, fmi3InstanceEnvironment e, fmi3LogMessageCallback cl, fmi3ClockUpdateCallback cu, fmi3LockPreemptionCallback lpc, fmi3UnlockPreemptionCallback upc) { return NULL; }
 
-FMI3_Export fmi3Status fmi3EnterConfigurationMode(fmi3Instance instance) { return fmi3OK; }
-FMI3_Export fmi3Status fmi3ExitConfigurationMode(fmi3Instance instance) { return fmi3OK; }
 
-FMI3_Export fmi3Status fmi3GetFMUState(fmi3Instance instance, fmi3FMUState* FMUState) { return fmi3Error; }
-FMI3_Export fmi3Status fmi3SetFMUState(fmi3Instance instance, fmi3FMUState FMUState) { return fmi3Error; }
-FMI3_Export fmi3Status fmi3FreeFMUState(fmi3Instance instance, fmi3FMUState* FMUState) { return fmi3Error; }
-FMI3_Export fmi3Status fmi3SerializedFMUStateSize(fmi3Instance instance, fmi3FMUState FMUState, size_t* size) { return fmi3Error; }
-FMI3_Export fmi3Status fmi3SerializeFMUState(fmi3Instance instance, fmi3FMUState FMUState, fmi3Byte serializedState[], size_t size) { return fmi3Error; }
-FMI3_Export fmi3Status fmi3DeserializeFMUState(fmi3Instance instance, const fmi3Byte serializedState[], size_t size, fmi3FMUState* FMUState) { return fmi3Error; }
 FMI3_Export fmi3Status fmi3GetDirectionalDerivative(fmi3Instance instance, const fmi3ValueReference u[], size_t nu, const fmi3ValueReference z[], size_t nz, const fmi3Float64 s[], size_t ns, fmi3Float64 sens[], size_t nsens) { return fmi3Error; }
 FMI3_Export fmi3Status fmi3GetAdjointDerivative(fmi3Instance instance, const fmi3ValueReference u[], size_t nu, const fmi3ValueReference z[], size_t nz, const fmi3Float64 s[], size_t ns, fmi3Float64 sens[], size_t nsens) { return fmi3Error; }
 
@@ -6,16 +6,27 @@
 #define FMI3_AMPLIFIER_HPP
 
 #include "fmi3Functions.h"
+#include <memory>
+#include <new>
 #include <string>
+#include <vector>
 
-// Value References for the variables
-constexpr fmi3ValueReference VR_U = 1; // Renumbered
-constexpr fmi3ValueReference VR_Y = 2; // Renumbered
-constexpr fmi3ValueReference VR_K = 3; // Renumbered
+// Value references, start values and the get/set dispatch tables, generated from modelDescription.xml.
+#include "ModelBindings.hpp"
+#include "ThreadPool.hpp"
 
 /**
  * @class AmplifierModel
  * @brief Encapsulates all state and logic for a single instance of the amplifier FMU.
+ *
+ * u and y are arrays of `nChannels` values and y = k * u is applied per channel. For wide
+ * channel banks, doStep is split across a persistent pool of `nThreads` workers; each
+ * worker owns a fixed chunk of the channels and first-touches it, so on NUMA machines the
+ * chunk's pages sit on the node of the worker that streams through them every step.
+ *
+ * With `singlePrecision` the channels are stored and computed as float32: twice the SIMD
+ * lanes and half the memory traffic per channel. Only one precision is stored; the
+ * variables of the other (u/y, or u32/y32 without singlePrecision) convert on access.
  */
 class AmplifierModel {
 public:
@@ -25,13 +36,100 @@ public:
     // FMI 3.0 API methods
     fmi3Status getFloat64(const fmi3ValueReference vr[], size_t nvr, fmi3Float64 value[], size_t nValues);
     fmi3Status setFloat64(const fmi3ValueReference vr[], size_t nvr, const fmi3Float64 value[], size_t nValues);
+    fmi3Status getFloat32(const fmi3ValueReference vr[], size_t nvr, fmi3Float32 value[], size_t nValues);
+    fmi3Status setFloat32(const fmi3ValueReference vr[], size_t nvr, const fmi3Float32 value[], size_t nValues);
+    fmi3Status getUInt32(const fmi3ValueReference vr[], size_t nvr, fmi3UInt32 value[], size_t nValues);
+    fmi3Status setUInt32(const fmi3ValueReference vr[], size_t nvr, const fmi3UInt32 value[], size_t nValues);
+    fmi3Status getUInt64(const fmi3ValueReference vr[], size_t nvr, fmi3UInt64 value[], size_t nValues);
+    fmi3Status setUInt64(const fmi3ValueReference vr[], size_t nvr, const fmi3UInt64 value[], size_t nValues);
+    fmi3Status getBoolean(const fmi3ValueReference vr[], size_t nvr, fmi3Boolean value[], size_t nValues);
+    fmi3Status setBoolean(const fmi3ValueReference vr[], size_t nvr, const fmi3Boolean value[], size_t nValues);
+    fmi3Status enterConfigurationMode();
+    fmi3Status exitConfigurationMode();
+    fmi3Status enterInitializationMode(fmi3Float64 startTime);
+    fmi3Status exitInitializationMode();
     fmi3Status doStep(fmi3Float64 currentCommunicationPoint, fmi3Float64 communicationStepSize);
 
+    // FMU state: snapshots of all variables, including the channel arrays in their stored precision.
+    fmi3Status getFMUState(fmi3FMUState* state);
+    fmi3Status setFMUState(fmi3FMUState state);
+    fmi3Status freeFMUState(fmi3FMUState* state);
+    fmi3Status serializedFMUStateSize(fmi3FMUState state, size_t* size);
+    fmi3Status serializeFMUState(fmi3FMUState state, fmi3Byte serialized[], size_t size);
+    fmi3Status deserializeFMUState(const fmi3Byte serialized[], size_t size, fmi3FMUState* state);
+
 private:
-    // Model variables
-    fmi3Float64 m_u; // input
-    fmi3Float64 m_y; // output
-    fmi3Float64 m_k; // parameter
+    // Freed states kept for reuse, so rollback loops do not reallocate the channel arrays.
+    static constexpr size_t MAX_POOLED_STATES = 8;
+
+    // Channels per worker below which another thread costs more than it saves.
+    static constexpr size_t MIN_CHANNELS_PER_THREAD = size_t{1} << 15;
+    // Chunk boundaries are multiples of one cache line of doubles.
+    static constexpr size_t CHUNK_ALIGN = 64 / sizeof(fmi3Float64);
+
+    struct AlignedDelete {
+        void operator()(void* p) const { ::operator delete[](p, std::align_val_t{64}); }
+    };
+    template <class T>
+    using ChannelArray = std::unique_ptr<T[], AlignedDelete>;
+    template <class T>
+    static ChannelArray<T> allocateChannels(size_t n);
+
+    // Structural parameters may only change while instantiated or in configuration mode.
+    enum class Mode { Instantiated, Configuration, Initialization, Step };
+
+    // Float64/Float32 access: arrays of either precision map onto the stored channels; Float64 also has scalars.
+    template <class Arrays>
+    fmi3Status getFloats(const char* function, const fmi3ValueReference vr[], size_t nvr, typename Arrays::Value value[], size_t nValues);
+    template <class Arrays>
+    fmi3Status setFloats(const char* function, const fmi3ValueReference vr[], size_t nvr, const typename Arrays::Value value[], size_t nValues);
+    template <class Dst, class Src>
+    void copyChannels(Dst* out, const Src* in, size_t count);
+
+    template <class Type>
+    fmi3Status getScalars(const char* function, const model::Bank<Type>& bank, const fmi3ValueReference vr[], size_t nvr, typename Type::Value value[], size_t nValues);
+    template <class Type>
+    fmi3Status setStructural(const char* function, model::Bank<Type>& bank, const fmi3ValueReference vr[], size_t nvr, const typename Type::Value value[], size_t nValues);
+
+    struct State;                            // Defined in fmi3_amplifier.cpp.
+    State* acquireState(size_t channels, bool singlePrecision);
+    void releaseState(State* state);
+
+    fmi3Status applyStructure();             // Allocates the channel arrays and the pool from the structural parameters.
+    template <class Arrays>
+    static int arrayIndex(fmi3ValueReference vr, bool forWriting); // Index into Arrays::VARIABLES, or -1.
+
+    // Calls f(begin, end) for each worker's chunk of count channels, in parallel.
+    template <class F>
+    void forEachChunk(size_t count, F&& f) {
+        if (!m_pool) {
+            // No pool after a failed applyStructure; states can still be copied on this thread.
+            if (count > 0) f(0, count);
+            return;
+        }
+        const size_t workers = m_pool->size();
+        m_pool->run([&](size_t worker) {
+            const auto range = ThreadPool::chunk(worker, workers, count, CHUNK_ALIGN);
+            if (range.first < range.second) f(range.first, range.second);
+        });
+    }
+
+    // Scalar model variables, indexed by model::Float64::K etc.
+    model::Bank<model::Float64> m_float64 = model::startValues<model::Float64>();
+    model::Bank<model::UInt32> m_uint32 = model::startValues<model::UInt32>();
+    model::Bank<model::UInt64> m_uint64 = model::startValues<model::UInt64>();
+    model::Bank<model::Boolean> m_boolean = model::startValues<model::Boolean>();
+
+    // Channel arrays (u, y) as applied from the structural parameters; only one precision is allocated.
+    static_assert(model::Float32Array::COUNT == model::Float64Array::COUNT, "u32/y32 must mirror u/y");
+    size_t m_channels = 0;
+    bool m_singlePrecision = false;
+    ChannelArray<fmi3Float64> m_float64Arrays[model::Float64Array::COUNT];
+    ChannelArray<fmi3Float32> m_float32Arrays[model::Float32Array::COUNT];
+    std::unique_ptr<ThreadPool> m_pool;
+    bool m_structureDirty = true;
+    Mode m_mode = Mode::Instantiated;
+    std::vector<std::unique_ptr<State>> m_statePool;
 
     // FMI 3.0 instance information
     std::string m_instanceName;
@@ -42,4 +140,4 @@ private:
     void log(fmi3Status status, const std::string& category, const std::string& message);
 };
 
-#endif // FMI3_AMPLIFIER_HPP
\ No newline at end of file
+#endif // FMI3_AMPLIFIER_HPP
@@ -0,0 +1,475 @@
+/**
+ * @file parareal_runner.cpp
+ * @brief Parallel-in-time (Parareal) execution of one long FMI 3.0 Co-Simulation scenario.
+ *
+ * The time span is cut into slices. A coarse pass with large steps predicts the FMU state at
+ * every slice boundary; then each iteration refines all unconverged slices in parallel with
+ * small steps, every worker starting from a boundary state restored into its own instance,
+ * and a sequential correction sweep propagates the fine results with the coarse solver:
+ *
+ *     U[n+1] = G(U_new[n]) + F(U_old[n]) - G(U_old[n])
+ *
+ * States travel between instances as serialized FMU states. FMU states are opaque, so the
+ * arithmetic of the correction is applied to the Float64 variables named by --state-vrs
+ * (which must be settable); the rest of the state is taken from the fine result. Without
+ * --state-vrs the correction degenerates to re-running the coarse solver from corrected
+ * boundaries, which still converges slice by slice. Iteration stops when the boundary values
+ * of the state (or output) variables change by less than --tolerance, or after --iterations.
+ *
+ * Usage: parareal_runner <fmu binary> [--start t0] [--stop t1] [--slices N] [--coarse-step H]
+ *            [--fine-step h] [--iterations K] [--tolerance tol] [--threads P]
+ *            [--state-vrs vr,...] [--output-vrs vr,...] [--set vr=value]...
+ *            [--input vr:const:value | vr:sine:amplitude:frequency] [--token guid]
+ *            [--resources uri] [--csv results.csv] [--verify]
+ */
+#include "fmi3Functions.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#define DLL_HANDLE HMODULE
+#define LOAD_LIBRARY(path) LoadLibraryA(path)
+#define GET_FUNCTION(handle, name) GetProcAddress(handle, name)
+#define FREE_LIBRARY(handle) FreeLibrary(handle)
+#else
+#include <dlfcn.h>
+#define DLL_HANDLE void*
+#define LOAD_LIBRARY(path) dlopen(path, RTLD_NOW | RTLD_LOCAL)
+#define GET_FUNCTION(handle, name) dlsym(handle, name)
+#define FREE_LIBRARY(handle) dlclose(handle)
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using StateBytes = std::vector<fmi3Byte>;
+
+// The FMI 3 functions the runner needs, resolved once from the FMU binary.
+struct Fmi3Api {
+    fmi3InstantiateCoSimulationTYPE* InstantiateCoSimulation = nullptr;
+    fmi3FreeInstanceTYPE* FreeInstance = nullptr;
+    fmi3EnterInitializationModeTYPE* EnterInitializationMode = nullptr;
+    fmi3ExitInitializationModeTYPE* ExitInitializationMode = nullptr;
+    fmi3GetFloat64TYPE* GetFloat64 = nullptr;
+    fmi3SetFloat64TYPE* SetFloat64 = nullptr;
+    fmi3DoStepTYPE* DoStep = nullptr;
+    fmi3GetFMUStateTYPE* GetFMUState = nullptr;
+    fmi3SetFMUStateTYPE* SetFMUState = nullptr;
+    fmi3FreeFMUStateTYPE* FreeFMUState = nullptr;
+    fmi3SerializedFMUStateSizeTYPE* SerializedFMUStateSize = nullptr;
+    fmi3SerializeFMUStateTYPE* SerializeFMUState = nullptr;
+    fmi3DeserializeFMUStateTYPE* DeserializeFMUState = nullptr;
+
+    void load(DLL_HANDLE library) {
+#define LOAD_FUNC(name)                                                                     \
+    name = reinterpret_cast<fmi3##name##TYPE*>(GET_FUNCTION(library, "fmi3" #name));       \
+    if (!name) throw std::runtime_error("FMU binary does not export fmi3" #name);
+        LOAD_FUNC(InstantiateCoSimulation); LOAD_FUNC(FreeInstance);
+        LOAD_FUNC(EnterInitializationMode); LOAD_FUNC(ExitInitializationMode);
+        LOAD_FUNC(GetFloat64); LOAD_FUNC(SetFloat64); LOAD_FUNC(DoStep);
+        LOAD_FUNC(GetFMUState); LOAD_FUNC(SetFMUState); LOAD_FUNC(FreeFMUState);
+        LOAD_FUNC(SerializedFMUStateSize); LOAD_FUNC(SerializeFMUState); LOAD_FUNC(DeserializeFMUState);
+#undef LOAD_FUNC
+    }
+};
+
+struct InputSpec {
+    fmi3ValueReference vr = 0;
+    bool sine = false;
+    double amplitude = 0.0; // The constant value for const inputs.
+    double frequency = 0.0;
+
+    double at(double t) const { return sine ? amplitude * std::sin(2.0 * M_PI * frequency * t) : amplitude; }
+};
+
+struct Options {
+    std::string library;
+    std::string token;
+    std::string resources;
+    double start = 0.0;
+    double stop = 100.0;
+    size_t slices = 0;          // 0 selects 4 slices per thread.
+    double coarseStep = 1.0;
+    double fineStep = 0.01;
+    size_t iterations = 0;      // 0 allows up to `slices` iterations (exact convergence).
+    double tolerance = 1e-9;
+    size_t threads = 0;         // 0 uses every CPU.
+    std::vector<fmi3ValueReference> stateVrs;
+    std::vector<fmi3ValueReference> outputVrs;
+    std::vector<std::pair<fmi3ValueReference, double>> parameters;
+    std::vector<InputSpec> inputs;
+    std::string csv;
+    bool verify = false;
+};
+
+void check(fmi3Status status, const char* what) {
+    if (status != fmi3OK && status != fmi3Warning) throw std::runtime_error(std::string(what) + " failed with status " + std::to_string(status));
+}
+
+void logMessage(fmi3InstanceEnvironment, fmi3Status status, fmi3String category, fmi3String message) {
+    if (status != fmi3OK) std::fprintf(stderr, "[%s] %s\n", category, message);
+}
+
+/**
+ * @class Runner
+ * @brief One initialized FMU instance that steps slices and converts states to and from bytes.
+ */
+class Runner {
+public:
+    Runner(const Fmi3Api& api, const Options& options) : m_api(api), m_options(options) {
+        m_instance = api.InstantiateCoSimulation("parareal", options.token.c_str(), options.resources.empty() ? nullptr : options.resources.c_str(),
+                                                 fmi3False, fmi3False, fmi3False, fmi3False, nullptr, 0, nullptr, logMessage, nullptr);
+        if (!m_instance) throw std::runtime_error("fmi3InstantiateCoSimulation failed");
+        check(api.EnterInitializationMode(m_instance, fmi3False, 0.0, options.start, fmi3True, options.stop), "fmi3EnterInitializationMode");
+        for (const auto& parameter : options.parameters) check(api.SetFloat64(m_instance, &parameter.first, 1, &parameter.second, 1), "setting a parameter");
+        applyInputs(options.start);
+        check(api.ExitInitializationMode(m_instance), "fmi3ExitInitializationMode");
+    }
+
+    ~Runner() {
+        if (m_state) m_api.FreeFMUState(m_instance, &m_state);
+        m_api.FreeInstance(m_instance);
+    }
+
+    Runner(const Runner&) = delete;
+    Runner& operator=(const Runner&) = delete;
+
+    void restore(const StateBytes& bytes) {
+        check(m_api.DeserializeFMUState(m_instance, bytes.data(), bytes.size(), &m_state), "fmi3DeserializeFMUState");
+        check(m_api.SetFMUState(m_instance, m_state), "fmi3SetFMUState");
+    }
+
+    StateBytes save() {
+        check(m_api.GetFMUState(m_instance, &m_state), "fmi3GetFMUState");
+        size_t size = 0;
+        check(m_api.SerializedFMUStateSize(m_instance, m_state, &size), "fmi3SerializedFMUStateSize");
+        StateBytes bytes(size);
+        check(m_api.SerializeFMUState(m_instance, m_state, bytes.data(), size), "fmi3SerializeFMUState");
+        return bytes;
+    }
+
+    /** @brief Steps from t0 to t1 in `steps` equal steps; appends the outputs after each step if `trace` is given. */
+    void advance(double t0, double t1, size_t steps, std::vector<double>* trace) {
+        const double h = (t1 - t0) / static_cast<double>(steps);
+        for (size_t i = 0; i < steps; i++) {
+            const double t = t0 + h * static_cast<double>(i);
+            applyInputs(t);
+            fmi3Boolean eventHandlingNeeded, terminateSimulation, earlyReturn;
+            fmi3Float64 lastSuccessfulTime;
+            check(m_api.DoStep(m_instance, t, h, fmi3False, &eventHandlingNeeded, &terminateSimulation, &earlyReturn, &lastSuccessfulTime), "fmi3DoStep");
+            if (trace) {
+                trace->push_back(t + h);
+                const size_t offset = trace->size();
+                trace->resize(offset + m_options.outputVrs.size());
+                read(m_options.outputVrs, trace->data() + offset);
+            }
+        }
+    }
+
+    void read(const std::vector<fmi3ValueReference>& vrs, double* values) {
+        if (!vrs.empty()) check(m_api.GetFloat64(m_instance, vrs.data(), vrs.size(), values, vrs.size()), "fmi3GetFloat64");
+    }
+
+    void write(const std::vector<fmi3ValueReference>& vrs, const double* values) {
+        if (!vrs.empty()) check(m_api.SetFloat64(m_instance, vrs.data(), vrs.size(), values, vrs.size()), "fmi3SetFloat64");
+    }
+
+private:
+    void applyInputs(double t) {
+        for (const InputSpec& input : m_options.inputs) {
+            const double value = input.at(t);
+            check(m_api.SetFloat64(m_instance, &input.vr, 1, &value, 1), "setting an input");
+        }
+    }
+
+    const Fmi3Api& m_api;
+    const Options& m_options;
+    fmi3Instance m_instance = nullptr;
+    fmi3FMUState m_state = nullptr; // Reused for every save and restore of this instance.
+};
+
+size_t stepsFor(double span, double step) {
+    return std::max<size_t>(1, static_cast<size_t>(std::llround(span / step)));
+}
+
+std::vector<fmi3ValueReference> parseVrs(const char* text) {
+    std::vector<fmi3ValueReference> vrs;
+    for (const char* p = text; *p;) {
+        char* end;
+        vrs.push_back(static_cast<fmi3ValueReference>(std::strtoul(p, &end, 10)));
+        if (end == p) throw std::runtime_error(std::string("invalid value reference list: ") + text);
+        p = *end == ',' ? end + 1 : end;
+    }
+    return vrs;
+}
+
+InputSpec parseInput(const std::string& text) {
+    InputSpec input;
+    char kind[16] = {0};
+    if (std::sscanf(text.c_str(), "%u:%15[a-z]:%lf:%lf", &input.vr, kind, &input.amplitude, &input.frequency) < 3 ||
+        (std::strcmp(kind, "const") != 0 && std::strcmp(kind, "sine") != 0)) {
+        throw std::runtime_error("invalid --input '" + text + "'; use vr:const:value or vr:sine:amplitude:frequency");
+    }
+    input.sine = std::strcmp(kind, "sine") == 0;
+    return input;
+}
+
+Options parseOptions(int argc, char** argv) {
+    if (argc < 2) throw std::runtime_error("usage: parareal_runner <fmu binary> [options]; see parareal_runner.cpp");
+    Options options;
+    options.library = argv[1];
+    for (int i = 2; i < argc; i++) {
+        const std::string arg = argv[i];
+        auto value = [&]() -> const char* {
+            if (i + 1 >= argc) throw std::runtime_error("missing value for " + arg);
+            return argv[++i];
+        };
+        if (arg == "--start") options.start = std::atof(value());
+        else if (arg == "--stop") options.stop = std::atof(value());
+        else if (arg == "--slices") options.slices = std::strtoul(value(), nullptr, 10);
+        else if (arg == "--coarse-step") options.coarseStep = std::atof(value());
+        else if (arg == "--fine-step") options.fineStep = std::atof(value());
+        else if (arg == "--iterations") options.iterations = std::strtoul(value(), nullptr, 10);
+        else if (arg == "--tolerance") options.tolerance = std::atof(value());
+        else if (arg == "--threads") options.threads = std::strtoul(value(), nullptr, 10);
+        else if (arg == "--state-vrs") options.stateVrs = parseVrs(value());
+        else if (arg == "--output-vrs") options.outputVrs = parseVrs(value());
+        else if (arg == "--input") options.inputs.push_back(parseInput(value()));
+        else if (arg == "--token") options.token = value();
+        else if (arg == "--resources") options.resources = value();
+        else if (arg == "--csv") options.csv = value();
+        else if (arg == "--verify") options.verify = true;
+        else if (arg == "--set") {
+            const std::string assignment = value();
+            const size_t eq = assignment.find('=');
+            if (eq == std::string::npos) throw std::runtime_error("invalid --set '" + assignment + "'; use vr=value");
+            options.parameters.emplace_back(static_cast<fmi3ValueReference>(std::stoul(assignment.substr(0, eq))), std::stod(assignment.substr(eq + 1)));
+        } else {
+            throw std::runtime_error("unknown option " + arg);
+        }
+    }
+    if (options.threads == 0) options.threads = std::max(1u, std::thread::hardware_concurrency());
+    if (options.slices == 0) options.slices = 4 * options.threads;
+    if (options.iterations == 0 || options.iterations > options.slices) options.iterations = options.slices;
+    if (!(options.stop > options.start) || options.fineStep <= 0.0 || options.coarseStep <= 0.0) {
+        throw std::runtime_error("need --stop > --start and positive step sizes");
+    }
+    return options;
+}
+
+/**
+ * @class Parareal
+ * @brief The coarse/fine iteration over all slices.
+ */
+class Parareal {
+public:
+    Parareal(const Fmi3Api& api, const Options& options) : m_api(api), m_options(options), m_coarse(api, options) {
+        const size_t n = options.slices;
+        m_boundaries.resize(n + 1);
+        for (size_t i = 0; i <= n; i++) m_boundaries[i] = options.start + (options.stop - options.start) * static_cast<double>(i) / static_cast<double>(n);
+        m_traces.resize(n);
+        for (size_t w = 0; w < std::min(options.threads, n); w++) m_fine.emplace_back(std::make_unique<Runner>(api, options));
+        // Convergence is measured on the state variables, or on the outputs if no state is exposed.
+        m_measureVrs = options.stateVrs.empty() ? options.outputVrs : options.stateVrs;
+    }
+
+    /** @brief Runs the iteration; returns the number of fine sweeps. */
+    size_t run() {
+        const size_t n = m_options.slices;
+        std::vector<StateBytes> states(n + 1);     // U[n], the current boundary states.
+        std::vector<StateBytes> coarse(n + 1);     // G(U_old[n-1]) from the previous sweep.
+        std::vector<StateBytes> fine(n + 1);       // F(U_old[n-1]).
+        std::vector<std::vector<double>> measured(n + 1, std::vector<double>(m_measureVrs.size()));
+
+        // Initial coarse pass.
+        states[0] = m_coarse.save();
+        for (size_t i = 0; i < n; i++) {
+            m_coarse.restore(states[i]);
+            coarseStep(i);
+            coarse[i + 1] = states[i + 1] = m_coarse.save();
+            m_coarse.read(m_measureVrs, measured[i + 1].data());
+        }
+
+        size_t converged = 0; // Slices [0, converged) are exact.
+        size_t sweep = 0;
+        while (converged < n && sweep < m_options.iterations) {
+            sweep++;
+            fineSweep(states, fine, converged);
+            // Slice `converged` started from an exact state, so its fine result is exact too.
+            double change = 0.0;
+            std::vector<StateBytes> next(n + 1);
+            next[converged + 1] = fine[converged + 1];
+            for (size_t i = converged + 1; i < n; i++) {
+                m_coarse.restore(next[i]);
+                coarseStep(i);
+                StateBytes predicted = m_coarse.save();
+                next[i + 1] = correct(predicted, fine[i + 1], coarse[i + 1]);
+                coarse[i + 1] = std::move(predicted);
+            }
+            // Boundary `first` is exact by construction (see above); the ones after it count as
+            // converged while they, and all before them, moved by no more than the tolerance.
+            const size_t first = converged + 1;
+            size_t exact = first + 1;
+            for (size_t i = first; i <= n; i++) {
+                std::vector<double> values(m_measureVrs.size());
+                m_coarse.restore(next[i]);
+                m_coarse.read(m_measureVrs, values.data());
+                double delta = 0.0;
+                for (size_t v = 0; v < values.size(); v++) delta = std::max(delta, std::fabs(values[v] - measured[i][v]));
+                if (m_measureVrs.empty() && next[i] != states[i]) delta = INFINITY;
+                if (i > first && delta <= m_options.tolerance && exact == i) exact = i + 1;
+                change = std::max(change, delta);
+                measured[i] = std::move(values);
+                states[i] = std::move(next[i]);
+            }
+            converged = exact - 1;
+            std::printf("iteration %zu: max boundary change %.3g, %zu of %zu slices converged\n", sweep, change, converged, n);
+        }
+        // Slices [0, converged) were last refined from boundaries that have not moved beyond the
+        // tolerance since; the rest still hold traces from older boundaries (or only the coarse
+        // pass), so refine them once more from the final ones.
+        if (converged < n) fineSweep(states, fine, converged);
+        return sweep;
+    }
+
+    void writeCsv(FILE* out) const {
+        std::fprintf(out, "time");
+        for (fmi3ValueReference vr : m_options.outputVrs) std::fprintf(out, ",vr%u", vr);
+        std::fprintf(out, "\n");
+        const size_t stride = 1 + m_options.outputVrs.size();
+        for (const std::vector<double>& trace : m_traces) {
+            for (size_t row = 0; row + stride <= trace.size(); row += stride) {
+                std::fprintf(out, "%.17g", trace[row]);
+                for (size_t v = 1; v < stride; v++) std::fprintf(out, ",%.17g", trace[row + v]);
+                std::fprintf(out, "\n");
+            }
+        }
+    }
+
+    const std::vector<std::vector<double>>& traces() const { return m_traces; }
+
+private:
+    void coarseStep(size_t slice) {
+        const double t0 = m_boundaries[slice], t1 = m_boundaries[slice + 1];
+        m_coarse.advance(t0, t1, stepsFor(t1 - t0, m_options.coarseStep), nullptr);
+    }
+
+    // Refines slices [from, n) in parallel; fine[i + 1] = F(states[i]).
+    void fineSweep(const std::vector<StateBytes>& states, std::vector<StateBytes>& fine, size_t from) {
+        std::atomic<size_t> next{from};
+        std::vector<std::thread> workers;
+        std::vector<std::string> errors(m_fine.size());
+        for (size_t w = 0; w < m_fine.size(); w++) {
+            workers.emplace_back([&, w] {
+                try {
+                    for (size_t i = next++; i < m_options.slices; i = next++) {
+                        const double t0 = m_boundaries[i], t1 = m_boundaries[i + 1];
+                        m_traces[i].clear();
+                        m_fine[w]->restore(states[i]);
+                        m_fine[w]->advance(t0, t1, stepsFor(t1 - t0, m_options.fineStep), &m_traces[i]);
+                        fine[i + 1] = m_fine[w]->save();
+                    }
+                } catch (const std::exception& e) {
+                    errors[w] = e.what();
+                    next = m_options.slices;
+                }
+            });
+        }
+        for (std::thread& worker : workers) worker.join();
+        for (const std::string& error : errors) {
+            if (!error.empty()) throw std::runtime_error(error);
+        }
+    }
+
+    // U_new = G(U_new[i]) + F(U_old[i]) - G(U_old[i]) on the state variables, rest from the fine state.
+    StateBytes correct(const StateBytes& predicted, const StateBytes& fine, const StateBytes& coarse) {
+        const size_t count = m_options.stateVrs.size();
+        if (count == 0) return predicted;
+        std::vector<double> g(count), f(count), gOld(count);
+        m_coarse.restore(predicted);
+        m_coarse.read(m_options.stateVrs, g.data());
+        m_coarse.restore(coarse);
+        m_coarse.read(m_options.stateVrs, gOld.data());
+        m_coarse.restore(fine);
+        m_coarse.read(m_options.stateVrs, f.data());
+        for (size_t v = 0; v < count; v++) g[v] += f[v] - gOld[v];
+        m_coarse.write(m_options.stateVrs, g.data());
+        return m_coarse.save();
+    }
+
+    const Fmi3Api& m_api;
+    const Options& m_options;
+    Runner m_coarse;
+    std::vector<std::unique_ptr<Runner>> m_fine;
+    std::vector<double> m_boundaries;
+    std::vector<fmi3ValueReference> m_measureVrs;
+    std::vector<std::vector<double>> m_traces; // Per slice: time, outputs... after every fine step.
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        const Options options = parseOptions(argc, argv);
+        DLL_HANDLE library = LOAD_LIBRARY(options.library.c_str());
+        if (!library) throw std::runtime_error("cannot load " + options.library);
+        Fmi3Api api;
+        api.load(library);
+
+        std::printf("Parareal: [%g, %g] in %zu slices, coarse step %g, fine step %g, %zu threads\n", options.start, options.stop,
+                    options.slices, options.coarseStep, options.fineStep, options.threads);
+        const auto start = Clock::now();
+        double parallelSeconds;
+        {
+            Parareal parareal(api, options);
+            const size_t sweeps = parareal.run();
+            parallelSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+            std::printf("finished after %zu fine sweeps in %.3f s\n", sweeps, parallelSeconds);
+
+            if (!options.csv.empty()) {
+                FILE* out = std::fopen(options.csv.c_str(), "w");
+                if (!out) throw std::runtime_error("cannot write " + options.csv);
+                parareal.writeCsv(out);
+                std::fclose(out);
+            }
+
+            if (options.verify) {
+                // Sequential fine reference over the whole span.
+                const auto sequentialStart = Clock::now();
+                Runner reference(api, options);
+                std::vector<double> trace;
+                for (size_t i = 0; i < options.slices; i++) {
+                    const double t0 = options.start + (options.stop - options.start) * static_cast<double>(i) / static_cast<double>(options.slices);
+                    const double t1 = options.start + (options.stop - options.start) * static_cast<double>(i + 1) / static_cast<double>(options.slices);
+                    reference.advance(t0, t1, stepsFor(t1 - t0, options.fineStep), &trace);
+                }
+                const double sequentialSeconds = std::chrono::duration<double>(Clock::now() - sequentialStart).count();
+                double maxError = 0.0;
+                size_t offset = 0;
+                for (const std::vector<double>& slice : parareal.traces()) {
+                    for (size_t k = 0; k < slice.size() && offset + k < trace.size(); k++) maxError = std::max(maxError, std::fabs(slice[k] - trace[offset + k]));
+                    offset += slice.size();
+                }
+                std::printf("sequential fine run: %.3f s (speedup %.2fx), max output deviation %.3g\n", sequentialSeconds,
+                            sequentialSeconds / parallelSeconds, maxError);
+            }
+        }
+        FREE_LIBRARY(library);
+        return 0;
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "parareal_runner: %s\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,69 @@
+// Serializes and restores an FMU state taken before nChannels was changed in configuration
+// mode; the state's own channel count, not the instance's, must size every copy.
+// Built and run under AddressSanitizer by test_state_resize.sh.
+#include <cstdio>
+#include <vector>
+
+#include "fmi3Functions.h"
+
+namespace {
+
+const fmi3ValueReference VR_U = 1;
+const fmi3ValueReference VR_N_CHANNELS = 4;
+
+void logMessage(fmi3InstanceEnvironment, fmi3Status status, fmi3String category, fmi3String message) {
+    if (status != fmi3OK) std::fprintf(stderr, "[%s] %s\n", category, message);
+}
+
+bool check(bool condition, const char* what) {
+    if (!condition) std::fprintf(stderr, "FAILED: %s\n", what);
+    return condition;
+}
+
+} // namespace
+
+int main() {
+    fmi3Instance instance = fmi3InstantiateCoSimulation("state_resize", "", "", fmi3False, fmi3False, fmi3False, fmi3False,
+                                                        nullptr, 0, nullptr, logMessage, nullptr);
+    if (!check(instance != nullptr, "instantiate")) return 1;
+
+    bool ok = true;
+    const fmi3Float64 u = 7.0;
+    ok &= check(fmi3SetFloat64(instance, &VR_U, 1, &u, 1) == fmi3OK, "set u with one channel");
+    fmi3FMUState before = nullptr;
+    ok &= check(fmi3GetFMUState(instance, &before) == fmi3OK, "get state with one channel");
+
+    const fmi3UInt64 wide = 100000;
+    ok &= check(fmi3EnterConfigurationMode(instance) == fmi3OK, "enter configuration mode");
+    ok &= check(fmi3SetUInt64(instance, &VR_N_CHANNELS, 1, &wide, 1) == fmi3OK, "set nChannels");
+    ok &= check(fmi3ExitConfigurationMode(instance) == fmi3OK, "exit configuration mode");
+
+    // The old state still describes one channel, whatever the instance holds now.
+    size_t size = 0;
+    ok &= check(fmi3SerializedFMUStateSize(instance, before, &size) == fmi3OK, "serialized size");
+    std::vector<fmi3Byte> buffer(size);
+    ok &= check(fmi3SerializeFMUState(instance, before, buffer.data(), buffer.size()) == fmi3OK, "serialize old state");
+
+    fmi3FMUState restored = nullptr;
+    ok &= check(fmi3DeserializeFMUState(instance, buffer.data(), buffer.size(), &restored) == fmi3OK, "deserialize");
+    ok &= check(fmi3SetFMUState(instance, restored) == fmi3OK, "set deserialized state");
+    fmi3UInt64 channels = 0;
+    fmi3Float64 value = 0.0;
+    ok &= check(fmi3GetUInt64(instance, &VR_N_CHANNELS, 1, &channels, 1) == fmi3OK && channels == 1, "nChannels restored");
+    ok &= check(fmi3GetFloat64(instance, &VR_U, 1, &value, 1) == fmi3OK && value == u, "u restored");
+
+    // Setting the original state directly takes the same path.
+    ok &= check(fmi3EnterConfigurationMode(instance) == fmi3OK && fmi3SetUInt64(instance, &VR_N_CHANNELS, 1, &wide, 1) == fmi3OK &&
+                fmi3ExitConfigurationMode(instance) == fmi3OK, "resize again");
+    ok &= check(fmi3SetFMUState(instance, before) == fmi3OK, "set old state");
+    ok &= check(fmi3GetFloat64(instance, &VR_U, 1, &value, 1) == fmi3OK && value == u, "u restored from the old state");
+
+    // Overwriting a state in place must keep working once the pool is full.
+    for (int i = 0; i < 64; i++) ok &= check(fmi3GetFMUState(instance, &before) == fmi3OK, "overwrite state");
+    fmi3FreeFMUState(instance, &before);
+    fmi3FreeFMUState(instance, &restored);
+    fmi3FreeInstance(instance);
+
+    std::puts(ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
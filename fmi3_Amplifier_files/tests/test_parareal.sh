@@ -0,0 +1,34 @@
+#!/bin/bash
+# Runs parareal_runner --verify on the amplifier and checks that the run matches the
+# sequential fine reference and converges in fewer fine sweeps than there are slices
+# (one sweep per slice is plain sequential refinement, i.e. no convergence across slices).
+# Usage: tests/test_parareal.sh (from fmi3_Amplifier_files or anywhere else)
+
+set -e
+
+MODEL_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+WORK_DIR="$(mktemp -d)"
+trap 'rm -rf "${WORK_DIR}"' EXIT
+
+SLICES=8
+cd "${MODEL_DIR}"
+g++ -shared -fPIC -std=c++17 -O2 -I. fmi3_amplifier.cpp ThreadPool.cpp TuningCache.cpp -o "${WORK_DIR}/fmi3_amplifier.so" -lpthread -ldl
+g++ -std=c++17 -O2 -I. parareal_runner.cpp -o "${WORK_DIR}/parareal_runner" -lpthread -ldl
+"${WORK_DIR}/parareal_runner" "${WORK_DIR}/fmi3_amplifier.so" --stop 4 --slices "${SLICES}" --coarse-step 0.1 --fine-step 0.001 \
+    --threads 4 --input 1:sine:1:0.5 --output-vrs 2 --verify | tee "${WORK_DIR}/run.log"
+
+SWEEPS="$(sed -n 's/^finished after \([0-9]*\) fine sweeps.*/\1/p' "${WORK_DIR}/run.log")"
+DEVIATION="$(sed -n 's/.*max output deviation \(.*\)$/\1/p' "${WORK_DIR}/run.log")"
+if [[ -z "${SWEEPS}" || -z "${DEVIATION}" ]]; then
+    echo "FAILED: no result line"
+    exit 1
+fi
+if (( SWEEPS >= SLICES )); then
+    echo "FAILED: ${SWEEPS} fine sweeps for ${SLICES} slices"
+    exit 1
+fi
+if ! awk -v d="${DEVIATION}" 'BEGIN { exit !(d <= 1e-9) }'; then
+    echo "FAILED: max output deviation ${DEVIATION} from the sequential run"
+    exit 1
+fi
+echo "OK"
@@ -0,0 +1,15 @@
+#!/bin/bash
+# Builds the amplifier with AddressSanitizer and checks that a state taken before nChannels
+# changed still serializes and restores within its own arrays.
+# Usage: tests/test_state_resize.sh (from fmi3_Amplifier_files or anywhere else)
+
+set -e
+
+MODEL_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+WORK_DIR="$(mktemp -d)"
+trap 'rm -rf "${WORK_DIR}"' EXIT
+
+cd "${MODEL_DIR}"
+g++ -std=c++17 -O1 -g -fsanitize=address,undefined -fno-omit-frame-pointer -I. \
+    tests/state_resize.cpp fmi3_amplifier.cpp ThreadPool.cpp TuningCache.cpp -o "${WORK_DIR}/state_resize" -lpthread -ldl
+ASAN_OPTIONS=detect_leaks=1 "${WORK_DIR}/state_resize"
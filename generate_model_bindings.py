@@ -0,0 +1,366 @@
+"""
+Generates a C++ header of compile-time variable bindings from an FMI 2.0 or 3.0 modelDescription.xml.
+
+The wrappers used to repeat their value references by hand (VR_U, VR_Y, VR_K, renumbered for
+FMI 3), which could silently drift from the XML. The generated header instead provides, for
+every variable type the model uses (for FMI 2, for every type, possibly with no variables):
+  * a descriptor struct with the constexpr table of variables (name, value reference, bank
+    index, causality, settable) and their start values,
+  * bank index constants and VR_<NAME> value reference constants,
+  * for FMI 3 array variables, a separate <Type>Array descriptor whose extents are the values
+    of the structural parameters referenced by their <Dimension> element,
+  * model::Dispatch<Type>, a template that builds the value reference -> bank index tables
+    for get and set at compile time, so a get/set is an array index rather than a lookup,
+  * static_asserts on the layout (unique value references, bank sizes).
+The build scripts regenerate the header before compiling; the generated file is also committed
+so builds without Python keep working.
+
+Usage: python generate_model_bindings.py modelDescription.xml ModelBindings.hpp
+"""
+import argparse
+import os
+import re
+import sys
+import xml.etree.ElementTree as ET
+
+MAX_DENSE_VR = 1 << 16
+
+# C type of each supported variable type, per FMI version.
+FMI2_TYPES = {"Real": "fmi2Real", "Integer": "fmi2Integer", "Boolean": "fmi2Boolean"}
+FMI3_TYPES = {
+    "Float64": "fmi3Float64", "Float32": "fmi3Float32",
+    "Int8": "fmi3Int8", "UInt8": "fmi3UInt8", "Int16": "fmi3Int16", "UInt16": "fmi3UInt16",
+    "Int32": "fmi3Int32", "UInt32": "fmi3UInt32", "Int64": "fmi3Int64", "UInt64": "fmi3UInt64",
+    "Boolean": "fmi3Boolean",
+}
+CAUSALITIES = {
+    "parameter": "Parameter", "calculatedParameter": "CalculatedParameter", "input": "Input",
+    "output": "Output", "local": "Local", "independent": "Independent",
+    "structuralParameter": "StructuralParameter",
+}
+# Variables the API may set after instantiation; outputs, locals and the independent variable are read-only.
+SETTABLE = {"input", "parameter", "structuralParameter"}
+CPP_KEYWORDS = {"int", "double", "float", "bool", "char", "class", "struct", "union", "enum", "return",
+                "default", "delete", "new", "this", "true", "false", "template", "typename", "namespace"}
+
+
+class Variable:
+    def __init__(self, name, vr, type_name, causality, start, dimension=None):
+        self.name = name
+        self.vr = vr
+        self.type_name = type_name
+        self.causality = causality
+        self.start = start
+        self.dimension = dimension  # Value reference of the extent's structural parameter, for arrays.
+
+
+def read_model(path):
+    """Returns (fmi_version, [Variable]) in model description order."""
+    root = ET.parse(path).getroot()
+    version = root.get("fmiVersion", "")
+    variables = []
+    if version.startswith("2."):
+        for sv in root.find("ModelVariables").findall("ScalarVariable"):
+            typed = next((child for child in sv if child.tag in FMI2_TYPES or child.tag in ("String", "Enumeration")), None)
+            if typed is None or typed.tag not in FMI2_TYPES:
+                raise SystemExit(f"{path}: variable '{sv.get('name')}' has no supported type element")
+            variables.append(Variable(sv.get("name"), int(sv.get("valueReference")), typed.tag,
+                                      sv.get("causality", "local"), typed.get("start")))
+        return 2, variables
+    if version.startswith("3."):
+        for element in root.find("ModelVariables"):
+            if element.tag not in FMI3_TYPES:
+                raise SystemExit(f"{path}: variable '{element.get('name')}' has unsupported type {element.tag}")
+            dimensions = element.findall("Dimension")
+            if len(dimensions) > 1 or any(d.get("valueReference") is None for d in dimensions):
+                raise SystemExit(f"{path}: array variable '{element.get('name')}' must have one Dimension "
+                                 "given by a structural parameter")
+            dimension = int(dimensions[0].get("valueReference")) if dimensions else None
+            variables.append(Variable(element.get("name"), int(element.get("valueReference")), element.tag,
+                                      element.get("causality", "local"), element.get("start"), dimension))
+        return 3, variables
+    raise SystemExit(f"{path}: unsupported fmiVersion '{version}'")
+
+
+def identifier(name):
+    ident = re.sub(r"\W", "_", re.sub(r"(?<=[a-z0-9])(?=[A-Z])", "_", name)).upper()
+    if ident[0].isdigit() or ident.lower() in CPP_KEYWORDS:
+        ident = "V_" + ident
+    return ident
+
+
+def start_literal(var, version):
+    """Start value as a C++ literal; arrays use their first start value for every element."""
+    if var.start is not None and var.dimension is not None:
+        var = Variable(var.name, var.vr, var.type_name, var.causality, (var.start.split() or [None])[0])
+    if var.type_name == "Boolean":
+        true = var.start in ("true", "1")
+        return f"fmi{version}True" if true else f"fmi{version}False"
+    if var.type_name.startswith("Float") or var.type_name == "Real":
+        value = repr(float(var.start or 0.0))
+        return value + ("f" if var.type_name == "Float32" else "")
+    return str(int(var.start or 0))
+
+
+def check(variables, path):
+    seen = {}
+    for var in variables:
+        if var.vr in seen:
+            raise SystemExit(f"{path}: value reference {var.vr} is used by '{seen[var.vr]}' and '{var.name}'")
+        if var.vr >= MAX_DENSE_VR:
+            raise SystemExit(f"{path}: value reference {var.vr} of '{var.name}' is too large for a dense table")
+        if var.causality not in CAUSALITIES:
+            raise SystemExit(f"{path}: variable '{var.name}' has unknown causality '{var.causality}'")
+        seen[var.vr] = var.name
+    by_vr = {var.vr: var for var in variables}
+    for var in variables:
+        if var.dimension is None:
+            continue
+        extent = by_vr.get(var.dimension)
+        if extent is None or extent.causality != "structuralParameter" or extent.dimension is not None \
+                or not extent.type_name.startswith("UInt"):
+            raise SystemExit(f"{path}: dimension of '{var.name}' must be a scalar unsigned structural parameter")
+    idents = [identifier(var.name) for var in variables]
+    duplicates = {ident for ident in idents if idents.count(ident) > 1}
+    if duplicates:
+        raise SystemExit(f"{path}: variable names map to the same identifier: {', '.join(sorted(duplicates))}")
+
+
+TEMPLATES = """
+// --- Compile-time dispatch -------------------------------------------------------------
+
+// The values of one variable type, indexed by the descriptor's bank indices.
+template <class Type>
+using Bank = std::array<typename Type::Value, Type::COUNT>;
+
+template <class Type>
+constexpr Bank<Type> startValues() {
+    Bank<Type> bank{};
+    for (size_t i = 0; i < Type::COUNT; i++) bank[i] = Type::START[i];
+    return bank;
+}
+
+/**
+ * @brief Value reference -> bank index tables for one variable type, built at compile time.
+ *
+ * get() and set() copy values between a Bank and the caller's array with one table index
+ * per element. They return false on the first value reference that is unknown for this
+ * type (or not settable, for set()); the caller reports the error. getIndex() and
+ * setIndex() expose the lookup for storage that is not a Bank; they return NONE instead.
+ */
+template <class Type>
+class Dispatch {
+public:
+    using Value = typename Type::Value;
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+    static uint32_t getIndex(ValueReference vr) { return vr < VR_LIMIT ? GET[vr] : NONE; }
+    static uint32_t setIndex(ValueReference vr) { return vr < VR_LIMIT ? SET[vr] : NONE; }
+
+    static bool get(const Bank<Type>& bank, const ValueReference vr[], size_t nvr, Value value[]) {
+        for (size_t i = 0; i < nvr; i++) {
+            const uint32_t index = getIndex(vr[i]);
+            if (index == NONE) return false;
+            value[i] = bank[index];
+        }
+        return true;
+    }
+
+    static bool set(Bank<Type>& bank, const ValueReference vr[], size_t nvr, const Value value[]) {
+        for (size_t i = 0; i < nvr; i++) {
+            const uint32_t index = setIndex(vr[i]);
+            if (index == NONE) return false;
+            bank[index] = value[i];
+        }
+        return true;
+    }
+
+private:
+    static constexpr ValueReference limit() {
+        ValueReference limit = 0;
+        for (const Variable& var : Type::VARIABLES) limit = var.valueReference >= limit ? var.valueReference + 1 : limit;
+        return limit;
+    }
+
+    static constexpr ValueReference VR_LIMIT = limit();
+
+    static constexpr std::array<uint32_t, VR_LIMIT> table(bool settableOnly) {
+        std::array<uint32_t, VR_LIMIT> table{};
+        for (uint32_t& entry : table) entry = NONE;
+        for (const Variable& var : Type::VARIABLES) {
+            if (!settableOnly || var.settable) table[var.valueReference] = var.index;
+        }
+        return table;
+    }
+
+    static constexpr std::array<uint32_t, VR_LIMIT> GET = table(false);
+    static constexpr std::array<uint32_t, VR_LIMIT> SET = table(true);
+
+    static constexpr bool consistent() {
+        for (size_t i = 0; i < Type::COUNT; i++) {
+            if (Type::VARIABLES[i].index != i || GET[Type::VARIABLES[i].valueReference] != i) return false;
+        }
+        return true;
+    }
+    static_assert(Type::COUNT == std::size(Type::VARIABLES) && Type::COUNT == std::size(Type::START),
+                  "descriptor tables disagree on the variable count");
+    static_assert(consistent(), "value references are not unique or bank indices are not dense");
+};
+"""
+
+
+def generate(path, output):
+    version, variables = read_model(path)
+    check(variables, path)
+    types = FMI2_TYPES if version == 2 else FMI3_TYPES
+    vr_type = f"fmi{version}ValueReference"
+    stem, ext = os.path.splitext(os.path.basename(output))
+    guard = (re.sub(r"(?<=[a-z0-9])(?=[A-Z])", "_", stem) + "_" + ext.lstrip(".")).upper()
+    source = os.path.basename(path)
+
+    lines = [
+        "/**",
+        f" * @file {os.path.basename(output)}",
+        f" * @brief Compile-time variable bindings generated from {source} (FMI {version}.0).",
+        " *",
+        " * Generated by generate_model_bindings.py; do not edit. The build regenerates this file",
+        " * from the model description, so value references cannot drift from the XML.",
+        " */",
+        f"#ifndef {guard}",
+        f"#define {guard}",
+        "",
+        "#include <array>",
+        "#include <cstddef>",
+        "#include <cstdint>",
+        "#include <iterator>",
+        "",
+    ]
+    if version == 2:
+        lines += ['extern "C" {', '#include "fmi2Functions.h"', "}"]
+    else:
+        lines += ['#include "fmi3Functions.h"']
+    lines += ["", "// Value references of all variables."]
+    width = max(len(identifier(var.name)) for var in variables) + 3
+    for var in variables:
+        lines.append(f"constexpr {vr_type} {('VR_' + identifier(var.name)).ljust(width)} = {var.vr};")
+
+    lines += [
+        "",
+        "namespace model {",
+        "",
+        f"using ValueReference = {vr_type};",
+        "",
+        "enum class Causality : uint8_t { " + ", ".join(dict.fromkeys(CAUSALITIES.values())) + " };",
+        "",
+        "struct Variable {",
+        "    const char* name;",
+        "    ValueReference valueReference;",
+        "    uint32_t index;     // Position in the bank of the variable's type.",
+        "    Causality causality;",
+        "    bool settable;      // Inputs and parameters; outputs, locals and the independent variable are read-only.",
+        "};",
+    ]
+
+    scalars = [var for var in variables if var.dimension is None]
+    arrays = [var for var in variables if var.dimension is not None]
+    for type_name, c_type in types.items():
+        members = [var for var in scalars if var.type_name == type_name]
+        # FMI 2 descriptors always exist, so code written against the wrapper's own types
+        # compiles whether or not the model has variables of that type.
+        if not members and version == 3:
+            continue
+        lines += [
+            "",
+            f"// {type_name} variables.",
+            f"struct {type_name} {{",
+            f"    using Value = {c_type};",
+            f"    static constexpr size_t COUNT = {len(members)};",
+            "",
+        ]
+        ident_width = max((len(identifier(var.name)) for var in members), default=0)
+        for index, var in enumerate(members):
+            lines.append(f"    static constexpr uint32_t {identifier(var.name).ljust(ident_width)} = {index};")
+        if members:
+            lines += ["", "    static constexpr std::array<Variable, COUNT> VARIABLES = {{"]
+            for index, var in enumerate(members):
+                settable = "true" if var.causality in SETTABLE else "false"
+                lines.append(f'        {{"{var.name}", {var.vr}, {index}, Causality::{CAUSALITIES[var.causality]}, {settable}}},')
+            lines.append("    }};")
+        else:
+            lines.append("    static constexpr std::array<Variable, COUNT> VARIABLES = {};")
+        starts = ", ".join(start_literal(var, version) for var in members)
+        lines += [
+            "    static constexpr std::array<Value, COUNT> START = " + ("{{" + starts + "}}" if members else "{}") + ";",
+            "};",
+        ]
+
+    if arrays:
+        lines += [
+            "",
+            "// An array variable; its extent is the current value of the structural parameter `dimension`.",
+            "struct ArrayVariable {",
+            "    const char* name;",
+            "    ValueReference valueReference;",
+            "    uint32_t index;",
+            "    ValueReference dimension;",
+            "    Causality causality;",
+            "    bool settable;",
+            "};",
+        ]
+    for type_name, c_type in types.items():
+        members = [var for var in arrays if var.type_name == type_name]
+        if not members:
+            continue
+        lines += [
+            "",
+            f"// {type_name} array variables; the model owns their storage.",
+            f"struct {type_name}Array {{",
+            f"    using Value = {c_type};",
+            f"    static constexpr size_t COUNT = {len(members)};",
+            "",
+        ]
+        ident_width = max(len(identifier(var.name)) for var in members)
+        for index, var in enumerate(members):
+            lines.append(f"    static constexpr uint32_t {identifier(var.name).ljust(ident_width)} = {index};")
+        lines += ["", "    static constexpr std::array<ArrayVariable, COUNT> VARIABLES = {{"]
+        for index, var in enumerate(members):
+            settable = "true" if var.causality in SETTABLE else "false"
+            lines.append(f'        {{"{var.name}", {var.vr}, {index}, {var.dimension}, '
+                         f'Causality::{CAUSALITIES[var.causality]}, {settable}}},')
+        lines += [
+            "    }};",
+            "    static constexpr std::array<Value, COUNT> START = {{" + ", ".join(start_literal(var, version) for var in members) + "}};",
+            "};",
+        ]
+
+    lines.append(TEMPLATES.rstrip("\n"))
+    lines += ["", "// Layout checks: a descriptor that disagrees with the XML fails here rather than at run time."]
+    for type_name, c_type in types.items():
+        count = sum(1 for var in scalars if var.type_name == type_name)
+        if count:
+            lines.append(f"static_assert(sizeof(Bank<{type_name}>) == {count} * sizeof({c_type}), \"{type_name} bank is not dense\");")
+        if count or version == 2:
+            lines.append(f"static_assert(sizeof(Dispatch<{type_name}>) > 0, \"instantiates the {type_name} table checks\");")
+    lines += ["", "} // namespace model", "", f"#endif // {guard}", ""]
+
+    content = "\n".join(lines)
+    # Leave the file untouched when nothing changed so dependent objects are not rebuilt.
+    if os.path.exists(output):
+        with open(output, encoding="utf-8") as existing:
+            if existing.read() == content:
+                return
+    with open(output, "w", encoding="utf-8", newline="\n") as f:
+        f.write(content)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("model_description", help="modelDescription.xml to read")
+    parser.add_argument("output", help="header to write, e.g. ModelBindings.hpp")
+    args = parser.parse_args()
+    generate(args.model_description, args.output)
+    print(f"Generated {args.output} from {args.model_description}")
+
+
+if __name__ == "__main__":
+    sys.exit(main())